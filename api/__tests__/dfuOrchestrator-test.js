@@ -0,0 +1,196 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const EventEmitter = require('events');
+const DfuOrchestrator = require('../dfuOrchestrator');
+
+class FakeTransport extends EventEmitter {
+    constructor(transportParameters, activeJobs) {
+        super();
+        this._adapter = transportParameters.adapter;
+        this._activeJobs = activeJobs;
+    }
+
+    init() {
+        const count = (this._activeJobs[this._adapter.instanceId] || 0) + 1;
+        this._activeJobs[this._adapter.instanceId] = count;
+        this._activeJobs.max[this._adapter.instanceId] =
+            Math.max(this._activeJobs.max[this._adapter.instanceId] || 0, count);
+        return Promise.resolve();
+    }
+
+    sendInitPacket() {
+        return Promise.resolve();
+    }
+
+    getFirmwareState() {
+        return Promise.resolve({ offset: 0 });
+    }
+
+    sendFirmware() {
+        return new Promise(resolve => setTimeout(resolve, 5));
+    }
+
+    waitForDisconnection() {
+        return Promise.resolve();
+    }
+
+    abort() {}
+
+    destroy() {
+        this._activeJobs[this._adapter.instanceId] -= 1;
+    }
+}
+
+// Fails halfway through sending the firmware
+class FailingTransport extends FakeTransport {
+    sendFirmware() {
+        this.emit('progressUpdate', { stage: 'Transferring firmware', offset: 4 });
+        return Promise.reject(new Error('Connection lost'));
+    }
+}
+
+function createUpdates() {
+    const updates = [{
+        datFile: { name: 'app.dat', loadData: () => Promise.resolve([1, 2, 3]) },
+        binFile: { name: 'app.bin', loadData: () => Promise.resolve([1, 2, 3, 4, 5, 6, 7, 8]) },
+    }];
+    return Promise.resolve({ updates, binFileSizes: { 'app.bin': 8 }, firmwareSize: 8 });
+}
+
+function createTargets(count) {
+    const targets = [];
+    for (let i = 0; i < count; i += 1) {
+        targets.push({ address: `target${i}`, addressType: 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC' });
+    }
+    return targets;
+}
+
+describe('constructor', () => {
+    it('throws error if no adapters are provided', () => {
+        expect(() => new DfuOrchestrator([])).toThrow();
+    });
+
+    it('creates instance if adapters are provided', () => {
+        expect(new DfuOrchestrator([{ instanceId: 'a', centralConnectionCount: 7 }])).toBeDefined();
+    });
+});
+
+describe('performDFU', () => {
+    it('limits concurrent jobs per adapter to its central connection count', done => {
+        const activeJobs = { max: {} };
+        const adapters = [
+            { instanceId: 'a', centralConnectionCount: 2 },
+            { instanceId: 'b', centralConnectionCount: 3 },
+        ];
+        const orchestrator = new DfuOrchestrator(adapters, {
+            transportFactory: params => new FakeTransport(params, activeJobs),
+        });
+        orchestrator._loadUpdates = createUpdates;
+
+        orchestrator.performDFU('firmware.zip', createTargets(12), (err, results) => {
+            expect(err).toBeUndefined();
+            expect(results.length).toEqual(12);
+            expect(results.every(result => !result.error && !result.aborted)).toBe(true);
+            expect(activeJobs.max.a).toEqual(2);
+            expect(activeJobs.max.b).toEqual(3);
+            done();
+        });
+    });
+
+    it('reports aggregate progress of all jobs', done => {
+        const activeJobs = { max: {} };
+        const orchestrator = new DfuOrchestrator([{ instanceId: 'a', centralConnectionCount: 7 }], {
+            maxJobsPerAdapter: 2,
+            transportFactory: params => new FakeTransport(params, activeJobs),
+        });
+        orchestrator._loadUpdates = createUpdates;
+
+        let lastProgress;
+        orchestrator.on('progressUpdate', progress => {
+            lastProgress = progress;
+        });
+
+        orchestrator.performDFU('firmware.zip', createTargets(4), () => {
+            expect(activeJobs.max.a).toEqual(2);
+            expect(lastProgress.totalBytes).toEqual(32);
+            expect(lastProgress.completedBytes).toEqual(32);
+            expect(lastProgress.percentCompleted).toEqual(100);
+            done();
+        });
+    });
+
+    it('does not count the partial file of a failed job as completed', done => {
+        const activeJobs = { max: {} };
+        const orchestrator = new DfuOrchestrator([{ instanceId: 'a', centralConnectionCount: 7 }], {
+            transportFactory: params => (params.targetAddress === 'target0' ?
+                new FailingTransport(params, activeJobs) : new FakeTransport(params, activeJobs)),
+        });
+        orchestrator._loadUpdates = createUpdates;
+
+        let lastProgress;
+        orchestrator.on('progressUpdate', progress => {
+            lastProgress = progress;
+        });
+
+        orchestrator.performDFU('firmware.zip', createTargets(2), (err, results) => {
+            expect(results[0].error).toBeDefined();
+            expect(results[1].error).toBeUndefined();
+            expect(lastProgress.completedBytes).toEqual(8);
+            done();
+        });
+    });
+});
+
+describe('abort', () => {
+    it('is ignored when no DFU is in progress', done => {
+        const activeJobs = { max: {} };
+        const orchestrator = new DfuOrchestrator([{ instanceId: 'a', centralConnectionCount: 7 }], {
+            transportFactory: params => new FakeTransport(params, activeJobs),
+        });
+        orchestrator._loadUpdates = createUpdates;
+
+        orchestrator.abort();
+
+        orchestrator.performDFU('firmware.zip', createTargets(1), (err, results) => {
+            expect(err).toBeUndefined();
+            expect(results[0].aborted).toBe(false);
+            done();
+        });
+    });
+});
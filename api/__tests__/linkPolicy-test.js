@@ -0,0 +1,85 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const Adapter = require('../adapter');
+
+// Constants of the AddOn used by the link policy, the AddOn adapter is replaced by a fake gattsExchangeMtuReply
+const bleDriver = {
+    BLE_GATT_ATT_MTU_DEFAULT: 23,
+    NRF_SD_BLE_API_VERSION: 5,
+    eccInit: () => {},
+};
+
+const CONN_HANDLE = 1;
+
+function createAdapter() {
+    const adapter = new Adapter(bleDriver, {
+        gattsExchangeMtuReply: jest.fn((connHandle, mtu, callback) => callback()),
+    }, 'fake', 'fake');
+
+    adapter._linkPolicy = { attMtu: 100 };
+    adapter._devices.peer = { instanceId: 'peer', connectionHandle: CONN_HANDLE };
+    return adapter;
+}
+
+describe('link policy', () => {
+    it('records the MTU the policy replied with', () => {
+        const adapter = createAdapter();
+        const changes = [];
+        adapter.on('attMtuChanged', (device, mtu) => changes.push(mtu));
+
+        adapter._parseGattsExchangeMtuRequestEvent({ conn_handle: CONN_HANDLE, client_rx_mtu: 150, answered_by_policy: true });
+
+        expect(adapter._adapter.gattsExchangeMtuReply).not.toHaveBeenCalled();
+        expect(adapter._devices.peer.attMtu).toEqual(100);
+        expect(changes).toEqual([100]);
+    });
+
+    it('replies from JavaScript when the policy reply failed', () => {
+        const adapter = createAdapter();
+        const changes = [];
+        adapter.on('attMtuChanged', (device, mtu) => changes.push(mtu));
+
+        adapter._parseGattsExchangeMtuRequestEvent({ conn_handle: CONN_HANDLE, client_rx_mtu: 150, answered_by_policy: false });
+
+        expect(adapter._adapter.gattsExchangeMtuReply).toHaveBeenCalledTimes(1);
+        expect(adapter._adapter.gattsExchangeMtuReply.mock.calls[0][1]).toEqual(150);
+        expect(adapter._devices.peer.attMtu).toEqual(150);
+        expect(changes).toEqual([150]);
+    });
+});
@@ -0,0 +1,179 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const Adapter = require('../adapter');
+const ServiceFactory = require('../serviceFactory');
+
+// Constants of the AddOn used by setServices, the AddOn adapter is replaced by a fake gattsBuildTable
+const bleDriver = {
+    BLE_GATTS_SRVC_TYPE_PRIMARY: 1,
+    BLE_GATTS_SRVC_TYPE_SECONDARY: 2,
+    BLE_GATTS_VLOC_STACK: 1,
+    BLE_UUID_TYPE_BLE: 1,
+    BLE_UUID_TYPE_VENDOR_BEGIN: 2,
+    eccInit: () => {},
+};
+
+const SERVICE_UUID = '6E400001B5A3F393E0A9E50E24DCCA9E';
+const CHARACTERISTIC_UUID = '6E400002B5A3F393E0A9E50E24DCCA9E';
+const DESCRIPTOR_UUID = '8EC90003F3154F609FB8838830DAEA50';
+
+const attributeOptions = { readPerm: ['open'], writePerm: ['open'], maxLength: 20 };
+
+function createAdapter(gattsBuildTable) {
+    return new Adapter(bleDriver, { gattsBuildTable: jest.fn(gattsBuildTable) }, 'fake', 'fake');
+}
+
+function createServices() {
+    const factory = new ServiceFactory();
+    const service = factory.createService(SERVICE_UUID);
+    const characteristic = factory.createCharacteristic(service, CHARACTERISTIC_UUID, [1, 2, 3],
+        { read: true, notify: true }, attributeOptions);
+    const cccd = factory.createDescriptor(characteristic, '2902', [0, 0], attributeOptions);
+    const descriptor = factory.createDescriptor(characteristic, DESCRIPTOR_UUID, [4], attributeOptions);
+
+    return { service, characteristic, cccd, descriptor };
+}
+
+// Resolves the vendor specific UUIDs the way the AddOn does, one type per base in order of appearance
+function buildTable(definition, callback) {
+    callback(undefined, {
+        services: [{
+            uuid: { uuid: 0x0001, type: 2 },
+            handle: 12,
+            characteristics: [{
+                uuid: { uuid: 0x0002, type: 2 },
+                handles: { value_handle: 14, user_desc_handle: 0, cccd_handle: 15, sccd_handle: 0 },
+                descriptors: [{ uuid: { uuid: 0x0003, type: 3 }, handle: 16 }],
+            }],
+        }],
+        vendorUuidCount: 2,
+    });
+}
+
+describe('setServices', () => {
+    it('builds the attribute table with the vendor specific UUIDs as strings', done => {
+        const adapter = createAdapter(buildTable);
+        const { service } = createServices();
+
+        adapter.setServices([service], err => {
+            expect(err).toBeUndefined();
+            expect(adapter._adapter.gattsBuildTable).toHaveBeenCalledTimes(1);
+
+            const definition = adapter._adapter.gattsBuildTable.mock.calls[0][0];
+            expect(definition.services.length).toEqual(1);
+
+            const tableService = definition.services[0];
+            expect(tableService.uuid).toEqual(SERVICE_UUID);
+            expect(tableService.type).toEqual(bleDriver.BLE_GATTS_SRVC_TYPE_PRIMARY);
+            expect(tableService.characteristics.length).toEqual(1);
+
+            const tableCharacteristic = tableService.characteristics[0];
+            expect(tableCharacteristic.uuid).toEqual(CHARACTERISTIC_UUID);
+            expect(tableCharacteristic.attribute.value).toEqual([1, 2, 3]);
+            expect(tableCharacteristic.metadata.char_props.notify).toBe(true);
+
+            // The CCCD is added by the SoftDevice from the characteristic metadata
+            expect(tableCharacteristic.metadata.cccd_md).not.toBeNull();
+            expect(tableCharacteristic.descriptors.length).toEqual(1);
+            expect(tableCharacteristic.descriptors[0].uuid).toEqual(DESCRIPTOR_UUID);
+            expect(tableCharacteristic.descriptors[0].value).toEqual([4]);
+            done();
+        });
+    });
+
+    it('applies the handles of the built table', done => {
+        const adapter = createAdapter(buildTable);
+        const { service, characteristic, cccd, descriptor } = createServices();
+
+        adapter.setServices([service], err => {
+            expect(err).toBeUndefined();
+
+            expect(service.startHandle).toEqual(12);
+            expect(adapter.getService(service.instanceId)).toBe(service);
+
+            expect(characteristic.declarationHandle).toEqual(13);
+            expect(characteristic.valueHandle).toEqual(14);
+            expect(adapter.getCharacteristic(characteristic.instanceId)).toBe(characteristic);
+
+            expect(cccd.handle).toEqual(15);
+            expect(adapter.getDescriptor(cccd.instanceId)).toBe(cccd);
+
+            expect(descriptor.handle).toEqual(16);
+            expect(adapter.getDescriptor(descriptor.instanceId)).toBe(descriptor);
+            done();
+        });
+    });
+
+    it('stores the vendor specific bases registered by the AddOn', done => {
+        const adapter = createAdapter(buildTable);
+        const { service } = createServices();
+
+        adapter.setServices([service], err => {
+            expect(err).toBeUndefined();
+            expect(adapter._converter.lookupVsUuid({ type: 2, uuid: 0x0002 })).toEqual(CHARACTERISTIC_UUID);
+            expect(adapter._converter.lookupVsUuid({ type: 3, uuid: 0x0003 })).toEqual(DESCRIPTOR_UUID);
+            done();
+        });
+    });
+
+    it('fails without building the table when a descriptor can not be converted', done => {
+        const adapter = createAdapter(buildTable);
+        const { service, descriptor } = createServices();
+        delete descriptor.maxLength;
+
+        adapter.on('error', () => {});
+        adapter.setServices([service], err => {
+            expect(err).toBeDefined();
+            expect(adapter._adapter.gattsBuildTable).not.toHaveBeenCalled();
+            done();
+        });
+    });
+
+    it('fails when the AddOn can not build the table', done => {
+        const adapter = createAdapter((definition, callback) => callback(new Error('NRF_ERROR_NO_MEM')));
+        const { service, characteristic } = createServices();
+
+        adapter.on('error', () => {});
+        adapter.setServices([service], err => {
+            expect(err).toBeDefined();
+            expect(characteristic.valueHandle).toBeNull();
+            done();
+        });
+    });
+});
@@ -0,0 +1,136 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+// Opens adapters with the simulated physical layer, needs the AddOn but no connectivity device.
+const bleDriver = require('bindings')('pc-ble-driver-js-sd_api_v5');
+const Adapter = require('../adapter');
+
+function createAdapter() {
+    return new Adapter(bleDriver, new bleDriver.Adapter(), 'simulated', 'simulated');
+}
+
+function openOptions(simulation) {
+    return {
+        physicalLayer: 'simulated',
+        simulation,
+    };
+}
+
+describe('simulated physical layer', () => {
+    let adapter;
+
+    beforeEach(() => {
+        adapter = createAdapter();
+        adapter.on('error', () => {});
+    });
+
+    afterEach(done => {
+        adapter.close(() => done());
+    });
+
+    it('delivers synthesized events', done => {
+        const connected = [];
+        let discovered = false;
+
+        const checkDone = () => {
+            if (connected.length === 2 && discovered) {
+                expect(adapter.getStats().simulatedEventCount).toBeGreaterThanOrEqual(3);
+                done();
+            }
+        };
+
+        adapter.on('deviceConnected', device => {
+            connected.push(device.connectionHandle);
+            checkDone();
+        });
+
+        adapter.once('deviceDiscovered', () => {
+            discovered = true;
+            checkDone();
+        });
+
+        adapter.open(openOptions({ advReportRate: 200, connectionCount: 2 }), err => {
+            expect(err).toBeUndefined();
+            expect(adapter.state.available).toBe(true);
+        });
+    });
+
+    it('acknowledges calls that only need a return code', done => {
+        adapter.open(openOptions(), openErr => {
+            expect(openErr).toBeUndefined();
+
+            adapter.startScan({ active: true, interval: 100, window: 50, timeout: 0 }, err => {
+                expect(err).toBeUndefined();
+                done();
+            });
+        });
+    });
+
+    it('returns NRF_ERROR_NOT_SUPPORTED for calls that need a SoftDevice', done => {
+        adapter.open(openOptions(), openErr => {
+            expect(openErr).toBeUndefined();
+
+            adapter._adapter.gapGetAppearance(err => {
+                expect(err).toBeDefined();
+                expect(err.errcode).toEqual('NRF_ERROR_NOT_SUPPORTED');
+                done();
+            });
+        });
+    });
+
+    it('closes and stops synthesizing events', done => {
+        let discoveredCount = 0;
+        adapter.on('deviceDiscovered', () => { discoveredCount += 1; });
+
+        adapter.open(openOptions({ advReportRate: 200 }), openErr => {
+            expect(openErr).toBeUndefined();
+
+            adapter.close(err => {
+                expect(err).toBeUndefined();
+                expect(adapter.state.available).toBe(false);
+
+                const closedCount = discoveredCount;
+
+                setTimeout(() => {
+                    expect(discoveredCount).toEqual(closedCount);
+                    done();
+                }, 50);
+            });
+        });
+    });
+});
@@ -72,6 +72,39 @@ const _makeError = function (userMessage, description) {
     return new Error(userMessage, description);
 };
 
+// Adapters opened with the shared event dispatcher, keyed by their AddOn adapter.
+const sharedEventAdapters = new WeakMap();
+
+// Drivers (one per SoftDevice API version) that have the shared event callback installed.
+const sharedEventDrivers = new WeakSet();
+
+/**
+ * Install the callback receiving events from all adapters of a driver that are opened with
+ * <code>sharedEventDispatcher</code>. The driver drains all those adapters in one wakeup and
+ * calls this callback once with one batch of events per adapter.
+ *
+ * @param {Object} bleDriver The driver (pc-ble-driver-js AddOn) to install the callback on.
+ * @returns {void}
+ * @private
+ */
+const _installSharedEventCallback = function (bleDriver) {
+    if (sharedEventDrivers.has(bleDriver)) {
+        return;
+    }
+
+    bleDriver.Adapter.setSharedEventCallback(batches => {
+        batches.forEach(batch => {
+            const adapter = sharedEventAdapters.get(batch.adapter);
+
+            if (adapter) {
+                adapter._eventCallback(batch.events);
+            }
+        });
+    });
+
+    sharedEventDrivers.add(bleDriver);
+};
+
 /**
  * Class representing a transport adapter (SoftDevice RPC module).
  *
@@ -142,7 +175,11 @@ class Adapter extends EventEmitter {
         this._notSupportedMessage = notSupportedMessage;
 
         this._keys = null;
+        this._lescDhKeyAutoReply = false;
         this._attMtuMap = {};
+        this._linkPolicy = null;
+        this._enableBLEParams = null;
+        this._eventLogEnabled = false;
 
         this._init();
     }
@@ -205,6 +242,18 @@ class Adapter extends EventEmitter {
         return this._bleDriver;
     }
 
+    /**
+     * Get the number of connections this adapter can have in the central role at the same time.
+     * @returns {number} The central connection count the BLE stack is (or will be) enabled with.
+     */
+    get centralConnectionCount() {
+        const params = this._enableBLEParams || this._getDefaultEnableBLEParams();
+        if (params.gap_enable_params) {
+            return params.gap_enable_params.central_conn_count;
+        }
+        return params.gap_cfg.role_count_cfg.central_role_count;
+    }
+
     /**
      * Get the `notSupportedMessage` of this adapter.
      * @returns {string} The error message thrown if this adapter is not supported on the platform/hardware.
@@ -213,21 +262,17 @@ class Adapter extends EventEmitter {
         return this._notSupportedMessage;
     }
 
-    _maxReadPayloadSize(deviceInstanceId) {
-        return this.getCurrentAttMtu(deviceInstanceId) - 1;
-    }
-
     _maxShortWritePayloadSize(deviceInstanceId) {
         return this.getCurrentAttMtu(deviceInstanceId) - 3;
     }
 
-    _maxLongWritePayloadSize(deviceInstanceId) {
-        return this.getCurrentAttMtu(deviceInstanceId) - 5;
-    }
-
     _generateKeyPair() {
         if (this._keys === null) {
             this._keys = this._security.generateKeyPair();
+
+            if (this._lescDhKeyAutoReply) {
+                this._adapter.gapEnableLescDhKeyAutoReply(this._keys.sk, this._lescDhKeyCallback.bind(this));
+            }
         }
     }
 
@@ -403,10 +448,34 @@ class Adapter extends EventEmitter {
      * <li>{string} [flowControl='none']: Whether flow control should be configured with this adapter's serial port.
      * <li>{number} [eventInterval=0]: Interval to use for sending BLE driver events to JavaScript.
      *                                 If `0`, events will be sent as soon as they are received from the BLE driver.
+     * <li>{number} [eventMaxLatency=0]: Enables adaptive event batching if not `0`. Events are sent to
+     *                                 JavaScript as soon as they are received while the adapter is idle,
+     *                                 and coalesced for up to this number of milliseconds under load.
+     *                                 Overrides `eventInterval`. Ignored with `sharedEventDispatcher`,
+     *                                 the shared dispatcher drains all its adapters in one pass.
+     * <li>{number} [eventMaxBatchSize=32]: Max number of events coalesced by adaptive event batching
+     *                                 before they are sent to JavaScript.
      * <li>{string} [logLevel='info']: The verbosity of logging the developer wants with this adapter.
      * <li>{number} [retransmissionInterval=250]: The time interval to wait between retransmitted packets.
      * <li>{number} [responseTimeout=1500]: Response timeout of the data link layer.
      * <li>{boolean} [enableBLE=true]: Whether the BLE stack should be initialized and enabled.
+     * <li>{boolean} [sharedEventDispatcher=false]: Whether BLE driver events, log messages and status
+     *                                 should be delivered through one wakeup shared by all adapters
+     *                                 that enable this option, instead of a wakeup per adapter.
+     *                                 Reduces event loop wakeups when many adapters are open.
+     * <li>{string} [physicalLayer='uart']: `'uart'` to use the serial port, or `'simulated'` to replace the serial
+     *                                 port and the connectivity device with a simulator for benchmarking without
+     *                                 hardware. The simulator synthesizes events at the rates in `simulation`.
+     *                                 SoftDevice calls that are only acknowledged by the SoftDevice, like starting
+     *                                 a scan or sending a notification, succeed. Other calls fail with
+     *                                 NRF_ERROR_NOT_SUPPORTED.
+     * <li>{Object} [simulation]: Simulator settings, used if `physicalLayer` is `'simulated'`:
+     *                                 {number} [advReportRate=0]: Advertising reports per second.
+     *                                 {number} [connectionCount=0]: Connections established when opened.
+     *                                 {number} [hvxRate=0]: Notifications per second on each connection.
+     *                                 {number} [hvxHandle=1]: Attribute handle of the notifications.
+     *                                 {number} [hvxLength=20]: Length of the notification data.
+     *                                 {number} [rpcLatency=0]: Time in microseconds each SoftDevice call takes.
      * </ul>
      * @param {function(Error)} [callback] Callback signature: err => {}.
      * @returns {void}
@@ -436,20 +505,39 @@ class Adapter extends EventEmitter {
                 parity: 'none',
                 flowControl: 'none',
                 eventInterval: 0,
+                eventMaxLatency: 0,
+                eventMaxBatchSize: 32,
                 logLevel: 'info',
                 retransmissionInterval: 250,
                 responseTimeout: 1500,
                 enableBLE: true,
+                sharedEventDispatcher: false,
+                physicalLayer: 'uart',
             };
         } else {
             if (!options.baudRate) options.baudRate = 1000000;
             if (!options.parity) options.parity = 'none';
             if (!options.flowControl) options.flowControl = 'none';
             if (!options.eventInterval) options.eventInterval = 0;
+            if (!options.eventMaxLatency) options.eventMaxLatency = 0;
+            if (!options.eventMaxBatchSize) options.eventMaxBatchSize = 32;
             if (!options.logLevel) options.logLevel = 'info';
             if (!options.retransmissionInterval) options.retransmissionInterval = 250;
             if (!options.responseTimeout) options.responseTimeout = 1500;
             if (options.enableBLE === undefined) options.enableBLE = true;
+            if (options.sharedEventDispatcher === undefined) options.sharedEventDispatcher = false;
+            if (!options.physicalLayer) options.physicalLayer = 'uart';
+        }
+
+        if (options.physicalLayer === 'simulated') {
+            options.simulation = Object.assign({
+                advReportRate: 0,
+                connectionCount: 0,
+                hvxRate: 0,
+                hvxHandle: 1,
+                hvxLength: 20,
+                rpcLatency: 0,
+            }, options.simulation);
         }
 
         this._changeState({
@@ -463,6 +551,17 @@ class Adapter extends EventEmitter {
         options.eventCallback = this._eventCallback.bind(this);
         options.statusCallback = this._statusCallback.bind(this);
         options.enableBLEParams = options.enableBLEParams || this._getDefaultEnableBLEParams();
+        this._enableBLEParams = options.enableBLEParams;
+
+        // Events are only formatted as DEBUG log messages if the adapter logs at that level
+        this._eventLogEnabled = (options.logLevel === 'trace' || options.logLevel === 'debug');
+
+        if (options.sharedEventDispatcher) {
+            _installSharedEventCallback(this._bleDriver);
+            sharedEventAdapters.set(this._adapter, this);
+        } else {
+            sharedEventAdapters.delete(this._adapter);
+        }
 
         this._adapter.open(this._state.port, options, err => {
             this._changeState({ opening: false });
@@ -478,7 +577,10 @@ class Adapter extends EventEmitter {
              */
             this.emit('opened', this);
 
-            if (options.enableBLE) {
+            if (options.enableBLE && options.physicalLayer === 'simulated') {
+                // The simulator has no SoftDevice state to retrieve
+                this._changeState({ bleEnabled: true });
+            } else if (options.enableBLE) {
                 this._changeState({ bleEnabled: true });
                 this.getState(getStateError => {
                     this._checkAndPropagateError(getStateError, 'Error retrieving adapter state.', callback);
@@ -550,10 +652,62 @@ class Adapter extends EventEmitter {
     /**
      * This function is for debugging purposes. It will return an object with these members:
      * <ul>
-     * <li>{number} eventCallbackTotalTime
-     * <li>{number} eventCallbackTotalCount
+     * <li>{number} eventCallbackTotalTime: Milliseconds spent in the JavaScript event callback, with sub-millisecond precision
+     * <li>{number} eventCallbackTotalCount: Events sent to JavaScript
+     * <li>{number} eventCallbackBatchCount: Calls to the JavaScript event callback
      * <li>{number} eventCallbackBatchMaxCount
      * <li>{number} eventCallbackBatchAvgCount
+     * <li>{Object} eventCallbackTime: Microseconds per JavaScript event callback, with
+     *              <code>min</code>, <code>max</code>, <code>mean</code>, <code>p50</code>, <code>p90</code>,
+     *              <code>p99</code> and <code>p999</code>
+     * <li>{Object} eventCallbackBatchSize: Events per JavaScript event callback, same members as eventCallbackTime
+     * <li>{number} eventDroppedCount: Events dropped because the event queue was full
+     * <li>{Object} eventCounts: Events received from the BLE driver by event name, including events handled natively
+     * <li>{number} eventCallbackBatchImmediateCount
+     * <li>{number} eventCallbackBatchCoalescedCount
+     * <li>{number} logDroppedCount
+     * <li>{number} logTruncatedCount
+     * <li>{number} eventTraceRecordCount
+     * <li>{number} eventTraceErrorCount
+     * <li>{number} eventReplayEventCount: Events fed back by the last <code>startEventReplay</code>
+     * <li>{number} eventReplayErrorCount: Truncated records in the replayed trace and
+     *                                     events recorded with pointers by an older version
+     * <li>{number} adapterId: Identifies this adapter in event traces, unique among the adapters of the same
+     *                          SoftDevice API version
+     * <li>{number} bondStoreSecInfoReplyCount
+     * <li>{number} bondStoreEncryptCount
+     * <li>{number} lescDhKeyReplyCount
+     * <li>{number} lescDhKeyErrorCount
+     * <li>{number} lescDhKeyMaxComputeTime: Longest native DH key computation in microseconds
+     * <li>{number} simulatedEventCount: Events synthesized by the simulated physical layer
+     * <li>{number} simulatedCallCount: SoftDevice calls completed by the simulated physical layer
+     * <li>{number} vendorUuidCount: Vendor specific UUID bases known to be registered in the SoftDevice
+     * <li>{number} vendorUuidHitCount: UUIDs encoded, decoded or added without a round trip to the SoftDevice
+     * <li>{number} vendorUuidMissCount
+     * <li>{number} notifyAllSentCount: Notifications and indications sent by <code>notifyCharacteristicValue</code>
+     * <li>{number} notifyAllQueuedCount: Notifications and indications that waited natively for TX buffers
+     * <li>{number} notifyAllDroppedCount: Queued notifications and indications that were not sent
+     * <li>{number} authorizeAcceptedCount, authorizeRejectedCount: Authorization requests answered by a native policy
+     * <li>{number} authorizeErrorCount: Native authorization replies rejected by the SoftDevice
+     * <li>{number} longReadCompletedCount, longReadFailedCount: Long reads of characteristic and descriptor values
+     * <li>{number} longReadRequestCount: Read and read blob requests sent by long reads
+     * <li>{number} longWriteCompletedCount, longWriteFailedCount: Long and reliable writes executed or cancelled
+     * <li>{number} longWriteVerifyFailedCount: Long writes cancelled because the peer echoed different data
+     * <li>{number} longWriteRequestCount: Prepare and execute write requests sent by long writes
+     * <li>{number} linkPolicyRequestCount: MTU, data length and PHY procedures started by the link policy on connect
+     * <li>{number} linkPolicyReplyCount: Peer MTU, data length and PHY requests answered by the link policy
+     * <li>{number} linkPolicyErrorCount: Link policy requests and replies the SoftDevice rejected
+     * <li>{number} connParamAcceptedCount: Connection parameter update requests accepted by the policy, including clamped ones
+     * <li>{number} connParamClampedCount: Connection parameter update requests accepted with parameters moved into the bounds
+     * <li>{number} connParamRejectedCount: Connection parameter update requests rejected by the policy
+     * <li>{number} connParamErrorCount: Connection parameter policy replies the SoftDevice rejected
+     * <li>{number} scheduledConnectPendingCount: Targets of scheduleConnect that are not completed yet
+     * <li>{number} scheduledConnectConnectedCount: Targets of scheduleConnect that were connected
+     * <li>{number} scheduledConnectFailedCount: Targets of scheduleConnect that failed, timed out or were cancelled
+     * <li>{number} scheduledConnectRetryCount: Connects retried by scheduleConnect
+     * <li>{number} whitelistAddressCount: Addresses in the whitelist, see <code>setWhitelist</code>
+     * <li>{number} whitelistIdentityCount: Entries in the device identity list, see <code>setDeviceIdentities</code>
+     * <li>{Object[]} links: Statistics for each connection, see <code>getLinkStats</code>
      * </ul>
      *
      * @returns {Object} This adapters stats.
@@ -562,6 +716,128 @@ class Adapter extends EventEmitter {
         return this._adapter.getStats();
     }
 
+    /**
+     * @summary Get statistics for each connection, maintained natively in the event path.
+     *
+     * Each object has these members:
+     * <ul>
+     * <li>{string} deviceInstanceId, {number} conn_handle
+     * <li>{number} connectedTime: Seconds since the connection was established
+     * <li>{number} rxPacketCount, rxByteCount, txPacketCount, txByteCount: ATT packets and value bytes
+     * <li>{number} hvxRxCount, hvxTxCount, writeRxCount, writeTxCount and the matching rates per second
+     *              hvxRxRate, hvxTxRate, writeRxRate, writeTxRate
+     * <li>{number} txStallCount: Notifications, indications and writes rejected because the SoftDevice had no TX buffers
+     * <li>{number} eventCount, eventLatencyAvg, eventLatencyP99: Events delivered to JavaScript and the time in
+     *              microseconds from the BLE driver thread to JavaScript. The 99th percentile is a power of two bound
+     * <li>{number} readRttCount, readRttAvg, readRttMax, writeRttCount, writeRttAvg, writeRttMax: Time in
+     *              microseconds from a read or write request to its response
+     * <li>{number} connInterval, slaveLatency, connSupTimeout: Connection parameters in effect
+     * <li>{number} attMtu, maxTxOctets, maxRxOctets, txPhy, rxPhy: ATT MTU, data length and PHY in effect
+     * </ul>
+     *
+     * @returns {Object[]} One object per connection.
+     */
+    getLinkStats() {
+        return this._adapter.getStats().links.map(link => {
+            const device = this._getDeviceByConnectionHandle(link.conn_handle);
+            return Object.assign({ deviceInstanceId: device ? device.instanceId : undefined }, link);
+        });
+    }
+
+    /**
+     * @summary Get latency statistics for the asynchronous calls into the BLE driver.
+     *
+     * Returns an object keyed by native method name, e.g. <code>GattcWrite</code>. Each entry has a
+     * <code>count</code> and three latency distributions in microseconds, each with
+     * <code>min</code>, <code>max</code>, <code>mean</code>, <code>p50</code>, <code>p90</code>,
+     * <code>p99</code> and <code>p999</code>:
+     * <ul>
+     * <li>{Object} queue: Waiting for a thread pool worker, high values indicate a saturated thread pool
+     * <li>{Object} execute: The SoftDevice call including the serialization round trip to the connectivity firmware
+     * <li>{Object} callback: Converting the result and running the JavaScript callback
+     * </ul>
+     * Percentiles are taken from a log-linear histogram and are accurate to within 12.5%.
+     *
+     * @returns {Object} Statistics per method since the adapter was created or the statistics were reset.
+     */
+    getMethodStats() {
+        return this._adapter.getMethodStats();
+    }
+
+    /**
+     * @summary Reset the statistics returned by <code>getMethodStats</code>.
+     *
+     * @returns {void}
+     */
+    resetMethodStats() {
+        this._adapter.resetMethodStats();
+    }
+
+    /**
+     * @summary Start writing all events received from the BLE driver to a binary trace file.
+     *
+     * Events are written natively in a compact binary format, as received from the BLE driver,
+     * without being formatted as text. Each event is written with a timestamp and the adapter ID
+     * reported by <code>getStats</code>. A trace that is already running is restarted.
+     *
+     * @param {string} path Path of the trace file.
+     * @param {Object} [options] Trace options:
+     * <ul>
+     * <li>{number} [maxFileSize=10485760]: Size in bytes when the trace file is rotated. `0` disables rotation.
+     * <li>{number} [maxFiles=5]: Number of rotated files to keep, as <code>path.1</code> to <code>path.N</code>.
+     * </ul>
+     * @returns {void}
+     */
+    startEventTrace(path, options) {
+        const traceOptions = Object.assign({ maxFileSize: 10 * 1024 * 1024, maxFiles: 5 }, options);
+        this._adapter.startEventTrace(path, traceOptions);
+    }
+
+    /**
+     * @summary Stop writing events to the binary trace file.
+     *
+     * @returns {void}
+     */
+    stopEventTrace() {
+        this._adapter.stopEventTrace();
+    }
+
+    /**
+     * @summary Replay the events in a binary trace file written by <code>startEventTrace</code>.
+     *
+     * The events are fed natively into the event queue, and are delivered as if they were received from
+     * the BLE driver. The adapter must be opened with the <code>'simulated'</code> physical layer, so that
+     * no replayed event reaches a connectivity device. The simulated events are paused until the replay is
+     * complete. A replay that is already running is stopped.
+     *
+     * @param {string} path Path of the trace file.
+     * @param {Object} [options] Replay options:
+     * <ul>
+     * <li>{number} [speed=1]: Replay speed relative to the timestamps in the trace. `0` replays the
+     *                         events as fast as possible.
+     * <li>{number} [adapterId=-1]: Only replay events traced by this adapter ID, `-1` replays all events.
+     *                              Adapter IDs are only unique within one SoftDevice API version.
+     * </ul>
+     * @param {function(Error, number)} [callback] Called when all replayed events are delivered or the
+     *                         replay is stopped. Callback signature: (err, eventCount) => {}.
+     * @returns {void}
+     */
+    startEventReplay(path, options, callback) {
+        const replayOptions = Object.assign({ speed: 1, adapterId: -1 }, options);
+        this._adapter.startEventReplay(path, replayOptions, (err, eventCount) => {
+            if (callback) { callback(err, eventCount); }
+        });
+    }
+
+    /**
+     * @summary Stop replaying a binary trace file.
+     *
+     * @returns {void}
+     */
+    stopEventReplay() {
+        this._adapter.stopEventReplay();
+    }
+
     /**
      * @summary Enable the BLE stack.
      *
@@ -601,11 +877,14 @@ class Adapter extends EventEmitter {
         if (options === undefined || options === null) {
             options = this._getDefaultEnableBLEParams();
         }
+        this._enableBLEParams = options;
 
         this._adapter.enableBLE(
             options,
             err => {
                 if (this._checkAndPropagateError(err, 'Enabling BLE failed.', callback)) { return; }
+                // The native link policy is cleared when the SoftDevice is enabled
+                this._linkPolicy = null;
                 this._changeState({ bleEnabled: true });
                 if (callback) {
                     callback();
@@ -705,23 +984,34 @@ class Adapter extends EventEmitter {
         this.emit('status', status);
     }
 
-    _logCallback(severity, message) {
-        /**
-         * Log message event.
-         *
-         * @event Adapter#logMessage
-         * @type {Object}
-         * @property {string} severity - Severity of the log event.
-         * @property {string} message - Human-readable log message.
-         */
-        this.emit('logMessage', severity, message);
+    _logCallback(logEntries, droppedCount) {
+        if (droppedCount > 0) {
+            this.emit('logMessage', logLevel.WARNING, `${droppedCount} log messages dropped, the log queue was full.`);
+        }
+
+        logEntries.forEach(entry => {
+            /**
+             * Log message event.
+             *
+             * @event Adapter#logMessage
+             * @type {Object}
+             * @property {string} severity - Severity of the log event.
+             * @property {string} message - Human-readable log message.
+             */
+            this.emit('logMessage', entry.severity, entry.message);
+        });
     }
 
     _eventCallback(eventArray) {
+        // Formatting events as text is costly, only do it if someone will see the result
+        const logEvents = this._eventLogEnabled && this.listenerCount('logMessage') > 0;
+
         eventArray.forEach(event => {
-            const text = new ToText(event);
-            // TODO: set the correct level for different types of events:
-            this.emit('logMessage', logLevel.DEBUG, text.toString());
+            if (logEvents) {
+                const text = new ToText(event);
+                // TODO: set the correct level for different types of events:
+                this.emit('logMessage', logLevel.DEBUG, text.toString());
+            }
 
             switch (event.id) {
                 case this._bleDriver.BLE_GAP_EVT_CONNECTED:
@@ -882,6 +1172,7 @@ class Adapter extends EventEmitter {
         this._devices[device.instanceId] = device;
 
         this._attMtuMap[device.instanceId] = this.driver.GATT_MTU_SIZE_DEFAULT || this.driver.BLE_GATT_ATT_MTU_DEFAULT;
+        device.attMtu = this._attMtuMap[device.instanceId];
 
         this._changeState({ connecting: false });
 
@@ -900,7 +1191,8 @@ class Adapter extends EventEmitter {
 
         this._addDeviceToAllPerConnectionValues(device.instanceId);
 
-        if (deviceRole === 'peripheral') {
+        // Links established by scheduleConnect have no pending connect operation
+        if (deviceRole === 'peripheral' && this._gapOperationsMap.connecting) {
             const callback = this._gapOperationsMap.connecting.callback;
             delete this._gapOperationsMap.connecting;
             if (callback) { callback(undefined, device); }
@@ -1188,6 +1480,11 @@ class Adapter extends EventEmitter {
          * @property {Object} event - DataLength Update Request Event Parameters.
          */
 
+        if (event.answered_by_policy) {
+            // Already answered by the link policy
+            return;
+        }
+
         this._adapter.gapDataLengthUpdate(event.conn_handle, {
             max_rx_octets: Math.min(event.peer_params.max_tx_octets),
             max_tx_octets: Math.min(event.peer_params.max_rx_octets),
@@ -1210,6 +1507,11 @@ class Adapter extends EventEmitter {
          * @property {Device} device - The <code>Device</code> instance representing the BLE peer we're connected to.
          * @property {Object} event - DataLength Update Event Parameters.
          */
+        if (device) {
+            device.maxTxOctets = event.effective_params.max_tx_octets;
+            device.maxRxOctets = event.effective_params.max_rx_octets;
+        }
+
         this.emit('dataLengthUpdated', device, event);
     }
 
@@ -1225,6 +1527,11 @@ class Adapter extends EventEmitter {
          * @property {Object} event - PHY Update Request Event Parameters.
          */
 
+        if (event.answered_by_policy) {
+            // Already answered by the link policy
+            return;
+        }
+
         this._adapter.gapPhyUpdate(event.conn_handle, {
             tx_phys: event.peer_preferred_phys.rx_phys,
             rx_phys: event.peer_preferred_phys.tx_phys,
@@ -1247,6 +1554,11 @@ class Adapter extends EventEmitter {
          * @property {Device} device - The <code>Device</code> instance representing the BLE peer we're connected to.
          * @property {Object} event - PHY Update Event Parameters.
          */
+        if (device && event.status === this._bleDriver.BLE_HCI_STATUS_CODE_SUCCESS) {
+            device.txPhy = event.tx_phy;
+            device.rxPhy = event.rx_phy;
+        }
+
         this.emit('phyUpdated', device, event);
     }
 
@@ -1709,42 +2021,11 @@ class Adapter extends EventEmitter {
                 });
                 break;
             }
-        } else {
-            if (event.gatt_status !== this._bleDriver.BLE_GATT_STATUS_SUCCESS) {
-                delete this._gattOperationsMap[device.instanceId];
-                gattOperation.callback(_makeError(`Read operation failed: ${event.gatt_status_name} (0x${HexConv.numberToHexString(event.gatt_status)})`));
-                return;
-            }
-
-            gattOperation.readBytes = gattOperation.readBytes ? gattOperation.readBytes.concat(event.data) : event.data;
-
-            if (event.data.length < this._maxReadPayloadSize(device.instanceId)) {
-                delete this._gattOperationsMap[device.instanceId];
-                gattOperation.callback(undefined, gattOperation.readBytes);
-            } else if (event.data.length === this._maxReadPayloadSize(device.instanceId)) {
-                // We need to read more:
-                this._adapter.gattcRead(event.conn_handle, event.handle, gattOperation.readBytes.length, err => {
-                    if (err) {
-                        delete this._gattOperationsMap[device.instanceId];
-                        this.emit('error', _makeError('Read value failed', err));
-                        gattOperation.callback('Failed reading at byte #' + gattOperation.readBytes.length);
-                    }
-                });
-            } else {
-                delete this._gattOperationsMap[device.instanceId];
-                this.emit('error', 'Length of Read response is > mtu');
-                gattOperation.callback('Invalid read response length. (> mtu)');
-            }
         }
     }
 
     _parseGattcWriteResponseEvent(event) {
-        // 1. Check if there is a long write in progress for this device
-        // 2a. If there is check if it is done after next write
-        // 2ai. If it is done after next write
-        //      Perform the last write and if success, exec write on fail, cancel write
-        //      callback, delete callback, delete pending write, emit
-        // 2aii. if not done, issue one more PREPARED_WRITE, update pendingwrite
+        // Prepared and execute write responses are handled natively, see _queuedWrite
 
         // TODO: Do more checking of write response?
         const device = this._getDeviceByConnectionHandle(event.conn_handle);
@@ -1760,52 +2041,7 @@ class Adapter extends EventEmitter {
 
         if (event.write_op === this._bleDriver.BLE_GATT_OP_WRITE_CMD) {
             gattOperation.attribute.value = gattOperation.value;
-        } else if (event.write_op === this._bleDriver.BLE_GATT_OP_PREP_WRITE_REQ) {
-
-            const writeParameters = {
-                write_op: 0,
-                flags: 0,
-                handle: handle,
-                offset: 0,
-                len: 0,
-                value: [],
-            };
-
-            if (gattOperation.bytesWritten < gattOperation.value.length) {
-                const value = gattOperation.value.slice(gattOperation.bytesWritten, gattOperation.bytesWritten + this._maxLongWritePayloadSize(device.instanceId));
-
-                writeParameters.write_op = this._bleDriver.BLE_GATT_OP_PREP_WRITE_REQ;
-                writeParameters.handle = handle;
-                writeParameters.offset = gattOperation.bytesWritten;
-                writeParameters.len = value.length;
-                writeParameters.value = value;
-                gattOperation.bytesWritten += value.length;
-
-                this._adapter.gattcWrite(device.connectionHandle, writeParameters, err => {
-
-                    if (err) {
-                        this._longWriteCancel(device, gattOperation.attribute);
-                        this.emit('error', _makeError('Failed to write value to device/handle ' + device.instanceId + '/' + handle, err));
-                        return;
-                    }
-                });
-            } else {
-                writeParameters.write_op = this._bleDriver.BLE_GATT_OP_EXEC_WRITE_REQ;
-                writeParameters.flags = this._bleDriver.BLE_GATT_EXEC_WRITE_FLAG_PREPARED_WRITE;
-
-                this._adapter.gattcWrite(device.connectionHandle, writeParameters, err => {
-
-                    if (err) {
-                        this._longWriteCancel(device, gattOperation.attribute);
-                        this.emit('error', _makeError('Failed to write value to device/handle ' + device.instanceId + '/' + handle, err));
-                        return;
-                    }
-                });
-            }
-
-            return;
-        } else if (event.write_op === this._bleDriver.BLE_GATT_OP_WRITE_REQ ||
-                   event.write_op === this._bleDriver.BLE_GATT_OP_EXEC_WRITE_REQ) {
+        } else if (event.write_op === this._bleDriver.BLE_GATT_OP_WRITE_REQ) {
             gattOperation.attribute.value = gattOperation.value;
             delete this._gattOperationsMap[device.instanceId];
             if (event.gatt_status !== this._bleDriver.BLE_GATT_STATUS_SUCCESS) {
@@ -1930,12 +2166,21 @@ class Adapter extends EventEmitter {
 
     _parseGattcExchangeMtuResponseEvent(event) {
         const device = this._getDeviceByConnectionHandle(event.conn_handle);
-        const gattOperation = this._gattOperationsMap[device.instanceId];
+        const pendingOperation = this._gattOperationsMap[device.instanceId];
+
+        // The exchange is either from requestAttMtu, or sent on connect by the link policy
+        const gattOperation = (pendingOperation && pendingOperation.clientRxMtu !== undefined) ? pendingOperation : null;
+        const clientRxMtu = gattOperation ? gattOperation.clientRxMtu : (this._linkPolicy && this._linkPolicy.attMtu);
+
+        if (!clientRxMtu) {
+            return;
+        }
 
         const previousMtu = this._attMtuMap[device.instanceId];
-        const newMtu = Math.min(event.server_rx_mtu, gattOperation.clientRxMtu);
+        const newMtu = Math.min(event.server_rx_mtu, clientRxMtu);
 
         this._attMtuMap[device.instanceId] = newMtu;
+        device.attMtu = newMtu;
 
         if (newMtu !== previousMtu) {
             /**
@@ -2138,6 +2383,20 @@ class Adapter extends EventEmitter {
     _parseGattsExchangeMtuRequestEvent(event) {
         const remoteDevice = this._getDeviceByConnectionHandle(event.conn_handle);
 
+        if (event.answered_by_policy && this._linkPolicy && this._linkPolicy.attMtu) {
+            // Already answered by the link policy. If its reply failed, answer the request below instead
+            const policyMtu = Math.max(Math.min(event.client_rx_mtu, this._linkPolicy.attMtu), this._bleDriver.BLE_GATT_ATT_MTU_DEFAULT);
+            const previousPolicyMtu = this._attMtuMap[remoteDevice.instanceId];
+            this._attMtuMap[remoteDevice.instanceId] = policyMtu;
+            remoteDevice.attMtu = policyMtu;
+
+            if (policyMtu !== previousPolicyMtu) {
+                this.emit('attMtuChanged', remoteDevice, policyMtu);
+            }
+
+            return;
+        }
+
         /* Make sure the requested mtu does not exceed the max supported size */
         const newMtu = Math.min(event.client_rx_mtu, MAX_SUPPORTED_ATT_MTU);
 
@@ -2149,6 +2408,7 @@ class Adapter extends EventEmitter {
 
             const previousMtu = this._attMtuMap[remoteDevice.instanceId];
             this._attMtuMap[remoteDevice.instanceId] = newMtu;
+            remoteDevice.attMtu = newMtu;
 
             if (newMtu !== previousMtu);
             this.emit('attMtuChanged', remoteDevice, newMtu);
@@ -2376,7 +2636,7 @@ class Adapter extends EventEmitter {
      * <li>{number} interval Scan interval between 0x0004 and 0x4000 in 0.625ms units (2.5ms to 10.24s).
      * <li>{number} window Scan window between 0x0004 and 0x4000 in 0.625ms units (2.5ms to 10.24s).
      * <li>{number} timeout Scan timeout between 0x0001 and 0xFFFF in seconds, 0x0000 disables timeout.
-     * <li>{number} use_whitelist If 1, filter advertisers using current active whitelist.
+     * <li>{number} use_whitelist If 1, filter advertisers using current active whitelist, see <code>setWhitelist</code>.
      * <li>{number} adv_dir_report If 1, also report directed advertisements where the initiator field is set to a
      *                             private resolvable address, even if the address did not resolve to an entry in the
      *                             device identity list. A report will be generated even if the peer is not in the whitelist.
@@ -2485,6 +2745,94 @@ class Adapter extends EventEmitter {
         });
     }
 
+    /**
+     * @summary Queue a connection establishment, started natively as soon as no other connect is pending.
+     *
+     * Targets are connected one after the other, highest priority first. Each target is connected as with
+     * <code>connect</code>, the scan timeout in <code>options.scanParams</code> is the timeout of each attempt.
+     * Links lost with BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED are retried, the delay before a retry is doubled
+     * for every attempt. The link policy, see <code>setLinkPolicy</code>, is applied to every link.
+     *
+     * Do not call <code>connect</code> while scheduled connects are pending, the SoftDevice allows one
+     * pending connect at a time.
+     *
+     * @param {string|Object} deviceAddress The address of the device to connect to.
+     * @param {Object} options Same as the options of <code>connect</code>, and:
+     * <ul>
+     * <li>{number} [priority=0]: Targets with a higher priority are connected first, between 0 and 255.
+     * <li>{number} [maxRetries=3]: Number of retries after the first attempt.
+     * <li>{number} [retryDelay=100]: Delay before the first retry in ms.
+     * </ul>
+     * @param {function(Error, Device, Object)} [callback] Signature: (err, device, stats) => {}, where stats has
+     *                                                      <code>attempts</code>, <code>waitTime</code>,
+     *                                                      <code>connectTime</code> and <code>totalTime</code>
+     *                                                      in ms, and <code>hciStatus</code>.
+     * @returns {number} Id of the scheduled connect, see <code>cancelScheduledConnect</code>.
+     */
+    scheduleConnect(deviceAddress, options, callback) {
+        let address = {};
+
+        if (typeof deviceAddress === 'string') {
+            address.address = deviceAddress;
+            address.type = 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC';
+        } else {
+            address = deviceAddress;
+        }
+
+        const scheduleOptions = {
+            priority: options.priority !== undefined ? options.priority : 0,
+            max_retries: options.maxRetries !== undefined ? options.maxRetries : 3,
+            retry_delay: options.retryDelay !== undefined ? options.retryDelay : 100,
+        };
+
+        return this._adapter.gapScheduleConnect(address, options.scanParams, options.connParams, scheduleOptions, (err, result) => {
+            const stats = {
+                attempts: result.attempts,
+                waitTime: result.wait_time,
+                connectTime: result.connect_time,
+                totalTime: result.total_time,
+                hciStatus: result.hci_status,
+            };
+
+            if (err) {
+                const errorObject = _makeError(`Could not connect to ${address.address}`, err);
+                this.emit('error', errorObject);
+                if (callback) { callback(errorObject, undefined, stats); }
+                return;
+            }
+
+            // The completion may be delivered before the connected event
+            const device = this._getDeviceByConnectionHandle(result.conn_handle);
+
+            if (device) {
+                if (callback) { callback(undefined, device, stats); }
+                return;
+            }
+
+            const onDeviceConnected = connectedDevice => {
+                if (connectedDevice.connectionHandle !== result.conn_handle) {
+                    return;
+                }
+
+                this.removeListener('deviceConnected', onDeviceConnected);
+                if (callback) { callback(undefined, connectedDevice, stats); }
+            };
+
+            this.on('deviceConnected', onDeviceConnected);
+        });
+    }
+
+    /**
+     * Cancel a connection establishment queued with <code>scheduleConnect</code>. Its callback is called with an
+     * error. A link that is connected but not yet reported stays connected.
+     *
+     * @param {number} id The id returned by <code>scheduleConnect</code>.
+     * @returns {boolean} True if the connect was still scheduled.
+     */
+    cancelScheduledConnect(id) {
+        return this._adapter.gapCancelScheduledConnect(id);
+    }
+
     /**
      * Cancel a connection establishment.
      *
@@ -2509,6 +2857,99 @@ class Adapter extends EventEmitter {
         });
     }
 
+    _getWhitelistAddress(address) {
+        if (typeof address === 'string') {
+            return this._getAddressStruct(address, 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC');
+        }
+
+        return address;
+    }
+
+    /**
+     * @summary Set the whitelist used when scanning and connecting with <code>use_whitelist</code> set.
+     *
+     * With <code>scanParams.use_whitelist</code> set, <code>startScan</code> only reports advertisers in the whitelist
+     * and <code>connect</code> and <code>scheduleConnect</code> connect to the first of them that advertises, the
+     * device address is then ignored. The advertisements are filtered by the controller. An empty list clears the
+     * whitelist. The whitelist cannot be changed while scanning or connecting.
+     *
+     * The whitelist is cleared when the adapter is opened.
+     *
+     * @param {Array<string|Object>} addresses The peer addresses, as strings or as <code>{address, type}</code>
+     *                                         objects. A string address is a random static address. Up to
+     *                                         BLE_GAP_WHITELIST_ADDR_MAX_COUNT addresses.
+     * @param {function(Error)} [callback] Callback signature: err => {}.
+     * @returns {void}
+     */
+    setWhitelist(addresses, callback) {
+        const nativeAddresses = addresses.map(address => this._getWhitelistAddress(address));
+
+        this._adapter.gapWhitelistSet(nativeAddresses, err => {
+            if (err) {
+                const errorObject = _makeError('Failed to set whitelist', err);
+                this.emit('error', errorObject);
+                if (callback) { callback(errorObject); }
+                return;
+            }
+
+            if (callback) { callback(); }
+        });
+    }
+
+    /**
+     * @summary Set the device identity list, used to resolve the private addresses of whitelisted peers.
+     *
+     * A peer in the device identity list is matched by its resolvable private address when its identity address is
+     * in the whitelist, see <code>setWhitelist</code>. The local identity is used for all peers. An empty list
+     * clears the device identity list. On SoftDevice API v2 the identities are used as whitelist IRKs.
+     *
+     * The device identity list is cleared when the adapter is opened.
+     *
+     * @param {Object[]} identities The peer identities, up to BLE_GAP_DEVICE_IDENTITIES_MAX_COUNT:
+     * <ul>
+     * <li>{string|Object} address: The peer identity address, as accepted by <code>setWhitelist</code>.
+     * <li>{number[]} irk: The peer identity resolving key, 16 bytes.
+     * </ul>
+     * @param {function(Error)} [callback] Callback signature: err => {}.
+     * @returns {void}
+     */
+    setDeviceIdentities(identities, callback) {
+        const idKeys = identities.map(identity => ({
+            id_info: { irk: identity.irk },
+            id_addr_info: this._getWhitelistAddress(identity.address),
+        }));
+
+        this._adapter.gapDeviceIdentitiesSet(idKeys, err => {
+            if (err) {
+                const errorObject = _makeError('Failed to set device identities', err);
+                this.emit('error', errorObject);
+                if (callback) { callback(errorObject); }
+                return;
+            }
+
+            if (callback) { callback(); }
+        });
+    }
+
+    /**
+     * Get the whitelist and device identity list last set. They are kept by the driver and read without involving
+     * the SoftDevice.
+     *
+     * @returns {Object} <code>{ addresses, identities }</code>, where addresses are <code>{address, type}</code>
+     *                   objects and identities are <code>{address, irk}</code> objects.
+     */
+    getWhitelist() {
+        const whitelist = this._adapter.gapGetWhitelist();
+
+        return {
+            addresses: whitelist.addresses.map(address => this._getAddressStruct(address.address, address.type)),
+            identities: whitelist.identities.map(identity => ({
+                address: this._getAddressStruct(identity.id_addr_info.address, identity.id_addr_info.type),
+                irk: identity.id_info.irk,
+            })),
+        };
+    }
+
     // Enable the client role and starts advertising
     _getAdvertisementParams(params) {
         var retval = {};
@@ -2760,14 +3201,75 @@ class Adapter extends EventEmitter {
     }
 
     /**
-     * Get the current ATT_MTU size.
+     * @summary Answer connection parameter update requests from peripherals natively.
      *
-     * @param {string} deviceInstanceId The device's unique Id.
-     * @returns {undefined|number} The current ATT_MTU size.
+     * Requests answered by the policy are not emitted as <code>connParamUpdateRequest</code>, the outcome is
+     * emitted as <code>connParamUpdate</code> as usual. A policy set for a device overrides the adapter wide
+     * policy until the device disconnects, use mode 'defer' to handle the requests of a device in JavaScript.
+     *
+     * Available modes:
+     * <ul>
+     * <li>'defer': Emit the request as <code>connParamUpdateRequest</code>.
+     * <li>'accept': Accept requests within the bounds, reject the others.
+     * <li>'clamp': Accept requests, with the parameters moved into the bounds.
+     * <li>'reject': Reject all requests.
+     * </ul>
+     *
+     * @param {Object} policy The connection parameter policy.
+     * @param {string} policy.mode 'defer', 'accept', 'clamp' or 'reject'.
+     * @param {number} [policy.minConnectionInterval=7.5] Lowest connection interval in ms.
+     * @param {number} [policy.maxConnectionInterval=4000] Highest connection interval in ms.
+     * @param {number} [policy.maxSlaveLatency=499] Highest slave latency in number of connection events.
+     * @param {number} [policy.minConnectionSupervisionTimeout=100] Shortest supervision timeout in ms.
+     * @param {number} [policy.maxConnectionSupervisionTimeout=32000] Longest supervision timeout in ms.
+     * @param {string} [deviceInstanceId] The device the policy applies to, all devices if not provided.
+     * @returns {void}
      */
-    getCurrentAttMtu(deviceInstanceId) {
-        if (!(deviceInstanceId in this._attMtuMap)) {
-            return;
+    setConnParamPolicy(policy, deviceInstanceId) {
+        const connectionHandle = this._getConnParamPolicyHandle(deviceInstanceId);
+
+        this._adapter.gapSetConnParamPolicy(connectionHandle, {
+            mode: policy.mode,
+            min_conn_interval: policy.minConnectionInterval !== undefined ? policy.minConnectionInterval : 7.5,
+            max_conn_interval: policy.maxConnectionInterval !== undefined ? policy.maxConnectionInterval : 4000,
+            max_slave_latency: policy.maxSlaveLatency !== undefined ? policy.maxSlaveLatency : 499,
+            min_conn_sup_timeout: policy.minConnectionSupervisionTimeout !== undefined ? policy.minConnectionSupervisionTimeout : 100,
+            max_conn_sup_timeout: policy.maxConnectionSupervisionTimeout !== undefined ? policy.maxConnectionSupervisionTimeout : 32000,
+        });
+    }
+
+    /**
+     * @summary Stop answering connection parameter update requests natively, see <code>setConnParamPolicy</code>.
+     *
+     * @param {string} [deviceInstanceId] The device to remove the policy of, the adapter wide policy if not provided.
+     * @returns {boolean} True if a policy was removed.
+     */
+    clearConnParamPolicy(deviceInstanceId) {
+        return this._adapter.gapClearConnParamPolicy(this._getConnParamPolicyHandle(deviceInstanceId));
+    }
+
+    _getConnParamPolicyHandle(deviceInstanceId) {
+        if (deviceInstanceId === undefined) {
+            return this._bleDriver.BLE_CONN_HANDLE_INVALID;
+        }
+
+        const device = this.getDevice(deviceInstanceId);
+        if (!device) {
+            throw new Error('No device with instance id: ' + deviceInstanceId);
+        }
+
+        return device.connectionHandle;
+    }
+
+    /**
+     * Get the current ATT_MTU size.
+     *
+     * @param {string} deviceInstanceId The device's unique Id.
+     * @returns {undefined|number} The current ATT_MTU size.
+     */
+    getCurrentAttMtu(deviceInstanceId) {
+        if (!(deviceInstanceId in this._attMtuMap)) {
+            return;
         }
 
         return this._attMtuMap[deviceInstanceId];
@@ -3145,162 +3647,109 @@ class Adapter extends EventEmitter {
     }
 
     /**
-     * Set the services in the BLE peripheral device's GATT attribute table.
+     * @summary Enable the native bond store.
      *
-     * @param {Service[]} services An array of `Service` objects to be set.
-     * @param {function(Error)} [callback] Callback signature: err => {}.
+     * Keys of bonded peers are stored natively when pairing completes and persisted to <code>path</code>.
+     * Stored bonds are used to answer `BLE_GAP_EVT_SEC_INFO_REQUEST` and to encrypt links to bonded
+     * peripherals on reconnect, without involving JavaScript. A `secInfoRequest` event is only emitted
+     * for peers that are not in the bond store.
+     *
+     * @param {string} path Path of the bond file. Created when the first bond is stored.
+     * @param {Object} [options] Bond store options:
+     * <ul>
+     * <li>{boolean} [autoReply=true]: Answer `BLE_GAP_EVT_SEC_INFO_REQUEST` for bonded peers.
+     * <li>{boolean} [autoEncrypt=true]: Encrypt the link when connecting as central to a bonded peer.
+     * </ul>
      * @returns {void}
      */
-    setServices(services, callback) {
-        let decodeUUID = (uuid, data) => {
-            return new Promise((resolve, reject) => {
-                const length = uuid.length === 32 ? 16 : 2;
+    enableBondStore(path, options) {
+        const bondStoreOptions = Object.assign({ autoReply: true, autoEncrypt: true }, options);
+        this._adapter.gapEnableBondStore(path, bondStoreOptions);
+    }
 
-                this._adapter.decodeUUID(length, uuid, (err, _uuid) => {
-                    if (err) {
-                        // If the UUID is not found it is a 128-bit UUID
-                        // so we have to add it to the SD and try again
-                        if (err.errno === this._bleDriver.NRF_ERROR_NOT_FOUND && length === 16) {
-                            this._adapter.addVendorspecificUUID(
-                                { uuid128: uuid },
-                                (err, type) => {
-                                    if (err) {
-                                        reject(_makeError(`Unable to add UUID ${uuid} to SoftDevice`, err));
-                                    } else {
-                                        this._adapter.decodeUUID(length, uuid, (err, _uuid) => {
-                                            if (err) {
-                                                reject(_makeError(`Unable to decode UUID ${uuid}`, err));
-                                            } else {
-                                                data.decoded_uuid = _uuid;
-                                                resolve(data);
-                                            }
-                                        });
-                                    }
-                                }
-                            );
-                        } else {
-                            reject(_makeError(`Unable to decode UUID ${uuid}`, err));
-                        }
-                    } else {
-                        data.decoded_uuid = _uuid;
-                        resolve(data);
-                    }
-                });
-            });
-        };
+    /**
+     * @summary Disable the native bond store. The bond file is kept.
+     *
+     * @returns {void}
+     */
+    disableBondStore() {
+        this._adapter.gapDisableBondStore();
+    }
 
-        let addService = (service, type, data) => {
-            return new Promise((resolve, reject) => {
-                var p = Promise.resolve(data);
-                var decode = decodeUUID.bind(undefined, service.uuid);
+    /**
+     * @summary Get the bonds in the native bond store.
+     *
+     * @returns {Object[]} One object per bond with the peer address (<code>peer_addr</code>), whether it is
+     *                     an LE Secure Connections bond (<code>lesc</code>) and which keys are stored.
+     */
+    getBonds() {
+        return this._adapter.gapGetBonds();
+    }
 
-                p.then(decode).then(data => {
-                    this._adapter.gattsAddService(type, data.decoded_uuid, (err, serviceHandle) => {
-                        if (err) {
-                            reject(_makeError('Error occurred adding service.', err));
-                        } else {
-                            data.serviceHandle = serviceHandle;
-                            service.startHandle = serviceHandle;
-                            this._services[service.instanceId] = service; // TODO: what if we fail later on this service ?
-                            resolve(data);
-                        }
-                    });
-                }).catch(err => {
-                    reject(err);
-                });
-            });
-        };
+    /**
+     * @summary Delete a bond from the native bond store.
+     *
+     * @param {Object} address The peer address, as reported in <code>peer_addr</code> by <code>getBonds()</code>.
+     * @returns {boolean} true if a bond was deleted.
+     */
+    deleteBond(address) {
+        return this._adapter.gapDeleteBond(address);
+    }
 
-        let addCharacteristic = (characteristic, data) => {
-            return new Promise((resolve, reject) => {
-                this._converter.characteristicToDriver(characteristic, (err, characteristicForDriver) => {
-                    if (err) {
-                        reject(_makeError('Error converting characteristic to driver.', err));
-                    } else {
-                        this._adapter.gattsAddCharacteristic(
-                            data.serviceHandle,
-                            characteristicForDriver.metadata,
-                            characteristicForDriver.attribute,
-                            (err, handles) => {
-                                if (err) {
-                                    reject(_makeError('Error occurred adding characteristic.', err));
-                                } else {
-                                    characteristic.valueHandle = data.characteristicHandle = handles.value_handle;
-                                    characteristic.declarationHandle = characteristic.valueHandle - 1; // valueHandle is always directly after declarationHandle
-                                    this._characteristics[characteristic.instanceId] = characteristic; // TODO: what if we fail later on this ?
-                                    resolve(data);
-
-                                    if (!characteristic._factory_descriptors) {
-                                        return;
-                                    }
-
-                                    const findDescriptor = uuid => {
-                                        return characteristic._factory_descriptors.find(descriptor => {
-                                            return descriptor.uuid === uuid;
-                                        });
-                                    };
-
-                                    if (handles.user_desc_handle) {
-                                        const userDescriptionDescriptor = findDescriptor('2901');
-                                        this._descriptors[userDescriptionDescriptor.instanceId] = userDescriptionDescriptor;
-                                        userDescriptionDescriptor.handle = handles.user_desc_handle;
-                                    }
-
-                                    if (handles.cccd_handle) {
-                                        const cccdDescriptor = findDescriptor('2902');
-                                        this._descriptors[cccdDescriptor.instanceId] = cccdDescriptor;
-                                        cccdDescriptor.handle = handles.cccd_handle;
-                                        cccdDescriptor.value = {};
-
-                                        for (let deviceInstanceId in this._devices) {
-                                            this._setDescriptorValue(cccdDescriptor, [0, 0], deviceInstanceId);
-                                        }
-                                    }
-
-                                    if (handles.sccd_handle) {
-                                        const sccdDescriptor = findDescriptor('2903');
-                                        this._descriptors[sccdDescriptor.instanceId] = sccdDescriptor;
-                                        sccdDescriptor.handle = handles.sccd_handle;
-                                    }
-                                }
-                            }
-                        );
-                    }
-                });
-            });
-        };
+    /**
+     * @summary Reply to LE Secure Connections DH key requests natively.
+     *
+     * The DH key is computed from this adapter's key-pair, see <code>computePublicKey</code>, in a native
+     * thread and sent to the SoftDevice without involving JavaScript. A <code>lescDhkeyReplied</code> event is
+     * emitted when the reply has been sent instead of <code>lescDhkeyRequest</code>. Requests that need OOB
+     * data are still emitted as <code>lescDhkeyRequest</code>. Native replies stop when the adapter is closed.
+     *
+     * @returns {void}
+     */
+    enableLescDhKeyAutoReply() {
+        this._lescDhKeyAutoReply = true;
+        this._generateKeyPair();
+        this._adapter.gapEnableLescDhKeyAutoReply(this._keys.sk, this._lescDhKeyCallback.bind(this));
+    }
 
-        let addDescriptor = (descriptor, data) => {
-            return new Promise((resolve, reject) => {
-                this._converter.descriptorToDriver(descriptor, (err, descriptorForDriver) => {
-                    if (err) {
-                        reject(_makeError('Error converting descriptor.', err));
-                    } else if (descriptorForDriver) {
-                        this._adapter.gattsAddDescriptor(
-                            data.characteristicHandle,
-                            descriptorForDriver,
-                            (err, handle) => {
-                                if (err) {
-                                    reject(_makeError(err, 'Error adding descriptor.'));
-                                } else {
-                                    descriptor.handle = data.descriptorHandle = handle;
-                                    this._descriptors[descriptor.instanceId] = descriptor; // TODO: what if we fail later on this ?
-                                    resolve(data);
-                                }
-                            }
-                        );
-                    }
-                });
-            });
-        };
+    /**
+     * @summary Stop replying to LE Secure Connections DH key requests natively.
+     *
+     * @returns {void}
+     */
+    disableLescDhKeyAutoReply() {
+        this._lescDhKeyAutoReply = false;
+        this._adapter.gapDisableLescDhKeyAutoReply();
+    }
 
-        let promiseSequencer = (list, data) => {
-            var p = Promise.resolve(data);
-            return list.reduce((previousP, nextP) => {
-                return previousP.then(nextP);
-            }, p);
-        };
+    _lescDhKeyCallback(completions) {
+        completions.forEach(completion => {
+            const device = this._getDeviceByConnectionHandle(completion.conn_handle);
 
+            if (completion.error) {
+                this.emit('error', _makeError(`Failed to reply with DH key to ${device ? device.instanceId : completion.conn_handle}`, completion.error));
+            }
+
+            /**
+             * The DH key was computed and sent to the SoftDevice natively.
+             *
+             * @event Adapter#lescDhkeyReplied
+             * @type {Object}
+             * @property {Device} device - The <code>Device</code> instance representing the BLE peer we're connected to.
+             * @property {boolean} peerKeyValid - false if the peer public key was invalid and pairing will fail.
+             */
+            this.emit('lescDhkeyReplied', device, completion.peer_key_valid);
+        });
+    }
+
+    /**
+     * Set the services in the BLE peripheral device's GATT attribute table.
+     *
+     * @param {Service[]} services An array of `Service` objects to be set.
+     * @param {function(Error)} [callback] Callback signature: err => {}.
+     * @returns {void}
+     */
+    setServices(services, callback) {
         let applyGapServiceCharacteristics = gapService => {
             for (let characteristic of gapService._factory_characteristics) {
                 // TODO: Fix Device Name uuid magic number
@@ -3339,53 +3788,141 @@ class Adapter extends EventEmitter {
             }
         };
 
-        // Create array of function objects to call in sequence.
-        var promises = [];
+        const findDescriptor = (characteristic, uuid) => {
+            return characteristic._factory_descriptors.find(descriptor => {
+                return descriptor.uuid === uuid;
+            });
+        };
 
-        for (let service of services) {
-            var p;
+        // Vendor specific bases registered natively must also be known by the converter, see lookupVsUuid.
+        const storeVsUuid = (uuid, driverUuid) => {
+            const uuidString = uuid.replace(/-/g, '');
 
-            if (service.uuid === '1800') {
-                service.startHandle = 1;
-                service.endHandle = 7;
-                applyGapServiceCharacteristics(service);
-                this._services[service.instanceId] = service;
-                continue;
-            } else if (service.uuid === '1801') {
-                service.startHandle = 8;
-                service.endHandle = 8;
-                this._services[service.instanceId] = service;
-                continue;
+            if (uuidString.length === 32 && driverUuid.type >= this._bleDriver.BLE_UUID_TYPE_VENDOR_BEGIN) {
+                this._converter.vsUuidStore[driverUuid.type - this._bleDriver.BLE_UUID_TYPE_VENDOR_BEGIN] =
+                    this._converter._replace16bitUuidIn128bitUuid(uuidString, '0000');
             }
+        };
 
-            p = addService.bind(undefined, service, this._getServiceType(service));
-            promises.push(p);
+        const applyCharacteristicHandles = (characteristic, handles) => {
+            characteristic.valueHandle = handles.value_handle;
+            characteristic.declarationHandle = characteristic.valueHandle - 1; // valueHandle is always directly after declarationHandle
+            this._characteristics[characteristic.instanceId] = characteristic;
 
-            if (service._factory_characteristics) {
-                for (let characteristic of service._factory_characteristics) {
-                    p = addCharacteristic.bind(undefined, characteristic);
-                    promises.push(p);
+            if (!characteristic._factory_descriptors) {
+                return;
+            }
 
-                    if (characteristic._factory_descriptors) {
-                        for (let descriptor of characteristic._factory_descriptors) {
-                            if (!this._converter.isSpecialUUID(descriptor.uuid)) {
-                                p = addDescriptor.bind(undefined, descriptor);
-                                promises.push(p);
-                            }
+            if (handles.user_desc_handle) {
+                const userDescriptionDescriptor = findDescriptor(characteristic, '2901');
+                this._descriptors[userDescriptionDescriptor.instanceId] = userDescriptionDescriptor;
+                userDescriptionDescriptor.handle = handles.user_desc_handle;
+            }
+
+            if (handles.cccd_handle) {
+                const cccdDescriptor = findDescriptor(characteristic, '2902');
+                this._descriptors[cccdDescriptor.instanceId] = cccdDescriptor;
+                cccdDescriptor.handle = handles.cccd_handle;
+                cccdDescriptor.value = {};
+
+                for (let deviceInstanceId in this._devices) {
+                    this._setDescriptorValue(cccdDescriptor, [0, 0], deviceInstanceId);
+                }
+            }
+
+            if (handles.sccd_handle) {
+                const sccdDescriptor = findDescriptor(characteristic, '2903');
+                this._descriptors[sccdDescriptor.instanceId] = sccdDescriptor;
+                sccdDescriptor.handle = handles.sccd_handle;
+            }
+        };
+
+        // Build the whole attribute table definition up front, the addon resolves UUIDs
+        // and adds all attributes to the SoftDevice in a single worker job.
+        const tableServices = [];
+        const definition = { services: [] };
+
+        try {
+            for (let service of services) {
+                if (service.uuid === '1800') {
+                    service.startHandle = 1;
+                    service.endHandle = 7;
+                    applyGapServiceCharacteristics(service);
+                    this._services[service.instanceId] = service;
+                    continue;
+                } else if (service.uuid === '1801') {
+                    service.startHandle = 8;
+                    service.endHandle = 8;
+                    this._services[service.instanceId] = service;
+                    continue;
+                }
+
+                const tableService = {
+                    type: this._getServiceType(service),
+                    uuid: service.uuid,
+                    characteristics: [],
+                };
+
+                const tableCharacteristics = [];
+
+                for (let characteristic of (service._factory_characteristics || [])) {
+                    const tableCharacteristic = this._converter.characteristicToTable(characteristic);
+                    const tableDescriptors = [];
+
+                    tableCharacteristic.descriptors = [];
+
+                    for (let descriptor of (characteristic._factory_descriptors || [])) {
+                        if (!this._converter.isSpecialUUID(descriptor.uuid)) {
+                            tableCharacteristic.descriptors.push(this._converter.descriptorToTable(descriptor));
+                            tableDescriptors.push(descriptor);
                         }
                     }
+
+                    tableService.characteristics.push(tableCharacteristic);
+                    tableCharacteristics.push({ characteristic, descriptors: tableDescriptors });
                 }
+
+                definition.services.push(tableService);
+                tableServices.push({ service, characteristics: tableCharacteristics });
             }
+        } catch (error) {
+            const err = _makeError('Error converting services to driver.', error);
+            this.emit('error', err);
+            if (callback) { callback(err); }
+            return;
         }
 
-        // Execute the promises in sequence, start with an empty object that
-        // is propagated to all promises.
-        promiseSequencer(promises, {}).then(data => {
-            // TODO: Ierate over all servicses, descriptors, characterstics from parameter services
+        this._adapter.gattsBuildTable(definition, (err, table) => {
+            if (err) {
+                const error = _makeError('Error occurred building attribute table.', err);
+                this.emit('error', error);
+                if (callback) { callback(error); }
+                return;
+            }
+
+            table.services.forEach((tableService, i) => {
+                const service = tableServices[i].service;
+
+                storeVsUuid(service.uuid, tableService.uuid);
+                service.startHandle = tableService.handle;
+                this._services[service.instanceId] = service;
+
+                tableService.characteristics.forEach((tableCharacteristic, j) => {
+                    const characteristic = tableServices[i].characteristics[j].characteristic;
+                    const descriptors = tableServices[i].characteristics[j].descriptors;
+
+                    storeVsUuid(characteristic.uuid, tableCharacteristic.uuid);
+                    applyCharacteristicHandles(characteristic, tableCharacteristic.handles);
+
+                    tableCharacteristic.descriptors.forEach((tableDescriptor, k) => {
+                        storeVsUuid(descriptors[k].uuid, tableDescriptor.uuid);
+                        descriptors[k].handle = tableDescriptor.handle;
+                        this._descriptors[descriptors[k].instanceId] = descriptors[k];
+                    });
+                });
+            });
+
             if (callback) { callback(); }
-        }).catch(err => {
-            this.emit('error', err);
-            if (callback) { callback(err); }
         });
     }
 
@@ -3731,15 +4268,167 @@ class Adapter extends EventEmitter {
             throw new Error('Characteristic value read failed: A gatt operation already in progress with device id ' + device.instanceId);
         }
 
-        this._gattOperationsMap[device.instanceId] = { callback: callback, readBytes: [] };
+        this._gattOperationsMap[device.instanceId] = { callback: callback };
+        this._readLongValue(device, characteristic.valueHandle, 'Read characteristic value failed', callback);
+    }
+
+    // Values longer than ATT MTU - 1 are read with read blob requests sent natively, and returned once
+    _readLongValue(device, handle, errorMessage, callback) {
+        this._adapter.gattcReadLong(device.connectionHandle, handle, (err, result) => {
+            delete this._gattOperationsMap[device.instanceId];
 
-        this._adapter.gattcRead(device.connectionHandle, characteristic.valueHandle, 0, err => {
             if (err) {
-                this.emit('error', _makeError('Read characteristic value failed', err));
+                const error = _makeError(errorMessage, err);
+                this.emit('error', error);
+                if (callback) { callback(error); }
+                return;
+            }
+
+            if (result.gatt_status !== this._bleDriver.BLE_GATT_STATUS_SUCCESS) {
+                if (callback) { callback(_makeError(`Read operation failed: ${result.gatt_status_name} (0x${HexConv.numberToHexString(result.gatt_status)})`)); }
+                return;
             }
+
+            if (callback) { callback(undefined, result.value); }
         });
     }
 
+    /**
+     * @summary Sets the value of a local GATT characteristic and notifies or indicates all subscribed centrals.
+     *
+     * The subscriptions are tracked natively from the CCCD writes of each peer, and all subscribers are
+     * served in one native job. Links without TX buffers get the value queued natively and sent when the
+     * SoftDevice has capacity again. Indications are sent if the peer has enabled both.
+     *
+     * The result object has these members:
+     * <ul>
+     * <li>{number} subscriberCount: Links that have notifications or indications enabled
+     * <li>{number} sentCount: Notifications and indications handed to the SoftDevice
+     * <li>{number} queuedCount: Waiting natively for TX buffers
+     * <li>{number} failedCount: Rejected by the SoftDevice or dropped because the link queue was full
+     * </ul>
+     *
+     * @param {string} characteristicId Unique ID of the local GATT characteristic.
+     * @param {array|Uint8Array} value The value (array of bytes) to be set and sent.
+     * @param {function(Error, Object)} [callback] Callback signature: (err, result) => {}.
+     * @returns {void}
+     */
+    notifyCharacteristicValue(characteristicId, value, callback) {
+        const characteristic = this.getCharacteristic(characteristicId);
+        if (!characteristic || !this._instanceIdIsOnLocalDevice(characteristicId)) {
+            throw new Error('Characteristic notify failed: Could not get local characteristic with id ' + characteristicId);
+        }
+
+        this._adapter.gattsNotifyAll(characteristic.valueHandle, value, (err, result) => {
+            if (err) {
+                const error = _makeError('Failed to notify subscribers', err);
+                this.emit('error', error);
+                if (callback) { callback(error); }
+                return;
+            }
+
+            characteristic.value = Array.from(value);
+            if (callback) { callback(undefined, result); }
+        });
+    }
+
+    _getLocalAttributeHandle(attributeId) {
+        if (!this._instanceIdIsOnLocalDevice(attributeId)) {
+            return undefined;
+        }
+
+        const characteristic = this.getCharacteristic(attributeId);
+        if (characteristic) {
+            return characteristic.valueHandle;
+        }
+
+        const descriptor = this.getDescriptor(attributeId);
+        return descriptor ? descriptor.handle : undefined;
+    }
+
+    /**
+     * @summary Answer read and write authorization requests for a local attribute natively.
+     *
+     * The attribute must have been added with read or write authorization. Requests answered by the
+     * policy are not emitted to JavaScript, so the value of the attribute in this adapter may be stale.
+     * Prepared (long) writes are always emitted.
+     *
+     * The policy object has these members:
+     * <ul>
+     * <li>{string} read, write: <code>'defer'</code> to emit the request as today (default),
+     *     <code>'accept'</code> to let the SoftDevice serve or store the value,
+     *     <code>'value'</code> to answer reads from, and store writes in, the native value, or
+     *     <code>'reject'</code> to reply with <code>rejectStatus</code>
+     * <li>{number} rejectStatus: GATT status used when rejecting, default
+     *     <code>BLE_GATT_STATUS_ATTERR_INSUF_AUTHORIZATION</code>
+     * <li>{array} value: Initial native value used by <code>'value'</code>
+     * </ul>
+     *
+     * @param {string} attributeId Unique ID of the local characteristic or descriptor.
+     * @param {Object} policy The policy to apply.
+     * @returns {void}
+     */
+    setAuthorizePolicy(attributeId, policy) {
+        const handle = this._getLocalAttributeHandle(attributeId);
+        if (handle === undefined) {
+            throw new Error('Set authorize policy failed: Could not get local attribute with id ' + attributeId);
+        }
+
+        const effectivePolicy = Object.assign({
+            read: 'defer',
+            write: 'defer',
+            rejectStatus: this._bleDriver.BLE_GATT_STATUS_ATTERR_INSUF_AUTHORIZATION,
+        }, policy);
+
+        this._adapter.gattsSetAuthorizePolicy(handle, effectivePolicy);
+    }
+
+    /**
+     * @summary Remove the native authorize policy of a local attribute, requests are emitted again.
+     *
+     * @param {string} attributeId Unique ID of the local characteristic or descriptor.
+     * @returns {boolean} False if the attribute had no policy.
+     */
+    clearAuthorizePolicy(attributeId) {
+        const handle = this._getLocalAttributeHandle(attributeId);
+        if (handle === undefined) {
+            throw new Error('Clear authorize policy failed: Could not get local attribute with id ' + attributeId);
+        }
+
+        return this._adapter.gattsClearAuthorizePolicy(handle);
+    }
+
+    /**
+     * @summary Set the native value used to answer reads for an attribute with a <code>'value'</code> policy.
+     *
+     * @param {string} attributeId Unique ID of the local characteristic or descriptor.
+     * @param {array|Uint8Array} value The value (array of bytes).
+     * @returns {boolean} False if the attribute has no policy.
+     */
+    setAuthorizeValue(attributeId, value) {
+        const handle = this._getLocalAttributeHandle(attributeId);
+        if (handle === undefined) {
+            throw new Error('Set authorize value failed: Could not get local attribute with id ' + attributeId);
+        }
+
+        return this._adapter.gattsSetAuthorizeValue(handle, value);
+    }
+
+    /**
+     * @summary Get the native value of an attribute with an authorize policy, including values written by peers.
+     *
+     * @param {string} attributeId Unique ID of the local characteristic or descriptor.
+     * @returns {array|undefined} The value, or undefined if the attribute has no policy.
+     */
+    getAuthorizeValue(attributeId) {
+        const handle = this._getLocalAttributeHandle(attributeId);
+        if (handle === undefined) {
+            throw new Error('Get authorize value failed: Could not get local attribute with id ' + attributeId);
+        }
+
+        return this._adapter.gattsGetAuthorizeValue(handle);
+    }
+
     /**
      * Writes the value of a GATT characteristic.
      *
@@ -3770,7 +4459,7 @@ class Adapter extends EventEmitter {
             throw new Error('Characteristic value write failed: A gatt operation already in progress with device id ' + device.instanceId);
         }
 
-        this._gattOperationsMap[device.instanceId] = { callback: completeCallback, bytesWritten: 0, value: value.slice(), attribute: characteristic };
+        this._gattOperationsMap[device.instanceId] = { callback: completeCallback, value: value.slice(), attribute: characteristic };
 
         if (value.length > this._maxShortWritePayloadSize(device.instanceId)) {
             if (!ack) {
@@ -3778,10 +4467,8 @@ class Adapter extends EventEmitter {
                 throw new Error('Long writes do not support BLE_GATT_OP_WRITE_CMD');
             }
 
-            this._gattOperationsMap[device.instanceId].bytesWritten = this._maxLongWritePayloadSize(device.instanceId);
-            this._longWrite(device, characteristic, value, completeCallback);
+            this._queuedWrite(device, [{ attribute: characteristic, value }], completeCallback);
         } else {
-            this._gattOperationsMap[device.instanceId].bytesWritten = value.length;
             this._shortWrite(device, characteristic, value, ack, completeCallback);
         }
     }
@@ -3861,13 +4548,8 @@ class Adapter extends EventEmitter {
             throw new Error('Descriptor read failed: A gatt operation already in progress with device with id ' + device.instanceId);
         }
 
-        this._gattOperationsMap[device.instanceId] = { callback: callback, readBytes: [] };
-
-        this._adapter.gattcRead(device.connectionHandle, descriptor.handle, 0, err => {
-            if (err) {
-                this.emit('error', _makeError('Read descriptor value failed', err));
-            }
-        });
+        this._gattOperationsMap[device.instanceId] = { callback: callback };
+        this._readLongValue(device, descriptor.handle, 'Read descriptor value failed', callback);
     }
 
     /**
@@ -3902,7 +4584,7 @@ class Adapter extends EventEmitter {
             throw new Error('Descriptor write failed: A gatt operation already in progress with device with id ' + device.instanceId);
         }
 
-        this._gattOperationsMap[device.instanceId] = { callback: callback, bytesWritten: 0, value: value.slice(), attribute: descriptor };
+        this._gattOperationsMap[device.instanceId] = { callback: callback, value: value.slice(), attribute: descriptor };
 
         if (value.length > this._maxShortWritePayloadSize(device.instanceId)) {
             if (!ack) {
@@ -3910,14 +4592,60 @@ class Adapter extends EventEmitter {
                 throw new Error('Long writes do not support BLE_GATT_OP_WRITE_CMD');
             }
 
-            this._gattOperationsMap[device.instanceId].bytesWritten = this._maxLongWritePayloadSize(device.instanceId);
-            this._longWrite(device, descriptor, value, callback);
+            this._queuedWrite(device, [{ attribute: descriptor, value }], callback);
         } else {
-            this._gattOperationsMap[device.instanceId].bytesWritten = value.length;
             this._shortWrite(device, descriptor, value, ack, callback);
         }
     }
 
+    /**
+     * @summary Reliably writes the values of several GATT characteristics or descriptors on one device.
+     *
+     * All values are queued on the peer with prepare write requests and written together by one execute
+     * write request. The value echoed for each prepare write request is verified, and any failure or
+     * mismatch cancels the whole queue so none of the values are written.
+     *
+     * @param {Object[]} writes Array of objects with <code>attributeId</code>, the unique ID of a characteristic or
+     *                          descriptor, and <code>value</code>, the array of bytes to write.
+     * @param {function(Error, Object[])} [callback] Callback signature: (err, attributes) => {}.
+     * @returns {void}
+     */
+    writeReliable(writes, callback) {
+        if (!Array.isArray(writes) || writes.length === 0) {
+            throw new Error('Reliable write failed: No values to write');
+        }
+
+        let device;
+
+        const attributeWrites = writes.map(write => {
+            const attribute = this.getCharacteristic(write.attributeId) || this.getDescriptor(write.attributeId);
+            if (!attribute || this._instanceIdIsOnLocalDevice(write.attributeId)) {
+                throw new Error('Reliable write failed: Could not get remote attribute with id ' + write.attributeId);
+            }
+
+            const attributeDevice = this._descriptors[write.attributeId] ?
+                this._getDeviceByDescriptorId(write.attributeId) : this._getDeviceByCharacteristicId(write.attributeId);
+
+            if (!attributeDevice) {
+                throw new Error('Reliable write failed: Could not get device of attribute with id ' + write.attributeId);
+            }
+
+            if (device && device !== attributeDevice) {
+                throw new Error('Reliable write failed: All attributes must be on the same device');
+            }
+
+            device = attributeDevice;
+            return { attribute, value: Array.from(write.value) };
+        });
+
+        if (this._gattOperationsMap[device.instanceId]) {
+            throw new Error('Reliable write failed: A gatt operation already in progress with device id ' + device.instanceId);
+        }
+
+        this._gattOperationsMap[device.instanceId] = { callback: callback };
+        this._queuedWrite(device, attributeWrites, callback);
+    }
+
     _shortWrite(device, attribute, value, ack, callback) {
         const writeParameters = {
             write_op: ack ? this._bleDriver.BLE_GATT_OP_WRITE_REQ : this._bleDriver.BLE_GATT_OP_WRITE_CMD,
@@ -3985,50 +4713,37 @@ class Adapter extends EventEmitter {
         ]);
     }
 
-    _longWrite(device, attribute, value, callback) {
-        if (value.length < this._maxShortWritePayloadSize(device.instanceId)) {
-            throw new Error('Wrong write method. Use regular write for payload sizes < ' + this._maxShortWritePayloadSize(device.instanceId));
-        }
+    // Sends the values with prepare write requests and one execute write request. The requests are sent natively as the
+    // responses arrive, and every echoed value is verified. Any failure cancels all the queued writes.
+    _queuedWrite(device, writes, callback) {
+        const items = writes.map(write => ({ handle: write.attribute.handle, value: write.value }));
 
-        const writeParameters = {
-            write_op: this._bleDriver.BLE_GATT_OP_PREP_WRITE_REQ,
-            flags: this._bleDriver.BLE_GATT_EXEC_WRITE_FLAG_PREPARED_WRITE,
-            handle: attribute.handle,
-            offset: 0,
-            len: this._maxLongWritePayloadSize(device.instanceId),
-            value: value.slice(0, this._maxLongWritePayloadSize(device.instanceId)),
-        };
+        this._adapter.gattcWriteLong(device.connectionHandle, items, (err, result) => {
+            delete this._gattOperationsMap[device.instanceId];
 
-        this._adapter.gattcWrite(device.connectionHandle, writeParameters, err => {
             if (err) {
-                this._longWriteCancel(device, attribute);
-                this.emit('error', _makeError('Failed to write value to device/handle ' + device.instanceId + '/' + attribute.handle, err));
+                const error = _makeError('Failed to write value to device ' + device.instanceId, err);
+                this.emit('error', error);
+                if (callback) { callback(error); }
                 return;
             }
 
-        });
-    }
+            if (result.verify_failed) {
+                if (callback) { callback(_makeError(`Write operation cancelled: Value echoed for handle ${result.error_handle} did not match`)); }
+                return;
+            }
 
-    _longWriteCancel(device, attribute) {
-        const gattOperation = this._gattOperationsMap[device.instanceId];
-        const writeParameters = {
-            write_op: this._bleDriver.BLE_GATT_OP_EXEC_WRITE_REQ,
-            flags: this._bleDriver.BLE_GATT_EXEC_WRITE_FLAG_PREPARED_CANCEL,
-            handle: attribute.handle,
-            offset: 0,
-            len: 0,
-            value: [],
-        };
+            if (!result.executed) {
+                if (callback) { callback(_makeError(`Write operation failed: ${result.gatt_status_name} (0x${HexConv.numberToHexString(result.gatt_status)})`)); }
+                return;
+            }
 
-        this._adapter.gattcWrite(device.connectionHandle, writeParameters, err => {
-            delete this._gattOperationsMap[device.instanceId];
+            writes.forEach(write => {
+                write.attribute.value = write.value.slice();
+                this._emitAttributeValueChanged(write.attribute);
+            });
 
-            if (err) {
-                this.emit('error', _makeError('Failed to cancel failed long write', err));
-                gattOperation.callback('Failed to write and failed to cancel write');
-            } else {
-                gattOperation.callback('Failed to write value to device/handle ' + device.instanceId + '/' + attribute.handle);
-            }
+            if (callback) { callback(undefined, writes.length === 1 ? writes[0].attribute : writes.map(write => write.attribute)); }
         });
     }
 
@@ -4304,6 +5019,82 @@ class Adapter extends EventEmitter {
             if (callback) { callback(); }
         });
     }
+
+    /**
+     * @summary Set the link settings negotiated natively on every connection.
+     *
+     * When a link is established the ATT MTU exchange, data length update and PHY update are started from the
+     * thread receiving SoftDevice events, and the peer's requests for the same procedures are answered there too,
+     * instead of waiting for a JavaScript round trip. Settings left at 0 are not negotiated and the corresponding
+     * requests are answered by JavaScript as before, as are requests the SoftDevice rejected the policy's reply
+     * to. The negotiated values are available on the <code>Device</code> as <code>attMtu</code>,
+     * <code>maxTxOctets</code>, <code>maxRxOctets</code>, <code>txPhy</code> and <code>rxPhy</code>.
+     *
+     * Note that the ATT MTU exchange on connect is a GATT client procedure, GATT client operations started before
+     * it completes fail with BUSY. Only available with SoftDevice API version 5 or newer.
+     *
+     * @param {Object} policy The link policy.
+     * @param {number} [policy.attMtu=0] ATT MTU to request and to reply with, at least BLE_GATT_ATT_MTU_DEFAULT and at
+     * most the att_mtu the SoftDevice was enabled with.
+     * @param {number} [policy.maxTxOctets=0] Maximum number of payload octets to send in a link layer packet.
+     * @param {number} [policy.maxRxOctets=0] Maximum number of payload octets to receive in a link layer packet.
+     * @param {number} [policy.txPhys=0] Preferred TX PHYs as a bitfield of BLE_GAP_PHY_*.
+     * @param {number} [policy.rxPhys=0] Preferred RX PHYs as a bitfield of BLE_GAP_PHY_*.
+     * @param {boolean} [policy.connEventExtension=false] Extend connection events while there is data to send.
+     * @param {function(Error)} [callback] Signature: err => {}.
+     * @returns {void}
+     */
+    setLinkPolicy(policy, callback) {
+        if (this._bleDriver.NRF_SD_BLE_API_VERSION < 5) {
+            const errorObject = _makeError('Failed to set link policy. Requires SoftDevice API version 5 or newer');
+            if (callback) { callback(errorObject); }
+            return;
+        }
+
+        const linkPolicy = {
+            attMtu: policy.attMtu || 0,
+            maxTxOctets: policy.maxTxOctets || 0,
+            maxRxOctets: policy.maxRxOctets || 0,
+            txPhys: policy.txPhys || 0,
+            rxPhys: policy.rxPhys || 0,
+            connEventExtension: !!policy.connEventExtension,
+        };
+
+        this._adapter.gapSetLinkPolicy({
+            att_mtu: linkPolicy.attMtu,
+            max_tx_octets: linkPolicy.maxTxOctets,
+            max_rx_octets: linkPolicy.maxRxOctets,
+            tx_phys: linkPolicy.txPhys,
+            rx_phys: linkPolicy.rxPhys,
+            conn_evt_ext: linkPolicy.connEventExtension,
+        }, err => {
+            if (err) {
+                const errorObject = _makeError('Failed to set link policy', err);
+                this.emit('error', errorObject);
+                if (callback) { callback(errorObject); }
+                return;
+            }
+
+            this._linkPolicy = linkPolicy;
+            if (callback) { callback(); }
+        });
+    }
+
+    /**
+     * @summary Stop negotiating link settings natively, see <code>setLinkPolicy</code>.
+     *
+     * @param {function(Error)} [callback] Signature: err => {}.
+     * @returns {void}
+     */
+    clearLinkPolicy(callback) {
+        this.setLinkPolicy({}, err => {
+            if (!err) {
+                this._linkPolicy = null;
+            }
+
+            if (callback) { callback(err); }
+        });
+    }
 }
 
 module.exports = Adapter;
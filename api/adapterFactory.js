@@ -122,8 +122,9 @@ class AdapterFactory extends EventEmitter {
         super();
         this._bleDrivers = bleDrivers;
         this._adapters = {};
+        this._isMonitoring = false;
 
-        if (options.enablePolling) {
+        if (options.enablePolling && !this._startAdapterMonitor()) {
             this.updateInterval = setInterval(this._updateAdapterList.bind(this), UPDATE_INTERVAL_MS);
         }
     }
@@ -133,9 +134,12 @@ class AdapterFactory extends EventEmitter {
      *
      * The mapping of SoftDevice API version to pc-ble-driver AddOn can be overridden
      * by providing a custom `bleDrivers` argument. By default the AdapterFactory will
-     * poll for added/removed adapters every 2 seconds and emit 'added' and 'removed'
-     * events. This can be disabled by passing `enablePolling: false` as part of the
-     * options object.
+     * watch for added/removed adapters and emit 'added' and 'removed' events. Where the
+     * AddOn supports hotplug monitoring (udev on Linux) the events are emitted as soon as
+     * an adapter is plugged in or out, and `getAdapters` returns the monitored adapters
+     * without enumerating the serial ports again. Otherwise the AdapterFactory polls for
+     * adapters every 2 seconds. This can be disabled by passing `enablePolling: false`
+     * as part of the options object. Monitoring and polling run for the lifetime of the process.
      *
      * @param {Object} [bleDrivers] Optional object mapping version to pc-ble-driver AddOn.
      * @param {Object} [options] Optional object for customizing the behavior of the adapter factory.
@@ -231,8 +235,97 @@ class AdapterFactory extends EventEmitter {
         });
     }
 
+    _addAdapter(adapter, silent) {
+        const adapterInstanceId = this._getInstanceId(adapter);
+
+        try {
+            const newAdapter = this._parseAndCreateAdapter(adapter);
+
+            if (this._adapters[adapterInstanceId] === undefined) {
+                this._adapters[adapterInstanceId] = newAdapter;
+                this._setUpListenersForAdapterOpenAndClose(newAdapter);
+
+                if (!silent) {
+                    this.emit('added', newAdapter);
+                }
+
+                return newAdapter;
+            }
+        } catch (error) {
+            this.emit('logMessage', logLevel.DEBUG, `Unable to create adapter: ${error.message}`);
+        }
+
+        return undefined;
+    }
+
+    _removeAdapter(adapterInstanceId) {
+        const removedAdapter = this._adapters[adapterInstanceId];
+        if (removedAdapter === undefined) {
+            return;
+        }
+
+        removedAdapter.removeAllListeners('opened');
+        delete this._adapters[adapterInstanceId];
+        this.emit('removed', removedAdapter);
+    }
+
+    /**
+     * Start hotplug monitoring of adapters, if supported by the AddOn on this platform.
+     *
+     * The monitor is shared by the process and is never stopped, like the polling it replaces it keeps the
+     * event loop alive. The AddOn only supports one monitor, a factory from another copy of this module
+     * falls back to polling.
+     *
+     * @private
+     * @returns {boolean} True if monitoring was started.
+     */
+    _startAdapterMonitor() {
+        // for monitoring the adapters we just use pc-ble-driver AddOn v2, same as for getting them
+        const driver = this._bleDrivers.v2;
+        if (!driver || typeof driver.startAdapterMonitor !== 'function') {
+            return false;
+        }
+
+        let adapters;
+        try {
+            adapters = driver.startAdapterMonitor((eventName, adapter) => {
+                if (eventName === 'added') {
+                    this._addAdapter(adapter);
+                } else if (eventName === 'removed') {
+                    this._removeAdapter(this._getInstanceId(adapter));
+                }
+            });
+        } catch (error) {
+            this.emit('logMessage', logLevel.DEBUG, `Adapter monitoring not available, polling instead: ${error.message}`);
+            return false;
+        }
+
+        this._isMonitoring = true;
+
+        // Called from the constructor, so the adapters already plugged in are announced once listeners can be attached.
+        // getAdapters sees them right away.
+        const addedAdapters = adapters.map(adapter => this._addAdapter(adapter, true))
+            .filter(adapter => adapter !== undefined);
+
+        setImmediate(() => {
+            addedAdapters
+                .filter(adapter => this._adapters[adapter.instanceId] === adapter)
+                .forEach(adapter => this.emit('added', adapter));
+        });
+
+        return true;
+    }
+
     // TODO: create a separate npm module that gets connected adapters and information about them
     _updateAdapterList(callback) {
+        if (this._isMonitoring) {
+            // The adapter list is kept up to date by the monitor, so no need to enumerate again.
+            if (callback && (typeof callback === 'function')) {
+                setImmediate(() => callback(undefined, this._adapters));
+            }
+            return;
+        }
+
         // for getting the adapters we just use pc-ble-driver AddOn v2
         this._bleDrivers.v2.getAdapters((err, adapters) => {
             const isCallback = callback && (typeof callback === 'function');
@@ -254,25 +347,10 @@ class AdapterFactory extends EventEmitter {
                     delete removedAdapters[adapterInstanceId];
                 }
 
-                try {
-                    const newAdapter = this._parseAndCreateAdapter(adapter);
-
-                    if (this._adapters[adapterInstanceId] === undefined) {
-                        this._adapters[adapterInstanceId] = newAdapter;
-                        this._setUpListenersForAdapterOpenAndClose(newAdapter);
-                        this.emit('added', newAdapter);
-                    }
-                } catch (error) {
-                    this.emit('logMessage', logLevel.DEBUG, `Unable to create adapter: ${error.message}`);
-                }
+                this._addAdapter(adapter);
             }
 
-            Object.keys(removedAdapters).forEach(adapterId => {
-                const removedAdapter = this._adapters[adapterId];
-                removedAdapter.removeAllListeners('opened');
-                delete this._adapters[adapterId];
-                this.emit('removed', removedAdapter);
-            });
+            Object.keys(removedAdapters).forEach(adapterId => this._removeAdapter(adapterId));
 
             if (isCallback) {
                 callback(undefined, this._adapters);
@@ -99,6 +99,13 @@ class Device {
         this.slaveLatency = null;
         this.connectionSupervisionTimeout = null;
 
+        // Negotiated link settings, see Adapter.setLinkPolicy
+        this.attMtu = null;
+        this.maxTxOctets = null;
+        this.maxRxOctets = null;
+        this.txPhy = null;
+        this.rxPhy = null;
+
         this.paired = false;
 
         // local adapter peripheral initiated a pairing procedure
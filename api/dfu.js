@@ -78,8 +78,10 @@ class Dfu extends EventEmitter {
      *  <li>{number} [prnValue]: Packet receipt notification number.
      *  <li>{number} [mtuSize]: Maximum transmission unit number.
      *  </ul>
+     * @param {function} [transportFactory] Creates the transport for each update. Signature:
+     *                   (transportParameters) => transport. Defaults to creating a <code>DfuTransport</code>.
      */
-    constructor(transportType, transportParameters) {
+    constructor(transportType, transportParameters, transportFactory) {
         super();
 
         if (!transportType) {
@@ -91,11 +93,22 @@ class Dfu extends EventEmitter {
 
         this._transportType = transportType;
         this._transportParameters = transportParameters;
+        this._transportFactory = transportFactory || Dfu.createTransport;
         this._transport = null;
         this._speedometer = null;
         this._setState(DfuState.READY);
     }
 
+    /**
+     * Create the default transport, which performs DFU over BLE.
+     *
+     * @param {Object} transportParameters Configuration parameters, see constructor.
+     * @returns {DfuTransport} The created transport.
+     */
+    static createTransport(transportParameters) {
+        return new BleTransport(transportParameters);
+    }
+
     /**
      * Perform DFU with the given zip file. Successful when callback is invoked with no arguments.
      *
@@ -115,9 +128,55 @@ class Dfu extends EventEmitter {
         }
 
         this._log(logLevel.INFO, `Performing DFU with file: ${zipFilePath}`);
-        this._setState(DfuState.IN_PROGRESS);
+        this._performDFU(() => this._fetchUpdates(zipFilePath), callback);
+    }
+
+    /**
+     * Perform DFU with updates that have already been fetched from a zip file, so that
+     * several Dfu controllers can share the same zip contents. Successful when callback
+     * is invoked with no arguments.
+     *
+     * @param {Array} updates Updates as returned by <code>fetchUpdates()</code>.
+     * @param {function} callback Signature: (err, abort) => {}.
+     * @returns {void}
+     */
+    performUpdates(updates, callback) {
+        if (this._state !== DfuState.READY) {
+            throw new Error('Not in READY state. DFU in progress or aborting.');
+        }
+        if (!updates) {
+            throw new Error('No updates provided.');
+        }
+        if (!callback) {
+            throw new Error('No callback function provided.');
+        }
+
+        this._performDFU(() => Promise.resolve(updates), callback);
+    }
+
+    /**
+     * Fetch the updates contained in the given zip file. The zip file and manifest are
+     * parsed once, and the data of each file is loaded once and then shared by all
+     * callers of its <code>loadData()</code>.
+     *
+     * @param {string} zipFilePath Path to zip file containing data for Dfu.
+     * @param {function} callback Signature: (err, updates) => {}.
+     * @returns {void}
+     */
+    fetchUpdates(zipFilePath, callback) {
+        if (!zipFilePath) {
+            throw new Error('No zipFilePath provided.');
+        }
 
         this._fetchUpdates(zipFilePath)
+            .then(updates => callback(undefined, updates))
+            .catch(err => callback(err));
+    }
+
+    _performDFU(getUpdates, callback) {
+        this._setState(DfuState.IN_PROGRESS);
+
+        getUpdates()
             .then(updates => this._performUpdates(updates))
             .then(() => {
                 this._log(logLevel.INFO, 'DFU completed successfully.');
@@ -186,7 +245,7 @@ class Dfu extends EventEmitter {
         return Promise.resolve()
             .then(() => {
                 this._log(logLevel.DEBUG, 'Creating DFU transport.');
-                this._transport = new BleTransport(this._transportParameters);
+                this._transport = this._transportFactory(this._transportParameters);
                 this._setupTransportListeners();
                 return this._transport.init();
             });
@@ -283,22 +342,6 @@ class Dfu extends EventEmitter {
         }
     }
 
-   /**
-    * Get promise for manifest.json from the given zip file.
-    * This function is a wrapper for getManifest().
-    *
-    * @param {string} zipFilePath Path of the zip file.
-    * @returns {Promise} For manifest.json
-    * @private
-    */
-    _getManifestAsync(zipFilePath) {
-        return new Promise((resolve, reject) => {
-            this.getManifest(zipFilePath, (err, manifest) => {
-                err ? reject(err) : resolve(manifest);
-            });
-        });
-    }
-
     /**
      * Get promise for JSZip zip object of the given zip file.
      * This function is a wrapper for _loadZip().
@@ -321,11 +364,11 @@ class Dfu extends EventEmitter {
      * [{
      *   datFile: {
      *     name: filename.dat,
-     *     loadData: <function returning promise with data>
+     *     loadData: <function returning promise with data as a Buffer>
      *   },
      *   binFile: {
      *     name: filename.bin,
-     *     loadData: <function returning promise with data>
+     *     loadData: <function returning promise with data as a Buffer>
      *   }
      * }, ... ]
      *
@@ -338,12 +381,11 @@ class Dfu extends EventEmitter {
      */
     _fetchUpdates(zipFilePath) {
         this._log(logLevel.DEBUG, `Loading zip file: ${zipFilePath}`);
-        return Promise.all([
-            this._loadZipAsync(zipFilePath),
-            this._getManifestAsync(zipFilePath),
-        ]).then(result => {
-            const zip = result[0];
-            const manifest = result[1];
+        return this._loadZipAsync(zipFilePath).then(zip => {
+            return this._readManifest(zip).then(manifest => ({ zip, manifest }));
+        }).then(result => {
+            const zip = result.zip;
+            const manifest = result.manifest;
             return this._getFirmwareTypes(manifest).map(type => {
                 const firmwareUpdate = manifest[type];
                 const datFileName = firmwareUpdate.dat_file;
@@ -352,11 +394,11 @@ class Dfu extends EventEmitter {
                 return {
                     datFile: {
                         name: datFileName,
-                        loadData: () => zip.file(datFileName).async('array'),
+                        loadData: _.once(() => zip.file(datFileName).async('nodebuffer')),
                     },
                     binFile: {
                         name: binFileName,
-                        loadData: () => zip.file(binFileName).async('array'),
+                        loadData: _.once(() => zip.file(binFileName).async('nodebuffer')),
                     },
                 };
             });
@@ -434,23 +476,28 @@ class Dfu extends EventEmitter {
             if (err) {
                 return callback(err);
             }
-            // Read out manifest from zip
-            zip.file('manifest.json')
-                .async('string')
-                .then(data => {
-                    let manifest;
-                    try {
-                        // Parse manifest as JSON
-                        manifest = JSON.parse(data).manifest;
-                    } catch (error) {
-                        return callback(error);
-                    }
-                    // Return manifest
-                    return callback(undefined, manifest);
-                });
+            return this._readManifest(zip)
+                .then(manifest => callback(undefined, manifest))
+                .catch(error => callback(error));
         });
     }
 
+    /**
+     * Read out and parse manifest.json from an already loaded JSZip zip object.
+     *
+     * @param {Object} zip JSZip zip object.
+     * @returns {Promise} For the manifest object.
+     * @private
+     */
+    _readManifest(zip) {
+        const manifestFile = zip.file('manifest.json');
+        if (!manifestFile) {
+            return Promise.reject(new Error('No manifest.json found in zip file.'));
+        }
+        // Parse manifest as JSON
+        return manifestFile.async('string').then(data => JSON.parse(data).manifest);
+    }
+
     _log(level, message) {
         this.emit('logMessage', level, message);
     }
@@ -40,7 +40,12 @@ const crc = require('crc');
 const createError = require('./dfuConstants').createError;
 const ErrorCode = require('./dfuConstants').ErrorCode;
 const splitArray = require('../util/arrayUtil').splitArray;
+const subarray = require('../util/arrayUtil').subarray;
 
+// CRC32 values of data prefixes, keyed by the data they were calculated from. Firmware data
+// is shared between all DFU jobs for the same zip file, so a prefix CRC only has to be
+// calculated once no matter how many targets resume from the same offset.
+const prefixCrc32Cache = new WeakMap();
 
 class InitPacketState {
 
@@ -48,7 +53,7 @@ class InitPacketState {
      * Create InitPacketState based on the total init packet data and the current
      * state on the device.
      *
-     * @param data complete initPacket data (byte array)
+     * @param data complete initPacket data (Buffer or byte array)
      * @param deviceState current state ({offset, crc32, maximumSize}) on device
      */
     constructor(data, deviceState) {
@@ -74,7 +79,7 @@ class InitPacketState {
 
     get remainingData() {
         if (this._hasResumablePartialObject) {
-            return this._data.slice(this._deviceState.offset);
+            return subarray(this._data, this._deviceState.offset);
         }
         return this._data;
     }
@@ -102,7 +107,7 @@ class FirmwareState {
      * Create FirmwareState based on the total firmware data and the current deviceState
      * on the device.
      *
-     * @param data complete firmware data (byte array)
+     * @param data complete firmware data (Buffer or byte array)
      * @param deviceState current state ({offset, crc32, maximumSize}) on device
      */
     constructor(data, deviceState) {
@@ -135,7 +140,7 @@ class FirmwareState {
     }
 
     get remainingObjects() {
-        const remainingData = this._data.slice(this.offset + this.remainingPartialObject.length);
+        const remainingData = subarray(this._data, this.offset + this.remainingPartialObject.length);
         return splitArray(remainingData, this._deviceState.maximumSize);
     }
 
@@ -160,11 +165,23 @@ function _getRemainingPartialObject(data, maximumSize, offset) {
     if (offset === 0 || remainder === 0 || offset === data.length) {
         return [];
     }
-    return data.slice(offset, offset + maximumSize - remainder);
+    return subarray(data, offset, offset + maximumSize - remainder);
+}
+
+function _getPrefixCrc32(data, offset) {
+    let crcByOffset = prefixCrc32Cache.get(data);
+    if (!crcByOffset) {
+        crcByOffset = new Map();
+        prefixCrc32Cache.set(data, crcByOffset);
+    }
+    if (!crcByOffset.has(offset)) {
+        crcByOffset.set(offset, crc.crc32(subarray(data, 0, offset)));
+    }
+    return crcByOffset.get(offset);
 }
 
 function _canResumeWriting(data, offset, crc32) {
-    if (offset === 0 || offset > data.length || crc32 !== crc.crc32(data.slice(0, offset))) {
+    if (offset === 0 || offset > data.length || crc32 !== _getPrefixCrc32(data, offset)) {
         return false;
     }
     return true;
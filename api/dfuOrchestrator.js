@@ -0,0 +1,387 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const _ = require('underscore');
+const EventEmitter = require('events');
+
+const Dfu = require('./dfu');
+const DfuSpeedometer = require('./dfu/dfuSpeedometer');
+const logLevel = require('./util/logLevel');
+
+/** @constant Enumeration of the Dfu orchestrator's possible states. */
+const DfuOrchestratorState = Object.freeze({
+    READY: 0,
+    IN_PROGRESS: 1,
+    ABORTING: 2,
+});
+
+const DEFAULT_PROGRESS_INTERVAL = 1000;
+
+/**
+ * Class that performs DFU on many targets concurrently, spread out over several adapters.
+ *
+ * The zip file and manifest are parsed once, and the firmware data is shared by all jobs.
+ * Each adapter runs at most as many jobs at the same time as it has central connections.
+ * Connection establishment is serialized per adapter, since an adapter can only have one
+ * connect procedure in progress at a time.
+ *
+ * @fires DfuOrchestrator#stateChanged
+ * @fires DfuOrchestrator#jobStart
+ * @fires DfuOrchestrator#jobComplete
+ * @fires DfuOrchestrator#progressUpdate
+ * @fires DfuOrchestrator#logMessage
+ */
+class DfuOrchestrator extends EventEmitter {
+    /**
+     * Initializes the Dfu orchestrator.
+     *
+     * @constructor
+     * @param {Array} adapters Opened adapters to perform DFU with.
+     * @param {Object} [options] Configuration options.
+     * Available options:
+     *  <ul>
+     *  <li>{number} [maxJobsPerAdapter]: Upper limit for concurrent jobs per adapter. The adapter's
+     *                                    central connection count is used if not given or larger.
+     *  <li>{number} [prnValue]: Packet receipt notification number.
+     *  <li>{number} [mtuSize]: Maximum transmission unit number.
+     *  <li>{number} [progressInterval=1000]: Minimum time in ms between aggregate progress updates.
+     *  <li>{function} [transportFactory]: Creates the transport for each job. Signature:
+     *                                     (transportParameters) => transport.
+     *  </ul>
+     */
+    constructor(adapters, options) {
+        super();
+
+        if (!adapters || adapters.length === 0) {
+            throw new Error('No adapters provided.');
+        }
+
+        const opts = options || {};
+        this._adapters = adapters;
+        this._maxJobsPerAdapter = opts.maxJobsPerAdapter;
+        this._prnValue = opts.prnValue;
+        this._mtuSize = opts.mtuSize;
+        this._progressInterval = opts.progressInterval || DEFAULT_PROGRESS_INTERVAL;
+        this._transportFactory = opts.transportFactory;
+        this._jobs = [];
+        this._speedometer = null;
+        this._setState(DfuOrchestratorState.READY);
+    }
+
+    /**
+     * Perform DFU with the given zip file on all the given targets.
+     *
+     * The callback is invoked with one result per target, in the same order as the targets,
+     * on the format { target, adapterInstanceId, error, aborted }. The err argument is only
+     * set if the zip file could not be loaded.
+     *
+     * @param {string} zipFilePath Path to zip file containing data for Dfu.
+     * @param {Array} targets Targets on the format { address, addressType }.
+     * @param {function} callback Signature: (err, results) => {}.
+     * @returns {void}
+     */
+    performDFU(zipFilePath, targets, callback) {
+        if (this._state !== DfuOrchestratorState.READY) {
+            throw new Error('Not in READY state. DFU in progress or aborting.');
+        }
+        if (!zipFilePath) {
+            throw new Error('No zipFilePath provided.');
+        }
+        if (!targets) {
+            throw new Error('No targets provided.');
+        }
+        if (!callback) {
+            throw new Error('No callback function provided.');
+        }
+
+        this._log(logLevel.INFO, `Performing DFU on ${targets.length} targets with file: ${zipFilePath}`);
+        this._setState(DfuOrchestratorState.IN_PROGRESS);
+        this._jobs = [];
+
+        this._loadUpdates(zipFilePath)
+            .then(loaded => {
+                this._speedometer = new DfuSpeedometer(loaded.firmwareSize * targets.length, 0);
+                return this._runJobs(loaded.updates, loaded.binFileSizes, targets);
+            })
+            .then(results => {
+                const failed = results.filter(result => result.error).length;
+                this._log(logLevel.INFO, `DFU completed on ${results.length - failed} of ${results.length} targets.`);
+                this._setState(DfuOrchestratorState.READY);
+                callback(undefined, results);
+            })
+            .catch(err => {
+                this._log(logLevel.ERROR, `DFU failed with error: ${err.message}.`);
+                this._setState(DfuOrchestratorState.READY);
+                callback(err);
+            });
+    }
+
+    /**
+     * Abort all running jobs. Targets that have not been started are reported as aborted.
+     * Does nothing unless a DFU is in progress.
+     *
+     * @returns {void}
+     */
+    abort() {
+        if (this._state !== DfuOrchestratorState.IN_PROGRESS) {
+            return;
+        }
+
+        this._log(logLevel.INFO, 'Aborting DFU on all targets.');
+        this._setState(DfuOrchestratorState.ABORTING);
+        this._jobs.forEach(job => {
+            if (job.running) {
+                job.dfu.abort();
+            }
+        });
+    }
+
+    _setState(state) {
+        if (this._state !== state) {
+            this._state = state;
+            this.emit('stateChanged', state);
+        }
+    }
+
+    _loadUpdates(zipFilePath) {
+        const loader = new Dfu('BLE', {});
+        loader.on('logMessage', (level, message) => this._log(level, message));
+
+        return new Promise((resolve, reject) => {
+            loader.fetchUpdates(zipFilePath, (err, updates) => {
+                err ? reject(err) : resolve(updates);
+            });
+        }).then(updates => {
+            // Load all data up front, so that it is shared by the jobs and the
+            // total number of bytes to transfer is known.
+            const loadAll = updates.map(update => Promise.all([
+                update.datFile.loadData(),
+                update.binFile.loadData(),
+            ]));
+            return Promise.all(loadAll).then(dataList => {
+                const binFileSizes = {};
+                let firmwareSize = 0;
+                updates.forEach((update, index) => {
+                    binFileSizes[update.binFile.name] = dataList[index][1].length;
+                    firmwareSize += dataList[index][1].length;
+                });
+                return { updates, binFileSizes, firmwareSize };
+            });
+        });
+    }
+
+    _getJobLimit(adapter) {
+        const connectionCount = adapter.centralConnectionCount || 1;
+        if (this._maxJobsPerAdapter > 0) {
+            return Math.min(connectionCount, this._maxJobsPerAdapter);
+        }
+        return connectionCount;
+    }
+
+    _runJobs(updates, binFileSizes, targets) {
+        const slots = this._adapters.map(adapter => ({
+            adapter,
+            freeJobs: this._getJobLimit(adapter),
+            initQueue: Promise.resolve(),
+        }));
+        const pendingTargets = targets.map((target, index) => ({ target, index }));
+        const results = new Array(targets.length);
+        let runningJobs = 0;
+
+        this._emitProgress = _.throttle(() => this._handleProgressUpdate(), this._progressInterval);
+
+        return new Promise(resolve => {
+            const scheduleJobs = () => {
+                if (this._state === DfuOrchestratorState.ABORTING) {
+                    pendingTargets.splice(0).forEach(pending => {
+                        results[pending.index] = { target: pending.target, aborted: true };
+                    });
+                }
+
+                while (pendingTargets.length > 0) {
+                    // Spread the jobs evenly, by using the adapter with most free capacity.
+                    const slot = _.max(slots, s => s.freeJobs);
+                    if (slot.freeJobs <= 0) {
+                        break;
+                    }
+
+                    const pending = pendingTargets.shift();
+                    slot.freeJobs -= 1;
+                    runningJobs += 1;
+
+                    this._runJob(slot, pending.target, updates, binFileSizes).then(result => {
+                        results[pending.index] = result;
+                        slot.freeJobs += 1;
+                        runningJobs -= 1;
+                        scheduleJobs();
+                    });
+                }
+
+                if (runningJobs === 0 && pendingTargets.length === 0) {
+                    this._emitProgress.cancel();
+                    this._handleProgressUpdate();
+                    resolve(results);
+                }
+            };
+
+            scheduleJobs();
+        });
+    }
+
+    _runJob(slot, target, updates, binFileSizes) {
+        const transportParameters = {
+            adapter: slot.adapter,
+            targetAddress: target.address,
+            targetAddressType: target.addressType,
+            prnValue: this._prnValue,
+            mtuSize: this._mtuSize,
+        };
+        const dfu = new Dfu('BLE', transportParameters, params => this._createTransport(slot, params));
+        const job = {
+            dfu,
+            target,
+            running: true,
+            transferredBytes: 0,
+            currentFileBytes: 0,
+        };
+        this._jobs.push(job);
+
+        dfu.on('logMessage', (level, message) => this._log(level, `${target.address}: ${message}`));
+        dfu.on('progressUpdate', progressUpdate => {
+            if (progressUpdate.completedBytes !== undefined) {
+                job.currentFileBytes = progressUpdate.completedBytes;
+                this._emitProgress();
+            }
+        });
+        dfu.on('transferComplete', fileName => {
+            if (binFileSizes[fileName] !== undefined) {
+                job.transferredBytes += binFileSizes[fileName];
+                job.currentFileBytes = 0;
+                this._emitProgress();
+            }
+        });
+
+        /**
+         * DFU job start event.
+         *
+         * @event DfuOrchestrator#jobStart
+         * @type {Object}
+         * @property {Object} target - The target the job performs DFU on.
+         * @property {string} adapterInstanceId - The instance id of the adapter used by the job.
+         */
+        this.emit('jobStart', target, slot.adapter.instanceId);
+
+        return new Promise(resolve => {
+            dfu.performUpdates(updates, (err, aborted) => {
+                job.running = false;
+                dfu.removeAllListeners();
+
+                // The bytes of a file that was not completed are not transferred
+                if (err) {
+                    job.currentFileBytes = 0;
+                }
+
+                const result = {
+                    target,
+                    adapterInstanceId: slot.adapter.instanceId,
+                    error: err || undefined,
+                    aborted: !!aborted,
+                };
+
+                /**
+                 * DFU job complete event.
+                 *
+                 * @event DfuOrchestrator#jobComplete
+                 * @type {Object}
+                 * @property {Object} result - The result of the job, on the format
+                 *                             { target, adapterInstanceId, error, aborted }.
+                 */
+                this.emit('jobComplete', result);
+                resolve(result);
+            });
+        });
+    }
+
+    _createTransport(slot, transportParameters) {
+        const transport = this._transportFactory ?
+            this._transportFactory(transportParameters) : Dfu.createTransport(transportParameters);
+
+        // Only one connect procedure can be in progress per adapter, so
+        // the transports of an adapter are initialized one at a time.
+        const init = transport.init.bind(transport);
+        transport.init = () => {
+            const initDone = slot.initQueue.then(() => init());
+            slot.initQueue = initDone.catch(() => {});
+            return initDone;
+        };
+        return transport;
+    }
+
+    _handleProgressUpdate() {
+        if (!this._speedometer) {
+            return;
+        }
+
+        const completedBytes = this._jobs.reduce((sum, job) =>
+            sum + job.transferredBytes + job.currentFileBytes, 0);
+        this._speedometer.updateState(completedBytes);
+
+        /**
+         * Aggregate DFU progress update event.
+         *
+         * @event DfuOrchestrator#progressUpdate
+         * @type {Object}
+         * @property {Object} _ - Progress meta-data for all jobs.
+         */
+        this.emit('progressUpdate', {
+            completedBytes,
+            totalBytes: this._speedometer.totalBytes,
+            bytesPerSecond: this._speedometer.calculateBytesPerSecond(),
+            averageBytesPerSecond: this._speedometer.calculateAverageBytesPerSecond(),
+            percentCompleted: this._speedometer.calculatePercentCompleted(),
+            runningJobs: this._jobs.filter(job => job.running).length,
+            completedJobs: this._jobs.filter(job => !job.running).length,
+        });
+    }
+
+    _log(level, message) {
+        this.emit('logMessage', level, message);
+    }
+}
+
+module.exports = DfuOrchestrator;
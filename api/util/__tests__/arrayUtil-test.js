@@ -37,6 +37,7 @@
 'use strict';
 
 const splitArray = require('../arrayUtil').splitArray;
+const subarray = require('../arrayUtil').subarray;
 
 describe('splitArray', () => {
 
@@ -93,4 +94,32 @@ describe('splitArray', () => {
             expect(splitArray(data, chunkSize)).toEqual([[1, 2, 3], [4, 5, 6], [7]]);
         });
     });
+
+    describe('when data is a Buffer with 5 items and chunk size is 2', () => {
+        const data = Buffer.from([1, 2, 3, 4, 5]);
+        const chunkSize = 2;
+
+        it('should return 3 Buffer chunks sharing memory with the data', () => {
+            const chunks = splitArray(data, chunkSize);
+            expect(chunks.map(chunk => Array.from(chunk))).toEqual([[1, 2], [3, 4], [5]]);
+            expect(chunks.every(chunk => chunk.buffer === data.buffer)).toBe(true);
+        });
+    });
+});
+
+describe('subarray', () => {
+
+    it('should return a copy when data is an array', () => {
+        const data = [1, 2, 3];
+        const result = subarray(data, 1);
+        result[0] = 0;
+        expect(data).toEqual([1, 2, 3]);
+    });
+
+    it('should return a view when data is a Buffer', () => {
+        const data = Buffer.from([1, 2, 3]);
+        const result = subarray(data, 1, 2);
+        result[0] = 0;
+        expect(Array.from(data)).toEqual([1, 0, 3]);
+    });
 });
@@ -0,0 +1,184 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const SoftDeviceConverter = require('../sdConv');
+
+// Constants of the AddOn used by the converter
+const bleDriver = {
+    BLE_GATTS_VLOC_STACK: 1,
+    BLE_UUID_TYPE_BLE: 1,
+};
+
+const VENDOR_CHARACTERISTIC_UUID = '6E400002B5A3F393E0A9E50E24DCCA9E';
+const VENDOR_DESCRIPTOR_UUID = '6E400003B5A3F393E0A9E50E24DCCA9E';
+
+function createConverter() {
+    return new SoftDeviceConverter(bleDriver, { addVendorspecificUUID: jest.fn() });
+}
+
+function createCharacteristic(descriptors) {
+    return {
+        uuid: VENDOR_CHARACTERISTIC_UUID,
+        value: [1, 2, 3],
+        maxLength: 20,
+        readPerm: ['open'],
+        writePerm: ['encrypt', 'mitm-protection'],
+        properties: {
+            read: true,
+            write: true,
+            notify: true,
+            reliableWr: true,
+        },
+        _factory_descriptors: descriptors,
+    };
+}
+
+describe('characteristicToTable', () => {
+    it('keeps a vendor specific UUID as a string without registering it', () => {
+        const converter = createConverter();
+        const table = converter.characteristicToTable(createCharacteristic());
+
+        expect(table.uuid).toEqual(VENDOR_CHARACTERISTIC_UUID);
+        expect(converter._adapter.addVendorspecificUUID).not.toHaveBeenCalled();
+        expect(converter.vsUuidStore).toEqual([]);
+    });
+
+    it('converts the properties and the value attribute', () => {
+        const table = createConverter().characteristicToTable(createCharacteristic());
+
+        expect(table.metadata.char_props).toEqual({
+            broadcast: false,
+            read: true,
+            write_wo_resp: false,
+            write: true,
+            notify: true,
+            indicate: false,
+            auth_signed_wr: false,
+        });
+        expect(table.metadata.char_ext_props).toEqual({ reliable_wr: true, wr_aux: false });
+
+        expect(table.attribute.value).toEqual([1, 2, 3]);
+        expect(table.attribute.init_len).toEqual(3);
+        expect(table.attribute.init_offs).toEqual(0);
+        expect(table.attribute.max_len).toEqual(20);
+        expect(table.attribute.attr_md.read_perm).toEqual({ sm: 1, lv: 1 });
+        expect(table.attribute.attr_md.write_perm).toEqual({ sm: 1, lv: 3 });
+        expect(table.attribute.attr_md.vloc).toEqual(bleDriver.BLE_GATTS_VLOC_STACK);
+    });
+
+    it('takes the metadata of the user description, CCCD and SCCD from their descriptors', () => {
+        const cccd = { uuid: '2902', value: [0, 0], maxLength: 2, readPerm: ['open'], writePerm: ['encrypt'] };
+        const vendorDescriptor = { uuid: VENDOR_DESCRIPTOR_UUID, value: [1], maxLength: 1, readPerm: ['open'], writePerm: ['open'] };
+        const table = createConverter().characteristicToTable(createCharacteristic([vendorDescriptor, cccd]));
+
+        expect(table.metadata.cccd_md.read_perm).toEqual({ sm: 1, lv: 1 });
+        expect(table.metadata.cccd_md.write_perm).toEqual({ sm: 1, lv: 2 });
+        expect(table.metadata.user_desc_md).toBeNull();
+        expect(table.metadata.sccd_md).toBeNull();
+    });
+
+    it('throws when mandatory attributes are missing', () => {
+        const characteristic = createCharacteristic();
+        delete characteristic.maxLength;
+        delete characteristic.properties;
+
+        expect(() => createConverter().characteristicToTable(characteristic))
+            .toThrow('properties must be provided. maxLength must be provided.');
+    });
+});
+
+describe('descriptorToTable', () => {
+    it('keeps a vendor specific UUID as a string and converts the attribute', () => {
+        const converter = createConverter();
+        const table = converter.descriptorToTable({
+            uuid: VENDOR_DESCRIPTOR_UUID,
+            value: [1, 2],
+            maxLength: 4,
+            readPerm: ['open'],
+            writePerm: ['signed'],
+        });
+
+        expect(table.uuid).toEqual(VENDOR_DESCRIPTOR_UUID);
+        expect(table.value).toEqual([1, 2]);
+        expect(table.init_len).toEqual(2);
+        expect(table.init_offs).toEqual(0);
+        expect(table.max_len).toEqual(4);
+        expect(table.attr_md.read_perm).toEqual({ sm: 1, lv: 1 });
+        expect(table.attr_md.write_perm).toEqual({ sm: 2, lv: 1 });
+        expect(converter._adapter.addVendorspecificUUID).not.toHaveBeenCalled();
+    });
+
+    it('throws when mandatory attributes are missing', () => {
+        expect(() => createConverter().descriptorToTable({ uuid: VENDOR_DESCRIPTOR_UUID }))
+            .toThrow('value must be provided. maxLength must be provided.');
+    });
+});
+
+describe('uuidToDriver', () => {
+    it('uses a vendor specific base already registered natively without adding it', done => {
+        const adapter = {
+            addVendorspecificUUID: jest.fn(),
+            decodeUUIDSync: jest.fn(() => ({ uuid: 0x0002, type: 3 })),
+        };
+        const converter = new SoftDeviceConverter(bleDriver, adapter);
+
+        converter.uuidToDriver(VENDOR_CHARACTERISTIC_UUID, (err, uuid) => {
+            expect(err).toBeUndefined();
+            expect(uuid).toEqual({ type: 3, uuid: 0x0002 });
+            expect(adapter.decodeUUIDSync).toHaveBeenCalledTimes(1);
+            expect(adapter.addVendorspecificUUID).not.toHaveBeenCalled();
+            expect(converter.lookupVsUuid({ type: 3, uuid: 0x0003 })).toEqual(VENDOR_DESCRIPTOR_UUID);
+            done();
+        });
+    });
+
+    it('adds a vendor specific base that is not registered', done => {
+        const adapter = {
+            addVendorspecificUUID: jest.fn((uuid, callback) => setImmediate(() => callback(undefined, 2))),
+            decodeUUIDSync: jest.fn(() => undefined),
+        };
+        const converter = new SoftDeviceConverter(bleDriver, adapter);
+
+        converter.uuidToDriver(VENDOR_CHARACTERISTIC_UUID, (err, uuid) => {
+            expect(err).toBeUndefined();
+            expect(uuid).toEqual({ type: 2, uuid: 0x0002 });
+            expect(adapter.addVendorspecificUUID).toHaveBeenCalledTimes(1);
+            done();
+        });
+    });
+});
@@ -36,6 +36,22 @@
 
 'use strict';
 
+/**
+ * Get the part of data between start and end. Buffers and other typed arrays
+ * are returned as views sharing memory with data, while plain arrays are copied.
+ *
+ * @param data array, Buffer or typed array
+ * @param start index to start at
+ * @param end index to end at, not included (optional)
+ * @returns the part of data between start and end
+ */
+function subarray(data, start, end) {
+    if (ArrayBuffer.isView(data)) {
+        return data.subarray(start, end);
+    }
+    return data.slice(start, end);
+}
+
 function splitArray(data, chunkSize) {
     if (chunkSize < 1) {
         throw new Error(`Invalid chunk size: ${chunkSize}`);
@@ -43,9 +59,9 @@ function splitArray(data, chunkSize) {
     const chunks = [];
     for (let i = 0; i < data.length; i += chunkSize) {
         if (i + chunkSize >= data.length) {
-            chunks.push(data.slice(i));
+            chunks.push(subarray(data, i));
         } else {
-            chunks.push(data.slice(i, i + chunkSize));
+            chunks.push(subarray(data, i, i + chunkSize));
         }
     }
     return chunks;
@@ -53,4 +69,5 @@ function splitArray(data, chunkSize) {
 
 module.exports = {
     splitArray,
+    subarray,
 };
@@ -139,6 +139,16 @@ class SoftDeviceConverter {
                 return;
             }
 
+            // The base may already be registered natively, e.g. by gattsBuildTable or another converter
+            const decoded = this._adapter.decodeUUIDSync ? this._adapter.decodeUUIDSync(16, uuid) : undefined;
+            if (decoded) {
+                this.vsUuidStore[decoded.type - 2] = uuidBase;
+                retval.type = decoded.type;
+                retval.uuid = decoded.uuid;
+                callback(undefined, retval);
+                return;
+            }
+
             this._adapter.addVendorspecificUUID({ uuid128: uuid }, (err, type) => {
                 if (err) {
                     callback(err);
@@ -193,7 +203,9 @@ class SoftDeviceConverter {
         return false;
     }
 
-    descriptorToDriver(descriptor, callback) {
+    // Converts everything but the UUID, which gattsBuildTable resolves natively.
+    // Throws an Error if mandatory attributes are missing.
+    descriptorToTable(descriptor) {
         var err = '';
 
         // Check if mandatory attributes are present in the characteristic object
@@ -202,13 +214,30 @@ class SoftDeviceConverter {
         if (!descriptor.maxLength) err += 'maxLength must be provided. ';
 
         if (err.length !== 0) {
-            callback(err);
-            return;
+            throw new Error(err);
         }
 
-        // Now let's start converting
         var retval = {};
-        retval.attr_md = {};
+
+        retval.uuid = descriptor.uuid;
+        retval.attr_md = this.attributeMetadataToDriver(descriptor);
+        retval.init_len = descriptor.value.length;
+        retval.init_offs = 0;
+        retval.max_len = descriptor.maxLength || retval.init_len;
+        retval.value = descriptor.value;
+
+        return retval;
+    }
+
+    descriptorToDriver(descriptor, callback) {
+        var retval;
+
+        try {
+            retval = this.descriptorToTable(descriptor);
+        } catch (error) {
+            callback(error.message);
+            return;
+        }
 
         this.uuidToDriver(descriptor.uuid, (err, uuid) => {
             if (err) {
@@ -219,13 +248,6 @@ class SoftDeviceConverter {
 
             retval.uuid = uuid;
 
-            retval.attr_md = this.attributeMetadataToDriver(descriptor);
-
-            retval.init_len = descriptor.value.length;
-            retval.init_offs = 0;
-            retval.max_len = descriptor.maxLength || retval.init_len;
-            retval.value = descriptor.value;
-
             callback(undefined, retval);
         });
     }
@@ -252,7 +274,9 @@ class SoftDeviceConverter {
         return null;
     }
 
-    characteristicToDriver(characteristic, callback) {
+    // Converts everything but the UUID, which gattsBuildTable resolves natively.
+    // Throws an Error if mandatory attributes are missing.
+    characteristicToTable(characteristic) {
         /* INPUT
                         {
                 uuid: 'be-ef', // Automatically determine type by uuid length (BT SIG: 16-bit, UUID: 128-bit)
@@ -284,12 +308,12 @@ class SoftDeviceConverter {
         if (!characteristic.maxLength) err += 'maxLength must be provided. ';
 
         if (err.length !== 0) {
-            callback(err);
-            return;
+            throw new Error(err);
         }
 
         // Now let's start converting
         var retval = {};
+        retval.uuid = characteristic.uuid;
         retval.metadata = {};
         retval.metadata.char_props = {};
         retval.metadata.char_ext_props = {};
@@ -316,6 +340,27 @@ class SoftDeviceConverter {
         retval.metadata.cccd_md = this.getAttributeMetadataForSpecialDescriptor(characteristic, '2902');
         retval.metadata.sccd_md = this.getAttributeMetadataForSpecialDescriptor(characteristic, '2903');
 
+        retval.attribute.value = characteristic.value;
+        retval.attribute.attr_md = this.attributeMetadataToDriver(characteristic);
+        retval.attribute.init_len = characteristic.value.length;
+        retval.attribute.init_offs = 0;
+        retval.attribute.max_len = characteristic.maxLength || retval.attribute.init_len;
+
+        return retval;
+    }
+
+    characteristicToDriver(characteristic, callback) {
+        var retval;
+
+        try {
+            retval = this.characteristicToTable(characteristic);
+        } catch (error) {
+            callback(error.message);
+            return;
+        }
+
+        delete retval.uuid;
+
         this.uuidToDriver(characteristic.uuid, (err, uuid) => {
             if (err) {
                 callback(err);
@@ -324,12 +369,6 @@ class SoftDeviceConverter {
 
             retval.attribute.uuid = uuid;
 
-            retval.attribute.value = characteristic.value;
-            retval.attribute.attr_md = this.attributeMetadataToDriver(characteristic);
-            retval.attribute.init_len = characteristic.value.length;
-            retval.attribute.init_offs = 0;
-            retval.attribute.max_len = characteristic.maxLength || retval.attribute.init_len;
-
             callback(undefined, retval);
         });
     }
@@ -41,6 +41,7 @@ const Characteristic = require('./api/characteristic');
 const Descriptor = require('./api/descriptor');
 const Device = require('./api/device');
 const Dfu = require('./api/dfu');
+const DfuOrchestrator = require('./api/dfuOrchestrator');
 const FirmwareRegistry = require('./api/firmwareRegistry');
 const FirmwareUpdater = require('./api/firmwareUpdater');
 const Security = require('./api/security');
@@ -55,6 +56,7 @@ module.exports = {
     Descriptor,
     Device,
     Dfu,
+    DfuOrchestrator,
     FirmwareRegistry,
     FirmwareUpdater,
     Security,
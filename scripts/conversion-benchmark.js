@@ -0,0 +1,131 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const fs = require('fs');
+
+/*
+ * This script measures the native cost of converting SoftDevice events to JavaScript
+ * objects, and JavaScript parameters to native structs. The events are synthetic,
+ * so no hardware is needed.
+ *
+ * Results can be saved as JSON and compared with a run from another commit.
+ *
+ * The benchmark binding is only exported by AddOns built with the BUILD_CONVERSION_BENCHMARK CMake option:
+ *
+ *   npm run build -- --CDBUILD_CONVERSION_BENCHMARK=ON
+ *
+ * Usage: node scripts/conversion-benchmark.js [iterations] [--api v2|v5] [--save file] [--compare file]
+ */
+
+const PAYLOAD_SIZES = [0, 20, 100, 244];
+
+function parseArguments(argv) {
+    const args = {
+        iterations: 100000,
+        api: 'v5',
+        save: undefined,
+        compare: undefined,
+    };
+
+    for (let i = 0; i < argv.length; i += 1) {
+        if (argv[i] === '--api') {
+            i += 1;
+            args.api = argv[i];
+        } else if (argv[i] === '--save') {
+            i += 1;
+            args.save = argv[i];
+        } else if (argv[i] === '--compare') {
+            i += 1;
+            args.compare = argv[i];
+        } else {
+            args.iterations = parseInt(argv[i], 10) || args.iterations;
+        }
+    }
+
+    return args;
+}
+
+function resultKey(result) {
+    return `${result.name}/${result.payloadSize}`;
+}
+
+const args = parseArguments(process.argv.slice(2));
+const driver = require('bindings')(`pc-ble-driver-js-sd_api_${args.api}`);
+
+if (typeof driver.benchmarkConversions !== 'function') {
+    console.error('The AddOn is built without the benchmark, rebuild it with: npm run build -- --CDBUILD_CONVERSION_BENCHMARK=ON');
+    process.exit(1);
+}
+
+const results = driver.benchmarkConversions({
+    iterations: args.iterations,
+    payloadSizes: PAYLOAD_SIZES,
+});
+
+const baseline = {};
+if (args.compare) {
+    JSON.parse(fs.readFileSync(args.compare, 'utf8')).results.forEach(result => {
+        baseline[resultKey(result)] = result;
+    });
+}
+
+console.log(`SoftDevice API ${args.api}, ${args.iterations} iterations`);
+console.log(`${'conversion'.padEnd(26)} ${'bytes'.padStart(5)} ${'ns/op'.padStart(9)}${args.compare ? ' baseline   change' : ''}`);
+
+results.forEach(result => {
+    let line = `${result.name.padEnd(26)} ${String(result.payloadSize).padStart(5)} ${result.nsPerOp.toFixed(1).padStart(9)}`;
+    const previous = baseline[resultKey(result)];
+
+    if (previous) {
+        const change = ((result.nsPerOp - previous.nsPerOp) / previous.nsPerOp) * 100;
+        line += ` ${previous.nsPerOp.toFixed(1).padStart(8)} ${((change >= 0 ? '+' : '') + change.toFixed(1)).padStart(7)}%`;
+    }
+
+    console.log(line);
+});
+
+if (args.save) {
+    const output = {
+        api: args.api,
+        iterations: args.iterations,
+        node: process.version,
+        results,
+    };
+    fs.writeFileSync(args.save, JSON.stringify(output, null, 2));
+    console.log(`Results saved to ${args.save}`);
+}
@@ -0,0 +1,108 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const fs = require('fs');
+
+const DfuOrchestrator = require('../api/dfuOrchestrator');
+const FakeAdapter = require('./dfu-fake-transport').FakeAdapter;
+const FakeTransport = require('./dfu-fake-transport').FakeTransport;
+const createZipFile = require('./dfu-fake-transport').createZipFile;
+
+/*
+ * This script measures how DFU throughput scales with the number of adapters and
+ * concurrent jobs per adapter. Targets are simulated by a fake transport, so no
+ * hardware is needed.
+ *
+ * Usage: node scripts/dfu-benchmark.js [targets] [adapters] [firmwareSize]
+ */
+
+const RATES = {
+    linkBytesPerSecond: 12000,
+    adapterBytesPerSecond: 60000,
+};
+
+const targetCount = parseInt(process.argv[2], 10) || 16;
+const adapterCount = parseInt(process.argv[3], 10) || 2;
+const firmwareSize = parseInt(process.argv[4], 10) || 64 * 1024;
+
+function runBenchmark(zipFilePath, maxJobsPerAdapter) {
+    const adapters = [];
+    for (let i = 0; i < adapterCount; i += 1) {
+        adapters.push(new FakeAdapter(`adapter${i}`, 7));
+    }
+    const targets = [];
+    for (let i = 0; i < targetCount; i += 1) {
+        targets.push({ address: `AA:BB:CC:DD:EE:${i.toString(16).padStart(2, '0')}`, addressType: 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC' });
+    }
+
+    const orchestrator = new DfuOrchestrator(adapters, {
+        maxJobsPerAdapter,
+        transportFactory: params => new FakeTransport(params, RATES),
+    });
+
+    const startTime = Date.now();
+    return new Promise((resolve, reject) => {
+        orchestrator.performDFU(zipFilePath, targets, (err, results) => {
+            if (err) {
+                reject(err);
+                return;
+            }
+            const elapsed = (Date.now() - startTime) / 1000;
+            const failed = results.filter(result => result.error || result.aborted).length;
+            resolve({ elapsed, failed });
+        });
+    });
+}
+
+createZipFile(firmwareSize)
+    .then(zipFilePath => {
+        console.log(`${targetCount} targets, ${adapterCount} adapters, ${firmwareSize} bytes firmware`);
+        console.log('jobs/adapter  seconds  bytes/s  failed');
+        return [1, 2, 4, 7].reduce((prev, jobs) => prev
+            .then(() => runBenchmark(zipFilePath, jobs))
+            .then(result => {
+                const bytesPerSecond = Math.round((targetCount * firmwareSize) / result.elapsed);
+                console.log(`${String(jobs).padStart(12)}  ${result.elapsed.toFixed(2).padStart(7)}  ` +
+                    `${String(bytesPerSecond).padStart(7)}  ${String(result.failed).padStart(6)}`);
+            }), Promise.resolve())
+            .then(() => fs.unlinkSync(zipFilePath));
+    })
+    .catch(err => {
+        console.error(err);
+        process.exit(1);
+    });
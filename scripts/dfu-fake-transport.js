@@ -0,0 +1,187 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const crc = require('crc');
+const EventEmitter = require('events');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const JSZip = require('jszip');
+
+const createError = require('../api/dfu/dfuConstants').createError;
+const ErrorCode = require('../api/dfu/dfuConstants').ErrorCode;
+const FirmwareState = require('../api/dfu/dfuModels').FirmwareState;
+const InitPacketState = require('../api/dfu/dfuModels').InitPacketState;
+const splitArray = require('../api/util/arrayUtil').splitArray;
+
+/*
+ * Fake DFU transport used by the DFU benchmarks. It splits data into objects and
+ * packets the same way as the BLE transport does, but instead of writing packets
+ * to a target it waits as long as the packets would take to send. Every link is
+ * limited to linkBytesPerSecond, and all links of one adapter share
+ * adapterBytesPerSecond, which models the serial port between the computer and the
+ * connectivity chip. Rates of 0 means no limit.
+ */
+
+const CONNECT_LATENCY_MS = 50;
+const MTU_SIZE = 20;
+const PRN_VALUE = 10;
+const OBJECT_SIZE = 4096;
+const INIT_PACKET_MAX_SIZE = 512;
+
+function delay(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+class FakeAdapter {
+    constructor(instanceId, centralConnectionCount) {
+        this.instanceId = instanceId;
+        this.centralConnectionCount = centralConnectionCount;
+        this.activeLinks = 0;
+    }
+}
+
+class FakeTransport extends EventEmitter {
+    constructor(transportParameters, rates) {
+        super();
+        this._adapter = transportParameters.adapter;
+        this._linkBytesPerSecond = rates.linkBytesPerSecond;
+        this._adapterBytesPerSecond = rates.adapterBytesPerSecond;
+        this._aborted = false;
+    }
+
+    init() {
+        this._adapter.activeLinks += 1;
+        return this._linkBytesPerSecond ? delay(CONNECT_LATENCY_MS) : Promise.resolve();
+    }
+
+    sendInitPacket(data) {
+        const state = new InitPacketState(data, { offset: 0, crc32: 0, maximumSize: INIT_PACKET_MAX_SIZE });
+        return this._writeObject(state.remainingData, 0);
+    }
+
+    getFirmwareState(data) {
+        return Promise.resolve(new FirmwareState(data, { offset: 0, crc32: 0, maximumSize: OBJECT_SIZE }));
+    }
+
+    sendFirmware(data) {
+        return this.getFirmwareState(data).then(state => {
+            return state.remainingObjects.reduce((prevPromise, object) => prevPromise
+                .then(progress => this._writeObject(object, progress.offset, progress.crc32))
+                .then(progress => {
+                    this.emit('progressUpdate', { stage: 'Transferring firmware', offset: progress.offset });
+                    return progress;
+                }), Promise.resolve({ offset: state.offset, crc32: state.crc32 }));
+        });
+    }
+
+    waitForDisconnection() {
+        return Promise.resolve();
+    }
+
+    abort() {
+        this._aborted = true;
+    }
+
+    destroy() {
+        this._adapter.activeLinks -= 1;
+    }
+
+    _writeObject(data, offset, crc32) {
+        const packets = splitArray(data, MTU_SIZE);
+        let promise = Promise.resolve({ offset, crc32 });
+        for (let i = 0; i < packets.length; i += PRN_VALUE) {
+            const prnPackets = packets.slice(i, i + PRN_VALUE);
+            promise = promise.then(progress => {
+                if (this._aborted) {
+                    throw createError(ErrorCode.ABORTED, 'Abort was triggered.');
+                }
+                let size = 0;
+                let packetCrc32 = progress.crc32;
+                prnPackets.forEach(packet => {
+                    packetCrc32 = crc.crc32(packet, packetCrc32);
+                    size += packet.length;
+                });
+                const updated = { offset: progress.offset + size, crc32: packetCrc32 };
+                return this._waitForLink(size).then(() => updated);
+            });
+        }
+        return promise;
+    }
+
+    _waitForLink(size) {
+        if (!this._linkBytesPerSecond) {
+            return new Promise(resolve => setImmediate(resolve));
+        }
+        const sharedRate = this._adapterBytesPerSecond / Math.max(this._adapter.activeLinks, 1);
+        const rate = Math.min(this._linkBytesPerSecond, sharedRate);
+        return delay((size / rate) * 1000);
+    }
+}
+
+/**
+ * Create a DFU zip file with an application image of the given size in the
+ * temporary directory.
+ *
+ * @param size size of the application image in bytes
+ * @returns Promise that resolves with the path of the zip file
+ */
+function createZipFile(size) {
+    const zip = new JSZip();
+    const firmware = Buffer.alloc(size);
+    for (let i = 0; i < size; i += 1) {
+        firmware[i] = (i * 31) & 0xFF;
+    }
+    zip.file('manifest.json', JSON.stringify({
+        manifest: { application: { bin_file: 'app.bin', dat_file: 'app.dat' } },
+    }));
+    zip.file('app.bin', firmware);
+    zip.file('app.dat', Buffer.alloc(128));
+
+    const zipFilePath = path.join(os.tmpdir(), `dfu-benchmark-${process.pid}.zip`);
+    return zip.generateAsync({ type: 'nodebuffer', compression: 'DEFLATE' }).then(data => {
+        fs.writeFileSync(zipFilePath, data);
+        return zipFilePath;
+    });
+}
+
+module.exports = {
+    FakeAdapter,
+    FakeTransport,
+    createZipFile,
+};
@@ -0,0 +1,127 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+'use strict';
+
+const execFileSync = require('child_process').execFileSync;
+const fs = require('fs');
+
+const Dfu = require('../api/dfu');
+const FakeAdapter = require('./dfu-fake-transport').FakeAdapter;
+const FakeTransport = require('./dfu-fake-transport').FakeTransport;
+const createZipFile = require('./dfu-fake-transport').createZipFile;
+
+/*
+ * This script measures peak RSS when performing DFU of an application image
+ * through a fake transport. Each run is done in a separate process, once with
+ * the firmware kept as Buffers, and once with the firmware converted to arrays
+ * of numbers, which is how the DFU pipeline used to represent it.
+ *
+ * Usage: node scripts/dfu-memory-benchmark.js [firmwareSize]
+ */
+
+const DEFAULT_FIRMWARE_SIZE = 500 * 1024;
+const RATES = {
+    linkBytesPerSecond: 0,
+    adapterBytesPerSecond: 0,
+};
+
+function toArrayUpdates(updates) {
+    const toArray = file => ({
+        name: file.name,
+        loadData: () => file.loadData().then(data => Array.from(data)),
+    });
+    return updates.map(update => ({
+        datFile: toArray(update.datFile),
+        binFile: toArray(update.binFile),
+    }));
+}
+
+function runChild(zipFilePath, mode) {
+    const adapter = new FakeAdapter('adapter0', 1);
+    const transportParameters = {
+        adapter,
+        targetAddress: 'AA:BB:CC:DD:EE:FF',
+        targetAddressType: 'BLE_GAP_ADDR_TYPE_RANDOM_STATIC',
+    };
+    const dfu = new Dfu('BLE', transportParameters, params => new FakeTransport(params, RATES));
+    const startTime = Date.now();
+
+    dfu.fetchUpdates(zipFilePath, (fetchError, updates) => {
+        if (fetchError) {
+            console.error(fetchError);
+            process.exit(1);
+        }
+        const modeUpdates = mode === 'array' ? toArrayUpdates(updates) : updates;
+        dfu.performUpdates(modeUpdates, err => {
+            if (err) {
+                console.error(err);
+                process.exit(1);
+            }
+            const result = {
+                mode,
+                seconds: (Date.now() - startTime) / 1000,
+                maxRssKiB: process.resourceUsage().maxRSS,
+            };
+            console.log(JSON.stringify(result));
+        });
+    });
+}
+
+function runParent(firmwareSize) {
+    createZipFile(firmwareSize)
+        .then(zipFilePath => {
+            console.log(`${firmwareSize} bytes firmware`);
+            console.log('   mode  seconds  peak RSS (KiB)');
+            ['buffer', 'array'].forEach(mode => {
+                const output = execFileSync(process.execPath, [__filename, '--child', mode, zipFilePath]);
+                const result = JSON.parse(output.toString());
+                console.log(`${result.mode.padStart(7)}  ${result.seconds.toFixed(2).padStart(7)}  ` +
+                    `${String(result.maxRssKiB).padStart(14)}`);
+            });
+            fs.unlinkSync(zipFilePath);
+        })
+        .catch(err => {
+            console.error(err);
+            process.exit(1);
+        });
+}
+
+if (process.argv[2] === '--child') {
+    runChild(process.argv[4], process.argv[3]);
+} else {
+    runParent(parseInt(process.argv[2], 10) || DEFAULT_FIRMWARE_SIZE);
+}
@@ -0,0 +1,188 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "native_test.h"
+
+#include "../conn_param_policy.h"
+
+#include <cstdio>
+
+namespace {
+    // Same value as NRF_ERROR_INVALID_PARAM
+    const uint32_t ERROR_INVALID_PARAM = 0x0007;
+
+    // 30 to 50 ms interval, up to 4 skipped events and a 1 to 4 s supervision timeout
+    const conn_param_policy_t BOUNDS = { CONN_PARAM_ACCEPT, 24, 40, 4, 100, 400 };
+
+    conn_param_policy_t withMode(conn_param_policy_t policy, const conn_param_mode_t mode)
+    {
+        policy.mode = mode;
+        return policy;
+    }
+
+    typedef struct {
+        const char *name;
+        conn_param_policy_t policy;
+        conn_param_values_t requested;
+        conn_param_decision_t decision;
+        conn_param_values_t reply;      // Only checked when the decision is to accept or clamp
+    } policy_case_t;
+
+    const policy_case_t POLICY_CASES[] = {
+        // Accept mode, the bounds are inclusive
+        { "accept at the lower bounds", BOUNDS, { 24, 24, 0, 100 }, CONN_PARAM_DECISION_ACCEPT, { 24, 24, 0, 100 } },
+        { "accept at the upper bounds", BOUNDS, { 40, 40, 4, 400 }, CONN_PARAM_DECISION_ACCEPT, { 40, 40, 4, 400 } },
+        { "accept rejects min interval below the bound", BOUNDS, { 23, 40, 0, 200 }, CONN_PARAM_DECISION_REJECT, {} },
+        { "accept rejects max interval above the bound", BOUNDS, { 24, 41, 0, 200 }, CONN_PARAM_DECISION_REJECT, {} },
+        { "accept rejects min interval above max interval", BOUNDS, { 32, 30, 0, 200 }, CONN_PARAM_DECISION_REJECT, {} },
+        { "accept rejects slave latency above the bound", BOUNDS, { 24, 40, 5, 400 }, CONN_PARAM_DECISION_REJECT, {} },
+        { "accept rejects timeout below the bound", BOUNDS, { 24, 40, 0, 99 }, CONN_PARAM_DECISION_REJECT, {} },
+        { "accept rejects timeout above the bound", BOUNDS, { 24, 40, 0, 401 }, CONN_PARAM_DECISION_REJECT, {} },
+
+        // Clamp mode accepts requests within the bounds unchanged
+        { "clamp accepts at the lower bounds", withMode(BOUNDS, CONN_PARAM_CLAMP), { 24, 24, 0, 100 }, CONN_PARAM_DECISION_ACCEPT, { 24, 24, 0, 100 } },
+        { "clamp accepts at the upper bounds", withMode(BOUNDS, CONN_PARAM_CLAMP), { 40, 40, 4, 400 }, CONN_PARAM_DECISION_ACCEPT, { 40, 40, 4, 400 } },
+
+        // Clamp mode keeps the part of the interval range within the bounds
+        { "clamp raises min interval", withMode(BOUNDS, CONN_PARAM_CLAMP), { 16, 32, 0, 200 }, CONN_PARAM_DECISION_CLAMP, { 24, 32, 0, 200 } },
+        { "clamp lowers max interval", withMode(BOUNDS, CONN_PARAM_CLAMP), { 32, 48, 0, 200 }, CONN_PARAM_DECISION_CLAMP, { 32, 40, 0, 200 } },
+        { "clamp narrows a range covering the bounds", withMode(BOUNDS, CONN_PARAM_CLAMP), { 6, 3200, 0, 200 }, CONN_PARAM_DECISION_CLAMP, { 24, 40, 0, 200 } },
+        { "clamp uses the lower bound for a range below", withMode(BOUNDS, CONN_PARAM_CLAMP), { 6, 12, 0, 200 }, CONN_PARAM_DECISION_CLAMP, { 24, 24, 0, 200 } },
+        { "clamp uses the upper bound for a range above", withMode(BOUNDS, CONN_PARAM_CLAMP), { 80, 100, 0, 200 }, CONN_PARAM_DECISION_CLAMP, { 40, 40, 0, 200 } },
+        { "clamp lowers slave latency", withMode(BOUNDS, CONN_PARAM_CLAMP), { 24, 40, 10, 400 }, CONN_PARAM_DECISION_CLAMP, { 24, 40, 4, 400 } },
+        { "clamp raises timeout", withMode(BOUNDS, CONN_PARAM_CLAMP), { 24, 40, 0, 50 }, CONN_PARAM_DECISION_CLAMP, { 24, 40, 0, 100 } },
+        { "clamp lowers timeout", withMode(BOUNDS, CONN_PARAM_CLAMP), { 24, 40, 0, 500 }, CONN_PARAM_DECISION_CLAMP, { 24, 40, 0, 400 } },
+
+        // Clamped values violating timeout > (1 + latency) * max interval * 2 get a longer timeout when the bounds allow it
+        { "clamp raises timeout to the shortest valid",
+          { CONN_PARAM_CLAMP, 24, 400, 10, 100, 3200 }, { 400, 400, 12, 100 }, CONN_PARAM_DECISION_CLAMP, { 400, 400, 10, 1101 } },
+
+        // otherwise a lower slave latency
+        { "clamp lowers latency when the timeout bound is too short",
+          { CONN_PARAM_CLAMP, 24, 400, 10, 100, 600 }, { 400, 400, 10, 700 }, CONN_PARAM_DECISION_CLAMP, { 400, 400, 4, 600 } },
+        { "clamp lowers latency when the timeout would exceed the SoftDevice maximum",
+          { CONN_PARAM_CLAMP, 3200, 3200, 20, 10, 0xFFFF }, { 3200, 3200, 22, 3200 }, CONN_PARAM_DECISION_CLAMP, { 3200, 3200, 2, 3200 } },
+
+        // or a reject when not even zero latency gives a valid timeout
+        { "clamp rejects when no valid timeout is within the bounds",
+          { CONN_PARAM_CLAMP, 3200, 3200, 0, 10, 100 }, { 3200, 3200, 1, 100 }, CONN_PARAM_DECISION_REJECT, {} },
+        { "clamp rejects inverted interval bounds",
+          { CONN_PARAM_CLAMP, 40, 24, 4, 100, 400 }, { 16, 32, 0, 200 }, CONN_PARAM_DECISION_REJECT, {} },
+        { "clamp rejects inverted timeout bounds",
+          { CONN_PARAM_CLAMP, 24, 40, 4, 400, 100 }, { 16, 32, 0, 200 }, CONN_PARAM_DECISION_REJECT, {} },
+
+        { "reject mode rejects requests within the bounds", withMode(BOUNDS, CONN_PARAM_REJECT), { 24, 40, 0, 200 }, CONN_PARAM_DECISION_REJECT, {} },
+        { "defer mode defers requests within the bounds", withMode(BOUNDS, CONN_PARAM_DEFER), { 24, 40, 0, 200 }, CONN_PARAM_DECISION_DEFER, {} },
+    };
+
+    bool operator==(const conn_param_values_t &a, const conn_param_values_t &b)
+    {
+        return a.min_conn_interval == b.min_conn_interval &&
+               a.max_conn_interval == b.max_conn_interval &&
+               a.slave_latency == b.slave_latency &&
+               a.conn_sup_timeout == b.conn_sup_timeout;
+    }
+}
+
+TEST_CASE("evaluates requests against the policy bounds")
+{
+    for (auto &policyCase : POLICY_CASES)
+    {
+        ConnParamPolicy policy;
+        policy.set(CONN_PARAM_POLICY_DEFAULT, policyCase.policy);
+
+        conn_param_values_t reply = { 0, 0, 0, 0 };
+        auto decision = policy.evaluate(0, policyCase.requested, reply);
+
+        auto accepted = decision == CONN_PARAM_DECISION_ACCEPT || decision == CONN_PARAM_DECISION_CLAMP;
+
+        if (decision != policyCase.decision || (accepted && !(reply == policyCase.reply)))
+        {
+            std::fprintf(stderr, "%s: decision %d, reply %u %u %u %u\n", policyCase.name, decision,
+                         reply.min_conn_interval, reply.max_conn_interval, reply.slave_latency, reply.conn_sup_timeout);
+        }
+
+        EXPECT(decision == policyCase.decision);
+        EXPECT(!accepted || reply == policyCase.reply);
+    }
+}
+
+TEST_CASE("defers requests when no policy is set")
+{
+    ConnParamPolicy policy;
+    conn_param_values_t reply = { 0, 0, 0, 0 };
+
+    EXPECT(policy.evaluate(0, { 24, 40, 0, 200 }, reply) == CONN_PARAM_DECISION_DEFER);
+}
+
+TEST_CASE("a link policy overrides the default policy until the link is disconnected")
+{
+    ConnParamPolicy policy;
+    conn_param_values_t reply = { 0, 0, 0, 0 };
+
+    policy.set(CONN_PARAM_POLICY_DEFAULT, withMode(BOUNDS, CONN_PARAM_REJECT));
+    policy.set(1, BOUNDS);
+
+    EXPECT(policy.evaluate(1, { 24, 40, 0, 200 }, reply) == CONN_PARAM_DECISION_ACCEPT);
+    EXPECT(policy.evaluate(2, { 24, 40, 0, 200 }, reply) == CONN_PARAM_DECISION_REJECT);
+
+    policy.onDisconnected(1);
+    EXPECT(policy.evaluate(1, { 24, 40, 0, 200 }, reply) == CONN_PARAM_DECISION_REJECT);
+
+    // The default policy is kept when a link without its own policy disconnects
+    policy.onDisconnected(CONN_PARAM_POLICY_DEFAULT);
+    EXPECT(policy.evaluate(2, { 24, 40, 0, 200 }, reply) == CONN_PARAM_DECISION_REJECT);
+}
+
+TEST_CASE("counts the replies by decision")
+{
+    ConnParamPolicy policy;
+
+    policy.onReplied(CONN_PARAM_DECISION_ACCEPT, 0);
+    policy.onReplied(CONN_PARAM_DECISION_CLAMP, 0);
+    policy.onReplied(CONN_PARAM_DECISION_REJECT, 0);
+    policy.onReplied(CONN_PARAM_DECISION_ACCEPT, ERROR_INVALID_PARAM);
+
+    EXPECT(policy.getAcceptedCount() == 2);
+    EXPECT(policy.getClampedCount() == 1);
+    EXPECT(policy.getRejectedCount() == 1);
+    EXPECT(policy.getErrorCount() == 1);
+}
+
+int main()
+{
+    return native_test::runTests();
+}
@@ -0,0 +1,385 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "native_test.h"
+
+#include "../connect_scheduler.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    typedef std::chrono::steady_clock clock;
+
+    // Same value as NRF_ERROR_BUSY
+    const uint32_t ERROR_BUSY = 0x0011;
+
+    // Same value as BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION
+    const uint8_t HCI_REMOTE_USER_TERMINATED_CONNECTION = 0x13;
+
+    // Upper bound for waiting on the scheduler thread, the tests normally complete in a few milliseconds
+    const auto WAIT_TIMEOUT = std::chrono::seconds(5);
+
+    // Records the calls the scheduler thread makes, the test thread polls the records
+    class SchedulerFixture
+    {
+    public:
+        SchedulerFixture() :
+            cancelResult(CONNECT_SCHEDULER_SUCCESS),
+            cancelCount(0)
+        {
+            scheduler.start([this]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                cancelCount++;
+                return cancelResult;
+            }, nullptr);
+        }
+
+        ConnectScheduler::connect_handler_t connectHandler(const uint32_t id, const uint32_t result = CONNECT_SCHEDULER_SUCCESS)
+        {
+            return [this, id, result]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                attemptIds.push_back(id);
+                attemptTimes.push_back(clock::now());
+                return result;
+            };
+        }
+
+        bool waitForAttempts(const size_t count)
+        {
+            return waitFor([this, count]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                return attemptIds.size() >= count;
+            });
+        }
+
+        bool waitForCancels(const int count)
+        {
+            return waitFor([this, count]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                return cancelCount >= count;
+            });
+        }
+
+        bool waitForCompletions(const size_t count)
+        {
+            return waitFor([this, count]() {
+                takeCompletions();
+                return completions.size() >= count;
+            });
+        }
+
+        void takeCompletions()
+        {
+            std::vector<connect_completion_t> taken;
+            scheduler.takeCompletions(taken);
+            completions.insert(completions.end(), taken.begin(), taken.end());
+        }
+
+        std::vector<uint32_t> getAttemptIds()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return attemptIds;
+        }
+
+        std::vector<clock::time_point> getAttemptTimes()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return attemptTimes;
+        }
+
+        int getCancelCount()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return cancelCount;
+        }
+
+        void setCancelResult(const uint32_t result)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelResult = result;
+        }
+
+        ConnectScheduler scheduler;
+        std::vector<connect_completion_t> completions;
+
+    private:
+        template<typename Predicate>
+        static bool waitFor(Predicate predicate)
+        {
+            auto deadline = clock::now() + WAIT_TIMEOUT;
+
+            while (!predicate())
+            {
+                if (clock::now() > deadline)
+                {
+                    return false;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            return true;
+        }
+
+        std::mutex mutex;
+        std::vector<uint32_t> attemptIds;
+        std::vector<clock::time_point> attemptTimes;
+        uint32_t cancelResult;
+        int cancelCount;
+    };
+
+    uint32_t elapsedMilliseconds(const clock::time_point from, const clock::time_point to)
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count());
+    }
+}
+
+TEST_CASE("starts the highest priority target first, equal priorities in enqueue order")
+{
+    SchedulerFixture fixture;
+
+    // The first target occupies the pending connect while the others are enqueued
+    EXPECT(fixture.scheduler.enqueue(1, 0, 0, 0, 0, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+
+    EXPECT(fixture.scheduler.enqueue(2, 1, 0, 0, 0, fixture.connectHandler(2)));
+    EXPECT(fixture.scheduler.enqueue(3, 5, 0, 0, 0, fixture.connectHandler(3)));
+    EXPECT(fixture.scheduler.enqueue(4, 5, 0, 0, 0, fixture.connectHandler(4)));
+
+    for (size_t attempt = 2; attempt <= 4; attempt++)
+    {
+        EXPECT(fixture.scheduler.onTimeout());
+        REQUIRE(fixture.waitForAttempts(attempt));
+    }
+
+    EXPECT(fixture.scheduler.onTimeout());
+    REQUIRE(fixture.waitForCompletions(4));
+
+    EXPECT(fixture.getAttemptIds() == std::vector<uint32_t>({ 1, 3, 4, 2 }));
+
+    for (auto &completion : fixture.completions)
+    {
+        EXPECT(completion.result == CONNECT_SCHEDULER_ERROR_TIMEOUT);
+        EXPECT(completion.attempts == 1);
+    }
+
+    EXPECT(!fixture.scheduler.onTimeout());
+}
+
+TEST_CASE("reports a link that survives the settle time as connected")
+{
+    SchedulerFixture fixture;
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 0, 0, 20, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+
+    fixture.scheduler.onConnected(7);
+    REQUIRE(fixture.waitForCompletions(1));
+
+    EXPECT(fixture.completions[0].id == 1);
+    EXPECT(fixture.completions[0].result == CONNECT_SCHEDULER_SUCCESS);
+    EXPECT(fixture.completions[0].conn_handle == 7);
+    EXPECT(fixture.completions[0].attempts == 1);
+    EXPECT(fixture.completions[0].total_time >= 20);
+    EXPECT(fixture.scheduler.getConnectedCount() == 1);
+    EXPECT(fixture.scheduler.getPendingCount() == 0);
+}
+
+TEST_CASE("retries a link lost with BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED during the settle time")
+{
+    SchedulerFixture fixture;
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 1, 1, 500, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+
+    fixture.scheduler.onConnected(3);
+    fixture.scheduler.onDisconnected(3, CONNECT_SCHEDULER_HCI_FAILED_TO_BE_ESTABLISHED);
+    REQUIRE(fixture.waitForAttempts(2));
+
+    fixture.scheduler.onConnected(4);
+    REQUIRE(fixture.waitForCompletions(1));
+
+    EXPECT(fixture.completions[0].result == CONNECT_SCHEDULER_SUCCESS);
+    EXPECT(fixture.completions[0].conn_handle == 4);
+    EXPECT(fixture.completions[0].attempts == 2);
+    EXPECT(fixture.scheduler.getRetryCount() == 1);
+}
+
+TEST_CASE("fails when the link is lost with BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED and no retries are left")
+{
+    SchedulerFixture fixture;
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 0, 1, 500, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+
+    fixture.scheduler.onConnected(3);
+    fixture.scheduler.onDisconnected(3, CONNECT_SCHEDULER_HCI_FAILED_TO_BE_ESTABLISHED);
+    fixture.takeCompletions();
+
+    REQUIRE(fixture.completions.size() == 1);
+    EXPECT(fixture.completions[0].result == CONNECT_SCHEDULER_ERROR_LINK_LOST);
+    EXPECT(fixture.completions[0].hci_status == CONNECT_SCHEDULER_HCI_FAILED_TO_BE_ESTABLISHED);
+    EXPECT(fixture.scheduler.getRetryCount() == 0);
+    EXPECT(fixture.scheduler.getFailedCount() == 1);
+}
+
+TEST_CASE("does not retry a link lost for other reasons during the settle time")
+{
+    SchedulerFixture fixture;
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 3, 1, 500, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+
+    fixture.scheduler.onConnected(3);
+    fixture.scheduler.onDisconnected(3, HCI_REMOTE_USER_TERMINATED_CONNECTION);
+    fixture.takeCompletions();
+
+    REQUIRE(fixture.completions.size() == 1);
+    EXPECT(fixture.completions[0].result == CONNECT_SCHEDULER_ERROR_LINK_LOST);
+    EXPECT(fixture.completions[0].hci_status == HCI_REMOTE_USER_TERMINATED_CONNECTION);
+    EXPECT(fixture.completions[0].attempts == 1);
+    EXPECT(fixture.scheduler.getRetryCount() == 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT(fixture.getAttemptIds().size() == 1);
+}
+
+TEST_CASE("doubles the backoff for each retry")
+{
+    SchedulerFixture fixture;
+    const uint32_t retryDelay = 40;
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 3, retryDelay, 0, fixture.connectHandler(1, ERROR_BUSY)));
+    REQUIRE(fixture.waitForCompletions(1));
+
+    EXPECT(fixture.completions[0].result == ERROR_BUSY);
+    EXPECT(fixture.completions[0].attempts == 4);
+    EXPECT(fixture.scheduler.getRetryCount() == 3);
+
+    auto times = fixture.getAttemptTimes();
+    REQUIRE(times.size() == 4);
+
+    for (size_t retry = 1; retry < times.size(); retry++)
+    {
+        EXPECT(elapsedMilliseconds(times[retry - 1], times[retry]) >= retryDelay << (retry - 1));
+    }
+}
+
+TEST_CASE("cancel while connecting cancels the pending connect")
+{
+    SchedulerFixture fixture;
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 0, 0, 0, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+
+    EXPECT(fixture.scheduler.cancel(1));
+    REQUIRE(fixture.waitForCompletions(1));
+
+    EXPECT(fixture.completions[0].result == CONNECT_SCHEDULER_ERROR_ABORTED);
+    EXPECT(fixture.getCancelCount() == 1);
+    EXPECT(!fixture.scheduler.onTimeout());
+}
+
+TEST_CASE("cancel while connecting keeps the target when the connect cannot be cancelled")
+{
+    SchedulerFixture fixture;
+
+    // Same value as NRF_ERROR_INVALID_STATE, the connect completed before it was cancelled
+    fixture.setCancelResult(0x0008);
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 0, 0, 0, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+
+    EXPECT(fixture.scheduler.cancel(1));
+    REQUIRE(fixture.waitForCancels(1));
+
+    fixture.takeCompletions();
+    EXPECT(fixture.completions.empty());
+
+    EXPECT(fixture.scheduler.onTimeout());
+    fixture.takeCompletions();
+
+    REQUIRE(fixture.completions.size() == 1);
+    EXPECT(fixture.completions[0].result == CONNECT_SCHEDULER_ERROR_TIMEOUT);
+}
+
+TEST_CASE("cancel while settling completes the target without cancelling the connect")
+{
+    SchedulerFixture fixture;
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 0, 0, 500, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+
+    fixture.scheduler.onConnected(5);
+    EXPECT(fixture.scheduler.cancel(1));
+    fixture.takeCompletions();
+
+    REQUIRE(fixture.completions.size() == 1);
+    EXPECT(fixture.completions[0].result == CONNECT_SCHEDULER_ERROR_ABORTED);
+    EXPECT(fixture.completions[0].conn_handle == 5);
+    EXPECT(fixture.getCancelCount() == 0);
+    EXPECT(!fixture.scheduler.cancel(1));
+}
+
+TEST_CASE("stop completes the remaining targets as aborted")
+{
+    SchedulerFixture fixture;
+
+    EXPECT(fixture.scheduler.enqueue(1, 0, 0, 0, 0, fixture.connectHandler(1)));
+    REQUIRE(fixture.waitForAttempts(1));
+    EXPECT(fixture.scheduler.enqueue(2, 0, 0, 0, 0, fixture.connectHandler(2)));
+
+    fixture.scheduler.stop();
+    fixture.takeCompletions();
+
+    REQUIRE(fixture.completions.size() == 2);
+
+    for (auto &completion : fixture.completions)
+    {
+        EXPECT(completion.result == CONNECT_SCHEDULER_ERROR_ABORTED);
+    }
+
+    EXPECT(!fixture.scheduler.isRunning());
+    EXPECT(!fixture.scheduler.enqueue(3, 0, 0, 0, 0, fixture.connectHandler(3)));
+}
+
+int main()
+{
+    return native_test::runTests();
+}
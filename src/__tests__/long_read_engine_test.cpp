@@ -0,0 +1,321 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "native_test.h"
+
+#include "../long_read_engine.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // Same value as BLE_GATT_STATUS_ATTERR_READ_NOT_PERMITTED
+    const uint16_t STATUS_READ_NOT_PERMITTED = 0x0102;
+
+    const uint16_t CONN_HANDLE = 1;
+    const uint16_t VALUE_HANDLE = 0x10;
+    const uint16_t DEFAULT_ATT_MTU = 23;
+
+    typedef struct {
+        uint16_t conn_handle;
+        uint16_t handle;
+        uint16_t offset;
+    } read_request_t;
+
+    // Answers the read requests of the engine like a peripheral with one attribute
+    class PeripheralFixture
+    {
+    public:
+        explicit PeripheralFixture(const size_t valueLength, const uint16_t attMtu = DEFAULT_ATT_MTU) :
+            attMtu(attMtu),
+            pastEndStatus(LONG_READ_STATUS_INVALID_OFFSET),
+            readResult(0),
+            pending(false)
+        {
+            for (size_t i = 0; i < valueLength; i++)
+            {
+                value.push_back(static_cast<uint8_t>(i));
+            }
+
+            engine.setHandlers([this](uint16_t connHandle, uint16_t handle, uint16_t offset) {
+                if (readResult == 0)
+                {
+                    requests.push_back({ connHandle, handle, offset });
+                    pending = true;
+                }
+
+                return readResult;
+            }, nullptr);
+        }
+
+        // Responds to the outstanding request, the engine sends the next one from onReadResponse
+        bool respond()
+        {
+            if (!pending)
+            {
+                return false;
+            }
+
+            pending = false;
+            auto offset = requests.back().offset;
+
+            if (offset > 0 && offset >= value.size())
+            {
+                return engine.onReadResponse(CONN_HANDLE, pastEndStatus, nullptr, 0);
+            }
+
+            auto length = std::min<size_t>(value.size() - offset, attMtu - 1);
+            return engine.onReadResponse(CONN_HANDLE, LONG_READ_STATUS_SUCCESS, value.data() + offset, static_cast<uint16_t>(length));
+        }
+
+        void respondUntilDone()
+        {
+            while (respond())
+            {
+            }
+        }
+
+        std::vector<long_read_completion_t> takeCompletions()
+        {
+            std::vector<long_read_completion_t> completions;
+            engine.takeCompletions(completions);
+            return completions;
+        }
+
+        LongReadEngine engine;
+        std::vector<uint8_t> value;
+        std::vector<read_request_t> requests;
+        uint16_t attMtu;
+        uint16_t pastEndStatus;
+        uint32_t readResult;
+        bool pending;
+    };
+
+    std::vector<uint16_t> requestOffsets(const PeripheralFixture &fixture)
+    {
+        std::vector<uint16_t> offsets;
+
+        for (auto &request : fixture.requests)
+        {
+            offsets.push_back(request.offset);
+        }
+
+        return offsets;
+    }
+}
+
+TEST_CASE("reads a value spanning several chunks")
+{
+    PeripheralFixture fixture(50);
+
+    EXPECT(fixture.engine.start(7, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+    fixture.respondUntilDone();
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+
+    EXPECT(completions[0].id == 7);
+    EXPECT(completions[0].conn_handle == CONN_HANDLE);
+    EXPECT(completions[0].handle == VALUE_HANDLE);
+    EXPECT(completions[0].result == 0);
+    EXPECT(completions[0].gatt_status == LONG_READ_STATUS_SUCCESS);
+    EXPECT(completions[0].request_count == 3);
+    EXPECT(completions[0].value == fixture.value);
+    EXPECT(requestOffsets(fixture) == std::vector<uint16_t>({ 0, 22, 44 }));
+
+    for (auto &request : fixture.requests)
+    {
+        EXPECT(request.conn_handle == CONN_HANDLE);
+        EXPECT(request.handle == VALUE_HANDLE);
+    }
+
+    EXPECT(fixture.engine.getCompletedCount() == 1);
+    EXPECT(fixture.engine.getRequestCount() == 3);
+}
+
+TEST_CASE("completes a short value with a single read")
+{
+    PeripheralFixture fixture(5);
+
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+    fixture.respondUntilDone();
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+    EXPECT(completions[0].request_count == 1);
+    EXPECT(completions[0].value == fixture.value);
+}
+
+TEST_CASE("a value that is a multiple of the chunk size ends with the error for the read past its end")
+{
+    const uint16_t pastEndStatuses[] = { LONG_READ_STATUS_INVALID_OFFSET, LONG_READ_STATUS_ATTRIBUTE_NOT_LONG };
+    const size_t valueLengths[] = { 22, 44 };
+
+    for (auto pastEndStatus : pastEndStatuses)
+    {
+        for (auto valueLength : valueLengths)
+        {
+            PeripheralFixture fixture(valueLength);
+            fixture.pastEndStatus = pastEndStatus;
+
+            EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+            fixture.respondUntilDone();
+
+            auto completions = fixture.takeCompletions();
+            REQUIRE(completions.size() == 1);
+
+            EXPECT(completions[0].result == 0);
+            EXPECT(completions[0].gatt_status == LONG_READ_STATUS_SUCCESS);
+            EXPECT(completions[0].value == fixture.value);
+            EXPECT(completions[0].request_count == valueLength / 22 + 1);
+            EXPECT(fixture.engine.getFailedCount() == 0);
+        }
+    }
+}
+
+TEST_CASE("an error response to the first read fails the read")
+{
+    PeripheralFixture fixture(50);
+
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+    EXPECT(fixture.engine.onReadResponse(CONN_HANDLE, STATUS_READ_NOT_PERMITTED, nullptr, 0));
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+    EXPECT(completions[0].gatt_status == STATUS_READ_NOT_PERMITTED);
+    EXPECT(completions[0].value.empty());
+    EXPECT(fixture.engine.getFailedCount() == 1);
+}
+
+TEST_CASE("an invalid offset error for the first read is not taken as the end of the value")
+{
+    PeripheralFixture fixture(50);
+
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+    EXPECT(fixture.engine.onReadResponse(CONN_HANDLE, LONG_READ_STATUS_INVALID_OFFSET, nullptr, 0));
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+    EXPECT(completions[0].gatt_status == LONG_READ_STATUS_INVALID_OFFSET);
+}
+
+TEST_CASE("uses the chunk size of the ATT MTU and stops at the largest attribute value")
+{
+    PeripheralFixture fixture(600, 247);
+
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+    fixture.respondUntilDone();
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+
+    EXPECT(completions[0].gatt_status == LONG_READ_STATUS_SUCCESS);
+    EXPECT(completions[0].value.size() == LONG_READ_MAX_LENGTH);
+    EXPECT(std::equal(completions[0].value.begin(), completions[0].value.end(), fixture.value.begin()));
+    EXPECT(requestOffsets(fixture) == std::vector<uint16_t>({ 0, 246, 492 }));
+}
+
+TEST_CASE("a disconnect during the read completes it with the value read so far")
+{
+    PeripheralFixture fixture(50);
+
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+    EXPECT(fixture.respond());
+
+    fixture.engine.onDisconnected(CONN_HANDLE);
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+    EXPECT(completions[0].result == LONG_READ_ERROR_INVALID_CONN_HANDLE);
+    EXPECT(completions[0].value.size() == 22);
+    EXPECT(fixture.engine.getFailedCount() == 1);
+
+    // A response arriving after the disconnect belongs to no read
+    EXPECT(!fixture.respond());
+    EXPECT(fixture.takeCompletions().empty());
+
+    // The link can start a new read once the previous one is completed
+    EXPECT(fixture.engine.start(2, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+}
+
+TEST_CASE("a disconnect on another link does not complete the read")
+{
+    PeripheralFixture fixture(50);
+
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+    fixture.engine.onDisconnected(CONN_HANDLE + 1);
+
+    EXPECT(fixture.takeCompletions().empty());
+    fixture.respondUntilDone();
+    EXPECT(fixture.takeCompletions().size() == 1);
+}
+
+TEST_CASE("allows one read per link")
+{
+    PeripheralFixture fixture(50);
+
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+    EXPECT(fixture.engine.start(2, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == LONG_READ_ERROR_BUSY);
+}
+
+TEST_CASE("fails with the error code when a read blob request can not be sent")
+{
+    // Same value as NRF_ERROR_RESOURCES
+    const uint32_t errorResources = 0x0013;
+    PeripheralFixture fixture(50);
+
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, VALUE_HANDLE, fixture.attMtu) == 0);
+
+    fixture.readResult = errorResources;
+    EXPECT(fixture.respond());
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+    EXPECT(completions[0].result == errorResources);
+    EXPECT(completions[0].value.size() == 22);
+}
+
+TEST_CASE("requires the handlers to start a read")
+{
+    LongReadEngine engine;
+
+    EXPECT(engine.start(1, CONN_HANDLE, VALUE_HANDLE, DEFAULT_ATT_MTU) == LONG_READ_ERROR_INVALID_STATE);
+}
+
+int main()
+{
+    return native_test::runTests();
+}
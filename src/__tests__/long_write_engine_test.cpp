@@ -0,0 +1,340 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "native_test.h"
+
+#include "../long_write_engine.h"
+
+#include <vector>
+
+namespace {
+    // Same values as BLE_GATT_STATUS_ATTERR_WRITE_NOT_PERMITTED and BLE_GATT_STATUS_ATTERR_PREPARE_QUEUE_FULL
+    const uint16_t STATUS_WRITE_NOT_PERMITTED = 0x0103;
+    const uint16_t STATUS_PREPARE_QUEUE_FULL = 0x0109;
+
+    // Same value as NRF_ERROR_RESOURCES
+    const uint32_t ERROR_RESOURCES = 0x0013;
+
+    const uint16_t CONN_HANDLE = 1;
+    const uint16_t FIRST_HANDLE = 0x10;
+    const uint16_t SECOND_HANDLE = 0x20;
+    const uint16_t ATT_MTU = 23;
+
+    typedef struct {
+        uint8_t write_op;
+        uint8_t flags;
+        uint16_t handle;
+        uint16_t offset;
+        std::vector<uint8_t> data;
+    } write_request_t;
+
+    std::vector<uint8_t> makeValue(const size_t length, const uint8_t first = 0)
+    {
+        std::vector<uint8_t> value;
+
+        for (size_t i = 0; i < length; i++)
+        {
+            value.push_back(static_cast<uint8_t>(first + i));
+        }
+
+        return value;
+    }
+
+    // Answers the write requests of the engine like a peripheral with a prepare write queue
+    class PeripheralFixture
+    {
+    public:
+        PeripheralFixture() :
+            writeResult(0)
+        {
+            engine.setHandlers([this](uint16_t, uint8_t writeOp, uint8_t flags, uint16_t handle, uint16_t offset,
+                                      const uint8_t *data, uint16_t length) {
+                if (writeResult == 0)
+                {
+                    requests.push_back({ writeOp, flags, handle, offset, std::vector<uint8_t>(data, data + length) });
+                }
+
+                return writeResult;
+            }, nullptr);
+        }
+
+        // Echoes the last prepare write request, or acknowledges the last execute write request
+        bool respond(const uint16_t gattStatus = LONG_WRITE_STATUS_SUCCESS)
+        {
+            auto &request = requests.back();
+            return engine.onWriteResponse(CONN_HANDLE, gattStatus, request.handle, request.offset,
+                                          request.data.data(), static_cast<uint16_t>(request.data.size()));
+        }
+
+        // Responds to the requests until an execute write request has been answered
+        void respondUntilExecuted()
+        {
+            while (requests.back().write_op != LONG_WRITE_OP_EXEC_WRITE_REQ)
+            {
+                REQUIRE(respond());
+            }
+
+            EXPECT(respond());
+        }
+
+        uint32_t start(std::vector<long_write_item_t> items)
+        {
+            return engine.start(1, CONN_HANDLE, items, ATT_MTU);
+        }
+
+        std::vector<long_write_completion_t> takeCompletions()
+        {
+            std::vector<long_write_completion_t> completions;
+            engine.takeCompletions(completions);
+            return completions;
+        }
+
+        LongWriteEngine engine;
+        std::vector<write_request_t> requests;
+        uint32_t writeResult;
+    };
+}
+
+TEST_CASE("writes a long value with prepare write requests and one execute write request")
+{
+    PeripheralFixture fixture;
+    auto value = makeValue(50);
+
+    EXPECT(fixture.start({ { FIRST_HANDLE, value } }) == 0);
+    fixture.respondUntilExecuted();
+
+    REQUIRE(fixture.requests.size() == 4);
+
+    std::vector<uint8_t> written;
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT(fixture.requests[i].write_op == LONG_WRITE_OP_PREP_WRITE_REQ);
+        EXPECT(fixture.requests[i].handle == FIRST_HANDLE);
+        EXPECT(fixture.requests[i].offset == written.size());
+        written.insert(written.end(), fixture.requests[i].data.begin(), fixture.requests[i].data.end());
+    }
+
+    // Each chunk is the ATT MTU less the opcode, handle and offset
+    EXPECT(fixture.requests[0].data.size() == 18);
+    EXPECT(written == value);
+
+    EXPECT(fixture.requests[3].write_op == LONG_WRITE_OP_EXEC_WRITE_REQ);
+    EXPECT(fixture.requests[3].flags == LONG_WRITE_FLAG_WRITE);
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+
+    EXPECT(completions[0].id == 1);
+    EXPECT(completions[0].conn_handle == CONN_HANDLE);
+    EXPECT(completions[0].result == 0);
+    EXPECT(completions[0].executed);
+    EXPECT(!completions[0].verify_failed);
+    EXPECT(completions[0].request_count == 4);
+    EXPECT(fixture.engine.getCompletedCount() == 1);
+}
+
+TEST_CASE("queues the values of several handles before one execute write request")
+{
+    PeripheralFixture fixture;
+
+    EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(10) }, { SECOND_HANDLE, makeValue(30, 100) } }) == 0);
+    fixture.respondUntilExecuted();
+
+    REQUIRE(fixture.requests.size() == 4);
+
+    EXPECT(fixture.requests[0].handle == FIRST_HANDLE);
+    EXPECT(fixture.requests[0].offset == 0);
+    EXPECT(fixture.requests[0].data == makeValue(10));
+
+    EXPECT(fixture.requests[1].handle == SECOND_HANDLE);
+    EXPECT(fixture.requests[1].offset == 0);
+    EXPECT(fixture.requests[1].data.size() == 18);
+
+    EXPECT(fixture.requests[2].handle == SECOND_HANDLE);
+    EXPECT(fixture.requests[2].offset == 18);
+    EXPECT(fixture.requests[2].data.size() == 12);
+
+    EXPECT(fixture.requests[3].write_op == LONG_WRITE_OP_EXEC_WRITE_REQ);
+    EXPECT(fixture.requests[3].flags == LONG_WRITE_FLAG_WRITE);
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+    EXPECT(completions[0].executed);
+}
+
+TEST_CASE("an echo that differs from the data sent cancels the queue")
+{
+    typedef struct {
+        const char *name;
+        int data_delta;     // Added to the first echoed byte
+        int offset_delta;
+        int length_delta;
+        int handle_delta;
+    } echo_case_t;
+
+    const echo_case_t echoCases[] = {
+        { "different data", 1, 0, 0, 0 },
+        { "different offset", 0, 1, 0, 0 },
+        { "shorter data", 0, 0, -1, 0 },
+        { "different handle", 0, 0, 0, 1 },
+    };
+
+    for (auto &echoCase : echoCases)
+    {
+        PeripheralFixture fixture;
+
+        EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(10) }, { SECOND_HANDLE, makeValue(30) } }) == 0);
+        EXPECT(fixture.respond());
+
+        auto request = fixture.requests.back();
+        request.data[0] = static_cast<uint8_t>(request.data[0] + echoCase.data_delta);
+
+        EXPECT(fixture.engine.onWriteResponse(CONN_HANDLE, LONG_WRITE_STATUS_SUCCESS,
+                                              static_cast<uint16_t>(request.handle + echoCase.handle_delta),
+                                              static_cast<uint16_t>(request.offset + echoCase.offset_delta), request.data.data(),
+                                              static_cast<uint16_t>(request.data.size() + echoCase.length_delta)));
+
+        REQUIRE(fixture.requests.size() == 3);
+        EXPECT(fixture.requests[2].write_op == LONG_WRITE_OP_EXEC_WRITE_REQ);
+        EXPECT(fixture.requests[2].flags == LONG_WRITE_FLAG_CANCEL);
+
+        // The write completes when the peer has cancelled the queue
+        EXPECT(fixture.takeCompletions().empty());
+        EXPECT(fixture.respond());
+
+        auto completions = fixture.takeCompletions();
+        REQUIRE(completions.size() == 1);
+
+        EXPECT(completions[0].verify_failed);
+        EXPECT(!completions[0].executed);
+        EXPECT(completions[0].error_handle == SECOND_HANDLE);
+        EXPECT(fixture.engine.getVerifyFailedCount() == 1);
+        EXPECT(fixture.engine.getFailedCount() == 1);
+    }
+}
+
+TEST_CASE("an error response in the middle of the queue cancels it")
+{
+    PeripheralFixture fixture;
+
+    EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(10) }, { SECOND_HANDLE, makeValue(30) } }) == 0);
+    EXPECT(fixture.respond());
+    EXPECT(fixture.respond(STATUS_WRITE_NOT_PERMITTED));
+
+    REQUIRE(fixture.requests.size() == 3);
+    EXPECT(fixture.requests[2].write_op == LONG_WRITE_OP_EXEC_WRITE_REQ);
+    EXPECT(fixture.requests[2].flags == LONG_WRITE_FLAG_CANCEL);
+
+    EXPECT(fixture.respond());
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+
+    EXPECT(completions[0].result == 0);
+    EXPECT(completions[0].gatt_status == STATUS_WRITE_NOT_PERMITTED);
+    EXPECT(completions[0].error_handle == SECOND_HANDLE);
+    EXPECT(!completions[0].verify_failed);
+    EXPECT(!completions[0].executed);
+    EXPECT(completions[0].request_count == 3);
+}
+
+TEST_CASE("an error response to the execute write request fails the write")
+{
+    PeripheralFixture fixture;
+
+    EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(10) } }) == 0);
+    EXPECT(fixture.respond());
+    EXPECT(fixture.respond(STATUS_PREPARE_QUEUE_FULL));
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+
+    EXPECT(completions[0].gatt_status == STATUS_PREPARE_QUEUE_FULL);
+    EXPECT(completions[0].error_handle == FIRST_HANDLE);
+    EXPECT(!completions[0].executed);
+}
+
+TEST_CASE("completes right away when the queue can not be cancelled")
+{
+    PeripheralFixture fixture;
+
+    EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(50) } }) == 0);
+
+    fixture.writeResult = ERROR_RESOURCES;
+    EXPECT(fixture.respond());
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+    EXPECT(completions[0].result == ERROR_RESOURCES);
+    EXPECT(!completions[0].executed);
+}
+
+TEST_CASE("a disconnect during the write completes it")
+{
+    PeripheralFixture fixture;
+
+    EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(50) } }) == 0);
+    EXPECT(fixture.respond());
+
+    fixture.engine.onDisconnected(CONN_HANDLE);
+
+    auto completions = fixture.takeCompletions();
+    REQUIRE(completions.size() == 1);
+    EXPECT(completions[0].result == LONG_WRITE_ERROR_INVALID_CONN_HANDLE);
+    EXPECT(!completions[0].executed);
+
+    EXPECT(!fixture.respond());
+}
+
+TEST_CASE("validates the values before the first request")
+{
+    PeripheralFixture fixture;
+    std::vector<long_write_item_t> tooSmallMtu = { { FIRST_HANDLE, makeValue(10) } };
+
+    EXPECT(fixture.start({}) == LONG_WRITE_ERROR_INVALID_PARAM);
+    EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(513) } }) == LONG_WRITE_ERROR_INVALID_PARAM);
+    EXPECT(fixture.engine.start(1, CONN_HANDLE, tooSmallMtu, 5) == LONG_WRITE_ERROR_INVALID_PARAM);
+    EXPECT(fixture.requests.empty());
+
+    EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(512) } }) == 0);
+    EXPECT(fixture.start({ { FIRST_HANDLE, makeValue(10) } }) == LONG_WRITE_ERROR_BUSY);
+}
+
+int main()
+{
+    return native_test::runTests();
+}
@@ -0,0 +1,118 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_TEST_H
+#define NATIVE_TEST_H
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal harness for the unit tests of the native classes that do not depend on the SoftDevice.
+// Each test executable registers its cases with TEST_CASE and returns the result of runTests() from main.
+
+namespace native_test {
+    typedef struct {
+        std::string name;
+        std::function<void()> body;
+    } test_case_t;
+
+    inline std::vector<test_case_t> &testCases()
+    {
+        static std::vector<test_case_t> cases;
+        return cases;
+    }
+
+    inline int &failureCount()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char *name, std::function<void()> body)
+        {
+            testCases().push_back({ name, body });
+        }
+    };
+
+    inline void fail(const char *file, const int line, const char *expression)
+    {
+        std::fprintf(stderr, "%s:%d: expectation failed: %s\n", file, line, expression);
+        failureCount()++;
+    }
+
+    inline int runTests()
+    {
+        auto failedCases = 0;
+
+        for (auto &testCase : testCases())
+        {
+            auto failuresBefore = failureCount();
+            testCase.body();
+
+            auto passed = failureCount() == failuresBefore;
+            std::printf("%s %s\n", passed ? "[ PASS ]" : "[ FAIL ]", testCase.name.c_str());
+
+            if (!passed)
+            {
+                failedCases++;
+            }
+        }
+
+        std::printf("%zu tests, %d failed\n", testCases().size(), failedCases);
+        return failedCases == 0 ? 0 : 1;
+    }
+}
+
+#define NATIVE_TEST_CONCAT_(a, b) a##b
+#define NATIVE_TEST_CONCAT(a, b) NATIVE_TEST_CONCAT_(a, b)
+
+#define TEST_CASE(name) \
+    static void NATIVE_TEST_CONCAT(testCase, __LINE__)(); \
+    static native_test::Registrar NATIVE_TEST_CONCAT(registrar, __LINE__)(name, NATIVE_TEST_CONCAT(testCase, __LINE__)); \
+    static void NATIVE_TEST_CONCAT(testCase, __LINE__)()
+
+#define EXPECT(expression) \
+    do { if (!(expression)) { native_test::fail(__FILE__, __LINE__, #expression); } } while (0)
+
+// Stops the current test case, for expectations the rest of the case depends on
+#define REQUIRE(expression) \
+    do { if (!(expression)) { native_test::fail(__FILE__, __LINE__, #expression); return; } } while (0)
+
+#endif // NATIVE_TEST_H
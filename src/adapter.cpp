@@ -44,6 +44,10 @@ Nan::Persistent<v8::Function> Adapter::constructor;
 
 std::vector<Adapter *> adapters;
 
+// Adapter ID of the next adapter created, adapters are created in the NodeJS thread.
+// Each SoftDevice API version module has its own counter, see Adapter::adapterId.
+static uint16_t nextAdapterId = 0;
+
 NAN_MODULE_INIT(Adapter::Init)
 {
     v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
@@ -130,33 +134,294 @@ namespace {
             std::terminate();
         }
     }
+
+    std::remove_pointer<uv_timer_cb>::type event_batch_timeout_handler;
+    void event_batch_timeout_handler(uv_timer_t *handle)
+    {
+        auto adapter = static_cast<Adapter *>(handle->data);
+
+        if (adapter != nullptr)
+        {
+            adapter->eventBatchTimeoutCallback(handle);
+        }
+        else
+        {
+            std::cerr << "No AddOn adapter to process event batch timeout." << std::endl;
+            std::terminate();
+        }
+    }
+}
+
+// Under load if the previous batch went to JavaScript less than eventMaxLatency ago,
+// or if events queued up while the previous batch was collected
+bool Adapter::isEventLoadHigh() const
+{
+    auto sinceLastDispatch = std::chrono::steady_clock::now() - eventLastDispatch;
+
+    return sinceLastDispatch < std::chrono::milliseconds(eventMaxLatency)
+        || eventStats.getLastBatchSize() > 1;
+}
+
+// Now we are in the NodeJS thread. Starts coalescing events if under load, returns true if the
+// events shall stay in the queue until the batch is full or eventMaxLatency has passed.
+bool Adapter::coalesceEvents()
+{
+    if (eventMaxLatency == 0 || eventBatchCoalescing)
+    {
+        return false;
+    }
+
+    if (eventBatchPendingCount >= eventMaxBatchSize || !isEventLoadHigh())
+    {
+        return false;
+    }
+
+    eventBatchCoalescing = true;
+
+    if (uv_timer_start(eventIntervalTimer.get(), event_batch_timeout_handler, eventMaxLatency, 0) != 0)
+    {
+        std::cerr << "Not able to start the event batch timer." << std::endl;
+        eventBatchCoalescing = false;
+        return false;
+    }
+
+    return true;
+}
+
+// Now we are in the NodeJS thread. Send the coalesced events to JavaScript.
+void Adapter::flushEvents()
+{
+    if (eventBatchCoalescing)
+    {
+        uv_timer_stop(eventIntervalTimer.get());
+        eventCallbackBatchCoalescedCount += 1;
+    }
+    else
+    {
+        eventCallbackBatchImmediateCount += 1;
+    }
+
+    // Must be cleared before the queue is drained, appendEvent() wakes up NodeJS again for events
+    // pushed after this point. The pending count is lowered by createEventArray().
+    eventBatchCoalescing = false;
+
+    callEventCallback(createEventArray());
+
+    eventLastDispatch = std::chrono::steady_clock::now();
+}
+
+void Adapter::eventBatchTimeoutCallback(uv_timer_t *handle)
+{
+    Nan::HandleScope scope;
+
+    if (eventQueue.wasEmpty())
+    {
+        eventBatchCoalescing = false;
+        return;
+    }
+
+    flushEvents();
+}
+
+// This compilation unit will be linked several times. So the
+// shared event dispatcher must not have external linkage. Each
+// SoftDevice API version gets its own dispatcher.
+namespace {
+    struct shared_event_dispatcher_t
+    {
+        // Single wakeup source for all registered adapters. libuv
+        // coalesces uv_async_send calls made before the handler runs.
+        std::unique_ptr<uv_async_t> async;
+
+        // Protects adapters, which is modified from the thread opening
+        // an adapter and read from the NodeJS thread.
+        uv_mutex_t mutex;
+        std::vector<Adapter *> adapters;
+
+        // Optional callback receiving the events of all adapters, tagged by adapter.
+        // If not set, each adapter's own event callback is called from the shared wakeup.
+        std::unique_ptr<Nan::Callback> callback;
+    };
+
+    shared_event_dispatcher_t sharedEventDispatcher;
+
+    std::remove_pointer<uv_async_cb>::type shared_event_handler;
+    void shared_event_handler(uv_async_t *handle)
+    {
+        Adapter::onSharedEvent(handle);
+    }
+}
+
+void Adapter::initSharedEventDispatcher()
+{
+    if (sharedEventDispatcher.async != nullptr)
+    {
+        return;
+    }
+
+    if (uv_mutex_init(&sharedEventDispatcher.mutex) != 0)
+    {
+        std::cerr << "Not able to create shared event dispatcher mutex! Terminating." << std::endl;
+        std::terminate();
+    }
+
+    sharedEventDispatcher.async = std::make_unique<uv_async_t>();
+
+    if (uv_async_init(uv_default_loop(), sharedEventDispatcher.async.get(), shared_event_handler) != 0)
+    {
+        std::cerr << "Not able to create the shared event handler." << std::endl;
+        std::terminate();
+    }
+
+    // The handle lives as long as the module. It must not keep the event loop alive by itself,
+    // the status handle of each open adapter does that.
+    uv_unref(reinterpret_cast<uv_handle_t *>(sharedEventDispatcher.async.get()));
+}
+
+// Now we are in the NodeJS thread. Drain all registered adapters in one pass.
+void Adapter::onSharedEvent(uv_async_t *handle)
+{
+    Nan::HandleScope scope;
+
+    std::vector<std::pair<Adapter *, v8::Local<v8::Object>>> registered;
+
+    uv_mutex_lock(&sharedEventDispatcher.mutex);
+
+    for (auto adapter : sharedEventDispatcher.adapters)
+    {
+        // Holding the JavaScript object keeps the adapter alive while callbacks run below
+        registered.push_back(std::make_pair(adapter, adapter->handle()));
+    }
+
+    uv_mutex_unlock(&sharedEventDispatcher.mutex);
+
+    for (auto &entry : registered)
+    {
+        entry.first->onStatusEvent(handle);
+        entry.first->onLogEvent(handle);
+    }
+
+    auto batches = Nan::New<v8::Array>();
+    std::vector<std::pair<Adapter *, uint32_t>> batchAdapters;
+
+    for (auto &entry : registered)
+    {
+        auto adapter = entry.first;
+
+        if (adapter->eventQueue.wasEmpty())
+        {
+            continue;
+        }
+
+        auto events = adapter->createEventArray();
+
+        if (sharedEventDispatcher.callback == nullptr)
+        {
+            adapter->callEventCallback(events);
+            continue;
+        }
+
+        auto batch = Nan::New<v8::Object>();
+        Utility::Set(batch, "adapter", entry.second);
+        Utility::Set(batch, "events", events);
+        Nan::Set(batches, static_cast<uint32_t>(batchAdapters.size()), batch);
+        batchAdapters.push_back(std::make_pair(adapter, events->Length()));
+    }
+
+    if (batchAdapters.empty())
+    {
+        return;
+    }
+
+    v8::Local<v8::Value> callback_value[1];
+    callback_value[0] = batches;
+
+    auto start = std::chrono::steady_clock::now();
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    sharedEventDispatcher.callback->Call(1, callback_value, &resource);
+
+    // All adapters in the batch waited for the same callback, charge each of them the full duration
+    auto duration = std::chrono::steady_clock::now() - start;
+
+    for (auto &batchAdapter : batchAdapters)
+    {
+        batchAdapter.first->addEventBatchStatistics(batchAdapter.second, duration);
+    }
 }
 
-void Adapter::initEventHandling(std::unique_ptr<Nan::Callback> callback, uint32_t interval)
+// Wakes up the NodeJS thread, through the shared event dispatcher if this adapter is registered with it
+void Adapter::wakeUp(uv_async_t *handle)
+{
+    if (sharedEventDispatch)
+    {
+        uv_async_send(sharedEventDispatcher.async.get());
+    }
+    else if (handle != nullptr)
+    {
+        uv_async_send(handle);
+    }
+}
+
+NAN_METHOD(Adapter::SetSharedEventCallback)
+{
+    v8::Local<v8::Function> callback;
+
+    try
+    {
+        callback = ConversionUtility::getCallbackFunction(info[0]);
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    initSharedEventDispatcher();
+    sharedEventDispatcher.callback = std::make_unique<Nan::Callback>(callback);
+}
+
+void Adapter::initEventHandling(std::unique_ptr<Nan::Callback> callback, uint32_t interval,
+                                uint32_t maxLatency, uint32_t maxBatchSize, bool shared)
 {
     eventInterval = interval;
-    asyncEvent = std::make_unique<uv_async_t>();
+
+    // The shared event dispatcher drains all adapters in one pass, adaptive batching is not used with it
+    eventMaxLatency = shared ? 0 : maxLatency;
+    eventMaxBatchSize = std::max<uint32_t>(1, std::min<uint32_t>(maxBatchSize, EVENT_QUEUE_SIZE - 1));
+    eventBatchCoalescing = false;
+    eventBatchPendingCount = 0;
+    eventLastDispatch = std::chrono::steady_clock::time_point();
 
     // Setup event related functionality
     eventCallback = std::move(callback);
-    asyncEvent->data = static_cast<void *>(this);
 
-    if (uv_async_init(uv_default_loop(), asyncEvent.get(), event_handler) != 0)
+    if (shared)
     {
-        std::cerr << "Not able to create a new async event handler." << std::endl;
-        std::terminate();
+        uv_mutex_lock(&sharedEventDispatcher.mutex);
+        sharedEventDispatcher.adapters.push_back(this);
+        sharedEventDispatch = true;
+        uv_mutex_unlock(&sharedEventDispatcher.mutex);
     }
+    else
+    {
+        asyncEvent = std::make_unique<uv_async_t>();
+        asyncEvent->data = static_cast<void *>(this);
 
-    // Clear the statistics
-    eventCallbackCount = 0;
+        if (uv_async_init(uv_default_loop(), asyncEvent.get(), event_handler) != 0)
+        {
+            std::cerr << "Not able to create a new async event handler." << std::endl;
+            std::terminate();
+        }
+    }
 
-    // Max number of events in queue before sending it to JavaScript
-    eventCallbackMaxCount = 0;
-    eventCallbackBatchEventCounter = 0;
-    eventCallbackBatchEventTotalCount = 0;
-    eventCallbackBatchNumber = 0;
+    // Clear the statistics
+    eventStats.reset();
+    eventCallbackBatchImmediateCount = 0;
+    eventCallbackBatchCoalescedCount = 0;
 
-    if (eventInterval == 0)
+    if (eventInterval == 0 && eventMaxLatency == 0)
     {
         return;
     }
@@ -175,6 +440,12 @@ void Adapter::initEventHandling(std::unique_ptr<Nan::Callback> callback, uint32_
         std::terminate();
     }
 
+    if (eventMaxLatency != 0)
+    {
+        // Adaptive event batching starts the timer on demand, when events are coalesced under load
+        return;
+    }
+
     if (uv_timer_start(eventIntervalTimer.get(), event_interval_handler, eventInterval, eventInterval) != 0)
     {
         std::cerr << "Not able to create a new event interval handler." << std::endl;
@@ -218,6 +489,10 @@ void Adapter::initLogHandling(std::unique_ptr<Nan::Callback> callback)
     logCallback = std::move(callback);
     asyncLog->data = static_cast<void *>(this);
 
+    logDroppedCount = 0;
+    logDroppedPendingCount = 0;
+    logTruncatedCount = 0;
+
     if (uv_async_init(uv_default_loop(), asyncLog.get(), log_handler) != 0)
     {
         std::cerr << "Not able to create a new event log handler." << std::endl;
@@ -268,6 +543,252 @@ void Adapter::initStatusHandling(std::unique_ptr<Nan::Callback> callback)
     }
 }
 
+// This compilation unit will be linked several times. So
+// lesc_dhkey_handler must not have external linkage.
+namespace {
+    std::remove_pointer<uv_async_cb>::type lesc_dhkey_handler;
+    void lesc_dhkey_handler(uv_async_t *handle)
+    {
+        auto adapter = static_cast<Adapter *>(handle->data);
+
+        if (adapter != nullptr)
+        {
+            adapter->onLescDhKeyEvent(handle);
+        }
+        else
+        {
+            std::cerr << "No AddOn adapter to process LESC DH key event." << std::endl;
+            std::terminate();
+        }
+    }
+}
+
+// This runs in Main Thread
+void Adapter::initLescDhKeyHandling(std::unique_ptr<Nan::Callback> callback)
+{
+    lescDhKeyCallback = std::move(callback);
+
+    if (asyncLescDhKey != nullptr)
+    {
+        return;
+    }
+
+    asyncLescDhKey = std::make_unique<uv_async_t>();
+    asyncLescDhKey->data = static_cast<void *>(this);
+
+    if (uv_async_init(uv_default_loop(), asyncLescDhKey.get(), lesc_dhkey_handler) != 0)
+    {
+        std::cerr << "Not able to create a new LESC DH key handler." << std::endl;
+        std::terminate();
+    }
+}
+
+// This compilation unit will be linked several times. So
+// event_replay_handler must not have external linkage.
+namespace {
+    std::remove_pointer<uv_async_cb>::type event_replay_handler;
+    void event_replay_handler(uv_async_t *handle)
+    {
+        auto adapter = static_cast<Adapter *>(handle->data);
+
+        if (adapter != nullptr)
+        {
+            adapter->onEventReplayEvent(handle);
+        }
+        else
+        {
+            std::cerr << "No AddOn adapter to process event replay completion." << std::endl;
+            std::terminate();
+        }
+    }
+}
+
+// This runs in Main Thread
+void Adapter::initEventReplayHandling(std::unique_ptr<Nan::Callback> callback)
+{
+    eventReplayCallback = std::move(callback);
+
+    if (asyncEventReplay != nullptr)
+    {
+        return;
+    }
+
+    asyncEventReplay = std::make_unique<uv_async_t>();
+    asyncEventReplay->data = static_cast<void *>(this);
+
+    if (uv_async_init(uv_default_loop(), asyncEventReplay.get(), event_replay_handler) != 0)
+    {
+        std::cerr << "Not able to create a new event replay handler." << std::endl;
+        std::terminate();
+    }
+}
+
+// This compilation unit will be linked several times. So
+// long_read_handler must not have external linkage.
+namespace {
+    std::remove_pointer<uv_async_cb>::type long_read_handler;
+    void long_read_handler(uv_async_t *handle)
+    {
+        auto adapter = static_cast<Adapter *>(handle->data);
+
+        if (adapter != nullptr)
+        {
+            adapter->onLongReadEvent(handle);
+        }
+        else
+        {
+            std::cerr << "No AddOn adapter to process long read completion." << std::endl;
+            std::terminate();
+        }
+    }
+}
+
+// This runs in Main Thread
+void Adapter::initLongReadHandling()
+{
+    if (asyncLongRead != nullptr)
+    {
+        return;
+    }
+
+    asyncLongRead = std::make_unique<uv_async_t>();
+    asyncLongRead->data = static_cast<void *>(this);
+
+    if (uv_async_init(uv_default_loop(), asyncLongRead.get(), long_read_handler) != 0)
+    {
+        std::cerr << "Not able to create a new long read handler." << std::endl;
+        std::terminate();
+    }
+
+    auto async = asyncLongRead.get();
+
+    longReads.setHandlers(
+        [this](uint16_t connHandle, uint16_t handle, uint16_t offset) {
+            auto result = sd_ble_gattc_read(adapter, connHandle, handle, offset);
+
+            if (result == NRF_SUCCESS)
+            {
+                linkStats.onRequest(connHandle, LINK_STATS_PACKET_READ);
+            }
+
+            return result;
+        },
+        [async]() {
+            uv_async_send(async);
+        });
+}
+
+// This compilation unit will be linked several times. So
+// long_write_handler must not have external linkage.
+namespace {
+    std::remove_pointer<uv_async_cb>::type long_write_handler;
+    void long_write_handler(uv_async_t *handle)
+    {
+        auto adapter = static_cast<Adapter *>(handle->data);
+
+        if (adapter != nullptr)
+        {
+            adapter->onLongWriteEvent(handle);
+        }
+        else
+        {
+            std::cerr << "No AddOn adapter to process long write completion." << std::endl;
+            std::terminate();
+        }
+    }
+}
+
+// This runs in Main Thread
+void Adapter::initLongWriteHandling()
+{
+    if (asyncLongWrite != nullptr)
+    {
+        return;
+    }
+
+    asyncLongWrite = std::make_unique<uv_async_t>();
+    asyncLongWrite->data = static_cast<void *>(this);
+
+    if (uv_async_init(uv_default_loop(), asyncLongWrite.get(), long_write_handler) != 0)
+    {
+        std::cerr << "Not able to create a new long write handler." << std::endl;
+        std::terminate();
+    }
+
+    auto async = asyncLongWrite.get();
+
+    longWrites.setHandlers(
+        [this](uint16_t connHandle, uint8_t writeOp, uint8_t flags, uint16_t handle, uint16_t offset, const uint8_t *data, uint16_t length) {
+            ble_gattc_write_params_t params;
+            params.write_op = writeOp;
+            params.flags = flags;
+            params.handle = handle;
+            params.offset = offset;
+            params.len = length;
+            params.p_value = data;
+
+            auto result = sd_ble_gattc_write(adapter, connHandle, &params);
+            trackLinkTx(connHandle, LINK_STATS_PACKET_WRITE, length, result);
+
+            return result;
+        },
+        [async]() {
+            uv_async_send(async);
+        });
+}
+
+// This compilation unit will be linked several times. So
+// connect_scheduler_handler must not have external linkage.
+namespace {
+    std::remove_pointer<uv_async_cb>::type connect_scheduler_handler;
+    void connect_scheduler_handler(uv_async_t *handle)
+    {
+        auto adapter = static_cast<Adapter *>(handle->data);
+
+        if (adapter != nullptr)
+        {
+            adapter->onConnectSchedulerEvent(handle);
+        }
+        else
+        {
+            std::cerr << "No AddOn adapter to process scheduled connect completion." << std::endl;
+            std::terminate();
+        }
+    }
+}
+
+// This runs in Main Thread
+void Adapter::initConnectSchedulerHandling()
+{
+    if (asyncConnectScheduler == nullptr)
+    {
+        asyncConnectScheduler = std::make_unique<uv_async_t>();
+        asyncConnectScheduler->data = static_cast<void *>(this);
+
+        if (uv_async_init(uv_default_loop(), asyncConnectScheduler.get(), connect_scheduler_handler) != 0)
+        {
+            std::cerr << "Not able to create a new scheduled connect handler." << std::endl;
+            std::terminate();
+        }
+    }
+
+    // The scheduler is stopped when the adapter is closed
+    if (connectScheduler.isRunning())
+    {
+        return;
+    }
+
+    auto async = asyncConnectScheduler.get();
+
+    connectScheduler.start(
+        [this]() {
+            return sd_ble_gap_connect_cancel(adapter);
+        },
+        [async]() {
+            uv_async_send(async);
+        });
+}
+
 // Helper function for cleanUpV8Resources for closing uv_*_t
 // handles. It is also suitable as a Deleter (template argment
 // of unique_ptr).
@@ -295,6 +816,53 @@ void Adapter::cleanUpV8Resources()
 {
     uv_mutex_lock(&adapterCloseMutex);
 
+    // Stop the worker first, it signals asyncLescDhKey
+    lescDhKeyWorker.stop();
+
+    if (asyncLescDhKey != nullptr)
+    {
+        close_uv_handle(std::move(asyncLescDhKey));
+        this->lescDhKeyCallback.reset();
+    }
+
+    // Remove the handlers first, they signal asyncLongRead
+    longReads.removeHandlers();
+
+    if (asyncLongRead != nullptr)
+    {
+        close_uv_handle(std::move(asyncLongRead));
+        this->longReadCallbacks.clear();
+    }
+
+    // Remove the handlers first, they signal asyncLongWrite
+    longWrites.removeHandlers();
+
+    if (asyncLongWrite != nullptr)
+    {
+        close_uv_handle(std::move(asyncLongWrite));
+        this->longWriteCallbacks.clear();
+    }
+
+    // Stop the scheduler first, it signals asyncConnectScheduler. The targets it aborts are
+    // reported before the callbacks are released.
+    connectScheduler.stop();
+
+    if (asyncConnectScheduler != nullptr)
+    {
+        onConnectSchedulerEvent(asyncConnectScheduler.get());
+        close_uv_handle(std::move(asyncConnectScheduler));
+        this->connectCallbacks.clear();
+    }
+
+    // Stop the replay before the event handles are closed, it signals asyncEventReplay
+    eventReplay.stop();
+
+    if (asyncEventReplay != nullptr)
+    {
+        close_uv_handle(std::move(asyncEventReplay));
+        this->eventReplayCallback.reset();
+    }
+
     if (asyncStatus != nullptr)
     {
         close_uv_handle(std::move(asyncStatus));
@@ -313,6 +881,17 @@ void Adapter::cleanUpV8Resources()
         this->eventCallback.reset();
     }
 
+    if (sharedEventDispatch)
+    {
+        uv_mutex_lock(&sharedEventDispatcher.mutex);
+        auto &registered = sharedEventDispatcher.adapters;
+        registered.erase(std::remove(registered.begin(), registered.end(), this), registered.end());
+        sharedEventDispatch = false;
+        uv_mutex_unlock(&sharedEventDispatcher.mutex);
+
+        this->eventCallback.reset();
+    }
+
     if (asyncLog != nullptr)
     {
         close_uv_handle(std::move(asyncLog));
@@ -332,11 +911,20 @@ void Adapter::initGeneric(v8::Local<v8::FunctionTemplate> tpl)
     Nan::SetPrototypeMethod(tpl, "addVendorspecificUUID", AddVendorSpecificUUID);
     Nan::SetPrototypeMethod(tpl, "encodeUUID", EncodeUUID);
     Nan::SetPrototypeMethod(tpl, "decodeUUID", DecodeUUID);
+    Nan::SetPrototypeMethod(tpl, "encodeUUIDSync", EncodeUUIDSync);
+    Nan::SetPrototypeMethod(tpl, "decodeUUIDSync", DecodeUUIDSync);
     Nan::SetPrototypeMethod(tpl, "replyUserMemory", ReplyUserMemory);
     Nan::SetPrototypeMethod(tpl, "setBleOption", SetBleOption);
     Nan::SetPrototypeMethod(tpl, "getBleOption", GetBleOption);
 
     Nan::SetPrototypeMethod(tpl, "getStats", GetStats);
+    Nan::SetMethod(tpl, "setSharedEventCallback", SetSharedEventCallback);
+    Nan::SetPrototypeMethod(tpl, "startEventTrace", StartEventTrace);
+    Nan::SetPrototypeMethod(tpl, "stopEventTrace", StopEventTrace);
+    Nan::SetPrototypeMethod(tpl, "startEventReplay", StartEventReplay);
+    Nan::SetPrototypeMethod(tpl, "stopEventReplay", StopEventReplay);
+    Nan::SetPrototypeMethod(tpl, "getMethodStats", GetMethodStats);
+    Nan::SetPrototypeMethod(tpl, "resetMethodStats", ResetMethodStats);
 
 #if NRF_SD_BLE_API_VERSION >= 5
     Nan::SetPrototypeMethod(tpl, "setBleConfig", SetBleConfig);
@@ -377,9 +965,23 @@ void Adapter::initGap(v8::Local<v8::FunctionTemplate> tpl)
     Nan::SetPrototypeMethod(tpl, "gapNotifyKeypress", GapNotifyKeypress);
     Nan::SetPrototypeMethod(tpl, "gapGetLescOobData", GapGetLESCOOBData);
     Nan::SetPrototypeMethod(tpl, "gapSetLescOobData", GapSetLESCOOBData);
+    Nan::SetPrototypeMethod(tpl, "gapWhitelistSet", GapWhitelistSet);
+    Nan::SetPrototypeMethod(tpl, "gapDeviceIdentitiesSet", GapDeviceIdentitiesSet);
+    Nan::SetPrototypeMethod(tpl, "gapEnableBondStore", GapEnableBondStore);
+    Nan::SetPrototypeMethod(tpl, "gapDisableBondStore", GapDisableBondStore);
+    Nan::SetPrototypeMethod(tpl, "gapGetBonds", GapGetBonds);
+    Nan::SetPrototypeMethod(tpl, "gapDeleteBond", GapDeleteBond);
+    Nan::SetPrototypeMethod(tpl, "gapEnableLescDhKeyAutoReply", GapEnableLescDhKeyAutoReply);
+    Nan::SetPrototypeMethod(tpl, "gapDisableLescDhKeyAutoReply", GapDisableLescDhKeyAutoReply);
+    Nan::SetPrototypeMethod(tpl, "gapSetConnParamPolicy", GapSetConnParamPolicy);
+    Nan::SetPrototypeMethod(tpl, "gapClearConnParamPolicy", GapClearConnParamPolicy);
+    Nan::SetPrototypeMethod(tpl, "gapScheduleConnect", GapScheduleConnect);
+    Nan::SetPrototypeMethod(tpl, "gapCancelScheduledConnect", GapCancelScheduledConnect);
+    Nan::SetPrototypeMethod(tpl, "gapGetWhitelist", GapGetWhitelist);
 #if NRF_SD_BLE_API_VERSION >= 5
     Nan::SetPrototypeMethod(tpl, "gapDataLengthUpdate", GapDataLengthUpdate);
     Nan::SetPrototypeMethod(tpl, "gapPhyUpdate", GapPhyUpdate);
+    Nan::SetPrototypeMethod(tpl, "gapSetLinkPolicy", GapSetLinkPolicy);
 #endif
 }
 
@@ -391,8 +993,10 @@ void Adapter::initGattC(v8::Local<v8::FunctionTemplate> tpl)
     Nan::SetPrototypeMethod(tpl, "gattcDiscoverDescriptors", GattcDiscoverDescriptors);
     Nan::SetPrototypeMethod(tpl, "gattcReadCharacteristicValueByUUID", GattcReadCharacteristicValueByUUID);
     Nan::SetPrototypeMethod(tpl, "gattcRead", GattcRead);
+    Nan::SetPrototypeMethod(tpl, "gattcReadLong", GattcReadLong);
     Nan::SetPrototypeMethod(tpl, "gattcReadCharacteristicValues", GattcReadCharacteristicValues);
     Nan::SetPrototypeMethod(tpl, "gattcWrite", GattcWrite);
+    Nan::SetPrototypeMethod(tpl, "gattcWriteLong", GattcWriteLong);
     Nan::SetPrototypeMethod(tpl, "gattcConfirmHandleValue", GattcConfirmHandleValue);
 #if NRF_SD_BLE_API_VERSION >= 5
     Nan::SetPrototypeMethod(tpl, "gattcExchangeMtuRequest", GattcExchangeMtuRequest);
@@ -404,6 +1008,12 @@ void Adapter::initGattS(v8::Local<v8::FunctionTemplate> tpl)
     Nan::SetPrototypeMethod(tpl, "gattsAddService", GattsAddService);
     Nan::SetPrototypeMethod(tpl, "gattsAddCharacteristic", GattsAddCharacteristic);
     Nan::SetPrototypeMethod(tpl, "gattsAddDescriptor", GattsAddDescriptor);
+    Nan::SetPrototypeMethod(tpl, "gattsBuildTable", GattsBuildTable);
+    Nan::SetPrototypeMethod(tpl, "gattsNotifyAll", GattsNotifyAll);
+    Nan::SetPrototypeMethod(tpl, "gattsSetAuthorizePolicy", GattsSetAuthorizePolicy);
+    Nan::SetPrototypeMethod(tpl, "gattsClearAuthorizePolicy", GattsClearAuthorizePolicy);
+    Nan::SetPrototypeMethod(tpl, "gattsSetAuthorizeValue", GattsSetAuthorizeValue);
+    Nan::SetPrototypeMethod(tpl, "gattsGetAuthorizeValue", GattsGetAuthorizeValue);
     Nan::SetPrototypeMethod(tpl, "gattsHVX", GattsHVX);
     Nan::SetPrototypeMethod(tpl, "gattsSystemAttributeSet", GattsSystemAttributeSet);
     Nan::SetPrototypeMethod(tpl, "gattsSetValue", GattsSetValue);
@@ -417,11 +1027,35 @@ void Adapter::initGattS(v8::Local<v8::FunctionTemplate> tpl)
 Adapter::Adapter()
 {
     adapter = nullptr;
+    adapterId = nextAdapterId++;
+    sharedEventDispatch = false;
+
+    eventCallbackBatchImmediateCount = 0;
+    eventCallbackBatchCoalescedCount = 0;
+
+    eventInterval = 0;
+    eventMaxLatency = 0;
+    eventMaxBatchSize = EVENT_BATCH_SIZE_DEFAULT;
+    eventBatchCoalescing = false;
+    eventBatchPendingCount = 0;
+
+    bondStoreAutoReply = false;
+    bondStoreAutoEncrypt = false;
+    bondStoreSecInfoReplyCount = 0;
+    bondStoreEncryptCount = 0;
 
-    eventCallbackMaxCount = 0;
-    eventCallbackBatchEventCounter = 0;
-    eventCallbackBatchEventTotalCount = 0;
-    eventCallbackBatchNumber = 0;
+    nextLongReadId = 0;
+    nextLongWriteId = 0;
+    nextConnectId = 0;
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    configuredAttMtu = BLE_GATT_ATT_MTU_DEFAULT;
+#endif
+
+    logSeverityFilter = SD_RPC_LOG_TRACE;
+    logDroppedCount = 0;
+    logDroppedPendingCount = 0;
+    logTruncatedCount = 0;
 
     if (uv_mutex_init(&adapterCloseMutex) != 0)
     {
@@ -458,50 +1092,29 @@ NAN_METHOD(Adapter::New)
     }
 }
 
-int32_t Adapter::getEventCallbackTotalTime() const
-{
-    return static_cast<int32_t>(eventCallbackDuration.count());
-}
-
-uint32_t Adapter::getEventCallbackCount() const
-{
-    return eventCallbackCount;
-}
-
-uint32_t Adapter::getEventCallbackMaxCount() const
+uint32_t Adapter::getEventCallbackBatchImmediateCount() const
 {
-    return eventCallbackMaxCount;
+    return eventCallbackBatchImmediateCount;
 }
 
-uint32_t Adapter::getEventCallbackBatchNumber() const
+uint32_t Adapter::getEventCallbackBatchCoalescedCount() const
 {
-    return eventCallbackBatchNumber;
+    return eventCallbackBatchCoalescedCount;
 }
 
-uint32_t Adapter::getEventCallbackBatchEventTotalCount() const
+uint32_t Adapter::getLogDroppedCount() const
 {
-    return eventCallbackBatchEventTotalCount;
+    return logDroppedCount;
 }
 
-double Adapter::getAverageCallbackBatchCount() const
+uint32_t Adapter::getLogTruncatedCount() const
 {
-    auto averageCallbackBatchCount = 0.0;
-
-    if (getEventCallbackBatchNumber() != 0)
-    {
-        averageCallbackBatchCount = getEventCallbackBatchEventTotalCount() / getEventCallbackBatchNumber();
-    }
-
-    return averageCallbackBatchCount;
+    return logTruncatedCount;
 }
 
-void Adapter::addEventBatchStatistics(std::chrono::milliseconds duration)
+void Adapter::addEventBatchStatistics(const uint32_t batchSize, const std::chrono::steady_clock::duration duration)
 {
-    eventCallbackDuration += duration;
-
-    eventCallbackBatchEventTotalCount += eventCallbackBatchEventCounter;
-    eventCallbackBatchEventCounter = 0;
-    eventCallbackBatchNumber += 1;
+    eventStats.onBatchDelivered(batchSize, duration);
 }
 
 void Adapter::createSecurityKeyStorage(const uint16_t connHandle, ble_gap_sec_keyset_t *keyset)
@@ -38,18 +38,38 @@
 #define ADAPTER_H
 
 #include <nan.h>
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <memory>
 
 #include "sd_rpc.h"
 
+#include "authorize_policy.h"
+#include "bond_store.h"
 #include "circular_fifo_unsafe.h"
+#include "conn_param_policy.h"
+#include "connect_scheduler.h"
+#include "event_replay.h"
+#include "event_stats.h"
+#include "event_trace.h"
+#include "lesc_dhkey_worker.h"
+#include "link_policy.h"
+#include "link_stats.h"
+#include "long_read_engine.h"
+#include "long_write_engine.h"
+#include "notification_fanout.h"
+#include "simulated_connectivity.h"
+#include "vendor_uuid_registry.h"
+#include "whitelist_mirror.h"
 
 const auto EVENT_QUEUE_SIZE = 64;
-const auto LOG_QUEUE_SIZE = 64;
+const auto LOG_QUEUE_SIZE = 256;
 const auto STATUS_QUEUE_SIZE = 64;
 
+// Default max number of events coalesced by adaptive event batching, leaves headroom in the event queue
+const auto EVENT_BATCH_SIZE_DEFAULT = EVENT_QUEUE_SIZE / 2;
+
 #define ADAPTER_METHOD_DEFINITIONS(MainName) \
     static NAN_METHOD(MainName); \
     static void MainName(uv_work_t *req); \
@@ -82,11 +102,16 @@ struct enable_ble_params_t {
 #endif
 };
 
+// Max length of a log message stored in the log queue, longer messages are truncated
+const auto LOG_MESSAGE_MAX_LENGTH = 255;
+
+// Log entries are stored by value in a preallocated queue, so logging does not allocate memory
 struct LogEntry
 {
 public:
     sd_rpc_log_severity_t severity;
-    std::string message;
+    size_t length;
+    char message[LOG_MESSAGE_MAX_LENGTH];
 };
 
 struct EventEntry
@@ -94,7 +119,9 @@ struct EventEntry
 public:
     ble_evt_t *event;
     std::string timestamp;
+    std::chrono::steady_clock::time_point received;
     int adapterID;
+    bool answeredByPolicy; // The request was already answered by the link policy, see replyFromLinkPolicy
 };
 
 struct StatusEntry
@@ -109,7 +136,7 @@ public:
 using namespace memory_sequential_unsafe;
 
 typedef CircularFifo<EventEntry *, EVENT_QUEUE_SIZE> EventQueue;
-typedef CircularFifo<LogEntry *, LOG_QUEUE_SIZE> LogQueue;
+typedef CircularFifo<LogEntry, LOG_QUEUE_SIZE> LogQueue;
 typedef CircularFifo<StatusEntry *, STATUS_QUEUE_SIZE> StatusQueue;
 
 class Adapter : public Nan::ObjectWrap
@@ -121,14 +148,21 @@ public:
 
     adapter_t *getInternalAdapter() const;
 
-    void initEventHandling(std::unique_ptr<Nan::Callback> callback, const uint32_t interval);
+    void initEventHandling(std::unique_ptr<Nan::Callback> callback, const uint32_t interval,
+                           const uint32_t maxLatency = 0, const uint32_t maxBatchSize = EVENT_BATCH_SIZE_DEFAULT,
+                           const bool shared = false);
     void appendEvent(ble_evt_t *event);
 
     void onRpcEvent(uv_async_t *handle);
     void eventIntervalCallback(uv_timer_t *handle);
+    void eventBatchTimeoutCallback(uv_timer_t *handle);
+
+    // Shared event dispatcher, one wakeup and one JavaScript callback for all adapters that opt in
+    static void initSharedEventDispatcher();
+    static void onSharedEvent(uv_async_t *handle);
 
     void initLogHandling(std::unique_ptr<Nan::Callback> callback);
-    void appendLog(LogEntry *log);
+    void appendLog(sd_rpc_log_severity_t severity, const char *message);
 
     void onLogEvent(uv_async_t *handle);
 
@@ -137,18 +171,31 @@ public:
 
     void onStatusEvent(uv_async_t *handle);
 
+    void initLescDhKeyHandling(std::unique_ptr<Nan::Callback> callback);
+    void onLescDhKeyEvent(uv_async_t *handle);
+
+    void initEventReplayHandling(std::unique_ptr<Nan::Callback> callback);
+    void onEventReplayEvent(uv_async_t *handle);
+
+    void initLongReadHandling();
+    void onLongReadEvent(uv_async_t *handle);
+
+    void initLongWriteHandling();
+    void onLongWriteEvent(uv_async_t *handle);
+
+    void initConnectSchedulerHandling();
+    void onConnectSchedulerEvent(uv_async_t *handle);
+
     void cleanUpV8Resources();
 
     // Statistics:
-    int32_t getEventCallbackTotalTime() const;
-    uint32_t getEventCallbackCount() const;
-    uint32_t getEventCallbackMaxCount() const;
-    uint32_t getEventCallbackBatchNumber() const;
-    uint32_t getEventCallbackBatchEventTotalCount() const;
+    uint32_t getEventCallbackBatchImmediateCount() const;
+    uint32_t getEventCallbackBatchCoalescedCount() const;
 
-    double getAverageCallbackBatchCount() const;
+    uint32_t getLogDroppedCount() const;
+    uint32_t getLogTruncatedCount() const;
 
-    void addEventBatchStatistics(std::chrono::milliseconds duration);
+    void addEventBatchStatistics(const uint32_t batchSize, const std::chrono::steady_clock::duration duration);
 
 private:
     explicit Adapter();
@@ -167,6 +214,8 @@ private:
     ADAPTER_METHOD_DEFINITIONS(AddVendorSpecificUUID);
     ADAPTER_METHOD_DEFINITIONS(EncodeUUID);
     ADAPTER_METHOD_DEFINITIONS(DecodeUUID);
+    static NAN_METHOD(EncodeUUIDSync);
+    static NAN_METHOD(DecodeUUIDSync);
     ADAPTER_METHOD_DEFINITIONS(ReplyUserMemory);
     ADAPTER_METHOD_DEFINITIONS(SetBleOption);
     ADAPTER_METHOD_DEFINITIONS(GetBleOption);
@@ -177,6 +226,13 @@ private:
 
     // General sync methods
     static NAN_METHOD(GetStats);
+    static NAN_METHOD(SetSharedEventCallback);
+    static NAN_METHOD(StartEventTrace);
+    static NAN_METHOD(StopEventTrace);
+    static NAN_METHOD(StartEventReplay);
+    static NAN_METHOD(StopEventReplay);
+    static NAN_METHOD(GetMethodStats);
+    static NAN_METHOD(ResetMethodStats);
 
     // Gap async mehtods
     ADAPTER_METHOD_DEFINITIONS(GapSetAddress);
@@ -212,9 +268,25 @@ private:
     ADAPTER_METHOD_DEFINITIONS(GapGetLESCOOBData);
 
     ADAPTER_METHOD_DEFINITIONS(GapSetLESCOOBData);
+    ADAPTER_METHOD_DEFINITIONS(GapWhitelistSet);
+    ADAPTER_METHOD_DEFINITIONS(GapDeviceIdentitiesSet);
+
+    // Gap sync methods
+    static NAN_METHOD(GapEnableBondStore);
+    static NAN_METHOD(GapDisableBondStore);
+    static NAN_METHOD(GapGetBonds);
+    static NAN_METHOD(GapDeleteBond);
+    static NAN_METHOD(GapEnableLescDhKeyAutoReply);
+    static NAN_METHOD(GapDisableLescDhKeyAutoReply);
+    static NAN_METHOD(GapSetConnParamPolicy);
+    static NAN_METHOD(GapClearConnParamPolicy);
+    static NAN_METHOD(GapScheduleConnect);
+    static NAN_METHOD(GapCancelScheduledConnect);
+    static NAN_METHOD(GapGetWhitelist);
 #if NRF_SD_BLE_API_VERSION >= 5
     ADAPTER_METHOD_DEFINITIONS(GapDataLengthUpdate);
     ADAPTER_METHOD_DEFINITIONS(GapPhyUpdate);
+    ADAPTER_METHOD_DEFINITIONS(GapSetLinkPolicy);
 #endif
 
     // Gattc async mehtods
@@ -224,8 +296,10 @@ private:
     ADAPTER_METHOD_DEFINITIONS(GattcDiscoverDescriptors);
     ADAPTER_METHOD_DEFINITIONS(GattcReadCharacteristicValueByUUID);
     ADAPTER_METHOD_DEFINITIONS(GattcRead);
+    ADAPTER_METHOD_DEFINITIONS(GattcReadLong);
     ADAPTER_METHOD_DEFINITIONS(GattcReadCharacteristicValues);
     ADAPTER_METHOD_DEFINITIONS(GattcWrite);
+    ADAPTER_METHOD_DEFINITIONS(GattcWriteLong);
     ADAPTER_METHOD_DEFINITIONS(GattcConfirmHandleValue);
 #if NRF_SD_BLE_API_VERSION >= 5
     ADAPTER_METHOD_DEFINITIONS(GattcExchangeMtuRequest);
@@ -235,6 +309,12 @@ private:
     ADAPTER_METHOD_DEFINITIONS(GattsAddService);
     ADAPTER_METHOD_DEFINITIONS(GattsAddCharacteristic);
     ADAPTER_METHOD_DEFINITIONS(GattsAddDescriptor);
+    ADAPTER_METHOD_DEFINITIONS(GattsBuildTable);
+    ADAPTER_METHOD_DEFINITIONS(GattsNotifyAll);
+    static NAN_METHOD(GattsSetAuthorizePolicy);
+    static NAN_METHOD(GattsClearAuthorizePolicy);
+    static NAN_METHOD(GattsSetAuthorizeValue);
+    static NAN_METHOD(GattsGetAuthorizeValue);
     ADAPTER_METHOD_DEFINITIONS(GattsHVX);
     ADAPTER_METHOD_DEFINITIONS(GattsSystemAttributeSet);
     ADAPTER_METHOD_DEFINITIONS(GattsSetValue);
@@ -250,6 +330,13 @@ private:
     static void initGattS(v8::Local<v8::FunctionTemplate> tpl);
 
     void dispatchEvents();
+    bool handleEventNatively(ble_evt_t *event, bool &answeredByPolicy);
+    void wakeUp(uv_async_t *handle);
+    bool isEventLoadHigh() const;
+    bool coalesceEvents();
+    void flushEvents();
+    v8::Local<v8::Array> createEventArray();
+    void callEventCallback(v8::Local<v8::Array> events);
 
     static uint32_t enableBLE(adapter_t *adapter, enable_ble_params_t *enable_params);
 
@@ -259,6 +346,94 @@ private:
 
     std::map<uint16_t, ble_gap_sec_keyset_t *> keysetMap;
 
+    // Bond store, answers SEC_INFO_REQUEST and encrypts links to bonded peers without involving JavaScript
+    void trackBondEvent(ble_evt_t *event);
+    bool replySecurityInfoFromBondStore(const ble_gap_evt_t *gapEvent);
+    void encryptFromBondStore(const ble_gap_evt_t *gapEvent);
+
+    BondStore bondStore;
+    std::atomic<bool> bondStoreAutoReply;
+    std::atomic<bool> bondStoreAutoEncrypt;
+    std::atomic<uint32_t> bondStoreSecInfoReplyCount;
+    std::atomic<uint32_t> bondStoreEncryptCount;
+
+    // LESC DH key auto reply, computes the DH key and replies to the SoftDevice without involving JavaScript
+    bool submitLescDhKeyRequest(const ble_gap_evt_t *gapEvent);
+
+    LescDhKeyWorker lescDhKeyWorker;
+    std::unique_ptr<uv_async_t> asyncLescDhKey;
+    std::unique_ptr<Nan::Callback> lescDhKeyCallback;
+
+    // Per connection link statistics, reported by getStats
+    void trackLinkEvent(const ble_evt_t *event);
+    void trackLinkTx(const uint16_t connHandle, const link_stats_packet_t type, const uint16_t length, const uint32_t result);
+
+    LinkStats linkStats;
+
+    // Vendor specific UUID bases known by the SoftDevice, resolves UUIDs without a round trip
+    VendorUuidRegistry vendorUuids;
+
+    // CCCD state per link and notifications waiting for TX buffers, see gattsNotifyAll
+    notification_send_result_t sendNotification(const uint16_t connHandle, const uint16_t valueHandle, const uint8_t type, const std::vector<uint8_t> &data);
+    void resumeNotifications(const uint16_t connHandle);
+
+    NotificationFanout notificationFanout;
+
+    // Replies to read and write authorization requests according to a per handle policy, without involving JavaScript
+    bool replyAuthorizeFromPolicy(const ble_gatts_evt_t *gattsEvent);
+
+    AuthorizePolicy authorizePolicy;
+
+    // Long reads continued from the event thread, the callbacks are only accessed in the Main Thread. See gattcReadLong
+    LongReadEngine longReads;
+    std::unique_ptr<uv_async_t> asyncLongRead;
+    std::map<uint32_t, std::unique_ptr<Nan::Callback>> longReadCallbacks;
+    uint32_t nextLongReadId;
+
+    // Prepared write queues continued from the event thread, the callbacks are only accessed in the Main Thread. See gattcWriteLong
+    bool continueLongWrite(const ble_gattc_evt_t *gattcEvent);
+
+    LongWriteEngine longWrites;
+    std::unique_ptr<uv_async_t> asyncLongWrite;
+    std::map<uint32_t, std::unique_ptr<Nan::Callback>> longWriteCallbacks;
+    uint32_t nextLongWriteId;
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    // Negotiates MTU, data length and PHY when a link is established and answers the peer's requests. See gapSetLinkPolicy
+    void applyLinkPolicy(const uint16_t connHandle);
+    bool replyFromLinkPolicy(const ble_evt_t *event);
+
+    // ATT MTU the SoftDevice was configured with, the link policy can not request or reply with a larger one
+    std::atomic<uint16_t> configuredAttMtu;
+#endif
+
+    LinkPolicy linkPolicy;
+
+    // Answers connection parameter update requests from peripherals without involving JavaScript
+    bool replyConnParamsFromPolicy(const ble_gap_evt_t *gapEvent);
+
+    ConnParamPolicy connParamPolicy;
+
+    // Central connects started one after the other from the scheduler thread, the callbacks are only accessed in the Main Thread. See gapScheduleConnect
+    ConnectScheduler connectScheduler;
+    std::unique_ptr<uv_async_t> asyncConnectScheduler;
+    std::map<uint32_t, std::unique_ptr<Nan::Callback>> connectCallbacks;
+    uint32_t nextConnectId;
+
+    // The whitelist and device identities set in the SoftDevice, shared by scanning and connecting. See gapWhitelistSet
+    WhitelistMirror whitelist;
+
+    void clearSoftDeviceState();
+
+    adapter_t *openSimulated(const simulated_connectivity_params_t &params);
+
+    // Set if the adapter is opened with the simulated physical layer, completes the async methods instead of the SoftDevice.
+    // Assigned in the Open worker and read from all threads, only accessed atomically through the methods below.
+    std::shared_ptr<SimulatedConnectivity> simulatedConnectivity;
+
+    std::shared_ptr<SimulatedConnectivity> getSimulatedConnectivity();
+    void setSimulatedConnectivity(std::shared_ptr<SimulatedConnectivity> simulation);
+
     adapter_t *adapter;
     EventQueue eventQueue;
     LogQueue logQueue;
@@ -271,22 +446,57 @@ private:
     // Interval to use for sending BLE driver events to JavaScript. If 0 events will be sent as soon as they are received from the BLE driver.
     uint32_t eventInterval;
     std::unique_ptr<uv_timer_t> eventIntervalTimer;
+
+    // Adaptive event batching. If eventMaxLatency is not 0 events are sent immediately while idle,
+    // and coalesced for up to eventMaxLatency ms or eventMaxBatchSize events under load.
+    uint32_t eventMaxLatency;
+    uint32_t eventMaxBatchSize;
+    std::atomic<bool> eventBatchCoalescing;
+    std::atomic<uint32_t> eventBatchPendingCount;
+    std::chrono::steady_clock::time_point eventLastDispatch;
     std::unique_ptr<uv_async_t> asyncEvent;
 
+    // Optional binary trace of all events received from the SoftDevice
+    void traceEvent(const ble_evt_t *event, const uint16_t size);
+
+    EventTrace eventTrace;
+
+    // Replays an event trace into appendEvent, only for adapters opened with the simulated physical layer
+    static bool resolveReplayedEvent(ble_evt_t *event);
+
+    EventReplay eventReplay;
+    std::unique_ptr<uv_async_t> asyncEventReplay;
+    std::unique_ptr<Nan::Callback> eventReplayCallback;
+
+    // Identifies this adapter in event traces. Unique among the adapters of one SoftDevice API version only,
+    // each API version is a separate module with its own counter. Trace headers record the API version.
+    uint16_t adapterId;
+
+    // Queue, execution and callback latency of the async methods, see QUEUE_ADAPTER_METHOD
+    MethodStats methodStats;
+
+    // If true, events, logs and status are drained by the shared event dispatcher instead of per adapter handles
+    std::atomic<bool> sharedEventDispatch;
+
     std::unique_ptr<uv_async_t> asyncLog;
+
+    // Log entries below this severity are discarded before they are queued
+    sd_rpc_log_severity_t logSeverityFilter;
+
+    // Log entries dropped because the log queue was full, in total and since the last delivery to JavaScript
+    std::atomic<uint32_t> logDroppedCount;
+    std::atomic<uint32_t> logDroppedPendingCount;
+    std::atomic<uint32_t> logTruncatedCount;
     std::unique_ptr<uv_async_t> asyncStatus;
 
     uv_mutex_t adapterCloseMutex;
 
     // Statistics:
-    // Accumulated deltas for event callbacks done to the driver
-    std::chrono::milliseconds eventCallbackDuration;
-    uint32_t eventCallbackCount;
-
-    // Max number of events in queue before sending it to JavaScript
-    uint32_t eventCallbackMaxCount;
-    uint32_t eventCallbackBatchEventCounter;
-    uint32_t eventCallbackBatchEventTotalCount;
-    uint32_t eventCallbackBatchNumber;
+    // Event counts per type, JavaScript event callback time and batch sizes
+    EventStats eventStats;
+
+    // Number of batches sent immediately and after being coalesced by adaptive event batching
+    std::atomic<uint32_t> eventCallbackBatchImmediateCount;
+    std::atomic<uint32_t> eventCallbackBatchCoalescedCount;
 };
 #endif
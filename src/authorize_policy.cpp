@@ -0,0 +1,208 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "authorize_policy.h"
+
+namespace {
+    // Same value as NRF_SUCCESS
+    const uint32_t REPLY_SUCCESS = 0;
+}
+
+AuthorizePolicy::AuthorizePolicy() :
+    acceptedCount(0),
+    rejectedCount(0),
+    errorCount(0)
+{
+}
+
+void AuthorizePolicy::set(const uint16_t handle, const authorize_action_t read, const authorize_action_t write, const uint16_t rejectStatus)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Keep the stored value if the policy of the handle changes
+    auto &policy = policies[handle];
+    policy.read = read;
+    policy.write = write;
+    policy.reject_status = rejectStatus;
+}
+
+bool AuthorizePolicy::remove(const uint16_t handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return policies.erase(handle) > 0;
+}
+
+void AuthorizePolicy::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    policies.clear();
+}
+
+bool AuthorizePolicy::setValue(const uint16_t handle, const std::vector<uint8_t> &value)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto policy = policies.find(handle);
+
+    if (policy == policies.end())
+    {
+        return false;
+    }
+
+    policy->second.value = value;
+    return true;
+}
+
+bool AuthorizePolicy::getValue(const uint16_t handle, std::vector<uint8_t> &value)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto policy = policies.find(handle);
+
+    if (policy == policies.end())
+    {
+        return false;
+    }
+
+    value = policy->second.value;
+    return true;
+}
+
+bool AuthorizePolicy::handleRead(const uint16_t handle, const uint16_t offset, reply_handler_t reply)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto entry = policies.find(handle);
+
+    if (entry == policies.end())
+    {
+        return false;
+    }
+
+    auto &policy = entry->second;
+
+    switch (policy.read)
+    {
+        case AUTHORIZE_ACCEPT:
+            return sendReply(policy.read, reply, AUTHORIZE_STATUS_SUCCESS, false, 0, nullptr, 0);
+        case AUTHORIZE_ACCEPT_WITH_VALUE:
+        {
+            if (offset > policy.value.size())
+            {
+                return sendReply(AUTHORIZE_REJECT, reply, AUTHORIZE_STATUS_INVALID_OFFSET, false, 0, nullptr, 0);
+            }
+
+            auto length = static_cast<uint16_t>(policy.value.size() - offset);
+            return sendReply(policy.read, reply, AUTHORIZE_STATUS_SUCCESS, true, offset, policy.value.data() + offset, length);
+        }
+        case AUTHORIZE_REJECT:
+            return sendReply(policy.read, reply, policy.reject_status, false, 0, nullptr, 0);
+        default:
+            return false;
+    }
+}
+
+bool AuthorizePolicy::handleWrite(const uint16_t handle, const uint16_t offset, const uint8_t *data, const uint16_t length, reply_handler_t reply)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto entry = policies.find(handle);
+
+    if (entry == policies.end())
+    {
+        return false;
+    }
+
+    auto &policy = entry->second;
+
+    switch (policy.write)
+    {
+        case AUTHORIZE_ACCEPT_WITH_VALUE:
+            if (offset > policy.value.size())
+            {
+                return sendReply(AUTHORIZE_REJECT, reply, AUTHORIZE_STATUS_INVALID_OFFSET, false, 0, nullptr, 0);
+            }
+
+            policy.value.resize(offset);
+            policy.value.insert(policy.value.end(), data, data + length);
+
+            // The SoftDevice must also store written data
+            return sendReply(policy.write, reply, AUTHORIZE_STATUS_SUCCESS, true, offset, data, length);
+        case AUTHORIZE_ACCEPT:
+            return sendReply(policy.write, reply, AUTHORIZE_STATUS_SUCCESS, true, offset, data, length);
+        case AUTHORIZE_REJECT:
+            return sendReply(policy.write, reply, policy.reject_status, false, 0, nullptr, 0);
+        default:
+            return false;
+    }
+}
+
+bool AuthorizePolicy::sendReply(const authorize_action_t action, reply_handler_t &reply, const uint16_t gattStatus, const bool update,
+                                const uint16_t offset, const uint8_t *data, const uint16_t length)
+{
+    if (reply(gattStatus, update, offset, data, length) != REPLY_SUCCESS)
+    {
+        // Let the application try
+        errorCount++;
+        return false;
+    }
+
+    if (action == AUTHORIZE_REJECT)
+    {
+        rejectedCount++;
+    }
+    else
+    {
+        acceptedCount++;
+    }
+
+    return true;
+}
+
+uint32_t AuthorizePolicy::getAcceptedCount() const
+{
+    return acceptedCount;
+}
+
+uint32_t AuthorizePolicy::getRejectedCount() const
+{
+    return rejectedCount;
+}
+
+uint32_t AuthorizePolicy::getErrorCount() const
+{
+    return errorCount;
+}
@@ -0,0 +1,108 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AUTHORIZE_POLICY_H
+#define AUTHORIZE_POLICY_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Same values as BLE_GATT_STATUS_SUCCESS and BLE_GATT_STATUS_ATTERR_INVALID_OFFSET
+const uint16_t AUTHORIZE_STATUS_SUCCESS = 0x0000;
+const uint16_t AUTHORIZE_STATUS_INVALID_OFFSET = 0x0107;
+
+enum authorize_action_t
+{
+    AUTHORIZE_DEFER,              // Send the request to JavaScript
+    AUTHORIZE_ACCEPT,             // Reads get the value in the SoftDevice, writes are stored by the SoftDevice
+    AUTHORIZE_ACCEPT_WITH_VALUE,  // Reads are answered from the native value store, writes also update it
+    AUTHORIZE_REJECT
+};
+
+// Declarative replies to read and write authorization requests, per attribute handle.
+// Requests for handles without a policy, or with AUTHORIZE_DEFER, go to JavaScript.
+//
+// All methods are thread safe. Requests arrive in the thread receiving events from the
+// SoftDevice, the reply is sent with the lock held so the value can not change meanwhile.
+class AuthorizePolicy
+{
+public:
+    // gattStatus and update as in ble_gatts_authorize_params_t, returns the SoftDevice error code
+    typedef std::function<uint32_t(uint16_t gattStatus, bool update, uint16_t offset,
+                                   const uint8_t *data, uint16_t length)> reply_handler_t;
+
+    AuthorizePolicy();
+
+    void set(const uint16_t handle, const authorize_action_t read, const authorize_action_t write, const uint16_t rejectStatus);
+    bool remove(const uint16_t handle);
+    void clear();
+
+    // Value used by AUTHORIZE_ACCEPT_WITH_VALUE, returns false if handle has no policy
+    bool setValue(const uint16_t handle, const std::vector<uint8_t> &value);
+    bool getValue(const uint16_t handle, std::vector<uint8_t> &value);
+
+    // Return false if the request shall be sent to JavaScript
+    bool handleRead(const uint16_t handle, const uint16_t offset, reply_handler_t reply);
+    bool handleWrite(const uint16_t handle, const uint16_t offset, const uint8_t *data, const uint16_t length, reply_handler_t reply);
+
+    uint32_t getAcceptedCount() const;
+    uint32_t getRejectedCount() const;
+    uint32_t getErrorCount() const;
+
+private:
+    typedef struct {
+        authorize_action_t read;
+        authorize_action_t write;
+        uint16_t reject_status;
+        std::vector<uint8_t> value;
+    } policy_t;
+
+    bool sendReply(const authorize_action_t action, reply_handler_t &reply, const uint16_t gattStatus, const bool update,
+                   const uint16_t offset, const uint8_t *data, const uint16_t length);
+
+    std::mutex mutex;
+    std::map<uint16_t, policy_t> policies;
+
+    std::atomic<uint32_t> acceptedCount;
+    std::atomic<uint32_t> rejectedCount;
+    std::atomic<uint32_t> errorCount;
+};
+
+#endif // AUTHORIZE_POLICY_H
@@ -0,0 +1,338 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bond_store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace {
+    const char BOND_STORE_MAGIC[8] = { 'P', 'C', 'B', 'L', 'E', 'B', 'N', 'D' };
+    const size_t BOND_STORE_HEADER_SIZE = 16;
+
+    bool isSameAddress(const ble_gap_addr_t &a, const ble_gap_addr_t &b)
+    {
+        return a.addr_type == b.addr_type && memcmp(a.addr, b.addr, BLE_GAP_ADDR_LEN) == 0;
+    }
+
+    bool isZeroMasterId(const ble_gap_master_id_t &masterId)
+    {
+        static const uint8_t zero[BLE_GAP_SEC_RAND_LEN] = { 0 };
+        return masterId.ediv == 0 && memcmp(masterId.rand, zero, BLE_GAP_SEC_RAND_LEN) == 0;
+    }
+
+    bool isSameMasterId(const ble_gap_master_id_t &a, const ble_gap_master_id_t &b)
+    {
+        return a.ediv == b.ediv && memcmp(a.rand, b.rand, BLE_GAP_SEC_RAND_LEN) == 0;
+    }
+}
+
+BondStore::BondStore() :
+    enabled(false),
+    apiVersion(0)
+{
+}
+
+void BondStore::open(const std::string &path, const uint8_t apiVersion)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    this->path = path;
+    this->apiVersion = apiVersion;
+    records.clear();
+
+    auto file = fopen(path.c_str(), "rb");
+
+    if (file != nullptr)
+    {
+        uint8_t header[BOND_STORE_HEADER_SIZE];
+        auto valid = fread(header, 1, sizeof(header), file) == sizeof(header)
+            && memcmp(header, BOND_STORE_MAGIC, sizeof(BOND_STORE_MAGIC)) == 0;
+
+        uint16_t recordSize = 0;
+        uint32_t recordCount = 0;
+
+        if (valid)
+        {
+            memcpy(&recordSize, &header[10], sizeof(recordSize));
+            memcpy(&recordCount, &header[12], sizeof(recordCount));
+
+            // Key structs differ between SoftDevice API versions
+            valid = header[8] == apiVersion && recordSize == sizeof(bond_record_t);
+        }
+
+        if (valid)
+        {
+            records.resize(recordCount);
+            valid = fread(records.data(), sizeof(bond_record_t), recordCount, file) == recordCount;
+        }
+
+        fclose(file);
+
+        if (!valid)
+        {
+            records.clear();
+
+            std::stringstream error;
+            error << "The bond file " << path << " is not valid for this SoftDevice API version.";
+            throw error.str();
+        }
+    }
+
+    enabled = true;
+}
+
+void BondStore::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    enabled = false;
+    records.clear();
+}
+
+bool BondStore::isEnabled() const
+{
+    return enabled;
+}
+
+void BondStore::onConnected(const uint16_t connHandle, const ble_gap_addr_t &peerAddr)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    connections[connHandle] = peerAddr;
+}
+
+void BondStore::onDisconnected(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    connections.erase(connHandle);
+}
+
+bool BondStore::addBond(const uint16_t connHandle, const ble_gap_sec_keyset_t *keyset,
+                        const ble_gap_sec_kdist_t &kdistOwn, const ble_gap_sec_kdist_t &kdistPeer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto connection = connections.find(connHandle);
+
+    if (!enabled || keyset == nullptr || connection == connections.end())
+    {
+        return false;
+    }
+
+    bond_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.peer_addr = connection->second;
+
+    const auto &own = keyset->keys_own;
+    const auto &peer = keyset->keys_peer;
+
+    // The application passes storage for every key it supports, only the distributed ones are valid
+    if (kdistOwn.enc && own.p_enc_key != nullptr) { record.own_enc = *own.p_enc_key; record.keys |= BOND_KEY_OWN_ENC; }
+    if (kdistOwn.id && own.p_id_key != nullptr) { record.own_id = *own.p_id_key; record.keys |= BOND_KEY_OWN_ID; }
+    if (kdistOwn.sign && own.p_sign_key != nullptr) { record.own_sign = *own.p_sign_key; record.keys |= BOND_KEY_OWN_SIGN; }
+    if (kdistPeer.enc && peer.p_enc_key != nullptr) { record.peer_enc = *peer.p_enc_key; record.keys |= BOND_KEY_PEER_ENC; }
+    if (kdistPeer.sign && peer.p_sign_key != nullptr) { record.peer_sign = *peer.p_sign_key; record.keys |= BOND_KEY_PEER_SIGN; }
+
+    if (kdistPeer.id && peer.p_id_key != nullptr)
+    {
+        record.peer_id = *peer.p_id_key;
+        record.keys |= BOND_KEY_PEER_ID;
+
+        // Prefer the identity address, a resolvable private address changes over time
+        static const uint8_t zero[BLE_GAP_ADDR_LEN] = { 0 };
+
+        if (memcmp(peer.p_id_key->id_addr_info.addr, zero, BLE_GAP_ADDR_LEN) != 0)
+        {
+            record.peer_addr = peer.p_id_key->id_addr_info;
+        }
+    }
+
+    records.erase(std::remove_if(records.begin(), records.end(), [&](const bond_record_t &existing) {
+        return isSameAddress(existing.peer_addr, record.peer_addr)
+            || isSameAddress(existing.peer_addr, connection->second);
+    }), records.end());
+
+    records.push_back(record);
+
+    return save();
+}
+
+bool BondStore::findBySecInfoRequest(const ble_gap_evt_sec_info_request_t &request, bond_record_t &record)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!enabled)
+    {
+        return false;
+    }
+
+    // Legacy pairing, the central identifies the key we distributed with its master identification
+    if (!isZeroMasterId(request.master_id))
+    {
+        auto found = std::find_if(records.begin(), records.end(), [&](const bond_record_t &existing) {
+            return (existing.keys & BOND_KEY_OWN_ENC) && isSameMasterId(existing.own_enc.master_id, request.master_id);
+        });
+
+        if (found == records.end())
+        {
+            return false;
+        }
+
+        record = *found;
+        return true;
+    }
+
+    // LE Secure Connections, the key is identified by the peer address
+    return findByAddressLocked(request.peer_addr, record);
+}
+
+bool BondStore::findByAddress(const ble_gap_addr_t &peerAddr, bond_record_t &record)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!enabled)
+    {
+        return false;
+    }
+
+    return findByAddressLocked(peerAddr, record);
+}
+
+std::vector<bond_record_t> BondStore::getBonds()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return records;
+}
+
+bool BondStore::removeBond(const ble_gap_addr_t &peerAddr)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto size = records.size();
+
+    records.erase(std::remove_if(records.begin(), records.end(), [&](const bond_record_t &existing) {
+        return isSameAddress(existing.peer_addr, peerAddr);
+    }), records.end());
+
+    if (records.size() == size)
+    {
+        return false;
+    }
+
+    return save();
+}
+
+void BondStore::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    records.clear();
+    save();
+}
+
+// Must be called with mutex held
+bool BondStore::findByAddressLocked(const ble_gap_addr_t &peerAddr, bond_record_t &record) const
+{
+    auto found = std::find_if(records.begin(), records.end(), [&](const bond_record_t &existing) {
+        return isSameAddress(existing.peer_addr, peerAddr);
+    });
+
+    if (found == records.end())
+    {
+        return false;
+    }
+
+    record = *found;
+    return true;
+}
+
+// Must be called with mutex held. Writes to a temporary file first so a crash never leaves a partial bond file.
+bool BondStore::save()
+{
+    if (!enabled || path.empty())
+    {
+        return false;
+    }
+
+    auto temporaryPath = path + ".tmp";
+    auto file = fopen(temporaryPath.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    uint8_t header[BOND_STORE_HEADER_SIZE] = { 0 };
+    uint16_t recordSize = sizeof(bond_record_t);
+    uint32_t recordCount = static_cast<uint32_t>(records.size());
+
+    memcpy(header, BOND_STORE_MAGIC, sizeof(BOND_STORE_MAGIC));
+    header[8] = apiVersion;
+    memcpy(&header[10], &recordSize, sizeof(recordSize));
+    memcpy(&header[12], &recordCount, sizeof(recordCount));
+
+    auto written = fwrite(header, 1, sizeof(header), file) == sizeof(header)
+        && fwrite(records.data(), sizeof(bond_record_t), recordCount, file) == recordCount;
+
+    written = (fclose(file) == 0) && written;
+
+    if (!written)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    // The bond file is replaced in one step, so a crash leaves either the old or the new file. If that fails the
+    // temporary file is kept, it holds the only copy of the new bonds.
+#ifdef _WIN32
+    // rename() does not replace an existing file on Windows
+    return MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,116 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BOND_STORE_H
+#define BOND_STORE_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "sd_rpc.h"
+
+// Keys present in a bond record
+const uint8_t BOND_KEY_OWN_ENC = 0x01;
+const uint8_t BOND_KEY_OWN_ID = 0x02;
+const uint8_t BOND_KEY_OWN_SIGN = 0x04;
+const uint8_t BOND_KEY_PEER_ENC = 0x08;
+const uint8_t BOND_KEY_PEER_ID = 0x10;
+const uint8_t BOND_KEY_PEER_SIGN = 0x20;
+
+// Flat record, stored by value and written to the bond file as is
+struct bond_record_t
+{
+    ble_gap_addr_t peer_addr; // Identity address if the peer distributed one, otherwise the address it connected with
+    uint8_t keys;             // BOND_KEY_* flags
+    ble_gap_enc_key_t own_enc;
+    ble_gap_id_key_t own_id;
+    ble_gap_sign_info_t own_sign;
+    ble_gap_enc_key_t peer_enc;
+    ble_gap_id_key_t peer_id;
+    ble_gap_sign_info_t peer_sign;
+};
+
+// Native bond database, persisted to a file.
+//
+// Bonds are added when pairing completes and are used to answer SEC_INFO_REQUEST and to
+// encrypt links to bonded peers, without involving JavaScript.
+//
+// File layout, integers in host byte order:
+//   header: "PCBLEBND" (8 bytes), SoftDevice API version (uint8), reserved (uint8), record size (uint16), record count (uint32)
+//   records: bond_record_t * record count
+class BondStore
+{
+public:
+    BondStore();
+
+    // Throws std::string if an existing file can not be read or is not a bond file
+    void open(const std::string &path, const uint8_t apiVersion);
+    void close();
+    bool isEnabled() const;
+
+    // Connection tracking, called in event order so the peer of a connection is known when pairing completes
+    void onConnected(const uint16_t connHandle, const ble_gap_addr_t &peerAddr);
+    void onDisconnected(const uint16_t connHandle);
+
+    // Stores the keys distributed on connHandle, as reported in the AUTH_STATUS event, replacing an existing
+    // bond with the same peer. Keys in the keyset that were not distributed are left out.
+    bool addBond(const uint16_t connHandle, const ble_gap_sec_keyset_t *keyset,
+                 const ble_gap_sec_kdist_t &kdistOwn, const ble_gap_sec_kdist_t &kdistPeer);
+
+    bool findBySecInfoRequest(const ble_gap_evt_sec_info_request_t &request, bond_record_t &record);
+    bool findByAddress(const ble_gap_addr_t &peerAddr, bond_record_t &record);
+
+    std::vector<bond_record_t> getBonds();
+    bool removeBond(const ble_gap_addr_t &peerAddr);
+    void clear();
+
+private:
+    bool findByAddressLocked(const ble_gap_addr_t &peerAddr, bond_record_t &record) const;
+    bool save();
+
+    std::mutex mutex;
+    std::atomic<bool> enabled;  // Set from the Main Thread, read by isEnabled() from the event thread
+    std::string path;
+    uint8_t apiVersion;
+
+    std::vector<bond_record_t> records;
+    std::map<uint16_t, ble_gap_addr_t> connections;
+};
+
+#endif // BOND_STORE_H
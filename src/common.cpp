@@ -35,6 +35,7 @@
  */
 
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <sstream>
 #include <iostream>
@@ -42,6 +43,7 @@
 
 #include "common.h"
 #include "ble_hci.h"
+#include "simulated_connectivity.h"
 
 #define RETURN_VALUE_OR_THROW_EXCEPTION(method) \
 try \
@@ -158,6 +160,71 @@ static name_map_t hci_status_map =
     NAME_MAP_ENTRY(BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED)
 };
 
+namespace {
+    // This runs in a worker thread (not Main Thread)
+    void baton_work(uv_work_t *req)
+    {
+        auto baton = static_cast<Baton *>(req->data);
+        baton->started = std::chrono::steady_clock::now();
+
+        if (baton->simulation != nullptr)
+        {
+            baton->result = baton->simulation->call(baton->methodName);
+        }
+        else
+        {
+            baton->work(req);
+        }
+
+        baton->finished = std::chrono::steady_clock::now();
+    }
+
+    // This runs in Main Thread
+    void baton_after_work(uv_work_t *req, int status)
+    {
+        auto baton = static_cast<Baton *>(req->data);
+
+        // The After function deletes the baton
+        auto methodName = baton->methodName;
+        auto methodStats = baton->methodStats;
+        auto queueTime = baton->started - baton->queued;
+        auto executeTime = baton->finished - baton->started;
+
+        auto callbackStarted = std::chrono::steady_clock::now();
+        baton->afterWork(req);
+        auto callbackTime = std::chrono::steady_clock::now() - callbackStarted;
+
+        methodStats->record(methodName, queueTime, executeTime, callbackTime);
+    }
+}
+
+void queueBatonWork(Baton *baton, const char *methodName, MethodStats *methodStats,
+                    std::shared_ptr<SimulatedConnectivity> simulation, uv_work_cb work, uv_work_cb afterWork)
+{
+    baton->methodName = methodName;
+    baton->methodStats = methodStats;
+    baton->simulation = simulation;
+    baton->work = work;
+    baton->afterWork = afterWork;
+    baton->queued = std::chrono::steady_clock::now();
+
+    uv_queue_work(uv_default_loop(), baton->req, baton_work, baton_after_work);
+}
+
+void queueBatonCompletion(Baton *baton, uv_work_cb afterWork)
+{
+    baton->afterWork = afterWork;
+
+    uv_queue_work(uv_default_loop(), baton->req,
+        [](uv_work_t *) {},
+        [](uv_work_t *req, int) {
+            auto baton = static_cast<Baton *>(req->data);
+
+            // The After function deletes the baton
+            baton->afterWork(req);
+        });
+}
+
 const std::string getCurrentTimeInMilliseconds()
 {
     auto current_time = std::chrono::system_clock::now();
@@ -313,6 +380,23 @@ uint8_t *ConversionUtility::getNativePointerToUint8(v8::Local<v8::Object>js, con
 
 uint8_t *ConversionUtility::getNativePointerToUint8(v8::Local<v8::Value> js)
 {
+    // Buffers and other Uint8Array views are copied directly from their backing store
+    if (js->IsUint8Array())
+    {
+        Nan::TypedArrayContents<uint8_t> contents(js);
+        auto length = contents.length();
+        auto string = static_cast<uint8_t *>(malloc(sizeof(uint8_t) * (length > 0 ? length : 1)));
+
+        assert(string != nullptr);
+
+        if (length > 0)
+        {
+            memcpy(string, *contents, length);
+        }
+
+        return string;
+    }
+
     if (!js->IsArray())
     {
         throw std::string("array");
@@ -332,6 +416,30 @@ uint8_t *ConversionUtility::getNativePointerToUint8(v8::Local<v8::Value> js)
     return string;
 }
 
+std::vector<uint8_t> ConversionUtility::getNativeByteVector(v8::Local<v8::Value> js)
+{
+    if (js->IsUint8Array())
+    {
+        Nan::TypedArrayContents<uint8_t> contents(js);
+        return std::vector<uint8_t>(*contents, *contents + contents.length());
+    }
+
+    if (!js->IsArray())
+    {
+        throw std::string("array or Uint8Array");
+    }
+
+    v8::Local<v8::Array> jsarray = v8::Local<v8::Array>::Cast(js);
+    auto bytes = std::vector<uint8_t>(jsarray->Length());
+
+    for (uint32_t i = 0; i < bytes.size(); ++i)
+    {
+        bytes[i] = static_cast<uint8_t>(jsarray->Get(Nan::New(i))->Uint32Value());
+    }
+
+    return bytes;
+}
+
 uint16_t *ConversionUtility::getNativePointerToUint16(v8::Local<v8::Object>js, const char *name)
 {
     v8::Local<v8::Value> value = Utility::Get(js, name);
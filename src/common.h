@@ -38,11 +38,14 @@
 #define SD_COMMON_H
 
 #include <nan.h>
+#include <chrono>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 
 #include "sd_rpc.h"
+#include "method_stats.h"
 
 #if !(defined NRF_SD_BLE_API_VERSION)
 #error "NRF_SD_BLE_API_VERSION is not defined. Aborting compilation."
@@ -55,6 +58,12 @@
 #define BATON_CONSTRUCTOR(BatonType) BatonType(v8::Local<v8::Function> callback) : Baton(callback) {}
 #define BATON_DESTRUCTOR(BatonType) ~BatonType()
 
+// Queues the worker and After function of an async adapter method in the libuv thread pool and
+// records the latency in the adapter's method statistics. Used from the NAN_METHOD implementation.
+// If the adapter is opened with the simulated physical layer the simulator completes the worker.
+#define QUEUE_ADAPTER_METHOD(obj, baton, MainName) \
+    queueBatonWork(baton, #MainName, &((obj)->methodStats), (obj)->getSimulatedConnectivity(), MainName, After##MainName)
+
 #define METHOD_DEFINITIONS(MainName) \
     NAN_METHOD(MainName); \
     void MainName(uv_work_t *req); \
@@ -70,6 +79,7 @@ extern int adapterCount;
 int findAdapterID(adapter_t *adapter);
 
 class ConversionUtility;
+class SimulatedConnectivity;
 
 
 template<typename NativeType>
@@ -184,6 +194,11 @@ public:
         req = new uv_work_t();
         callback = new Nan::Callback(cb);
         req->data = static_cast<void*>(this);
+
+        methodName = nullptr;
+        methodStats = nullptr;
+        work = nullptr;
+        afterWork = nullptr;
     }
 
     ~Baton()
@@ -197,8 +212,25 @@ public:
 
     int result;
     adapter_t *adapter;
+
+    // Set by queueBatonWork
+    const char *methodName;
+    MethodStats *methodStats;
+    uv_work_cb work;
+    uv_work_cb afterWork;
+    std::shared_ptr<SimulatedConnectivity> simulation;
+    std::chrono::steady_clock::time_point queued;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point finished;
 };
 
+void queueBatonWork(Baton *baton, const char *methodName, MethodStats *methodStats,
+                    std::shared_ptr<SimulatedConnectivity> simulation, uv_work_cb work, uv_work_cb afterWork);
+
+// Completes a baton with its result already set from a later loop iteration, without a SoftDevice call,
+// so that the callback is asynchronous also when the result is known up front
+void queueBatonCompletion(Baton *baton, uv_work_cb afterWork);
+
 const std::string getCurrentTimeInMilliseconds();
 
 uint16_t uint16_decode(const uint8_t *p_encoded_data);
@@ -302,6 +334,7 @@ public:
     static bool         getBool(v8::Local<v8::Value>js);
     static uint8_t *    getNativePointerToUint8(v8::Local<v8::Object>js, const char *name);
     static uint8_t *    getNativePointerToUint8(v8::Local<v8::Value>js);
+    static std::vector<uint8_t> getNativeByteVector(v8::Local<v8::Value>js);
     static uint16_t *   getNativePointerToUint16(v8::Local<v8::Object>js, const char *name);
     static uint16_t *   getNativePointerToUint16(v8::Local<v8::Value>js);
     static v8::Local<v8::Object> getJsObject(v8::Local<v8::Object>js, const char *name);
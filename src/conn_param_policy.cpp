@@ -0,0 +1,235 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "conn_param_policy.h"
+
+#include <algorithm>
+
+namespace {
+    // Same value as NRF_SUCCESS
+    const uint32_t REPLY_SUCCESS = 0;
+
+    // Same value as BLE_GAP_CP_CONN_SUP_TIMEOUT_MAX
+    const uint16_t CONN_SUP_TIMEOUT_MAX = 0x0C80;
+
+    // The supervision timeout must be longer than (1 + slave latency) * max connection interval * 2,
+    // with the timeout in 10 ms units and the interval in 1.25 ms units
+    bool isTimeoutValid(const uint16_t connSupTimeout, const uint16_t slaveLatency, const uint16_t maxConnInterval)
+    {
+        return static_cast<uint32_t>(connSupTimeout) * 4 > (1 + static_cast<uint32_t>(slaveLatency)) * maxConnInterval;
+    }
+}
+
+ConnParamPolicy::ConnParamPolicy() :
+    acceptedCount(0),
+    clampedCount(0),
+    rejectedCount(0),
+    errorCount(0)
+{
+}
+
+void ConnParamPolicy::set(const uint16_t connHandle, const conn_param_policy_t &policy)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    policies[connHandle] = policy;
+}
+
+bool ConnParamPolicy::remove(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return policies.erase(connHandle) > 0;
+}
+
+void ConnParamPolicy::onDisconnected(const uint16_t connHandle)
+{
+    if (connHandle == CONN_PARAM_POLICY_DEFAULT)
+    {
+        return;
+    }
+
+    remove(connHandle);
+}
+
+void ConnParamPolicy::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    policies.clear();
+}
+
+conn_param_decision_t ConnParamPolicy::evaluate(const uint16_t connHandle, const conn_param_values_t &requested, conn_param_values_t &reply)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto policy = policies.find(connHandle);
+
+    if (policy == policies.end())
+    {
+        policy = policies.find(CONN_PARAM_POLICY_DEFAULT);
+    }
+
+    if (policy == policies.end())
+    {
+        return CONN_PARAM_DECISION_DEFER;
+    }
+
+    switch (policy->second.mode)
+    {
+        case CONN_PARAM_ACCEPT:
+            if (!isWithinBounds(policy->second, requested))
+            {
+                return CONN_PARAM_DECISION_REJECT;
+            }
+
+            reply = requested;
+            return CONN_PARAM_DECISION_ACCEPT;
+        case CONN_PARAM_CLAMP:
+            if (isWithinBounds(policy->second, requested))
+            {
+                reply = requested;
+                return CONN_PARAM_DECISION_ACCEPT;
+            }
+
+            return clamp(policy->second, requested, reply) ? CONN_PARAM_DECISION_CLAMP : CONN_PARAM_DECISION_REJECT;
+        case CONN_PARAM_REJECT:
+            return CONN_PARAM_DECISION_REJECT;
+        case CONN_PARAM_DEFER:
+        default:
+            return CONN_PARAM_DECISION_DEFER;
+    }
+}
+
+void ConnParamPolicy::onReplied(const conn_param_decision_t decision, const uint32_t result)
+{
+    if (result != REPLY_SUCCESS)
+    {
+        errorCount++;
+        return;
+    }
+
+    switch (decision)
+    {
+        case CONN_PARAM_DECISION_CLAMP:
+            clampedCount++;
+            acceptedCount++;
+            break;
+        case CONN_PARAM_DECISION_ACCEPT:
+            acceptedCount++;
+            break;
+        case CONN_PARAM_DECISION_REJECT:
+            rejectedCount++;
+            break;
+        default:
+            break;
+    }
+}
+
+uint32_t ConnParamPolicy::getAcceptedCount() const
+{
+    return acceptedCount;
+}
+
+uint32_t ConnParamPolicy::getClampedCount() const
+{
+    return clampedCount;
+}
+
+uint32_t ConnParamPolicy::getRejectedCount() const
+{
+    return rejectedCount;
+}
+
+uint32_t ConnParamPolicy::getErrorCount() const
+{
+    return errorCount;
+}
+
+bool ConnParamPolicy::isWithinBounds(const conn_param_policy_t &policy, const conn_param_values_t &values)
+{
+    return values.min_conn_interval >= policy.min_conn_interval &&
+           values.max_conn_interval <= policy.max_conn_interval &&
+           values.min_conn_interval <= values.max_conn_interval &&
+           values.slave_latency <= policy.max_slave_latency &&
+           values.conn_sup_timeout >= policy.min_conn_sup_timeout &&
+           values.conn_sup_timeout <= policy.max_conn_sup_timeout;
+}
+
+// Returns false if no valid parameters within the bounds exist
+bool ConnParamPolicy::clamp(const conn_param_policy_t &policy, const conn_param_values_t &requested, conn_param_values_t &reply)
+{
+    if (policy.min_conn_interval > policy.max_conn_interval || policy.min_conn_sup_timeout > policy.max_conn_sup_timeout)
+    {
+        return false;
+    }
+
+    // Keep the part of the requested interval range within the bounds, or the bound closest to it
+    auto minInterval = std::max(requested.min_conn_interval, policy.min_conn_interval);
+    auto maxInterval = std::min(requested.max_conn_interval, policy.max_conn_interval);
+
+    if (minInterval > maxInterval)
+    {
+        minInterval = maxInterval = (requested.max_conn_interval < policy.min_conn_interval) ? policy.min_conn_interval : policy.max_conn_interval;
+    }
+
+    auto slaveLatency = std::min(requested.slave_latency, policy.max_slave_latency);
+    auto connSupTimeout = std::min(std::max(requested.conn_sup_timeout, policy.min_conn_sup_timeout), policy.max_conn_sup_timeout);
+
+    if (!isTimeoutValid(connSupTimeout, slaveLatency, maxInterval))
+    {
+        // Prefer a longer supervision timeout, then a lower slave latency
+        auto minTimeout = (1 + static_cast<uint32_t>(slaveLatency)) * maxInterval / 4 + 1;
+
+        if (minTimeout <= std::min(policy.max_conn_sup_timeout, CONN_SUP_TIMEOUT_MAX))
+        {
+            connSupTimeout = static_cast<uint16_t>(minTimeout);
+        }
+        else
+        {
+            auto maxLatency = (static_cast<uint32_t>(connSupTimeout) * 4 - 1) / maxInterval;
+            slaveLatency = static_cast<uint16_t>(maxLatency > 0 ? maxLatency - 1 : 0);
+        }
+
+        if (!isTimeoutValid(connSupTimeout, slaveLatency, maxInterval))
+        {
+            return false;
+        }
+    }
+
+    reply.min_conn_interval = minInterval;
+    reply.max_conn_interval = maxInterval;
+    reply.slave_latency = slaveLatency;
+    reply.conn_sup_timeout = connSupTimeout;
+    return true;
+}
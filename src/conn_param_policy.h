@@ -0,0 +1,118 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CONN_PARAM_POLICY_H
+#define CONN_PARAM_POLICY_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+// Same value as BLE_CONN_HANDLE_INVALID, selects the policy used for links without their own policy
+const uint16_t CONN_PARAM_POLICY_DEFAULT = 0xFFFF;
+
+// Same layout as ble_gap_conn_params_t, intervals in 1.25 ms units and supervision timeout in 10 ms units
+typedef struct {
+    uint16_t min_conn_interval;
+    uint16_t max_conn_interval;
+    uint16_t slave_latency;
+    uint16_t conn_sup_timeout;
+} conn_param_values_t;
+
+enum conn_param_mode_t
+{
+    CONN_PARAM_DEFER,   // Send the request to JavaScript
+    CONN_PARAM_ACCEPT,  // Accept requests within the bounds, reject the others
+    CONN_PARAM_CLAMP,   // Accept requests with the parameters moved into the bounds
+    CONN_PARAM_REJECT
+};
+
+typedef struct {
+    conn_param_mode_t mode;
+    uint16_t min_conn_interval;
+    uint16_t max_conn_interval;
+    uint16_t max_slave_latency;
+    uint16_t min_conn_sup_timeout;
+    uint16_t max_conn_sup_timeout;
+} conn_param_policy_t;
+
+enum conn_param_decision_t
+{
+    CONN_PARAM_DECISION_DEFER,
+    CONN_PARAM_DECISION_ACCEPT,
+    CONN_PARAM_DECISION_CLAMP,
+    CONN_PARAM_DECISION_REJECT
+};
+
+// Answers connection parameter update requests from peripherals in the thread receiving events from the
+// SoftDevice. A policy set for a link overrides the default policy until the link is disconnected.
+// All methods are thread safe.
+class ConnParamPolicy
+{
+public:
+    ConnParamPolicy();
+
+    void set(const uint16_t connHandle, const conn_param_policy_t &policy);
+    bool remove(const uint16_t connHandle);
+    void onDisconnected(const uint16_t connHandle);
+    void clear();
+
+    // reply is set to the parameters to accept with, if the decision is to accept
+    conn_param_decision_t evaluate(const uint16_t connHandle, const conn_param_values_t &requested, conn_param_values_t &reply);
+
+    // result is the SoftDevice error code of the reply
+    void onReplied(const conn_param_decision_t decision, const uint32_t result);
+
+    uint32_t getAcceptedCount() const;
+    uint32_t getClampedCount() const;
+    uint32_t getRejectedCount() const;
+    uint32_t getErrorCount() const;
+
+private:
+    static bool isWithinBounds(const conn_param_policy_t &policy, const conn_param_values_t &values);
+    static bool clamp(const conn_param_policy_t &policy, const conn_param_values_t &requested, conn_param_values_t &reply);
+
+    std::mutex mutex;
+    std::map<uint16_t, conn_param_policy_t> policies;
+
+    std::atomic<uint32_t> acceptedCount;
+    std::atomic<uint32_t> clampedCount;
+    std::atomic<uint32_t> rejectedCount;
+    std::atomic<uint32_t> errorCount;
+};
+
+#endif // CONN_PARAM_POLICY_H
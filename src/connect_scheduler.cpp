@@ -0,0 +1,447 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "connect_scheduler.h"
+
+#include <algorithm>
+
+namespace {
+    uint32_t toMilliseconds(const std::chrono::steady_clock::duration duration)
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+    }
+
+    // Limits the exponential backoff, the delay is doubled at most this many times
+    const uint8_t MAX_BACKOFF_SHIFT = 10;
+}
+
+ConnectScheduler::ConnectScheduler() :
+    running(false),
+    stopping(false),
+    connectedCount(0),
+    failedCount(0),
+    retryCount(0)
+{
+}
+
+ConnectScheduler::~ConnectScheduler()
+{
+    stop();
+}
+
+void ConnectScheduler::start(cancel_handler_t cancelConnect, completion_handler_t onCompletion)
+{
+    stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    this->cancelConnect = cancelConnect;
+    this->onCompletion = onCompletion;
+    stopping = false;
+
+    thread = std::thread(&ConnectScheduler::run, this);
+    running = true;
+}
+
+void ConnectScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!thread.joinable())
+        {
+            return;
+        }
+
+        running = false;
+        stopping = true;
+    }
+
+    condition.notify_one();
+    thread.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    while (!targets.empty())
+    {
+        complete(targets.begin(), CONNECT_SCHEDULER_ERROR_ABORTED, 0);
+    }
+
+    cancelConnect = nullptr;
+    onCompletion = nullptr;
+}
+
+bool ConnectScheduler::isRunning() const
+{
+    return running;
+}
+
+bool ConnectScheduler::enqueue(const uint32_t id, const uint8_t priority, const uint8_t maxRetries, const uint32_t retryDelay,
+                               const uint32_t settleTime, connect_handler_t connect)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!running)
+        {
+            return false;
+        }
+
+        target_t target;
+        target.id = id;
+        target.priority = priority;
+        target.max_retries = maxRetries;
+        target.retry_delay = retryDelay;
+        target.settle_time = settleTime;
+        target.connect = connect;
+        target.state = TARGET_QUEUED;
+        target.cancelled = false;
+        target.attempts = 0;
+        target.conn_handle = 0;
+        target.enqueued = clock::now();
+        target.not_before = target.enqueued;
+        targets.push_back(target);
+    }
+
+    condition.notify_one();
+    return true;
+}
+
+bool ConnectScheduler::cancel(const uint32_t id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto target = std::find_if(targets.begin(), targets.end(), [id](const target_t &target) { return target.id == id; });
+
+        if (target == targets.end())
+        {
+            return false;
+        }
+
+        if (target->state != TARGET_CONNECTING)
+        {
+            // A link being settled stays connected
+            complete(target, CONNECT_SCHEDULER_ERROR_ABORTED, 0);
+            return true;
+        }
+
+        // The scheduler thread cancels the pending connect
+        target->cancelled = true;
+    }
+
+    condition.notify_one();
+    return true;
+}
+
+void ConnectScheduler::onConnected(const uint16_t connHandle)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto target = findConnecting();
+
+        if (target == targets.end())
+        {
+            return;
+        }
+
+        target->state = TARGET_SETTLING;
+        target->conn_handle = connHandle;
+        target->connected = clock::now();
+        target->not_before = target->connected + std::chrono::milliseconds(target->settle_time);
+    }
+
+    condition.notify_one();
+}
+
+bool ConnectScheduler::onTimeout()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto target = findConnecting();
+
+        if (target == targets.end())
+        {
+            return false;
+        }
+
+        complete(target, CONNECT_SCHEDULER_ERROR_TIMEOUT, 0);
+    }
+
+    condition.notify_one();
+    return true;
+}
+
+void ConnectScheduler::onDisconnected(const uint16_t connHandle, const uint8_t reason)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto target = std::find_if(targets.begin(), targets.end(), [connHandle](const target_t &target) {
+            return target.state == TARGET_SETTLING && target.conn_handle == connHandle;
+        });
+
+        if (target == targets.end())
+        {
+            return;
+        }
+
+        if (reason == CONNECT_SCHEDULER_HCI_FAILED_TO_BE_ESTABLISHED)
+        {
+            retryOrFail(target, CONNECT_SCHEDULER_ERROR_LINK_LOST, reason);
+        }
+        else
+        {
+            complete(target, CONNECT_SCHEDULER_ERROR_LINK_LOST, reason);
+        }
+    }
+
+    condition.notify_one();
+}
+
+void ConnectScheduler::abortAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    while (!targets.empty())
+    {
+        complete(targets.begin(), CONNECT_SCHEDULER_ERROR_ABORTED, 0);
+    }
+}
+
+void ConnectScheduler::takeCompletions(std::vector<connect_completion_t> &completions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    completions.swap(this->completions);
+    this->completions.clear();
+}
+
+uint32_t ConnectScheduler::getPendingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<uint32_t>(targets.size());
+}
+
+uint32_t ConnectScheduler::getConnectedCount() const
+{
+    return connectedCount;
+}
+
+uint32_t ConnectScheduler::getFailedCount() const
+{
+    return failedCount;
+}
+
+uint32_t ConnectScheduler::getRetryCount() const
+{
+    return retryCount;
+}
+
+void ConnectScheduler::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping)
+    {
+        auto now = clock::now();
+
+        // Links that stayed connected for the settle time are established
+        for (auto target = targets.begin(); target != targets.end();)
+        {
+            auto current = target++;
+
+            if (current->state == TARGET_SETTLING && current->not_before <= now)
+            {
+                complete(current, CONNECT_SCHEDULER_SUCCESS, 0);
+            }
+        }
+
+        auto connecting = findConnecting();
+
+        if (connecting != targets.end() && connecting->cancelled)
+        {
+            auto id = connecting->id;
+            auto cancel = cancelConnect;
+
+            lock.unlock();
+            auto result = cancel();
+            lock.lock();
+
+            // The target is still connecting unless it connected or timed out meanwhile
+            auto target = findConnecting();
+
+            if (target != targets.end() && target->id == id && result == CONNECT_SCHEDULER_SUCCESS)
+            {
+                complete(target, CONNECT_SCHEDULER_ERROR_ABORTED, 0);
+            }
+            else if (target != targets.end() && target->id == id)
+            {
+                target->cancelled = false;
+            }
+
+            continue;
+        }
+
+        if (connecting == targets.end())
+        {
+            auto next = findNext(now);
+
+            if (next != targets.end())
+            {
+                next->state = TARGET_CONNECTING;
+                next->attempts++;
+                next->attempt = now;
+
+                if (next->attempts == 1)
+                {
+                    next->first_attempt = now;
+                }
+
+                auto id = next->id;
+                auto connect = next->connect;
+
+                lock.unlock();
+                auto result = connect();
+                lock.lock();
+
+                if (result != CONNECT_SCHEDULER_SUCCESS)
+                {
+                    auto target = findConnecting();
+
+                    if (target != targets.end() && target->id == id)
+                    {
+                        retryOrFail(target, result, 0);
+                    }
+                }
+
+                continue;
+            }
+        }
+
+        // Sleep until a link is settled or a retry is due, a pending connect completes with an event
+        auto wakeUp = clock::time_point::max();
+
+        for (auto &target : targets)
+        {
+            if (target.state == TARGET_SETTLING || (target.state == TARGET_QUEUED && connecting == targets.end()))
+            {
+                wakeUp = std::min(wakeUp, target.not_before);
+            }
+        }
+
+        if (wakeUp == clock::time_point::max())
+        {
+            condition.wait(lock);
+        }
+        else
+        {
+            condition.wait_until(lock, wakeUp);
+        }
+    }
+}
+
+std::list<ConnectScheduler::target_t>::iterator ConnectScheduler::findNext(const clock::time_point now)
+{
+    auto next = targets.end();
+
+    for (auto target = targets.begin(); target != targets.end(); target++)
+    {
+        if (target->state != TARGET_QUEUED || target->not_before > now)
+        {
+            continue;
+        }
+
+        // Targets with the same priority are started in the order they were enqueued
+        if (next == targets.end() || target->priority > next->priority)
+        {
+            next = target;
+        }
+    }
+
+    return next;
+}
+
+std::list<ConnectScheduler::target_t>::iterator ConnectScheduler::findConnecting()
+{
+    return std::find_if(targets.begin(), targets.end(), [](const target_t &target) { return target.state == TARGET_CONNECTING; });
+}
+
+void ConnectScheduler::retryOrFail(std::list<target_t>::iterator target, const uint32_t result, const uint8_t hciStatus)
+{
+    if (target->cancelled || target->attempts > target->max_retries)
+    {
+        complete(target, result, hciStatus);
+        return;
+    }
+
+    auto shift = std::min<uint8_t>(target->attempts - 1, MAX_BACKOFF_SHIFT);
+    target->state = TARGET_QUEUED;
+    target->not_before = clock::now() + std::chrono::milliseconds(static_cast<uint64_t>(target->retry_delay) << shift);
+    retryCount++;
+}
+
+void ConnectScheduler::complete(std::list<target_t>::iterator target, const uint32_t result, const uint8_t hciStatus)
+{
+    auto now = clock::now();
+
+    connect_completion_t completion;
+    completion.id = target->id;
+    completion.result = result;
+    completion.hci_status = hciStatus;
+    completion.conn_handle = target->conn_handle;
+    completion.attempts = target->attempts;
+    completion.wait_time = toMilliseconds((target->attempts > 0 ? target->first_attempt : now) - target->enqueued);
+    completion.connect_time = (result == CONNECT_SCHEDULER_SUCCESS) ? toMilliseconds(target->connected - target->attempt) : 0;
+    completion.total_time = toMilliseconds(now - target->enqueued);
+
+    if (result == CONNECT_SCHEDULER_SUCCESS)
+    {
+        connectedCount++;
+    }
+    else
+    {
+        failedCount++;
+    }
+
+    targets.erase(target);
+    completions.push_back(completion);
+
+    if (onCompletion)
+    {
+        onCompletion();
+    }
+}
@@ -0,0 +1,173 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CONNECT_SCHEDULER_H
+#define CONNECT_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Same values as NRF_SUCCESS, NRF_ERROR_INVALID_STATE, NRF_ERROR_TIMEOUT and BLE_ERROR_INVALID_CONN_HANDLE
+const uint32_t CONNECT_SCHEDULER_SUCCESS = 0x0000;
+const uint32_t CONNECT_SCHEDULER_ERROR_ABORTED = 0x0008;
+const uint32_t CONNECT_SCHEDULER_ERROR_TIMEOUT = 0x000D;
+const uint32_t CONNECT_SCHEDULER_ERROR_LINK_LOST = 0x3002;
+
+// Same value as BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED
+const uint8_t CONNECT_SCHEDULER_HCI_FAILED_TO_BE_ESTABLISHED = 0x3E;
+
+typedef struct {
+    uint32_t id;
+    uint32_t result;        // Error code from starting the last attempt, or one of the CONNECT_SCHEDULER_ERROR_* codes
+    uint8_t hci_status;     // Disconnect reason if the link was lost during the settle time, 0 otherwise
+    uint16_t conn_handle;
+    uint8_t attempts;
+    uint32_t wait_time;     // Milliseconds from enqueue to the first attempt
+    uint32_t connect_time;  // Milliseconds from the start of the successful attempt until connected
+    uint32_t total_time;    // Milliseconds from enqueue until completed
+} connect_completion_t;
+
+// Runs central connection establishments one after the other from a dedicated thread, highest priority first.
+// The SoftDevice allows one pending connect at a time, the next is started as soon as the previous is
+// connected or has timed out.
+//
+// A link is only reported as connected when it survives the settle time after BLE_GAP_EVT_CONNECTED,
+// links lost with BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED meanwhile are retried with exponential backoff.
+// All methods are thread safe.
+class ConnectScheduler
+{
+public:
+    // Starts the connection establishment of a target, returns the SoftDevice error code
+    typedef std::function<uint32_t()> connect_handler_t;
+    // Cancels the pending connection establishment, returns the SoftDevice error code
+    typedef std::function<uint32_t()> cancel_handler_t;
+    typedef std::function<void()> completion_handler_t;
+
+    ConnectScheduler();
+    ~ConnectScheduler();
+
+    // onCompletion is called with the lock held whenever a completion is available. Both handlers,
+    // and the connect handlers of the targets, are called from the scheduler thread.
+    void start(cancel_handler_t cancelConnect, completion_handler_t onCompletion);
+    // Completes the remaining targets as aborted, the completions are kept until taken
+    void stop();
+
+    bool isRunning() const;
+
+    // retryDelay is the backoff before the first retry in milliseconds, doubled for each retry.
+    // settleTime is how long a new link must stay connected to count as established, in milliseconds.
+    bool enqueue(const uint32_t id, const uint8_t priority, const uint8_t maxRetries, const uint32_t retryDelay,
+                 const uint32_t settleTime, connect_handler_t connect);
+    bool cancel(const uint32_t id);
+
+    // Called from the thread receiving events from the SoftDevice. onTimeout returns false if
+    // the connect timing out was not started by the scheduler.
+    void onConnected(const uint16_t connHandle);
+    bool onTimeout();
+    void onDisconnected(const uint16_t connHandle, const uint8_t reason);
+
+    // Completes all targets as aborted
+    void abortAll();
+
+    void takeCompletions(std::vector<connect_completion_t> &completions);
+
+    uint32_t getPendingCount();
+    uint32_t getConnectedCount() const;
+    uint32_t getFailedCount() const;
+    uint32_t getRetryCount() const;
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    enum target_state_t
+    {
+        TARGET_QUEUED,
+        TARGET_CONNECTING,
+        TARGET_SETTLING
+    };
+
+    typedef struct {
+        uint32_t id;
+        uint8_t priority;
+        uint8_t max_retries;
+        uint32_t retry_delay;
+        uint32_t settle_time;
+        connect_handler_t connect;
+
+        target_state_t state;
+        bool cancelled;
+        uint8_t attempts;
+        uint16_t conn_handle;
+        clock::time_point enqueued;
+        clock::time_point first_attempt;
+        clock::time_point attempt;
+        clock::time_point connected;
+        clock::time_point not_before;  // Start of the next attempt when queued, end of the settle time when settling
+    } target_t;
+
+    void run();
+
+    // Requires the lock to be held
+    std::list<target_t>::iterator findNext(const clock::time_point now);
+    std::list<target_t>::iterator findConnecting();
+    void retryOrFail(std::list<target_t>::iterator target, const uint32_t result, const uint8_t hciStatus);
+    void complete(std::list<target_t>::iterator target, const uint32_t result, const uint8_t hciStatus);
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    std::atomic<bool> running;
+    bool stopping;
+
+    cancel_handler_t cancelConnect;
+    completion_handler_t onCompletion;
+
+    std::list<target_t> targets;
+    std::vector<connect_completion_t> completions;
+
+    std::atomic<uint32_t> connectedCount;
+    std::atomic<uint32_t> failedCount;
+    std::atomic<uint32_t> retryCount;
+};
+
+#endif // CONNECT_SCHEDULER_H
@@ -0,0 +1,312 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "conversion_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "common.h"
+#include "driver_gap.h"
+#include "driver_gattc.h"
+#include "driver_gatts.h"
+
+namespace {
+    // Events are built in a buffer of the size Adapter::appendEvent copies from the driver
+    const size_t BENCHMARK_EVENT_SIZE = 512;
+
+    const std::string timestamp = "2020-01-01T00:00:00.000Z";
+
+    typedef std::function<void()> conversion_t;
+
+    class EventBuffer
+    {
+    public:
+        EventBuffer() : storage(BENCHMARK_EVENT_SIZE / sizeof(uint64_t)) {}
+
+        ble_evt_t *clear()
+        {
+            memset(storage.data(), 0, BENCHMARK_EVENT_SIZE);
+            return reinterpret_cast<ble_evt_t *>(storage.data());
+        }
+
+    private:
+        // uint64_t storage keeps the event aligned
+        std::vector<uint64_t> storage;
+    };
+
+    void fillPayload(uint8_t *data, const uint16_t length)
+    {
+        for (uint16_t i = 0; i < length; i++)
+        {
+            data[i] = static_cast<uint8_t>(i);
+        }
+    }
+
+    v8::Local<v8::Value> payloadToJs(const uint16_t length, const bool buffer)
+    {
+        std::vector<uint8_t> data(length);
+        fillPayload(data.data(), length);
+
+        if (buffer)
+        {
+            return Nan::CopyBuffer(reinterpret_cast<const char *>(data.data()), length).ToLocalChecked();
+        }
+
+        return ConversionUtility::toJsValueArray(data.data(), length);
+    }
+
+    // Returns the average time in nanoseconds of one conversion. Every conversion runs in its own
+    // HandleScope, as it does when events are converted in Adapter::createEventArray.
+    double measure(const conversion_t &conversion, const uint32_t iterations)
+    {
+        const auto warmup = std::max<uint32_t>(iterations / 10, 1);
+
+        for (uint32_t i = 0; i < warmup; i++)
+        {
+            Nan::HandleScope scope;
+            conversion();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            Nan::HandleScope scope;
+            conversion();
+        }
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+    }
+
+    v8::Local<v8::Object> result(const char *name, const uint16_t payloadSize, const uint32_t iterations, const double nsPerOp)
+    {
+        auto entry = Nan::New<v8::Object>();
+        Utility::Set(entry, "name", name);
+        Utility::Set(entry, "payloadSize", payloadSize);
+        Utility::Set(entry, "iterations", iterations);
+        Utility::Set(entry, "nsPerOp", nsPerOp);
+        return entry;
+    }
+}
+
+NAN_METHOD(BenchmarkConversions)
+{
+    v8::Local<v8::Object> options;
+    uint32_t iterations;
+    std::vector<uint16_t> payloadSizes;
+
+    try
+    {
+        options = ConversionUtility::getJsObject(info[0]);
+        iterations = ConversionUtility::getNativeUint32(options, "iterations");
+
+        auto sizesValue = Utility::Get(options, "payloadSizes");
+
+        if (!sizesValue->IsArray())
+        {
+            throw std::string("array");
+        }
+
+        auto sizes = v8::Local<v8::Array>::Cast(sizesValue);
+
+        for (uint32_t i = 0; i < sizes->Length(); i++)
+        {
+            payloadSizes.push_back(ConversionUtility::getNativeUint16(Utility::Get(sizes, i)));
+        }
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    if (iterations == 0)
+    {
+        Nan::ThrowRangeError("iterations must be larger than 0.");
+        return;
+    }
+
+    EventBuffer buffer;
+    auto results = Nan::New<v8::Array>();
+    uint32_t resultIndex = 0;
+
+    // Events without payload
+    {
+        auto event = buffer.clear();
+        auto connected = &(event->evt.gap_evt.params.connected);
+        connected->peer_addr.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+        connected->role = BLE_GAP_ROLE_CENTRAL;
+        connected->conn_params.min_conn_interval = 24;
+        connected->conn_params.max_conn_interval = 24;
+        connected->conn_params.conn_sup_timeout = 400;
+
+        auto nsPerOp = measure([&]() {
+            GapConnected(timestamp, 0, connected).ToJs();
+        }, iterations);
+
+        Nan::Set(results, resultIndex++, result("CONNECTED", 0, iterations, nsPerOp));
+    }
+
+    for (auto payloadSize : payloadSizes)
+    {
+        // Advertising data is limited by the SoftDevice
+        {
+            auto event = buffer.clear();
+            auto report = &(event->evt.gap_evt.params.adv_report);
+            auto length = std::min<uint16_t>(payloadSize, BLE_GAP_ADV_MAX_SIZE);
+
+            report->peer_addr.addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+            report->rssi = -50;
+            report->type = BLE_GAP_ADV_TYPE_ADV_IND;
+            report->dlen = static_cast<uint8_t>(length);
+            fillPayload(report->data, length);
+
+            auto nsPerOp = measure([&]() {
+                GapAdvReport(timestamp, BLE_CONN_HANDLE_INVALID, report).ToJs();
+            }, iterations);
+
+            Nan::Set(results, resultIndex++, result("ADV_REPORT", length, iterations, nsPerOp));
+        }
+
+        {
+            auto event = buffer.clear();
+            auto hvx = &(event->evt.gattc_evt.params.hvx);
+            auto length = std::min<uint16_t>(payloadSize, BENCHMARK_EVENT_SIZE - offsetof(ble_evt_t, evt.gattc_evt.params.hvx.data));
+
+            hvx->handle = 0x10;
+            hvx->type = BLE_GATT_HVX_NOTIFICATION;
+            hvx->len = length;
+            fillPayload(hvx->data, length);
+
+            auto nsPerOp = measure([&]() {
+                GattcHandleValueNotificationEvent(timestamp, 0, BLE_GATT_STATUS_SUCCESS, 0, hvx).ToJs();
+            }, iterations);
+
+            Nan::Set(results, resultIndex++, result("HVX", length, iterations, nsPerOp));
+        }
+
+        {
+            auto event = buffer.clear();
+            auto readResponse = &(event->evt.gattc_evt.params.read_rsp);
+            auto length = std::min<uint16_t>(payloadSize, BENCHMARK_EVENT_SIZE - offsetof(ble_evt_t, evt.gattc_evt.params.read_rsp.data));
+
+            readResponse->handle = 0x10;
+            readResponse->len = length;
+            fillPayload(readResponse->data, length);
+
+            auto nsPerOp = measure([&]() {
+                GattcReadEvent(timestamp, 0, BLE_GATT_STATUS_SUCCESS, 0, readResponse).ToJs();
+            }, iterations);
+
+            Nan::Set(results, resultIndex++, result("READ_RSP", length, iterations, nsPerOp));
+        }
+
+        {
+            auto event = buffer.clear();
+            auto write = &(event->evt.gatts_evt.params.write);
+            auto length = std::min<uint16_t>(payloadSize, BENCHMARK_EVENT_SIZE - offsetof(ble_evt_t, evt.gatts_evt.params.write.data));
+
+            write->handle = 0x10;
+            write->uuid.type = BLE_UUID_TYPE_BLE;
+            write->uuid.uuid = 0x2A00;
+            write->op = BLE_GATTS_OP_WRITE_REQ;
+            write->len = length;
+            fillPayload(write->data, length);
+
+            auto nsPerOp = measure([&]() {
+                GattsWriteEvent(timestamp, 0, write).ToJs();
+            }, iterations);
+
+            Nan::Set(results, resultIndex++, result("GATTS_WRITE", length, iterations, nsPerOp));
+        }
+
+        // Input conversion, the value is given as an array of numbers or as a Buffer
+        for (auto buffered : { false, true })
+        {
+            Nan::HandleScope scope;
+            auto writeParams = Nan::New<v8::Object>();
+            Utility::Set(writeParams, "write_op", static_cast<uint8_t>(BLE_GATT_OP_WRITE_CMD));
+            Utility::Set(writeParams, "flags", static_cast<uint8_t>(0));
+            Utility::Set(writeParams, "handle", static_cast<uint16_t>(0x10));
+            Utility::Set(writeParams, "offset", static_cast<uint16_t>(0));
+            Utility::Set(writeParams, "len", payloadSize);
+            Utility::Set(writeParams, "value", payloadToJs(payloadSize, buffered));
+
+            auto nsPerOp = measure([&]() {
+                auto native = GattcWriteParameters(writeParams).ToNative();
+                free(const_cast<uint8_t *>(native->p_value));
+                delete native;
+            }, iterations);
+
+            Nan::Set(results, resultIndex++, result(buffered ? "GATTC_WRITE_PARAMS_BUFFER" : "GATTC_WRITE_PARAMS", payloadSize, iterations, nsPerOp));
+        }
+
+        {
+            Nan::HandleScope scope;
+            auto hvxParams = Nan::New<v8::Object>();
+            Utility::Set(hvxParams, "handle", static_cast<uint16_t>(0x10));
+            Utility::Set(hvxParams, "type", static_cast<uint8_t>(BLE_GATT_HVX_NOTIFICATION));
+            Utility::Set(hvxParams, "offset", static_cast<uint16_t>(0));
+            Utility::Set(hvxParams, "len", payloadSize);
+            Utility::Set(hvxParams, "data", payloadToJs(payloadSize, false));
+
+            auto nsPerOp = measure([&]() {
+                auto native = GattsHVXParams(hvxParams).ToNative();
+                free(native->p_len);
+                free(const_cast<uint8_t *>(native->p_data));
+                delete native;
+            }, iterations);
+
+            Nan::Set(results, resultIndex++, result("GATTS_HVX_PARAMS", payloadSize, iterations, nsPerOp));
+        }
+    }
+
+    info.GetReturnValue().Set(results);
+}
+
+extern "C" {
+    void init_conversion_benchmark(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target)
+    {
+        Utility::SetMethod(target, "benchmarkConversions", BenchmarkConversions);
+    }
+}
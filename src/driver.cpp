@@ -49,6 +49,9 @@
 #include "driver_gattc.h"
 #include "driver_gatts.h"
 #include "driver_uecc.h"
+#ifdef PC_BLE_DRIVER_JS_CONVERSION_BENCHMARK
+#include "conversion_benchmark.h"
+#endif
 
 using namespace std;
 
@@ -113,15 +116,11 @@ static name_map_t uuid_type_name_map = {
 // This function is ran by the thread that the SoftDevice Driver has initiated
 void sd_rpc_on_log_event(adapter_t *adapter, sd_rpc_log_severity_t severity, const char *log_message)
 {
-    auto logEntry = new LogEntry();
-    logEntry->message = std::string(log_message);
-    logEntry->severity = severity;
-
     auto jsAdapter = Adapter::getAdapter(adapter, adapterBeingOpened);
 
     if (jsAdapter != nullptr)
     {
-        jsAdapter->appendLog(logEntry);
+        jsAdapter->appendLog(severity, log_message);
     }
     else
     {
@@ -130,13 +129,34 @@ void sd_rpc_on_log_event(adapter_t *adapter, sd_rpc_log_severity_t severity, con
     }
 }
 
-void Adapter::appendLog(LogEntry *log)
+void Adapter::appendLog(sd_rpc_log_severity_t severity, const char *message)
 {
-    if (asyncLog != nullptr)
+    // Filter before anything is copied, at debug level the transport logs every packet
+    if (severity < logSeverityFilter || asyncLog == nullptr)
+    {
+        return;
+    }
+
+    LogEntry logEntry;
+    logEntry.severity = severity;
+    logEntry.length = strnlen(message, LOG_MESSAGE_MAX_LENGTH + 1);
+
+    if (logEntry.length > LOG_MESSAGE_MAX_LENGTH)
+    {
+        logEntry.length = LOG_MESSAGE_MAX_LENGTH;
+        logTruncatedCount += 1;
+    }
+
+    memcpy(logEntry.message, message, logEntry.length);
+
+    if (!logQueue.push(logEntry))
     {
-        logQueue.push(log);
-        uv_async_send(asyncLog.get());
+        logDroppedCount += 1;
+        logDroppedPendingCount += 1;
+        return;
     }
+
+    wakeUp(asyncLog.get());
 }
 
 // Now we are in the NodeJS thread. Call callbacks.
@@ -144,26 +164,35 @@ void Adapter::onLogEvent(uv_async_t *handle)
 {
     Nan::HandleScope scope;
 
-    while (!logQueue.wasEmpty())
+    if (logQueue.wasEmpty())
     {
-        LogEntry *logEntry;
-        logQueue.pop(logEntry);
+        return;
+    }
 
-        if (logCallback != nullptr)
-        {
-            v8::Local<v8::Value> argv[2];
-            argv[0] = ConversionUtility::toJsNumber(static_cast<int>(logEntry->severity));
-            argv[1] = ConversionUtility::toJsString(logEntry->message);
-            Nan::AsyncResource resource("pc-ble-driver-js:callback");
-            logCallback->Call(2, argv, &resource);
-        }
-        else
-        {
-            std::cerr << "Log event received, but no callback is registered." << std::endl;
-        }
+    // Deliver all queued entries in one callback
+    auto entries = Nan::New<v8::Array>();
+    uint32_t index = 0;
+    LogEntry logEntry;
 
-        // Free memory for current entry, we remove the element from the deque when the iteration is done
-        delete logEntry;
+    while (logQueue.pop(logEntry))
+    {
+        auto entry = Nan::New<v8::Object>();
+        Utility::Set(entry, "severity", static_cast<int32_t>(logEntry.severity));
+        Utility::Set(entry, "message", Nan::New(logEntry.message, static_cast<int>(logEntry.length)).ToLocalChecked());
+        Nan::Set(entries, index++, entry);
+    }
+
+    if (logCallback != nullptr)
+    {
+        v8::Local<v8::Value> argv[2];
+        argv[0] = entries;
+        argv[1] = ConversionUtility::toJsNumber(logDroppedPendingCount.exchange(0));
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        logCallback->Call(2, argv, &resource);
+    }
+    else
+    {
+        std::cerr << "Log event received, but no callback is registered." << std::endl;
     }
 }
 
@@ -171,9 +200,9 @@ void Adapter::onLogEvent(uv_async_t *handle)
 void Adapter::dispatchEvents()
 {
     // Trigger callback in NodeJS thread to call NodeJS callbacks
-    if (asyncEvent != nullptr)
+    if (asyncEvent != nullptr || sharedEventDispatch)
     {
-        uv_async_send(asyncEvent.get());
+        wakeUp(asyncEvent.get());
     }
     else
     {
@@ -232,28 +261,343 @@ static void sd_rpc_on_event(adapter_t *adapter, ble_evt_t *event)
     }
 }
 
-void Adapter::appendEvent(ble_evt_t *event)
+// Handles events that do not need JavaScript. This runs in the thread the SoftDevice driver has initiated.
+// Returns true if the event was handled and shall not be sent to JavaScript. Sets answeredByPolicy if a request
+// is still sent to JavaScript but the link policy has already replied to it.
+bool Adapter::handleEventNatively(ble_evt_t *event, bool &answeredByPolicy)
+{
+    // There is no SoftDevice to reply to
+    if (getSimulatedConnectivity() != nullptr)
+    {
+        return false;
+    }
+
+    switch (event->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            notificationFanout.onConnected(event->evt.gap_evt.conn_handle);
+            encryptFromBondStore(&(event->evt.gap_evt));
+
+            if (event->evt.gap_evt.params.connected.role == BLE_GAP_ROLE_CENTRAL)
+            {
+                connectScheduler.onConnected(event->evt.gap_evt.conn_handle);
+            }
+#if NRF_SD_BLE_API_VERSION >= 5
+            applyLinkPolicy(event->evt.gap_evt.conn_handle);
+#endif
+            return false;
+        case BLE_GAP_EVT_DISCONNECTED:
+            notificationFanout.onDisconnected(event->evt.gap_evt.conn_handle);
+            longReads.onDisconnected(event->evt.gap_evt.conn_handle);
+            longWrites.onDisconnected(event->evt.gap_evt.conn_handle);
+            connParamPolicy.onDisconnected(event->evt.gap_evt.conn_handle);
+            connectScheduler.onDisconnected(event->evt.gap_evt.conn_handle, event->evt.gap_evt.params.disconnected.reason);
+            return false;
+        case BLE_GAP_EVT_TIMEOUT:
+            // The pending connect timing out is only for JavaScript if it started it
+            return event->evt.gap_evt.params.timeout.src == BLE_GAP_TIMEOUT_SRC_CONN && connectScheduler.onTimeout();
+        case BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST:
+            return replyConnParamsFromPolicy(&(event->evt.gap_evt));
+        case BLE_GATTC_EVT_READ_RSP:
+            return longReads.onReadResponse(event->evt.gattc_evt.conn_handle, event->evt.gattc_evt.gatt_status,
+                                            event->evt.gattc_evt.params.read_rsp.data, event->evt.gattc_evt.params.read_rsp.len);
+        case BLE_GATTC_EVT_WRITE_RSP:
+            return continueLongWrite(&(event->evt.gattc_evt));
+        case BLE_GATTS_EVT_WRITE:
+            notificationFanout.onWrite(event->evt.gatts_evt.conn_handle, event->evt.gatts_evt.params.write.handle,
+                                       event->evt.gatts_evt.params.write.data, event->evt.gatts_evt.params.write.len);
+            return false;
+        case BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST:
+            return replyAuthorizeFromPolicy(&(event->evt.gatts_evt));
+        case BLE_GATTS_EVT_HVC:
+            resumeNotifications(event->evt.gatts_evt.conn_handle);
+            return false;
+#if NRF_SD_BLE_API_VERSION <= 3
+        case BLE_EVT_TX_COMPLETE:
+            resumeNotifications(event->evt.common_evt.conn_handle);
+            return false;
+#else
+        case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+            resumeNotifications(event->evt.gatts_evt.conn_handle);
+            return false;
+#endif
+        case BLE_GAP_EVT_SEC_INFO_REQUEST:
+            return replySecurityInfoFromBondStore(&(event->evt.gap_evt));
+        case BLE_GAP_EVT_LESC_DHKEY_REQUEST:
+            return submitLescDhKeyRequest(&(event->evt.gap_evt));
+#if NRF_SD_BLE_API_VERSION >= 5
+        // Answered here when the link policy covers them, JavaScript still receives them to record the outcome
+        // or to reply itself if the policy did not
+        case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+        case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
+        case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+            answeredByPolicy = replyFromLinkPolicy(event);
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+// Forgets the state mirrored from the SoftDevice, which is lost when the SoftDevice is reset or enabled
+void Adapter::clearSoftDeviceState()
+{
+    vendorUuids.clear();
+    notificationFanout.clear();
+    authorizePolicy.clear();
+    linkPolicy.clear();
+    connParamPolicy.clear();
+    connectScheduler.abortAll();
+    longReads.abortAll();
+    longWrites.abortAll();
+    whitelist.clear();
+}
+
+// Updates the per connection link statistics. This runs in the thread the SoftDevice driver has initiated.
+void Adapter::trackLinkEvent(const ble_evt_t *event)
+{
+    auto gapEvent = &(event->evt.gap_evt);
+    auto gattcEvent = &(event->evt.gattc_evt);
+    auto gattsEvent = &(event->evt.gatts_evt);
+
+    switch (event->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+        {
+            auto params = &(gapEvent->params.connected.conn_params);
+            linkStats.onConnected(gapEvent->conn_handle, params->max_conn_interval, params->slave_latency, params->conn_sup_timeout);
+            break;
+        }
+        case BLE_GAP_EVT_DISCONNECTED:
+            linkStats.onDisconnected(gapEvent->conn_handle);
+            break;
+        case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+        {
+            auto params = &(gapEvent->params.conn_param_update.conn_params);
+            linkStats.onConnParams(gapEvent->conn_handle, params->max_conn_interval, params->slave_latency, params->conn_sup_timeout);
+            break;
+        }
+#if NRF_SD_BLE_API_VERSION >= 5
+        case BLE_GAP_EVT_DATA_LENGTH_UPDATE:
+        {
+            auto params = &(gapEvent->params.data_length_update.effective_params);
+            linkStats.setDataLength(gapEvent->conn_handle, params->max_tx_octets, params->max_rx_octets);
+            break;
+        }
+        case BLE_GAP_EVT_PHY_UPDATE:
+            if (gapEvent->params.phy_update.status == BLE_HCI_STATUS_CODE_SUCCESS)
+            {
+                linkStats.setPhy(gapEvent->conn_handle, gapEvent->params.phy_update.tx_phy, gapEvent->params.phy_update.rx_phy);
+            }
+            break;
+        case BLE_GATTC_EVT_EXCHANGE_MTU_RSP:
+            linkStats.setPeerAttMtu(gattcEvent->conn_handle, gattcEvent->params.exchange_mtu_rsp.server_rx_mtu);
+            break;
+        case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+            linkStats.setPeerAttMtu(gattsEvent->conn_handle, gattsEvent->params.exchange_mtu_request.client_rx_mtu);
+            break;
+#endif
+        case BLE_GATTC_EVT_HVX:
+            linkStats.onRx(gattcEvent->conn_handle, LINK_STATS_PACKET_HVX, gattcEvent->params.hvx.len);
+            break;
+        case BLE_GATTC_EVT_READ_RSP:
+            linkStats.onRx(gattcEvent->conn_handle, LINK_STATS_PACKET_READ, gattcEvent->params.read_rsp.len);
+            linkStats.onResponse(gattcEvent->conn_handle, LINK_STATS_PACKET_READ);
+            break;
+        case BLE_GATTC_EVT_WRITE_RSP:
+            linkStats.onRx(gattcEvent->conn_handle, LINK_STATS_PACKET_OTHER, 0);
+
+            if (gattcEvent->params.write_rsp.write_op == BLE_GATT_OP_WRITE_REQ)
+            {
+                linkStats.onResponse(gattcEvent->conn_handle, LINK_STATS_PACKET_WRITE);
+            }
+            break;
+        case BLE_GATTS_EVT_WRITE:
+            linkStats.onRx(gattsEvent->conn_handle, LINK_STATS_PACKET_WRITE, gattsEvent->params.write.len);
+            break;
+        default:
+            break;
+    }
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::trackLinkTx(const uint16_t connHandle, const link_stats_packet_t type, const uint16_t length, const uint32_t result)
+{
+    if (result == NRF_SUCCESS)
+    {
+        linkStats.onTx(connHandle, type, length);
+    }
+#if NRF_SD_BLE_API_VERSION <= 3
+    else if (result == BLE_ERROR_NO_TX_PACKETS)
+#else
+    else if (result == NRF_ERROR_RESOURCES)
+#endif
+    {
+        linkStats.onTxStall(connHandle);
+    }
+}
+
+// An LESC DH key request as it is traced, the peer public key follows the event instead of being pointed to
+struct lesc_dhkey_request_record_t
+{
+    ble_evt_t event;
+    ble_gap_lesc_p256_pk_t pk_peer;
+};
+
+static_assert(sizeof(lesc_dhkey_request_record_t) <= EVENT_REPLAY_EVENT_SIZE, "LESC DH key request record does not fit the replay buffer");
+
+// Pointers in an event are meaningless to a later process. The data they point to is written inline, or left out
+// if it is memory of the application. This runs in the thread the SoftDevice driver has initiated.
+void Adapter::traceEvent(const ble_evt_t *event, const uint16_t size)
 {
-    eventCallbackCount += 1;
-    eventCallbackBatchEventCounter += 1;
+    auto timestamp = static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count());
+
+    // evt_len includes the header, fall back to the full copy size if the driver did not set it
+    auto length = std::min<uint16_t>(event->header.evt_len, size);
+
+    if (length == 0)
+    {
+        length = size;
+    }
+
+    switch (event->header.evt_id)
+    {
+        case BLE_GAP_EVT_LESC_DHKEY_REQUEST:
+        {
+            lesc_dhkey_request_record_t record;
+            memset(&record, 0, sizeof(record));
+            memcpy(&record.event, event, std::min<size_t>(length, sizeof(record.event)));
+
+            auto pkPeer = event->evt.gap_evt.params.lesc_dhkey_request.p_pk_peer;
+
+            if (pkPeer != nullptr)
+            {
+                record.pk_peer = *pkPeer;
+            }
+
+            record.event.evt.gap_evt.params.lesc_dhkey_request.p_pk_peer = nullptr;
+            eventTrace.write(timestamp, adapterId, &record, sizeof(record));
+            return;
+        }
+        case BLE_EVT_USER_MEM_RELEASE:
+        {
+            ble_evt_t record;
+            memset(&record, 0, sizeof(record));
+            memcpy(&record, event, std::min<size_t>(length, sizeof(record)));
+
+            record.evt.common_evt.params.user_mem_release.mem_block.p_mem = nullptr;
+            record.evt.common_evt.params.user_mem_release.mem_block.len = 0;
+            eventTrace.write(timestamp, adapterId, &record, sizeof(record));
+            return;
+        }
+        default:
+            eventTrace.write(timestamp, adapterId, event, length);
+            return;
+    }
+}
 
-    if (eventCallbackBatchEventCounter > eventCallbackMaxCount)
+// Points the pointer members of an event read from a trace at the data traced with it. Returns false if the event
+// still holds a pointer recorded by an earlier version of the trace, which can not be replayed.
+bool Adapter::resolveReplayedEvent(ble_evt_t *event)
+{
+    switch (event->header.evt_id)
     {
-        eventCallbackMaxCount = eventCallbackBatchEventCounter;
+        case BLE_GAP_EVT_LESC_DHKEY_REQUEST:
+        {
+            auto &request = event->evt.gap_evt.params.lesc_dhkey_request;
+
+            if (request.p_pk_peer != nullptr)
+            {
+                return false;
+            }
+
+            request.p_pk_peer = &(reinterpret_cast<lesc_dhkey_request_record_t *>(event)->pk_peer);
+            return true;
+        }
+        case BLE_EVT_USER_MEM_RELEASE:
+            return event->evt.common_evt.params.user_mem_release.mem_block.p_mem == nullptr;
+        default:
+            return true;
     }
+}
 
+void Adapter::appendEvent(ble_evt_t *event)
+{
     // Allocate memory to store decoded event including an unkown quantity of padding, use the same size as serialization_transport.cpp
     const int size = 512;
 
+    if (eventTrace.isEnabled())
+    {
+        traceEvent(event, size);
+    }
+
+    trackLinkEvent(event);
+    eventStats.onEventReceived(event->header.evt_id);
+
+    auto answeredByPolicy = false;
+
+    if (handleEventNatively(event, answeredByPolicy))
+    {
+        return;
+    }
+
     auto evt = malloc(size);
     memset(evt, 0, size);
     memcpy(evt, event, size);
 
+    // The peer public key may be stored after the event, it must point into the copy and not the driver's buffer
+    if (event->header.evt_id == BLE_GAP_EVT_LESC_DHKEY_REQUEST)
+    {
+        auto pkPeer = reinterpret_cast<const uint8_t *>(event->evt.gap_evt.params.lesc_dhkey_request.p_pk_peer);
+        auto begin = reinterpret_cast<const uint8_t *>(event);
+
+        if (pkPeer >= begin && pkPeer + sizeof(ble_gap_lesc_p256_pk_t) <= begin + size)
+        {
+            static_cast<ble_evt_t *>(evt)->evt.gap_evt.params.lesc_dhkey_request.p_pk_peer =
+                reinterpret_cast<ble_gap_lesc_p256_pk_t *>(static_cast<uint8_t *>(evt) + (pkPeer - begin));
+        }
+    }
+
     auto eventEntry = new EventEntry();
     eventEntry->event = static_cast<ble_evt_t*>(evt);
     eventEntry->timestamp = getCurrentTimeInMilliseconds();
+    eventEntry->received = chrono::steady_clock::now();
+    eventEntry->answeredByPolicy = answeredByPolicy;
+
+    // Counted before the push, createEventArray() subtracts the events it drains
+    uint32_t pending = 0;
+
+    if (eventMaxLatency != 0)
+    {
+        pending = ++eventBatchPendingCount;
+    }
+
+    // The queue is full if NodeJS does not keep up with the events
+    if (!eventQueue.push(eventEntry))
+    {
+        if (eventMaxLatency != 0)
+        {
+            --eventBatchPendingCount;
+        }
+
+        free(evt);
+        delete eventEntry;
+        eventStats.onEventDropped();
+        return;
+    }
 
-    eventQueue.push(eventEntry);
+    eventStats.onEventQueued();
+
+    // With adaptive batching, wake up NodeJS unless a batch is being coalesced and not yet full.
+    if (eventMaxLatency != 0)
+    {
+        if (!eventBatchCoalescing || pending >= eventMaxBatchSize)
+        {
+            dispatchEvents();
+        }
+
+        return;
+    }
 
     // If the event interval is not set, send the events to NodeJS as soon as possible.
     if (eventInterval == 0)
@@ -272,8 +616,26 @@ void Adapter::onRpcEvent(uv_async_t *handle)
         return;
     }
 
+    if (eventMaxLatency == 0)
+    {
+        callEventCallback(createEventArray());
+        return;
+    }
+
+    if (coalesceEvents())
+    {
+        return;
+    }
+
+    flushEvents();
+}
+
+// Converts and frees all queued events. Must be called in the NodeJS thread within a HandleScope.
+v8::Local<v8::Array> Adapter::createEventArray()
+{
     auto array = Nan::New<v8::Array>();
     auto arrayIndex = 0;
+    auto delivered = chrono::steady_clock::now();
 
     while (!eventQueue.wasEmpty())
     {
@@ -293,6 +655,15 @@ void Adapter::onRpcEvent(uv_async_t *handle)
             std::terminate();
         }
 
+        // Bonds are tracked in event order, before the keyset is released below
+        if (bondStore.isEnabled())
+        {
+            trackBondEvent(event);
+        }
+
+        // All event types start with conn_handle, events without a tracked connection are ignored
+        linkStats.onEventDelivered(event->evt.gap_evt.conn_handle, eventEntry->received, delivered);
+
         if (eventCallback != nullptr)
         {
             switch (event->header.evt_id)
@@ -377,6 +748,16 @@ void Adapter::onRpcEvent(uv_async_t *handle)
 
                 destroySecurityKeyStorage(event->evt.gap_evt.conn_handle);
             }
+
+#if NRF_SD_BLE_API_VERSION >= 5
+            if (event->header.evt_id == BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST ||
+                event->header.evt_id == BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST ||
+                event->header.evt_id == BLE_GAP_EVT_PHY_UPDATE_REQUEST)
+            {
+                v8::Local<v8::Object> obj = Utility::Get(array, arrayIndex)->ToObject();
+                Utility::Set(obj, "answered_by_policy", eventEntry->answeredByPolicy);
+            }
+#endif
         }
 
         arrayIndex++;
@@ -386,10 +767,23 @@ void Adapter::onRpcEvent(uv_async_t *handle)
         delete eventEntry;
     }
 
+    // The drained events are not pending for the next batch anymore, whichever dispatch drained them
+    auto drained = static_cast<uint32_t>(arrayIndex);
+    auto pending = eventBatchPendingCount.load();
+
+    while (!eventBatchPendingCount.compare_exchange_weak(pending, pending > drained ? pending - drained : 0))
+    {
+    }
+
+    return array;
+}
+
+void Adapter::callEventCallback(v8::Local<v8::Array> events)
+{
     v8::Local<v8::Value> callback_value[1];
-    callback_value[0] = array;
+    callback_value[0] = events;
 
-    auto start = chrono::high_resolution_clock::now();
+    auto start = chrono::steady_clock::now();
 
     if (eventCallback != nullptr)
     {
@@ -401,10 +795,7 @@ void Adapter::onRpcEvent(uv_async_t *handle)
         std::cerr << "BLE event received, but no callback is registered." << std::endl;
     }
 
-    auto end = chrono::high_resolution_clock::now();
-
-    auto duration = chrono::duration_cast<chrono::milliseconds>(end - start);
-    addEventBatchStatistics(duration);
+    addEventBatchStatistics(events->Length(), chrono::steady_clock::now() - start);
 }
 
 static void sd_rpc_on_status(adapter_t *adapter, sd_rpc_app_status_t id, const char * message)
@@ -432,7 +823,7 @@ void Adapter::appendStatus(StatusEntry *status)
     if (asyncStatus != nullptr)
     {
         statusQueue.push(status);
-        uv_async_send(asyncStatus.get());
+        wakeUp(asyncStatus.get());
     }
 }
 
@@ -496,6 +887,19 @@ v8::Local<v8::Object> CommonMemReleaseEvent::ToJs()
     return scope.Escape(obj);
 }
 
+#if NRF_SD_BLE_API_VERSION >= 5
+// The ATT MTU the SoftDevice is enabled with, BLE_GATT_ATT_MTU_DEFAULT unless configured
+static uint16_t getConfiguredAttMtu(const enable_ble_params_t *enable_params)
+{
+    if (enable_params->gatt_conn_cfg != nullptr && enable_params->gatt_conn_cfg->conn_cfg.params.gatt_conn_cfg.att_mtu != 0)
+    {
+        return enable_params->gatt_conn_cfg->conn_cfg.params.gatt_conn_cfg.att_mtu;
+    }
+
+    return BLE_GATT_ATT_MTU_DEFAULT;
+}
+#endif
+
 // Class private method that is only used by the class to activate the SoftDevice in the Adapter
 uint32_t Adapter::enableBLE(adapter_t *adapter, enable_ble_params_t *enable_params)
 {
@@ -588,6 +992,7 @@ NAN_METHOD(Adapter::EnableBLE)
 
     auto baton = new EnableBLEBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
 
     try
     {
@@ -600,14 +1005,24 @@ NAN_METHOD(Adapter::EnableBLE)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, EnableBLE, reinterpret_cast<uv_after_work_cb>(AfterEnableBLE));
+    QUEUE_ADAPTER_METHOD(obj, baton, EnableBLE);
 }
 
 // This runs in a worker thread (not Main Thread)
 void Adapter::EnableBLE(uv_work_t *req)
 {
     auto baton = static_cast<EnableBLEBaton *>(req->data);
+
+    // The attribute table and vendor specific UUIDs are empty after the SoftDevice is enabled
+    baton->mainObject->clearSoftDeviceState();
     baton->result = Adapter::enableBLE(baton->adapter, baton->enable_ble_params);
+
+#if NRF_SD_BLE_API_VERSION >= 5
+    if (baton->result == NRF_SUCCESS)
+    {
+        baton->mainObject->configuredAttMtu = getConfiguredAttMtu(baton->enable_ble_params);
+    }
+#endif
 }
 
 // This runs in  Main Thread
@@ -677,6 +1092,22 @@ NAN_METHOD(Adapter::Open)
         baton->response_timeout = ConversionUtility::getNativeUint32(options, "responseTimeout"); parameter++;
         baton->enable_ble = ConversionUtility::getBool(options, "enableBLE"); parameter++;
         baton->enable_ble_params = EnableParameters(ConversionUtility::getJsObject(options, "enableBLEParams")); parameter++;
+        baton->shared_event_dispatcher = ConversionUtility::getBool(options, "sharedEventDispatcher"); parameter++;
+        baton->evt_max_latency = ConversionUtility::getNativeUint32(options, "eventMaxLatency"); parameter++;
+        baton->evt_max_batch_size = ConversionUtility::getNativeUint32(options, "eventMaxBatchSize"); parameter++;
+        baton->simulated = ToSimulatedPhysicalLayer(ConversionUtility::getNativeString(options, "physicalLayer")); parameter++;
+
+        if (baton->simulated)
+        {
+            auto simulation = ConversionUtility::getJsObject(options, "simulation");
+            baton->simulation_params.adv_report_rate = ConversionUtility::getNativeUint32(simulation, "advReportRate");
+            baton->simulation_params.connection_count = ConversionUtility::getNativeUint32(simulation, "connectionCount");
+            baton->simulation_params.hvx_rate = ConversionUtility::getNativeUint32(simulation, "hvxRate");
+            baton->simulation_params.hvx_handle = ConversionUtility::getNativeUint16(simulation, "hvxHandle");
+            baton->simulation_params.hvx_length = ConversionUtility::getNativeUint16(simulation, "hvxLength");
+            baton->simulation_params.rpc_latency = ConversionUtility::getNativeUint32(simulation, "rpcLatency");
+        }
+        parameter++;
     }
     catch (std::string error)
     {
@@ -691,7 +1122,12 @@ NAN_METHOD(Adapter::Open)
             "retransmissionInterval",
             "responseTimeout",
             "enableBLE",
-            "enableBLEParams"
+            "enableBLEParams",
+            "sharedEventDispatcher",
+            "eventMaxLatency",
+            "eventMaxBatchSize",
+            "physicalLayer",
+            "simulation"
         };
         errormessage << _options[parameter] << ". Reason: " << error;
         Nan::ThrowTypeError(errormessage.str().c_str());
@@ -731,7 +1167,13 @@ NAN_METHOD(Adapter::Open)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, Open, reinterpret_cast<uv_after_work_cb>(AfterOpen));
+    // The shared wakeup handle must be created in the NodeJS thread
+    if (baton->shared_event_dispatcher)
+    {
+        initSharedEventDispatcher();
+    }
+
+    QUEUE_ADAPTER_METHOD(obj, baton, Open);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -739,10 +1181,23 @@ void Adapter::Open(uv_work_t *req)
 {
     auto baton = static_cast<OpenBaton *>(req->data);
 
-    baton->mainObject->initEventHandling(std::move(baton->event_callback), baton->evt_interval);
+    baton->mainObject->initEventHandling(std::move(baton->event_callback), baton->evt_interval,
+                                         baton->evt_max_latency, baton->evt_max_batch_size,
+                                         baton->shared_event_dispatcher);
     baton->mainObject->initLogHandling(std::move(baton->log_callback));
     baton->mainObject->initStatusHandling(std::move(baton->status_callback));
 
+    // Opening resets the SoftDevice
+    baton->mainObject->clearSoftDeviceState();
+
+    if (baton->simulated)
+    {
+        baton->mainObject->logSeverityFilter = baton->log_level;
+        baton->adapter = baton->mainObject->openSimulated(baton->simulation_params);
+        baton->result = NRF_SUCCESS;
+        return;
+    }
+
     // Ensure that the correct adapter gets the callbacks as long as we have no reference to
     // the driver adapter until after sd_rpc_open is called
     adapterBeingOpened = baton->mainObject;
@@ -762,7 +1217,8 @@ void Adapter::Open(uv_work_t *req)
     baton->adapter = adapter;
     baton->mainObject->adapter = adapter;
 
-    // Set the log level
+    // Set the log level, both in the driver and for entries reaching the log queue
+    baton->mainObject->logSeverityFilter = baton->log_level;
     auto error_code = sd_rpc_log_handler_severity_filter_set(adapter, baton->log_level);
 
     if (error_code != NRF_SUCCESS)
@@ -794,6 +1250,9 @@ void Adapter::Open(uv_work_t *req)
 
         if (error_code == NRF_SUCCESS)
         {
+#if NRF_SD_BLE_API_VERSION >= 5
+            baton->mainObject->configuredAttMtu = getConfiguredAttMtu(baton->enable_ble_params);
+#endif
             baton->result = error_code;
             return;
         }
@@ -808,6 +1267,36 @@ void Adapter::Open(uv_work_t *req)
     baton->result = error_code;
 }
 
+// Replaces the serial port, the serialization transport and the connectivity firmware with a simulator
+// that synthesizes events. This runs in a worker thread (not Main Thread)
+adapter_t *Adapter::openSimulated(const simulated_connectivity_params_t &params)
+{
+    auto simulation = std::make_shared<SimulatedConnectivity>(params);
+
+    // The adapter is never passed to the driver, it only identifies this adapter in the addon
+    auto simulatedAdapter = static_cast<adapter_t *>(calloc(1, sizeof(adapter_t)));
+    simulatedAdapter->internal = simulation.get();
+
+    adapter = simulatedAdapter;
+    setSimulatedConnectivity(simulation);
+
+    simulation->start([this](ble_evt_t *event) {
+        appendEvent(event);
+    });
+
+    return simulatedAdapter;
+}
+
+std::shared_ptr<SimulatedConnectivity> Adapter::getSimulatedConnectivity()
+{
+    return std::atomic_load(&simulatedConnectivity);
+}
+
+void Adapter::setSimulatedConnectivity(std::shared_ptr<SimulatedConnectivity> simulation)
+{
+    std::atomic_store(&simulatedConnectivity, simulation);
+}
+
 // This runs in  Main Thread
 void Adapter::AfterOpen(uv_work_t *req)
 {
@@ -852,17 +1341,35 @@ NAN_METHOD(Adapter::Close)
         return;
     }
 
+    // The worker replies to the SoftDevice, it must be stopped before the driver is closed
+    obj->lescDhKeyWorker.stop();
+
+    // Scheduled connects are reported as aborted, before the thread that would start them is stopped
+    obj->connectScheduler.abortAll();
+    obj->connectScheduler.stop();
+
+    // No events must be appended after the V8 resources are cleaned up
+    obj->eventReplay.stop();
+
+    auto simulation = obj->getSimulatedConnectivity();
+
+    if (simulation != nullptr)
+    {
+        simulation->stop();
+    }
+
     auto baton = new CloseBaton(callback);
     baton->adapter = obj->adapter;
     baton->mainObject = obj;
 
-    uv_queue_work(uv_default_loop(), baton->req, Close, reinterpret_cast<uv_after_work_cb>(AfterClose));
+    QUEUE_ADAPTER_METHOD(obj, baton, Close);
 }
 
 void Adapter::Close(uv_work_t *req)
 {
     auto baton = static_cast<CloseBaton *>(req->data);
     baton->result = sd_rpc_close(baton->adapter);
+    baton->mainObject->clearSoftDeviceState();
 }
 
 void Adapter::AfterClose(uv_work_t *req)
@@ -870,6 +1377,12 @@ void Adapter::AfterClose(uv_work_t *req)
     Nan::HandleScope scope;
     auto baton = static_cast<CloseBaton *>(req->data);
 
+    // The simulator completes the Close worker in place of sd_rpc_close, forget the state here instead
+    if (baton->mainObject->getSimulatedConnectivity() != nullptr)
+    {
+        baton->mainObject->clearSoftDeviceState();
+    }
+
     baton->mainObject->cleanUpV8Resources();
 
     if (baton->callback != nullptr)
@@ -884,7 +1397,16 @@ void Adapter::AfterClose(uv_work_t *req)
         {
             argv[0] = Nan::Undefined();
 
-            sd_rpc_adapter_delete(baton->adapter);
+            // A simulated adapter was never created by the driver
+            if (baton->mainObject->getSimulatedConnectivity() != nullptr)
+            {
+                baton->mainObject->setSimulatedConnectivity(nullptr);
+            }
+            else
+            {
+                sd_rpc_adapter_delete(baton->adapter);
+            }
+
             free(baton->adapter);
             baton->adapter = nullptr;
         }
@@ -918,13 +1440,15 @@ NAN_METHOD(Adapter::ConnReset)
     /* Hardcoding the reset mode. Consider adding argument for letting user choose reset mode. */
     baton->reset = SOFT_RESET;
 
-    uv_queue_work(uv_default_loop(), baton->req, ConnReset, reinterpret_cast<uv_after_work_cb>(AfterConnReset));
+    QUEUE_ADAPTER_METHOD(obj, baton, ConnReset);
 }
 
 void Adapter::ConnReset(uv_work_t *req)
 {
     auto baton = static_cast<ConnResetBaton *>(req->data);
     baton->result = sd_rpc_conn_reset(baton->adapter, baton->reset);
+
+    baton->mainObject->clearSoftDeviceState();
 }
 
 void Adapter::AfterConnReset(uv_work_t *req)
@@ -978,14 +1502,28 @@ NAN_METHOD(Adapter::AddVendorSpecificUUID)
     auto baton = new BleAddVendorSpcificUUIDBaton(callback);
     baton->p_vs_uuid = BleUUID128(uuid);
     baton->adapter = obj->adapter;
+    baton->vendorUuids = &obj->vendorUuids;
+
+    // The SoftDevice already knows this base, complete without a round trip
+    if (obj->vendorUuids.findType(baton->p_vs_uuid->uuid128, &baton->p_uuid_type))
+    {
+        baton->result = NRF_SUCCESS;
+        queueBatonCompletion(baton, AfterAddVendorSpecificUUID);
+        return;
+    }
 
-    uv_queue_work(uv_default_loop(), baton->req, AddVendorSpecificUUID, reinterpret_cast<uv_after_work_cb>(AfterAddVendorSpecificUUID));
+    QUEUE_ADAPTER_METHOD(obj, baton, AddVendorSpecificUUID);
 }
 
 void Adapter::AddVendorSpecificUUID(uv_work_t *req)
 {
     auto baton = static_cast<BleAddVendorSpcificUUIDBaton *>(req->data);
     baton->result = sd_ble_uuid_vs_add(baton->adapter, baton->p_vs_uuid, &baton->p_uuid_type);
+
+    if (baton->result == NRF_SUCCESS)
+    {
+        baton->vendorUuids->add(baton->p_uuid_type, baton->p_vs_uuid->uuid128);
+    }
 }
 
 void Adapter::AfterAddVendorSpecificUUID(uv_work_t *req)
@@ -1071,6 +1609,22 @@ NAN_INLINE sd_rpc_log_severity_t ToLogSeverityEnum(const v8::Handle<v8::String>&
     return log_severity;
 }
 
+// Returns true if the simulated physical layer is selected
+NAN_INLINE bool ToSimulatedPhysicalLayer(const std::string& physicalLayer)
+{
+    if (physicalLayer == "simulated")
+    {
+        return true;
+    }
+
+    if (physicalLayer != "uart")
+    {
+        throw std::string("'uart' or 'simulated'");
+    }
+
+    return false;
+}
+
 NAN_METHOD(Adapter::GetVersion)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
@@ -1094,7 +1648,7 @@ NAN_METHOD(Adapter::GetVersion)
     baton->version = version;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GetVersion, reinterpret_cast<uv_after_work_cb>(AfterGetVersion));
+    QUEUE_ADAPTER_METHOD(obj, baton, GetVersion);
 
     return;
 }
@@ -1167,7 +1721,28 @@ NAN_METHOD(Adapter::EncodeUUID)
     baton->uuid_le = new uint8_t[16];
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, EncodeUUID, reinterpret_cast<uv_after_work_cb>(AfterEncodeUUID));
+    // Encoding is a lookup if the base is known, complete without a round trip
+    if (baton->p_uuid->type == BLE_UUID_TYPE_BLE)
+    {
+        baton->uuid_le_len = 2;
+        baton->uuid_le[0] = static_cast<uint8_t>(baton->p_uuid->uuid & 0xFF);
+        baton->uuid_le[1] = static_cast<uint8_t>(baton->p_uuid->uuid >> 8);
+        baton->result = NRF_SUCCESS;
+        queueBatonCompletion(baton, AfterEncodeUUID);
+        return;
+    }
+
+    if (baton->p_uuid->type >= BLE_UUID_TYPE_VENDOR_BEGIN && obj->vendorUuids.getBase(baton->p_uuid->type, baton->uuid_le))
+    {
+        baton->uuid_le_len = VENDOR_UUID_LENGTH;
+        baton->uuid_le[12] = static_cast<uint8_t>(baton->p_uuid->uuid & 0xFF);
+        baton->uuid_le[13] = static_cast<uint8_t>(baton->p_uuid->uuid >> 8);
+        baton->result = NRF_SUCCESS;
+        queueBatonCompletion(baton, AfterEncodeUUID);
+        return;
+    }
+
+    QUEUE_ADAPTER_METHOD(obj, baton, EncodeUUID);
 
     return;
 }
@@ -1236,8 +1811,28 @@ NAN_METHOD(Adapter::DecodeUUID)
     baton->uuid_le = ConversionUtility::extractHex(uuid_le);
     baton->p_uuid = new ble_uuid_t();
     baton->adapter = obj->adapter;
+    baton->vendorUuids = &obj->vendorUuids;
+
+    // Decoding is a lookup if the base is known, complete without a round trip
+    if (baton->uuid_le_len == 2 && baton->uuid_le.size() == 2)
+    {
+        baton->p_uuid->type = BLE_UUID_TYPE_BLE;
+        baton->p_uuid->uuid = static_cast<uint16_t>(baton->uuid_le[0] | (baton->uuid_le[1] << 8));
+        baton->result = NRF_SUCCESS;
+        queueBatonCompletion(baton, AfterDecodeUUID);
+        return;
+    }
+
+    if (baton->uuid_le_len == VENDOR_UUID_LENGTH && baton->uuid_le.size() == VENDOR_UUID_LENGTH &&
+        obj->vendorUuids.findType(baton->uuid_le.data(), &baton->p_uuid->type))
+    {
+        baton->p_uuid->uuid = static_cast<uint16_t>(baton->uuid_le[12] | (baton->uuid_le[13] << 8));
+        baton->result = NRF_SUCCESS;
+        queueBatonCompletion(baton, AfterDecodeUUID);
+        return;
+    }
 
-    uv_queue_work(uv_default_loop(), baton->req, DecodeUUID, reinterpret_cast<uv_after_work_cb>(AfterDecodeUUID));
+    QUEUE_ADAPTER_METHOD(obj, baton, DecodeUUID);
 
     return;
 }
@@ -1246,6 +1841,11 @@ void Adapter::DecodeUUID(uv_work_t *req)
 {
     auto baton = static_cast<BleUUIDDecodeBaton *>(req->data);
     baton->result = sd_ble_uuid_decode(baton->adapter, baton->uuid_le_len, baton->uuid_le.data(), baton->p_uuid);
+
+    if (baton->result == NRF_SUCCESS && baton->uuid_le_len == VENDOR_UUID_LENGTH && baton->p_uuid->type >= BLE_UUID_TYPE_VENDOR_BEGIN)
+    {
+        baton->vendorUuids->add(baton->p_uuid->type, baton->uuid_le.data());
+    }
 }
 
 // This runs in Main Thread
@@ -1271,19 +1871,489 @@ void Adapter::AfterDecodeUUID(uv_work_t *req)
     delete baton;
 }
 
+// Returns the encoded UUID as hex, like the last argument of the encodeUUID callback, or undefined
+// if the vendor specific base is not known. Only reads the registry, never calls the SoftDevice.
+NAN_METHOD(Adapter::EncodeUUIDSync)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    ble_uuid_t uuid;
+
+    try
+    {
+        auto jsUuid = ConversionUtility::getJsObject(info[0]);
+        uuid.uuid = ConversionUtility::getNativeUint16(jsUuid, "uuid");
+        uuid.type = ConversionUtility::getNativeUint8(jsUuid, "type");
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    uint8_t uuid_le[VENDOR_UUID_LENGTH];
+    uint8_t uuid_le_len;
+
+    if (uuid.type == BLE_UUID_TYPE_BLE)
+    {
+        uuid_le_len = 2;
+        uuid_le[0] = static_cast<uint8_t>(uuid.uuid & 0xFF);
+        uuid_le[1] = static_cast<uint8_t>(uuid.uuid >> 8);
+    }
+    else if (uuid.type >= BLE_UUID_TYPE_VENDOR_BEGIN && obj->vendorUuids.getBase(uuid.type, uuid_le))
+    {
+        uuid_le_len = VENDOR_UUID_LENGTH;
+        uuid_le[12] = static_cast<uint8_t>(uuid.uuid & 0xFF);
+        uuid_le[13] = static_cast<uint8_t>(uuid.uuid >> 8);
+    }
+    else
+    {
+        info.GetReturnValue().SetUndefined();
+        return;
+    }
+
+    info.GetReturnValue().Set(ConversionUtility::encodeHex(reinterpret_cast<char *>(uuid_le), uuid_le_len));
+}
+
+// Returns the decoded UUID, like the decodeUUID callback, or undefined if the vendor specific base
+// is not known. Only reads the registry, never calls the SoftDevice.
+NAN_METHOD(Adapter::DecodeUUIDSync)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint8_t le_len;
+    v8::Local<v8::String> uuid_text;
+    auto argumentcount = 0;
+
+    try
+    {
+        le_len = ConversionUtility::getNativeUint8(info[argumentcount]);
+        argumentcount++;
+
+        if (!info[argumentcount]->IsString())
+        {
+            throw std::string("string");
+        }
+
+        uuid_text = info[argumentcount]->ToString();
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    if ((le_len != 2 && le_len != VENDOR_UUID_LENGTH) || uuid_text->Length() != le_len * 2)
+    {
+        info.GetReturnValue().SetUndefined();
+        return;
+    }
+
+    // The text is big endian, as in extractHex
+    char text[VENDOR_UUID_LENGTH * 2];
+    uint8_t uuid_le[VENDOR_UUID_LENGTH];
+
+    uuid_text->WriteUtf8(text, le_len * 2);
+
+    for (auto i = 0; i < le_len; i++)
+    {
+        auto first = ConversionUtility::extractHexHelper(text[i * 2]);
+        auto second = ConversionUtility::extractHexHelper(text[i * 2 + 1]);
+
+        if (first == 0xFF || second == 0xFF)
+        {
+            info.GetReturnValue().SetUndefined();
+            return;
+        }
+
+        uuid_le[le_len - 1 - i] = static_cast<uint8_t>((first << 4) + second);
+    }
+
+    ble_uuid_t uuid;
+
+    if (le_len == 2)
+    {
+        uuid.type = BLE_UUID_TYPE_BLE;
+        uuid.uuid = static_cast<uint16_t>(uuid_le[0] | (uuid_le[1] << 8));
+    }
+    else if (obj->vendorUuids.findType(uuid_le, &uuid.type))
+    {
+        uuid.uuid = static_cast<uint16_t>(uuid_le[12] | (uuid_le[13] << 8));
+    }
+    else
+    {
+        info.GetReturnValue().SetUndefined();
+        return;
+    }
+
+    info.GetReturnValue().Set(BleUUID(&uuid).ToJs());
+}
+
+namespace {
+    // Values are divided by scale, latency histograms are in nanoseconds and JavaScript gets microseconds
+    v8::Local<v8::Object> histogramToJs(const LatencyHistogram &histogram, const double scale = 1000.0)
+    {
+        Nan::EscapableHandleScope scope;
+        auto obj = Nan::New<v8::Object>();
+
+        Utility::Set(obj, "min", histogram.getMin() / scale);
+        Utility::Set(obj, "max", histogram.getMax() / scale);
+        Utility::Set(obj, "mean", histogram.getMean() / scale);
+        Utility::Set(obj, "p50", histogram.getPercentile(50) / scale);
+        Utility::Set(obj, "p90", histogram.getPercentile(90) / scale);
+        Utility::Set(obj, "p99", histogram.getPercentile(99) / scale);
+        Utility::Set(obj, "p999", histogram.getPercentile(99.9) / scale);
+
+        return scope.Escape(obj);
+    }
+
+    const char *eventIdToString(const uint16_t evtId)
+    {
+        for (auto nameMap : { &common_event_name_map, &gap_event_name_map, &gattc_event_name_map, &gatts_event_name_map })
+        {
+            auto it = nameMap->find(evtId);
+
+            if (it != nameMap->end())
+            {
+                return it->second;
+            }
+        }
+
+        return nullptr;
+    }
+}
+
 NAN_METHOD(Adapter::GetStats)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
     auto stats = Nan::New<v8::Object>();
 
-    Utility::Set(stats, "eventCallbackTotalTime", obj->getEventCallbackTotalTime());
-    Utility::Set(stats, "eventCallbackTotalCount", obj->getEventCallbackCount());
-    Utility::Set(stats, "eventCallbackBatchMaxCount", obj->getEventCallbackMaxCount());
-    Utility::Set(stats, "eventCallbackBatchAvgCount", obj->getAverageCallbackBatchCount());
+    auto eventStats = obj->eventStats.getSnapshot();
+
+    Utility::Set(stats, "eventCallbackTotalTime", eventStats.callback_total_time / 1000000.0);
+    Utility::Set(stats, "eventCallbackTotalCount", static_cast<double>(eventStats.event_count));
+    Utility::Set(stats, "eventCallbackBatchCount", static_cast<double>(eventStats.batch_count));
+    Utility::Set(stats, "eventCallbackBatchMaxCount", static_cast<double>(eventStats.batch_size.getMax()));
+    Utility::Set(stats, "eventCallbackBatchAvgCount", eventStats.batch_size.getMean());
+    Utility::Set(stats, "eventCallbackTime", histogramToJs(eventStats.callback_time));
+    Utility::Set(stats, "eventCallbackBatchSize", histogramToJs(eventStats.batch_size, 1.0));
+    Utility::Set(stats, "eventDroppedCount", obj->eventStats.getDroppedCount());
+
+    auto eventCounts = Nan::New<v8::Object>();
+
+    for (uint16_t evtId = 0; evtId < EventStats::EVENT_ID_COUNT; evtId++)
+    {
+        auto count = obj->eventStats.getEventTypeCount(evtId);
+
+        if (count == 0)
+        {
+            continue;
+        }
+
+        auto name = eventIdToString(evtId);
+        Utility::Set(eventCounts, name != nullptr ? name : std::to_string(evtId).c_str(), count);
+    }
+
+    Utility::Set(stats, "eventCounts", eventCounts);
+    Utility::Set(stats, "eventCallbackBatchImmediateCount", obj->getEventCallbackBatchImmediateCount());
+    Utility::Set(stats, "eventCallbackBatchCoalescedCount", obj->getEventCallbackBatchCoalescedCount());
+    Utility::Set(stats, "logDroppedCount", obj->getLogDroppedCount());
+    Utility::Set(stats, "logTruncatedCount", obj->getLogTruncatedCount());
+    Utility::Set(stats, "eventTraceRecordCount", obj->eventTrace.getRecordCount());
+    Utility::Set(stats, "eventTraceErrorCount", obj->eventTrace.getErrorCount());
+    Utility::Set(stats, "eventReplayEventCount", obj->eventReplay.getEventCount());
+    Utility::Set(stats, "eventReplayErrorCount", obj->eventReplay.getErrorCount());
+    Utility::Set(stats, "adapterId", obj->adapterId);
+    Utility::Set(stats, "bondStoreSecInfoReplyCount", static_cast<uint32_t>(obj->bondStoreSecInfoReplyCount));
+    Utility::Set(stats, "bondStoreEncryptCount", static_cast<uint32_t>(obj->bondStoreEncryptCount));
+    Utility::Set(stats, "lescDhKeyReplyCount", obj->lescDhKeyWorker.getReplyCount());
+    Utility::Set(stats, "lescDhKeyErrorCount", obj->lescDhKeyWorker.getErrorCount());
+    Utility::Set(stats, "lescDhKeyMaxComputeTime", obj->lescDhKeyWorker.getMaxComputeTime());
+
+    auto simulation = obj->getSimulatedConnectivity();
+    Utility::Set(stats, "simulatedEventCount", simulation != nullptr ? simulation->getEventCount() : 0);
+    Utility::Set(stats, "simulatedCallCount", simulation != nullptr ? simulation->getCallCount() : 0);
+
+    Utility::Set(stats, "vendorUuidCount", static_cast<uint32_t>(obj->vendorUuids.getCount()));
+    Utility::Set(stats, "vendorUuidHitCount", obj->vendorUuids.getHitCount());
+    Utility::Set(stats, "vendorUuidMissCount", obj->vendorUuids.getMissCount());
+    Utility::Set(stats, "notifyAllSentCount", obj->notificationFanout.getSentCount());
+    Utility::Set(stats, "notifyAllQueuedCount", obj->notificationFanout.getQueuedCount());
+    Utility::Set(stats, "notifyAllDroppedCount", obj->notificationFanout.getDroppedCount());
+    Utility::Set(stats, "authorizeAcceptedCount", obj->authorizePolicy.getAcceptedCount());
+    Utility::Set(stats, "authorizeRejectedCount", obj->authorizePolicy.getRejectedCount());
+    Utility::Set(stats, "authorizeErrorCount", obj->authorizePolicy.getErrorCount());
+    Utility::Set(stats, "longReadCompletedCount", obj->longReads.getCompletedCount());
+    Utility::Set(stats, "longReadFailedCount", obj->longReads.getFailedCount());
+    Utility::Set(stats, "longReadRequestCount", obj->longReads.getRequestCount());
+    Utility::Set(stats, "longWriteCompletedCount", obj->longWrites.getCompletedCount());
+    Utility::Set(stats, "longWriteFailedCount", obj->longWrites.getFailedCount());
+    Utility::Set(stats, "longWriteVerifyFailedCount", obj->longWrites.getVerifyFailedCount());
+    Utility::Set(stats, "longWriteRequestCount", obj->longWrites.getRequestCount());
+    Utility::Set(stats, "linkPolicyRequestCount", obj->linkPolicy.getRequestCount());
+    Utility::Set(stats, "linkPolicyReplyCount", obj->linkPolicy.getReplyCount());
+    Utility::Set(stats, "linkPolicyErrorCount", obj->linkPolicy.getErrorCount());
+    Utility::Set(stats, "connParamAcceptedCount", obj->connParamPolicy.getAcceptedCount());
+    Utility::Set(stats, "connParamClampedCount", obj->connParamPolicy.getClampedCount());
+    Utility::Set(stats, "connParamRejectedCount", obj->connParamPolicy.getRejectedCount());
+    Utility::Set(stats, "connParamErrorCount", obj->connParamPolicy.getErrorCount());
+    Utility::Set(stats, "scheduledConnectPendingCount", obj->connectScheduler.getPendingCount());
+    Utility::Set(stats, "scheduledConnectConnectedCount", obj->connectScheduler.getConnectedCount());
+    Utility::Set(stats, "scheduledConnectFailedCount", obj->connectScheduler.getFailedCount());
+    Utility::Set(stats, "scheduledConnectRetryCount", obj->connectScheduler.getRetryCount());
+    Utility::Set(stats, "whitelistAddressCount", obj->whitelist.getAddressCount());
+    Utility::Set(stats, "whitelistIdentityCount", obj->whitelist.getIdentityCount());
+
+    auto links = obj->linkStats.getSnapshot();
+    auto linkArray = Nan::New<v8::Array>();
+
+    for (uint32_t i = 0; i < links.size(); i++)
+    {
+        auto &link = links[i];
+        auto linkObject = Nan::New<v8::Object>();
+
+        Utility::Set(linkObject, "conn_handle", link.conn_handle);
+        Utility::Set(linkObject, "connectedTime", link.connected_time);
+        Utility::Set(linkObject, "rxPacketCount", link.rx_packet_count);
+        Utility::Set(linkObject, "rxByteCount", link.rx_byte_count);
+        Utility::Set(linkObject, "txPacketCount", link.tx_packet_count);
+        Utility::Set(linkObject, "txByteCount", link.tx_byte_count);
+        Utility::Set(linkObject, "hvxRxCount", link.hvx_rx_count);
+        Utility::Set(linkObject, "hvxTxCount", link.hvx_tx_count);
+        Utility::Set(linkObject, "writeRxCount", link.write_rx_count);
+        Utility::Set(linkObject, "writeTxCount", link.write_tx_count);
+        Utility::Set(linkObject, "hvxRxRate", link.hvx_rx_rate);
+        Utility::Set(linkObject, "hvxTxRate", link.hvx_tx_rate);
+        Utility::Set(linkObject, "writeRxRate", link.write_rx_rate);
+        Utility::Set(linkObject, "writeTxRate", link.write_tx_rate);
+        Utility::Set(linkObject, "txStallCount", link.tx_stall_count);
+        Utility::Set(linkObject, "eventCount", link.event_count);
+        Utility::Set(linkObject, "eventLatencyAvg", link.event_latency_avg);
+        Utility::Set(linkObject, "eventLatencyP99", link.event_latency_p99);
+        Utility::Set(linkObject, "readRttCount", link.read_rtt_count);
+        Utility::Set(linkObject, "readRttAvg", link.read_rtt_avg);
+        Utility::Set(linkObject, "readRttMax", link.read_rtt_max);
+        Utility::Set(linkObject, "writeRttCount", link.write_rtt_count);
+        Utility::Set(linkObject, "writeRttAvg", link.write_rtt_avg);
+        Utility::Set(linkObject, "writeRttMax", link.write_rtt_max);
+        Utility::Set(linkObject, "connInterval", link.conn_interval);
+        Utility::Set(linkObject, "slaveLatency", link.slave_latency);
+        Utility::Set(linkObject, "connSupTimeout", link.conn_sup_timeout);
+        Utility::Set(linkObject, "attMtu", link.att_mtu);
+        Utility::Set(linkObject, "maxTxOctets", link.max_tx_octets);
+        Utility::Set(linkObject, "maxRxOctets", link.max_rx_octets);
+        Utility::Set(linkObject, "txPhy", link.tx_phy);
+        Utility::Set(linkObject, "rxPhy", link.rx_phy);
+
+        Nan::Set(linkArray, i, linkObject);
+    }
+
+    Utility::Set(stats, "links", linkArray);
+
+    Utility::SetReturnValue(info, stats);
+}
+
+NAN_METHOD(Adapter::StartEventTrace)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    std::string path;
+    v8::Local<v8::Object> options;
+    auto argumentcount = 0;
+
+    try
+    {
+        path = ConversionUtility::getNativeString(info[argumentcount]);
+        argumentcount++;
+
+        options = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    uint32_t maxFileSize;
+    uint32_t maxFiles;
+
+    try
+    {
+        maxFileSize = ConversionUtility::getNativeUint32(options, "maxFileSize");
+        maxFiles = ConversionUtility::getNativeUint32(options, "maxFiles");
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getStructErrorMessage("event trace options", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    try
+    {
+        obj->eventTrace.start(path, maxFileSize, maxFiles, NRF_SD_BLE_API_VERSION);
+    }
+    catch (std::string error)
+    {
+        Nan::ThrowError(error.c_str());
+    }
+}
+
+NAN_METHOD(Adapter::StopEventTrace)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    obj->eventTrace.stop();
+}
+
+NAN_METHOD(Adapter::StartEventReplay)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    std::string path;
+    v8::Local<v8::Object> options;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        path = ConversionUtility::getNativeString(info[argumentcount]);
+        argumentcount++;
+
+        options = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    double speed;
+    int32_t adapterId;
+
+    try
+    {
+        speed = ConversionUtility::getNativeDouble(options, "speed");
+        adapterId = ConversionUtility::getNativeInt32(options, "adapterId");
+    }
+    catch (std::string error)
+    {
+        auto message = ErrorMessage::getStructErrorMessage("event replay options", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    // Replayed events must not reach a SoftDevice, it would receive replies for events it never sent
+    if (obj->getSimulatedConnectivity() == nullptr)
+    {
+        Nan::ThrowError("Event replay requires an adapter opened with the simulated physical layer.");
+        return;
+    }
+
+    obj->initEventReplayHandling(std::make_unique<Nan::Callback>(callback));
+
+    // The replay thread becomes the only producer of the event queue until the replay is complete.
+    // A running replay resumes the simulation when it is stopped, stop it first.
+    obj->eventReplay.stop();
+
+    auto simulation = obj->getSimulatedConnectivity();
+    simulation->pause();
+
+    try
+    {
+        auto asyncEventReplay = obj->asyncEventReplay.get();
+
+        obj->eventReplay.start(path, NRF_SD_BLE_API_VERSION, speed, adapterId,
+            [obj](void *event) {
+                auto bleEvent = static_cast<ble_evt_t *>(event);
+
+                if (!resolveReplayedEvent(bleEvent))
+                {
+                    return false;
+                }
+
+                obj->appendEvent(bleEvent);
+                return true;
+            },
+            [simulation, asyncEventReplay]() {
+                simulation->resume();
+                uv_async_send(asyncEventReplay);
+            });
+    }
+    catch (std::string error)
+    {
+        simulation->resume();
+        obj->eventReplayCallback.reset();
+        Nan::ThrowError(error.c_str());
+    }
+}
+
+NAN_METHOD(Adapter::StopEventReplay)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    obj->eventReplay.stop();
+}
+
+// This runs in Main Thread
+void Adapter::onEventReplayEvent(uv_async_t *handle)
+{
+    if (eventReplay.isRunning() || eventReplayCallback == nullptr)
+    {
+        return;
+    }
+
+    // The replay is reported complete after the replayed events are delivered to JavaScript
+    if (!eventQueue.wasEmpty())
+    {
+        uv_async_send(handle);
+        return;
+    }
+
+    Nan::HandleScope scope;
+
+    // The callback may start a new replay
+    auto callback = std::move(eventReplayCallback);
+
+    v8::Local<v8::Value> argv[2];
+    argv[0] = Nan::Undefined();
+    argv[1] = ConversionUtility::toJsNumber(eventReplay.getEventCount());
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    callback->Call(2, argv, &resource);
+}
+
+NAN_METHOD(Adapter::GetMethodStats)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    auto methods = obj->methodStats.getSnapshot();
+    auto stats = Nan::New<v8::Object>();
+
+    for (auto &method : methods)
+    {
+        auto methodObject = Nan::New<v8::Object>();
+
+        Utility::Set(methodObject, "count", static_cast<double>(method.execute.getCount()));
+        Utility::Set(methodObject, "queue", histogramToJs(method.queue));
+        Utility::Set(methodObject, "execute", histogramToJs(method.execute));
+        Utility::Set(methodObject, "callback", histogramToJs(method.callback));
+
+        Utility::Set(stats, method.name.c_str(), methodObject);
+    }
 
     Utility::SetReturnValue(info, stats);
 }
 
+NAN_METHOD(Adapter::ResetMethodStats)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    obj->methodStats.reset();
+}
+
 NAN_METHOD(Adapter::ReplyUserMemory)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
@@ -1325,7 +2395,7 @@ NAN_METHOD(Adapter::ReplyUserMemory)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, ReplyUserMemory, reinterpret_cast<uv_after_work_cb>(AfterReplyUserMemory));
+    QUEUE_ADAPTER_METHOD(obj, baton, ReplyUserMemory);
 }
 
 void Adapter::ReplyUserMemory(uv_work_t *req)
@@ -1399,7 +2469,7 @@ NAN_METHOD(Adapter::SetBleOption)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, SetBleOption, reinterpret_cast<uv_after_work_cb>(AfterSetBleOption));
+    QUEUE_ADAPTER_METHOD(obj, baton, SetBleOption);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1463,7 +2533,7 @@ NAN_METHOD(Adapter::GetBleOption)
     baton->opt_id = optionId;
     baton->p_opt = new ble_opt_t();
 
-    uv_queue_work(uv_default_loop(), baton->req, GetBleOption, reinterpret_cast<uv_after_work_cb>(AfterGetBleOption));
+    QUEUE_ADAPTER_METHOD(obj, baton, GetBleOption);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1540,6 +2610,7 @@ NAN_METHOD(Adapter::SetBleConfig)
 
     auto baton = new BleConfigBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->cfg_id = configId;
 
     try
@@ -1553,7 +2624,7 @@ NAN_METHOD(Adapter::SetBleConfig)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, SetBleConfig, reinterpret_cast<uv_after_work_cb>(AfterSetBleConfig));
+    QUEUE_ADAPTER_METHOD(obj, baton, SetBleConfig);
 }
 
 void Adapter::SetBleConfig(uv_work_t *req)
@@ -1561,6 +2632,13 @@ void Adapter::SetBleConfig(uv_work_t *req)
     auto baton = static_cast<BleConfigBaton *>(req->data);
     const uint32_t app_ram_base = 0;
     baton->result = sd_ble_cfg_set(baton->adapter, baton->cfg_id, baton->p_cfg, app_ram_base);
+
+    if (baton->result == NRF_SUCCESS && baton->cfg_id == BLE_CONN_CFG_GATT)
+    {
+        baton->mainObject->configuredAttMtu = baton->p_cfg->conn_cfg.params.gatt_conn_cfg.att_mtu != 0
+            ? baton->p_cfg->conn_cfg.params.gatt_conn_cfg.att_mtu
+            : static_cast<uint16_t>(BLE_GATT_ATT_MTU_DEFAULT);
+    }
 }
 
 void Adapter::AfterSetBleConfig(uv_work_t *req)
@@ -2459,11 +3537,16 @@ extern "C" {
         Adapter::Init(target);
 
         init_uecc(target);
+#ifdef PC_BLE_DRIVER_JS_CONVERSION_BENCHMARK
+        init_conversion_benchmark(target);
+#endif
     }
 
     void init_adapter_list(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target)
     {
         Utility::SetMethod(target, "getAdapters", GetAdapterList);
+        Utility::SetMethod(target, "startAdapterMonitor", StartAdapterMonitor);
+        Utility::SetMethod(target, "stopAdapterMonitor", StopAdapterMonitor);
     }
 
     void init_driver(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target)
@@ -62,6 +62,7 @@ static name_map_t common_event_name_map = {
 NAN_INLINE sd_rpc_parity_t ToParityEnum(const v8::Handle<v8::String>& str);
 NAN_INLINE sd_rpc_flow_control_t ToFlowControlEnum(const v8::Handle<v8::String>& str);
 NAN_INLINE sd_rpc_log_severity_t ToLogSeverityEnum(const v8::Handle<v8::String>& str);
+NAN_INLINE bool ToSimulatedPhysicalLayer(const std::string& physicalLayer);
 
 #pragma region Struct conversions
 
@@ -425,13 +426,19 @@ public:
     sd_rpc_parity_t parity;
 
     uint32_t evt_interval; // The interval in ms that the event queue is sent to NodeJS
+    uint32_t evt_max_latency; // Max time in ms events are coalesced under load, 0 disables adaptive batching
+    uint32_t evt_max_batch_size; // Max number of events coalesced under load before they are sent to NodeJS
     uint32_t retransmission_interval; // The interval between each retransmission of packet to target
     uint32_t response_timeout; // Duration to wait for reply on reliable packet sent to target
 
     bool enable_ble; // Enable BLE or not when connecting, if not the developer must enable the BLE when state is active
+    bool shared_event_dispatcher; // Deliver events through the shared event dispatcher instead of a wakeup per adapter
 
     enable_ble_params_t *enable_ble_params; // If enable BLE is true, then use these params when enabling BLE
 
+    bool simulated; // Use the simulated physical layer instead of the serial port, no connectivity device is needed
+    simulated_connectivity_params_t simulation_params;
+
     Adapter *mainObject;
 };
 
@@ -459,6 +466,7 @@ public:
     }
 
     enable_ble_params_t *enable_ble_params;
+    Adapter *mainObject;
 };
 
 
@@ -478,6 +486,7 @@ public:
     BATON_DESTRUCTOR(BleAddVendorSpcificUUIDBaton) { delete p_vs_uuid; }
     ble_uuid128_t *p_vs_uuid;
     uint8_t p_uuid_type;
+    VendorUuidRegistry *vendorUuids;
 };
 
 class BleUUIDEncodeBaton : public Baton
@@ -505,6 +514,7 @@ public:
     uint8_t uuid_le_len;
     ble_uuid_t *p_uuid;
     std::vector<uint8_t> uuid_le;
+    VendorUuidRegistry *vendorUuids;
 };
 
 class BleUserMemReplyBaton : public Baton
@@ -537,6 +547,7 @@ public:
     BATON_DESTRUCTOR(BleConfigBaton) { delete p_cfg; }
     uint32_t cfg_id;
     ble_cfg_t *p_cfg;
+    Adapter *mainObject;
 };
 #endif
 
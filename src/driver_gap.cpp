@@ -548,6 +548,26 @@ ble_gap_adv_params_t *GapAdvParams::ToNative()
 
 #pragma region GapScanParams
 
+namespace {
+    // The filter flags are optional and documented as 0/1, accept booleans as well
+    uint8_t getOptionalScanFlag(v8::Local<v8::Object> jsobj, const char *name)
+    {
+        if (!Utility::Has(jsobj, name))
+        {
+            return 0;
+        }
+
+        auto value = Utility::Get(jsobj, name);
+
+        if (value->IsBoolean())
+        {
+            return ConversionUtility::getNativeBool(value);
+        }
+
+        return ConversionUtility::getNativeUint8(value) ? 1 : 0;
+    }
+}
+
 v8::Local<v8::Object> GapScanParams::ToJs()
 {
     Nan::EscapableHandleScope scope;
@@ -567,8 +587,13 @@ ble_gap_scan_params_t *GapScanParams::ToNative()
     memset(params, 0, sizeof(ble_gap_scan_params_t));
 
     params->active = ConversionUtility::getNativeBool(jsobj, "active");
-    //params->selective = ConversionUtility::getNativeBool(jsobj, "selective");
-    //TODO: params->p_whitelist =
+#if NRF_SD_BLE_API_VERSION < 3
+    // p_whitelist is filled from the adapter whitelist when the scan or connect is started
+    params->selective = getOptionalScanFlag(jsobj, "use_whitelist") | getOptionalScanFlag(jsobj, "selective");
+#else
+    params->use_whitelist = getOptionalScanFlag(jsobj, "use_whitelist");
+    params->adv_dir_report = getOptionalScanFlag(jsobj, "adv_dir_report");
+#endif
     params->interval = ConversionUtility::msecsToUnitsUint16(jsobj, "interval", ConversionUtility::ConversionUnit625ms);
     params->window = ConversionUtility::msecsToUnitsUint16(jsobj, "window", ConversionUtility::ConversionUnit625ms);
     params->timeout = ConversionUtility::getNativeUint16(jsobj, "timeout");
@@ -1707,7 +1732,7 @@ NAN_METHOD(Adapter::GapSetAddress)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetAddress, reinterpret_cast<uv_after_work_cb>(AfterGapSetAddress));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapSetAddress);
 }
 
 void Adapter::GapSetAddress(uv_work_t *req)
@@ -1770,7 +1795,7 @@ NAN_METHOD(Adapter::GapGetAddress)
     baton->address = address;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetAddress, reinterpret_cast<uv_after_work_cb>(AfterGapGetAddress));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapGetAddress);
 
     return;
 }
@@ -1855,7 +1880,7 @@ NAN_METHOD(Adapter::GapUpdateConnectionParameters)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapUpdateConnectionParameters, reinterpret_cast<uv_after_work_cb>(AfterGapUpdateConnectionParameters));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapUpdateConnectionParameters);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1924,7 +1949,7 @@ NAN_METHOD(Adapter::GapDisconnect)
     baton->hci_status_code = hci_status_code;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapDisconnect, reinterpret_cast<uv_after_work_cb>(AfterGapDisconnect));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapDisconnect);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1987,7 +2012,7 @@ NAN_METHOD(Adapter::GapSetTXPower)
     baton->tx_power = tx_power;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetTXPower, reinterpret_cast<uv_after_work_cb>(AfterGapSetTXPower));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapSetTXPower);
 
 }
 
@@ -2073,7 +2098,7 @@ NAN_METHOD(Adapter::GapSetDeviceName)
     baton->length = (uint16_t)length;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetDeviceName, reinterpret_cast<uv_after_work_cb>(AfterGapSetDeviceName));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapSetDeviceName);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2134,7 +2159,7 @@ NAN_METHOD(Adapter::GapGetDeviceName)
     baton->dev_name.resize(baton->length);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetDeviceName, reinterpret_cast<uv_after_work_cb>(AfterGapGetDeviceName));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapGetDeviceName);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2213,7 +2238,7 @@ NAN_METHOD(Adapter::GapStartRSSI)
     baton->skip_count = skip_count;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStartRSSI, reinterpret_cast<uv_after_work_cb>(AfterGapStartRSSI));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapStartRSSI);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2275,7 +2300,7 @@ NAN_METHOD(Adapter::GapStopRSSI)
     baton->conn_handle = conn_handle;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStopRSSI, reinterpret_cast<uv_after_work_cb>(AfterGapStopRSSI));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapStopRSSI);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2351,9 +2376,10 @@ NAN_METHOD(Adapter::GapStartScan)
     baton->cont = cont;
 #endif
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
 
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStartScan, reinterpret_cast<uv_after_work_cb>(AfterGapStartScan));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapStartScan);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2361,7 +2387,11 @@ void Adapter::GapStartScan(uv_work_t *req)
 {
     auto baton = static_cast<StartScanBaton *>(req->data);
 
-#if NRF_SD_BLE_API_VERSION <= 5
+#if NRF_SD_BLE_API_VERSION < 3
+    WhitelistBuffer whitelist(baton->mainObject->whitelist);
+    whitelist.apply(baton->scan_params);
+    baton->result = sd_ble_gap_scan_start(baton->adapter, baton->scan_params);
+#elif NRF_SD_BLE_API_VERSION <= 5
     baton->result = sd_ble_gap_scan_start(baton->adapter, baton->scan_params);
 #else // NRF_SD_BLE_API_VERSION > 5
 #warning "Not implemented for V6 sd_ble_gap_scan_start(): does the pc-ble-driver-js have a static memory that it uses for this?"
@@ -2415,7 +2445,7 @@ NAN_METHOD(Adapter::GapStopScan)
     auto baton = new StopScanBaton(callback);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStopScan, reinterpret_cast<uv_after_work_cb>(AfterGapStopScan));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapStopScan);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2483,6 +2513,7 @@ NAN_METHOD(Adapter::GapConnect)
 
     auto baton = new GapConnectBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->req->data = static_cast<void *>(baton);
 
     try
@@ -2518,14 +2549,18 @@ NAN_METHOD(Adapter::GapConnect)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GapConnect, reinterpret_cast<uv_after_work_cb>(AfterGapConnect));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapConnect);
 }
 
 // This runs in a worker thread (not Main Thread)
 void Adapter::GapConnect(uv_work_t *req)
 {
     auto baton = static_cast<GapConnectBaton *>(req->data);
-#if  NRF_SD_BLE_API_VERSION < 5
+#if NRF_SD_BLE_API_VERSION < 3
+    WhitelistBuffer whitelist(baton->mainObject->whitelist);
+    whitelist.apply(baton->scan_params);
+    baton->result = sd_ble_gap_connect(baton->adapter, baton->address, baton->scan_params, baton->conn_params);
+#elif NRF_SD_BLE_API_VERSION < 5
     baton->result = sd_ble_gap_connect(baton->adapter, baton->address, baton->scan_params, baton->conn_params);
 #elif NRF_SD_BLE_API_VERSION >= 5
     const uint8_t conn_cfg_tag = 1;
@@ -2580,7 +2615,7 @@ NAN_METHOD(Adapter::GapCancelConnect)
     auto baton = new GapConnectCancelBaton(callback);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapCancelConnect, reinterpret_cast<uv_after_work_cb>(AfterGapCancelConnect));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapCancelConnect);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2614,17 +2649,30 @@ void Adapter::AfterGapCancelConnect(uv_work_t *req)
 
 #pragma endregion GapCancelConnect
 
-#pragma region GapGetRSSI
-NAN_METHOD(Adapter::GapGetRSSI)
+#pragma region ConnectScheduler
+
+NAN_METHOD(Adapter::GapScheduleConnect)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
-    uint16_t conn_handle;
+    v8::Local<v8::Object> address;
+    v8::Local<v8::Object> scan_params;
+    v8::Local<v8::Object> conn_params;
+    v8::Local<v8::Object> options;
     v8::Local<v8::Function> callback;
     auto argumentcount = 0;
 
     try
     {
-        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        address = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        scan_params = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        conn_params = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        options = ConversionUtility::getJsObject(info[argumentcount]);
         argumentcount++;
 
         callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
@@ -2637,80 +2685,241 @@ NAN_METHOD(Adapter::GapGetRSSI)
         return;
     }
 
-    auto baton = new GapGetRSSIBaton(callback);
-    baton->conn_handle = conn_handle;
-    baton->rssi = 0;
-    baton->adapter = obj->adapter;
+    // The scheduler calls the SoftDevice directly from its thread
+    if (obj->getSimulatedConnectivity() != nullptr)
+    {
+        Nan::ThrowError("Scheduled connects are not supported by the simulated physical layer.");
+        return;
+    }
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetRSSI, reinterpret_cast<uv_after_work_cb>(AfterGapGetRSSI));
-}
+    std::unique_ptr<ble_gap_addr_t> nativeAddress;
+    std::unique_ptr<ble_gap_scan_params_t> nativeScanParams;
+    std::unique_ptr<ble_gap_conn_params_t> nativeConnParams;
+    uint8_t priority;
+    uint8_t maxRetries;
+    uint32_t retryDelay;
 
-// This runs in a worker thread (not Main Thread)
-void Adapter::GapGetRSSI(uv_work_t *req)
-{
-    auto baton = static_cast<GapGetRSSIBaton *>(req->data);
+    try
+    {
+        nativeAddress.reset(GapAddr(address));
+        nativeScanParams.reset(GapScanParams(scan_params));
+        nativeConnParams.reset(GapConnParams(conn_params));
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("scheduled connect target", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
 
-    //TODO: Does not return. Unsure if it is the serialization, my code, or SD which does not behave.
+    try
+    {
+        priority = ConversionUtility::getNativeUint8(options, "priority");
+        maxRetries = ConversionUtility::getNativeUint8(options, "max_retries");
+        retryDelay = ConversionUtility::getNativeUint32(options, "retry_delay");
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("scheduled connect options", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
 
-#if NRF_SD_BLE_API_VERSION <= 5
-    baton->result = sd_ble_gap_rssi_get(baton->adapter, baton->conn_handle, &(baton->rssi));
+    if (nativeAddress == nullptr || nativeScanParams == nullptr || nativeConnParams == nullptr)
+    {
+        Nan::ThrowTypeError("NRF_ERROR_NULL");
+        return;
+    }
+
+    // A link is lost with BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED if no packet is received within
+    // the first 6 connection intervals, allow some time for the event to arrive
+    auto settleTime = static_cast<uint32_t>(nativeConnParams->max_conn_interval) * 6 * 5 / 4 + 50;
+
+    obj->initConnectSchedulerHandling();
+
+    auto id = obj->nextConnectId++;
+    obj->connectCallbacks[id] = std::make_unique<Nan::Callback>(callback);
+
+    auto adapter = obj->adapter;
+    auto targetAddress = *nativeAddress;
+    auto targetScanParams = *nativeScanParams;
+    auto targetConnParams = *nativeConnParams;
+
+    auto queued = obj->connectScheduler.enqueue(id, priority, maxRetries, retryDelay, settleTime,
+        [obj, adapter, targetAddress, targetScanParams, targetConnParams]() {
+#if NRF_SD_BLE_API_VERSION < 3
+            // The whitelist is read when each attempt is made, it may have changed while queued
+            auto scanParams = targetScanParams;
+            WhitelistBuffer whitelist(obj->whitelist);
+            whitelist.apply(&scanParams);
+            return sd_ble_gap_connect(adapter, &targetAddress, &scanParams, &targetConnParams);
+#elif NRF_SD_BLE_API_VERSION < 5
+            return sd_ble_gap_connect(adapter, &targetAddress, &targetScanParams, &targetConnParams);
 #else
-    uint8_t channelIndex;
-    baton->result = sd_ble_gap_rssi_get(baton->adapter, baton->conn_handle, &(baton->rssi), &channelIndex);
+            const uint8_t conn_cfg_tag = 1;
+            return sd_ble_gap_connect(adapter, &targetAddress, &targetScanParams, &targetConnParams, conn_cfg_tag);
 #endif
+        });
+
+    if (!queued)
+    {
+        obj->connectCallbacks.erase(id);
+        Nan::ThrowError("Not able to schedule the connect.");
+        return;
+    }
+
+    info.GetReturnValue().Set(ConversionUtility::toJsNumber(id));
 }
 
-// This runs in Main Thread
-void Adapter::AfterGapGetRSSI(uv_work_t *req)
+NAN_METHOD(Adapter::GapCancelScheduledConnect)
 {
-    Nan::HandleScope scope;
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint32_t id;
 
-    auto baton = static_cast<GapGetRSSIBaton *>(req->data);
-    v8::Local<v8::Value> argv[2];
+    try
+    {
+        id = ConversionUtility::getNativeUint32(info[0]);
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
 
-    if (baton->result != NRF_SUCCESS)
+    // The callback is called from onConnectSchedulerEvent
+    info.GetReturnValue().Set(obj->connectScheduler.cancel(id));
+}
+
+// This runs in Main Thread
+void Adapter::onConnectSchedulerEvent(uv_async_t *handle)
+{
+    std::vector<connect_completion_t> completions;
+    connectScheduler.takeCompletions(completions);
+
+    for (auto &completion : completions)
     {
-        argv[0] = Nan::Undefined();
-        argv[1] = ErrorMessage::getErrorMessage(baton->result, "getting rssi");
+        auto entry = connectCallbacks.find(completion.id);
+
+        if (entry == connectCallbacks.end())
+        {
+            continue;
+        }
+
+        // Take the callback out of the map first, it may schedule another connect
+        auto callback = std::move(entry->second);
+        connectCallbacks.erase(entry);
+
+        Nan::HandleScope scope;
+        v8::Local<v8::Value> argv[2];
+
+        if (completion.result != NRF_SUCCESS)
+        {
+            argv[0] = ErrorMessage::getErrorMessage(completion.result, "connecting scheduled target");
+        }
+        else
+        {
+            argv[0] = Nan::Undefined();
+        }
+
+        // The timing is reported for failed targets too
+        auto result = Nan::New<v8::Object>();
+        Utility::Set(result, "conn_handle", completion.conn_handle);
+        Utility::Set(result, "hci_status", completion.hci_status);
+        Utility::Set(result, "attempts", completion.attempts);
+        Utility::Set(result, "wait_time", completion.wait_time);
+        Utility::Set(result, "connect_time", completion.connect_time);
+        Utility::Set(result, "total_time", completion.total_time);
+        argv[1] = result;
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        callback->Call(2, argv, &resource);
     }
-    else
+}
+
+#pragma endregion ConnectScheduler
+
+#pragma region Whitelist
+
+namespace {
+    whitelist_addr_t toWhitelistAddr(const ble_gap_addr_t &address)
     {
-        argv[0] = ConversionUtility::toJsNumber(baton->rssi);
-        argv[1] = Nan::Undefined();
+        whitelist_addr_t entry;
+        entry.addr_type = address.addr_type;
+        memcpy(entry.addr, address.addr, WHITELIST_ADDR_LEN);
+        return entry;
     }
 
-    Nan::AsyncResource resource("pc-ble-driver-js:callback");
-    baton->callback->Call(2, argv, &resource);
-    delete baton;
+    ble_gap_addr_t toGapAddr(const whitelist_addr_t &entry)
+    {
+        ble_gap_addr_t address;
+        memset(&address, 0, sizeof(ble_gap_addr_t));
+        address.addr_type = entry.addr_type;
+        memcpy(address.addr, entry.addr, BLE_GAP_ADDR_LEN);
+        return address;
+    }
 }
 
-#pragma endregion GapGetRSSI
+#if NRF_SD_BLE_API_VERSION < 3
+WhitelistBuffer::WhitelistBuffer(WhitelistMirror &mirror)
+{
+    for (auto &entry : mirror.getAddresses())
+    {
+        addresses.push_back(toGapAddr(entry));
+    }
 
-#pragma region GapStartAdvertising
+    // The identities are used as IRKs, the peer resolvable private address is matched against them
+    for (auto &identity : mirror.getIdentities())
+    {
+        ble_gap_irk_t irk;
+        memcpy(irk.irk, identity.irk, BLE_GAP_SEC_KEY_LEN);
+        irks.push_back(irk);
+    }
 
-NAN_METHOD(Adapter::GapStartAdvertising)
+    // The pointers are taken when the vectors do not grow anymore
+    for (auto &address : addresses)
+    {
+        addressPointers.push_back(&address);
+    }
+
+    for (auto &irk : irks)
+    {
+        irkPointers.push_back(&irk);
+    }
+
+    whitelist.pp_addrs = addressPointers.empty() ? nullptr : addressPointers.data();
+    whitelist.addr_count = static_cast<uint8_t>(addressPointers.size());
+    whitelist.pp_irks = irkPointers.empty() ? nullptr : irkPointers.data();
+    whitelist.irk_count = static_cast<uint8_t>(irkPointers.size());
+}
+
+void WhitelistBuffer::apply(ble_gap_scan_params_t *scanParams)
 {
-    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
-#if NRF_SD_BLE_API_VERSION <= 5
-    v8::Local<v8::Object> adv_params;
-#endif
-#if NRF_SD_BLE_API_VERSION > 5
-    uint8_t adv_handle;
+    if (scanParams != nullptr && scanParams->selective)
+    {
+        scanParams->p_whitelist = &whitelist;
+    }
+}
 #endif
 
+NAN_METHOD(Adapter::GapWhitelistSet)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    v8::Local<v8::Object> addresses;
     v8::Local<v8::Function> callback;
     auto argumentcount = 0;
 
     try
     {
-#if NRF_SD_BLE_API_VERSION <= 5
-        adv_params = ConversionUtility::getJsObject(info[argumentcount]);
-        argumentcount++;
-#endif
-#if NRF_SD_BLE_API_VERSION > 5
-        adv_handle = ConversionUtility::getNativeUint8(info[argumentcount]);
+        addresses = ConversionUtility::getJsObject(info[argumentcount]);
+
+        if (!addresses->IsArray())
+        {
+            throw std::string("array");
+        }
+
         argumentcount++;
-#endif
+
         callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
         argumentcount++;
     }
@@ -2721,55 +2930,85 @@ NAN_METHOD(Adapter::GapStartAdvertising)
         return;
     }
 
-    auto baton = new GapStartAdvertisingBaton(callback);
-#if NRF_SD_BLE_API_VERSION <= 5
+    std::vector<ble_gap_addr_t> nativeAddresses;
+
     try
     {
-        baton->p_adv_params = GapAdvParams(adv_params);
+        auto array = v8::Local<v8::Array>::Cast(addresses);
+
+        for (uint32_t i = 0; i < array->Length(); i++)
+        {
+            std::unique_ptr<ble_gap_addr_t> address(GapAddr(ConversionUtility::getJsObject(Utility::Get(array, i))).ToNative());
+            nativeAddresses.push_back(*address);
+        }
     }
     catch (std::string error)
     {
-        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("adv_params", error);
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("addresses", error);
         Nan::ThrowTypeError(message);
         return;
     }
-#endif
-#if NRF_SD_BLE_API_VERSION > 5
-    baton->adv_handle = adv_handle;
-#endif
 
+    auto baton = new GapWhitelistSetBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->addresses.swap(nativeAddresses);
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStartAdvertising, reinterpret_cast<uv_after_work_cb>(AfterGapStartAdvertising));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapWhitelistSet);
 }
 
 // This runs in a worker thread (not Main Thread)
-void Adapter::GapStartAdvertising(uv_work_t *req)
+void Adapter::GapWhitelistSet(uv_work_t *req)
 {
-    auto baton = static_cast<GapStartAdvertisingBaton *>(req->data);
+    auto baton = static_cast<GapWhitelistSetBaton *>(req->data);
 
-#if NRF_SD_BLE_API_VERSION < 5
-    baton->result = sd_ble_gap_adv_start(baton->adapter, baton->p_adv_params);
-#elif NRF_SD_BLE_API_VERSION == 5
-    const uint8_t conn_cfg_tag = 1;
-    baton->result = sd_ble_gap_adv_start(baton->adapter, baton->p_adv_params, conn_cfg_tag);
-#else // NRF_SD_BLE_API_VERSION > 5
-    const uint8_t conn_cfg_tag = 1;
-    baton->result = sd_ble_gap_adv_start(baton->adapter, baton->adv_handle, conn_cfg_tag);
+#if NRF_SD_BLE_API_VERSION < 3
+    // There is no whitelist in the SoftDevice, it is passed with each selective scan or connect
+    if (baton->addresses.size() > BLE_GAP_WHITELIST_ADDR_MAX_COUNT)
+    {
+        baton->result = NRF_ERROR_DATA_SIZE;
+        return;
+    }
+
+    baton->result = NRF_SUCCESS;
+#else
+    std::vector<ble_gap_addr_t const *> addressPointers;
+
+    for (auto &address : baton->addresses)
+    {
+        addressPointers.push_back(&address);
+    }
+
+    // An empty list clears the whitelist
+    baton->result = sd_ble_gap_whitelist_set(baton->adapter,
+        addressPointers.empty() ? nullptr : addressPointers.data(),
+        static_cast<uint8_t>(addressPointers.size()));
 #endif
+
+    if (baton->result == NRF_SUCCESS)
+    {
+        std::vector<whitelist_addr_t> entries;
+
+        for (auto &address : baton->addresses)
+        {
+            entries.push_back(toWhitelistAddr(address));
+        }
+
+        baton->mainObject->whitelist.setAddresses(entries);
+    }
 }
 
 // This runs in Main Thread
-void Adapter::AfterGapStartAdvertising(uv_work_t *req)
+void Adapter::AfterGapWhitelistSet(uv_work_t *req)
 {
     Nan::HandleScope scope;
 
-    auto baton = static_cast<GapStartAdvertisingBaton *>(req->data);
+    auto baton = static_cast<GapWhitelistSetBaton *>(req->data);
     v8::Local<v8::Value> argv[1];
 
     if (baton->result != NRF_SUCCESS)
     {
-        argv[0] = ErrorMessage::getErrorMessage(baton->result, "starting advertisement");
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "setting whitelist");
     }
     else
     {
@@ -2781,18 +3020,24 @@ void Adapter::AfterGapStartAdvertising(uv_work_t *req)
     delete baton;
 }
 
-#pragma endregion GapStartAdvertising
-
-#pragma region GapStopAdvertising
-
-NAN_METHOD(Adapter::GapStopAdvertising)
+NAN_METHOD(Adapter::GapDeviceIdentitiesSet)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    v8::Local<v8::Object> identities;
     v8::Local<v8::Function> callback;
     auto argumentcount = 0;
 
     try
     {
+        identities = ConversionUtility::getJsObject(info[argumentcount]);
+
+        if (!identities->IsArray())
+        {
+            throw std::string("array");
+        }
+
+        argumentcount++;
+
         callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
         argumentcount++;
     }
@@ -2803,25 +3048,341 @@ NAN_METHOD(Adapter::GapStopAdvertising)
         return;
     }
 
-    auto baton = new GapStopAdvertisingBaton(callback);
+    std::vector<ble_gap_id_key_t> nativeIdentities;
+
+    try
+    {
+        auto array = v8::Local<v8::Array>::Cast(identities);
+
+        for (uint32_t i = 0; i < array->Length(); i++)
+        {
+            std::unique_ptr<ble_gap_id_key_t> identity(GapIdKey(ConversionUtility::getJsObject(Utility::Get(array, i))).ToNative());
+            nativeIdentities.push_back(*identity);
+        }
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("identities", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto baton = new GapDeviceIdentitiesSetBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->identities.swap(nativeIdentities);
 
-    uv_queue_work(uv_default_loop(), baton->req, GapStopAdvertising, reinterpret_cast<uv_after_work_cb>(AfterGapStopAdvertising));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapDeviceIdentitiesSet);
 }
 
 // This runs in a worker thread (not Main Thread)
-void Adapter::GapStopAdvertising(uv_work_t *req)
+void Adapter::GapDeviceIdentitiesSet(uv_work_t *req)
 {
-    auto baton = static_cast<GapStopAdvertisingBaton *>(req->data);
-    baton->result = sd_ble_gap_adv_stop(baton->adapter);
+    auto baton = static_cast<GapDeviceIdentitiesSetBaton *>(req->data);
+
+#if NRF_SD_BLE_API_VERSION < 3
+    // The identity IRKs are passed as whitelist IRKs with each selective scan or connect
+    if (baton->identities.size() > BLE_GAP_WHITELIST_IRK_MAX_COUNT)
+    {
+        baton->result = NRF_ERROR_DATA_SIZE;
+        return;
+    }
+
+    baton->result = NRF_SUCCESS;
+#else
+    std::vector<ble_gap_id_key_t const *> identityPointers;
+
+    for (auto &identity : baton->identities)
+    {
+        identityPointers.push_back(&identity);
+    }
+
+    // No local IRKs, the device identity is used for all peers. An empty list clears the list.
+    baton->result = sd_ble_gap_device_identities_set(baton->adapter,
+        identityPointers.empty() ? nullptr : identityPointers.data(),
+        nullptr,
+        static_cast<uint8_t>(identityPointers.size()));
+#endif
+
+    if (baton->result == NRF_SUCCESS)
+    {
+        std::vector<whitelist_identity_t> entries;
+
+        for (auto &identity : baton->identities)
+        {
+            whitelist_identity_t entry;
+            entry.id_addr = toWhitelistAddr(identity.id_addr_info);
+            memcpy(entry.irk, identity.id_info.irk, WHITELIST_IRK_LEN);
+            entries.push_back(entry);
+        }
+
+        baton->mainObject->whitelist.setIdentities(entries);
+    }
 }
 
 // This runs in Main Thread
-void Adapter::AfterGapStopAdvertising(uv_work_t *req)
+void Adapter::AfterGapDeviceIdentitiesSet(uv_work_t *req)
 {
     Nan::HandleScope scope;
 
-    auto baton = static_cast<GapStopAdvertisingBaton *>(req->data);
+    auto baton = static_cast<GapDeviceIdentitiesSetBaton *>(req->data);
+    v8::Local<v8::Value> argv[1];
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "setting device identities");
+    }
+    else
+    {
+        argv[0] = Nan::Undefined();
+    }
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    baton->callback->Call(1, argv, &resource);
+    delete baton;
+}
+
+NAN_METHOD(Adapter::GapGetWhitelist)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    auto entries = obj->whitelist.getAddresses();
+    auto identityEntries = obj->whitelist.getIdentities();
+
+    auto addresses = Nan::New<v8::Array>();
+
+    for (uint32_t i = 0; i < entries.size(); i++)
+    {
+        auto address = toGapAddr(entries[i]);
+        Nan::Set(addresses, i, GapAddr(&address).ToJs());
+    }
+
+    auto identities = Nan::New<v8::Array>();
+
+    for (uint32_t i = 0; i < identityEntries.size(); i++)
+    {
+        ble_gap_id_key_t identity;
+        identity.id_addr_info = toGapAddr(identityEntries[i].id_addr);
+        memcpy(identity.id_info.irk, identityEntries[i].irk, BLE_GAP_SEC_KEY_LEN);
+        Nan::Set(identities, i, GapIdKey(&identity).ToJs());
+    }
+
+    auto result = Nan::New<v8::Object>();
+    Utility::Set(result, "addresses", addresses);
+    Utility::Set(result, "identities", identities);
+
+    Utility::SetReturnValue(info, result);
+}
+
+#pragma endregion Whitelist
+
+#pragma region GapGetRSSI
+NAN_METHOD(Adapter::GapGetRSSI)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t conn_handle;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto baton = new GapGetRSSIBaton(callback);
+    baton->conn_handle = conn_handle;
+    baton->rssi = 0;
+    baton->adapter = obj->adapter;
+
+    QUEUE_ADAPTER_METHOD(obj, baton, GapGetRSSI);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GapGetRSSI(uv_work_t *req)
+{
+    auto baton = static_cast<GapGetRSSIBaton *>(req->data);
+
+    //TODO: Does not return. Unsure if it is the serialization, my code, or SD which does not behave.
+
+#if NRF_SD_BLE_API_VERSION <= 5
+    baton->result = sd_ble_gap_rssi_get(baton->adapter, baton->conn_handle, &(baton->rssi));
+#else
+    uint8_t channelIndex;
+    baton->result = sd_ble_gap_rssi_get(baton->adapter, baton->conn_handle, &(baton->rssi), &channelIndex);
+#endif
+}
+
+// This runs in Main Thread
+void Adapter::AfterGapGetRSSI(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GapGetRSSIBaton *>(req->data);
+    v8::Local<v8::Value> argv[2];
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        argv[0] = Nan::Undefined();
+        argv[1] = ErrorMessage::getErrorMessage(baton->result, "getting rssi");
+    }
+    else
+    {
+        argv[0] = ConversionUtility::toJsNumber(baton->rssi);
+        argv[1] = Nan::Undefined();
+    }
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    baton->callback->Call(2, argv, &resource);
+    delete baton;
+}
+
+#pragma endregion GapGetRSSI
+
+#pragma region GapStartAdvertising
+
+NAN_METHOD(Adapter::GapStartAdvertising)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+#if NRF_SD_BLE_API_VERSION <= 5
+    v8::Local<v8::Object> adv_params;
+#endif
+#if NRF_SD_BLE_API_VERSION > 5
+    uint8_t adv_handle;
+#endif
+
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+#if NRF_SD_BLE_API_VERSION <= 5
+        adv_params = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+#endif
+#if NRF_SD_BLE_API_VERSION > 5
+        adv_handle = ConversionUtility::getNativeUint8(info[argumentcount]);
+        argumentcount++;
+#endif
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto baton = new GapStartAdvertisingBaton(callback);
+#if NRF_SD_BLE_API_VERSION <= 5
+    try
+    {
+        baton->p_adv_params = GapAdvParams(adv_params);
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("adv_params", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+#endif
+#if NRF_SD_BLE_API_VERSION > 5
+    baton->adv_handle = adv_handle;
+#endif
+
+    baton->adapter = obj->adapter;
+
+    QUEUE_ADAPTER_METHOD(obj, baton, GapStartAdvertising);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GapStartAdvertising(uv_work_t *req)
+{
+    auto baton = static_cast<GapStartAdvertisingBaton *>(req->data);
+
+#if NRF_SD_BLE_API_VERSION < 5
+    baton->result = sd_ble_gap_adv_start(baton->adapter, baton->p_adv_params);
+#elif NRF_SD_BLE_API_VERSION == 5
+    const uint8_t conn_cfg_tag = 1;
+    baton->result = sd_ble_gap_adv_start(baton->adapter, baton->p_adv_params, conn_cfg_tag);
+#else // NRF_SD_BLE_API_VERSION > 5
+    const uint8_t conn_cfg_tag = 1;
+    baton->result = sd_ble_gap_adv_start(baton->adapter, baton->adv_handle, conn_cfg_tag);
+#endif
+}
+
+// This runs in Main Thread
+void Adapter::AfterGapStartAdvertising(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GapStartAdvertisingBaton *>(req->data);
+    v8::Local<v8::Value> argv[1];
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "starting advertisement");
+    }
+    else
+    {
+        argv[0] = Nan::Undefined();
+    }
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    baton->callback->Call(1, argv, &resource);
+    delete baton;
+}
+
+#pragma endregion GapStartAdvertising
+
+#pragma region GapStopAdvertising
+
+NAN_METHOD(Adapter::GapStopAdvertising)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto baton = new GapStopAdvertisingBaton(callback);
+    baton->adapter = obj->adapter;
+
+    QUEUE_ADAPTER_METHOD(obj, baton, GapStopAdvertising);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GapStopAdvertising(uv_work_t *req)
+{
+    auto baton = static_cast<GapStopAdvertisingBaton *>(req->data);
+    baton->result = sd_ble_gap_adv_stop(baton->adapter);
+}
+
+// This runs in Main Thread
+void Adapter::AfterGapStopAdvertising(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GapStopAdvertisingBaton *>(req->data);
     v8::Local<v8::Value> argv[1];
 
     if (baton->result != NRF_SUCCESS)
@@ -2869,7 +3430,7 @@ NAN_METHOD(Adapter::GapGetConnectionSecurity)
     baton->conn_sec = new ble_gap_conn_sec_t();
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetConnectionSecurity, reinterpret_cast<uv_after_work_cb>(AfterGapGetConnectionSecurity));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapGetConnectionSecurity);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -2963,7 +3524,7 @@ NAN_METHOD(Adapter::GapEncrypt)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapEncrypt, reinterpret_cast<uv_after_work_cb>(AfterGapEncrypt));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapEncrypt);
 }
 
 void Adapter::GapEncrypt(uv_work_t *req)
@@ -3096,7 +3657,7 @@ NAN_METHOD(Adapter::GapReplySecurityParameters)
 
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapReplySecurityParameters, reinterpret_cast<uv_after_work_cb>(AfterGapReplySecurityParameters));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapReplySecurityParameters);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3218,7 +3779,7 @@ NAN_METHOD(Adapter::GapReplySecurityInfo)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapReplySecurityInfo, reinterpret_cast<uv_after_work_cb>(AfterGapReplySecurityInfo));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapReplySecurityInfo);
 }
 
 void Adapter::GapReplySecurityInfo(uv_work_t *req)
@@ -3293,7 +3854,7 @@ NAN_METHOD(Adapter::GapAuthenticate)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapAuthenticate, reinterpret_cast<uv_after_work_cb>(AfterGapAuthenticate));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapAuthenticate);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3387,7 +3948,7 @@ NAN_METHOD(Adapter::GapSetAdvertisingData)
     baton->srdlen = scan_response_length;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetAdvertisingData, reinterpret_cast<uv_after_work_cb>(AfterGapSetAdvertisingData));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapSetAdvertisingData);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3460,7 +4021,7 @@ NAN_METHOD(Adapter::GapSetPPCP)
     }
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetPPCP, reinterpret_cast<uv_after_work_cb>(AfterGapSetPPCP));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapSetPPCP);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3518,7 +4079,7 @@ NAN_METHOD(Adapter::GapGetPPCP)
     baton->p_conn_params = new ble_gap_conn_params_t();
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetPPCP, reinterpret_cast<uv_after_work_cb>(AfterGapGetPPCP));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapGetPPCP);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3582,7 +4143,7 @@ NAN_METHOD(Adapter::GapSetAppearance)
     baton->appearance = appearance;
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetAppearance, reinterpret_cast<uv_after_work_cb>(AfterGapSetAppearance));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapSetAppearance);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3637,7 +4198,7 @@ NAN_METHOD(Adapter::GapGetAppearance)
     auto baton = new GapGetAppearanceBaton(callback);
     baton->adapter = obj->adapter;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetAppearance, reinterpret_cast<uv_after_work_cb>(AfterGapGetAppearance));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapGetAppearance);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3727,7 +4288,7 @@ NAN_METHOD(Adapter::GapReplyAuthKey)
     baton->key_type = key_type;
     baton->key = key;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapReplyAuthKey, reinterpret_cast<uv_after_work_cb>(AfterGapReplyAuthKey));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapReplyAuthKey);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3797,7 +4358,7 @@ NAN_METHOD(Adapter::GapReplyDHKeyLESC)
     baton->dhkey = dhkey;
     free(key);
 
-    uv_queue_work(uv_default_loop(), baton->req, GapReplyDHKeyLESC, reinterpret_cast<uv_after_work_cb>(AfterGapReplyDHKeyLESC));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapReplyDHKeyLESC);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3863,7 +4424,7 @@ NAN_METHOD(Adapter::GapNotifyKeypress)
     baton->conn_handle = conn_handle;
     baton->kp_not = kp_not;
 
-    uv_queue_work(uv_default_loop(), baton->req, GapNotifyKeypress, reinterpret_cast<uv_after_work_cb>(AfterGapNotifyKeypress));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapNotifyKeypress);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -3934,7 +4495,7 @@ NAN_METHOD(Adapter::GapGetLESCOOBData)
     baton->p_pk_own = p_pk_own;
     baton->p_oobd_own = new ble_gap_lesc_oob_data_t();
 
-    uv_queue_work(uv_default_loop(), baton->req, GapGetLESCOOBData, reinterpret_cast<uv_after_work_cb>(AfterGapGetLESCOOBData));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapGetLESCOOBData);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -4027,7 +4588,7 @@ NAN_METHOD(Adapter::GapSetLESCOOBData)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GapSetLESCOOBData, reinterpret_cast<uv_after_work_cb>(AfterGapSetLESCOOBData));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapSetLESCOOBData);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -4060,30 +4621,168 @@ void Adapter::AfterGapSetLESCOOBData(uv_work_t *req)
 }
 #pragma endregion GapSetLESCOOBData
 
-#if NRF_SD_BLE_API_VERSION >= 5
+#pragma region ConnParamPolicy
 
-#pragma region GapDataLengthUpdate
-NAN_METHOD(Adapter::GapDataLengthUpdate)
+// This runs in the thread the SoftDevice driver has initiated. Returns true if the request was answered.
+bool Adapter::replyConnParamsFromPolicy(const ble_gap_evt_t *gapEvent)
 {
-    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
-    uint16_t conn_handle;
-    v8::Local<v8::Object> p_dl_params;
-    v8::Local<v8::Object> p_dl_limitation;
-    v8::Local<v8::Function> callback;
-    auto argumentcount = 0;
+    auto params = &(gapEvent->params.conn_param_update_request.conn_params);
 
-    try
-    {
-        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
-        argumentcount++;
+    conn_param_values_t requested;
+    requested.min_conn_interval = params->min_conn_interval;
+    requested.max_conn_interval = params->max_conn_interval;
+    requested.slave_latency = params->slave_latency;
+    requested.conn_sup_timeout = params->conn_sup_timeout;
 
-        p_dl_params = ConversionUtility::getJsObjectOrNull(info[argumentcount]);
-        argumentcount++;
+    conn_param_values_t reply;
+    auto decision = connParamPolicy.evaluate(gapEvent->conn_handle, requested, reply);
 
-        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
-        argumentcount++;
+    if (decision == CONN_PARAM_DECISION_DEFER)
+    {
+        return false;
     }
-    catch (std::string error)
+
+    uint32_t errorCode;
+
+    if (decision == CONN_PARAM_DECISION_REJECT)
+    {
+        // A central rejects the request by not providing parameters
+        errorCode = sd_ble_gap_conn_param_update(adapter, gapEvent->conn_handle, nullptr);
+    }
+    else
+    {
+        ble_gap_conn_params_t connParams;
+        connParams.min_conn_interval = reply.min_conn_interval;
+        connParams.max_conn_interval = reply.max_conn_interval;
+        connParams.slave_latency = reply.slave_latency;
+        connParams.conn_sup_timeout = reply.conn_sup_timeout;
+
+        errorCode = sd_ble_gap_conn_param_update(adapter, gapEvent->conn_handle, &connParams);
+    }
+
+    connParamPolicy.onReplied(decision, errorCode);
+
+    if (errorCode != NRF_SUCCESS)
+    {
+        std::cerr << "Not able to reply to connection parameter update request from policy, error " << errorCode << "." << std::endl;
+    }
+
+    return true;
+}
+
+NAN_INLINE conn_param_mode_t ToConnParamMode(const std::string &mode)
+{
+    if (mode == "defer")
+    {
+        return CONN_PARAM_DEFER;
+    }
+
+    if (mode == "accept")
+    {
+        return CONN_PARAM_ACCEPT;
+    }
+
+    if (mode == "clamp")
+    {
+        return CONN_PARAM_CLAMP;
+    }
+
+    if (mode == "reject")
+    {
+        return CONN_PARAM_REJECT;
+    }
+
+    throw std::string("'defer', 'accept', 'clamp' or 'reject'");
+}
+
+NAN_METHOD(Adapter::GapSetConnParamPolicy)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t connHandle;
+    v8::Local<v8::Object> jsPolicy;
+    auto argumentcount = 0;
+
+    try
+    {
+        connHandle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        jsPolicy = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    conn_param_policy_t policy;
+
+    try
+    {
+        policy.mode = ToConnParamMode(ConversionUtility::getNativeString(jsPolicy, "mode"));
+        policy.min_conn_interval = ConversionUtility::msecsToUnitsUint16(jsPolicy, "min_conn_interval", ConversionUtility::ConversionUnit1250ms);
+        policy.max_conn_interval = ConversionUtility::msecsToUnitsUint16(jsPolicy, "max_conn_interval", ConversionUtility::ConversionUnit1250ms);
+        policy.max_slave_latency = ConversionUtility::getNativeUint16(jsPolicy, "max_slave_latency");
+        policy.min_conn_sup_timeout = ConversionUtility::msecsToUnitsUint16(jsPolicy, "min_conn_sup_timeout", ConversionUtility::ConversionUnit10s);
+        policy.max_conn_sup_timeout = ConversionUtility::msecsToUnitsUint16(jsPolicy, "max_conn_sup_timeout", ConversionUtility::ConversionUnit10s);
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("connection parameter policy", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    obj->connParamPolicy.set(connHandle, policy);
+}
+
+NAN_METHOD(Adapter::GapClearConnParamPolicy)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t connHandle;
+
+    try
+    {
+        connHandle = ConversionUtility::getNativeUint16(info[0]);
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    info.GetReturnValue().Set(obj->connParamPolicy.remove(connHandle));
+}
+
+#pragma endregion ConnParamPolicy
+
+#if NRF_SD_BLE_API_VERSION >= 5
+
+#pragma region GapDataLengthUpdate
+NAN_METHOD(Adapter::GapDataLengthUpdate)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t conn_handle;
+    v8::Local<v8::Object> p_dl_params;
+    v8::Local<v8::Object> p_dl_limitation;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        p_dl_params = ConversionUtility::getJsObjectOrNull(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
     {
         v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
         Nan::ThrowTypeError(message);
@@ -4107,7 +4806,7 @@ NAN_METHOD(Adapter::GapDataLengthUpdate)
 
     baton->p_dl_limitation = new ble_gap_data_length_limitation_t();
 
-    uv_queue_work(uv_default_loop(), baton->req, GapDataLengthUpdate, reinterpret_cast<uv_after_work_cb>(AfterGapDataLengthUpdate));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapDataLengthUpdate);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -4188,7 +4887,7 @@ NAN_METHOD(Adapter::GapPhyUpdate)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GapPhyUpdate, reinterpret_cast<uv_after_work_cb>(AfterGapPhyUpdate));
+    QUEUE_ADAPTER_METHOD(obj, baton, GapPhyUpdate);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -4224,8 +4923,581 @@ void Adapter::AfterGapPhyUpdate(uv_work_t *req)
 
 #pragma endregion GapPhyUpdate
 
+#pragma region LinkPolicy
+
+// This runs in the thread the SoftDevice driver has initiated
+void Adapter::applyLinkPolicy(const uint16_t connHandle)
+{
+    auto params = linkPolicy.get();
+
+    if (params.att_mtu != 0)
+    {
+        auto errorCode = sd_ble_gattc_exchange_mtu_request(adapter, connHandle, params.att_mtu);
+        linkPolicy.onRequested(errorCode);
+
+        if (errorCode == NRF_SUCCESS)
+        {
+            linkStats.setLocalAttMtu(connHandle, params.att_mtu);
+        }
+    }
+
+    if (params.max_tx_octets != 0 || params.max_rx_octets != 0)
+    {
+        ble_gap_data_length_params_t dataLength;
+        memset(&dataLength, 0, sizeof(dataLength));
+        dataLength.max_tx_octets = params.max_tx_octets;
+        dataLength.max_rx_octets = params.max_rx_octets;
+        dataLength.max_tx_time_us = BLE_GAP_DATA_LENGTH_AUTO;
+        dataLength.max_rx_time_us = BLE_GAP_DATA_LENGTH_AUTO;
+
+        linkPolicy.onRequested(sd_ble_gap_data_length_update(adapter, connHandle, &dataLength, nullptr));
+    }
+
+    if (params.tx_phys != 0 || params.rx_phys != 0)
+    {
+        ble_gap_phys_t phys;
+        phys.tx_phys = params.tx_phys;
+        phys.rx_phys = params.rx_phys;
+
+        linkPolicy.onRequested(sd_ble_gap_phy_update(adapter, connHandle, &phys));
+    }
+}
+
+// This runs in the thread the SoftDevice driver has initiated. The requests are still sent to JavaScript,
+// which records the outcome when the policy answered them and replies itself otherwise.
+// Returns true if the reply was accepted by the SoftDevice.
+bool Adapter::replyFromLinkPolicy(const ble_evt_t *event)
+{
+    auto params = linkPolicy.get();
+
+    switch (event->header.evt_id)
+    {
+        case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+        {
+            if (params.att_mtu == 0)
+            {
+                return false;
+            }
+
+            auto connHandle = event->evt.gatts_evt.conn_handle;
+            auto errorCode = sd_ble_gatts_exchange_mtu_reply(adapter, connHandle, params.att_mtu);
+            linkPolicy.onReplied(errorCode);
+
+            if (errorCode != NRF_SUCCESS)
+            {
+                return false;
+            }
+
+            linkStats.setLocalAttMtu(connHandle, params.att_mtu);
+            return true;
+        }
+        case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
+        {
+            if (params.max_tx_octets == 0 && params.max_rx_octets == 0)
+            {
+                return false;
+            }
+
+            ble_gap_data_length_params_t dataLength;
+            memset(&dataLength, 0, sizeof(dataLength));
+            dataLength.max_tx_octets = params.max_tx_octets;
+            dataLength.max_rx_octets = params.max_rx_octets;
+            dataLength.max_tx_time_us = BLE_GAP_DATA_LENGTH_AUTO;
+            dataLength.max_rx_time_us = BLE_GAP_DATA_LENGTH_AUTO;
+
+            auto errorCode = sd_ble_gap_data_length_update(adapter, event->evt.gap_evt.conn_handle, &dataLength, nullptr);
+            linkPolicy.onReplied(errorCode);
+            return errorCode == NRF_SUCCESS;
+        }
+        case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+        {
+            if (params.tx_phys == 0 && params.rx_phys == 0)
+            {
+                return false;
+            }
+
+            ble_gap_phys_t phys;
+            phys.tx_phys = params.tx_phys;
+            phys.rx_phys = params.rx_phys;
+
+            auto errorCode = sd_ble_gap_phy_update(adapter, event->evt.gap_evt.conn_handle, &phys);
+            linkPolicy.onReplied(errorCode);
+            return errorCode == NRF_SUCCESS;
+        }
+        default:
+            return false;
+    }
+}
+
+NAN_METHOD(Adapter::GapSetLinkPolicy)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    v8::Local<v8::Object> policy;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        policy = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto baton = new GapSetLinkPolicyBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+
+    try
+    {
+        baton->params.att_mtu = ConversionUtility::getNativeUint16(policy, "att_mtu");
+
+        // 0 leaves the MTU to JavaScript, the SoftDevice rejects replies outside of what it was configured with
+        if (baton->params.att_mtu != 0 &&
+            (baton->params.att_mtu < BLE_GATT_ATT_MTU_DEFAULT || baton->params.att_mtu > obj->configuredAttMtu))
+        {
+            throw std::string("att_mtu of 0 or between " + std::to_string(BLE_GATT_ATT_MTU_DEFAULT) +
+                              " and the configured att_mtu " + std::to_string(obj->configuredAttMtu.load()));
+        }
+
+        baton->params.max_tx_octets = ConversionUtility::getNativeUint16(policy, "max_tx_octets");
+        baton->params.max_rx_octets = ConversionUtility::getNativeUint16(policy, "max_rx_octets");
+        baton->params.tx_phys = ConversionUtility::getNativeUint8(policy, "tx_phys");
+        baton->params.rx_phys = ConversionUtility::getNativeUint8(policy, "rx_phys");
+        baton->params.conn_evt_ext = ConversionUtility::getNativeBool(policy, "conn_evt_ext");
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("link policy", error);
+        Nan::ThrowTypeError(message);
+        delete baton;
+        return;
+    }
+
+    QUEUE_ADAPTER_METHOD(obj, baton, GapSetLinkPolicy);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GapSetLinkPolicy(uv_work_t *req)
+{
+    auto baton = static_cast<GapSetLinkPolicyBaton *>(req->data);
+
+    ble_opt_t opt;
+    memset(&opt, 0, sizeof(opt));
+    opt.common_opt.conn_evt_ext.enable = baton->params.conn_evt_ext ? 1 : 0;
+
+    baton->result = sd_ble_opt_set(baton->adapter, BLE_COMMON_OPT_CONN_EVT_EXT, &opt);
+
+    if (baton->result == NRF_SUCCESS)
+    {
+        baton->mainObject->linkPolicy.set(baton->params);
+    }
+}
+
+// This runs in Main Thread
+void Adapter::AfterGapSetLinkPolicy(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GapSetLinkPolicyBaton *>(req->data);
+    v8::Local<v8::Value> argv[1];
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "setting link policy");
+    }
+    else
+    {
+        argv[0] = Nan::Undefined();
+    }
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    baton->callback->Call(1, argv, &resource);
+    delete baton;
+}
+
+#pragma endregion LinkPolicy
+
 #endif // NRF_SD_BLE_API_VERSION >= 5
 
+#pragma region BondStore
+
+namespace {
+    // Legacy pairing encrypts with the key distributed by the peripheral, LE Secure Connections
+    // uses the same key on both sides. ownKey selects the key distributed by this device.
+    const ble_gap_enc_key_t *getBondEncKey(const bond_record_t &record, const bool ownKey)
+    {
+        auto preferred = ownKey ? &record.own_enc : &record.peer_enc;
+        auto other = ownKey ? &record.peer_enc : &record.own_enc;
+        auto preferredFlag = ownKey ? BOND_KEY_OWN_ENC : BOND_KEY_PEER_ENC;
+        auto otherFlag = ownKey ? BOND_KEY_PEER_ENC : BOND_KEY_OWN_ENC;
+
+        if ((record.keys & preferredFlag) && preferred->enc_info.ltk_len > 0)
+        {
+            return preferred;
+        }
+
+        if ((record.keys & otherFlag) && other->enc_info.ltk_len > 0 && other->enc_info.lesc)
+        {
+            return other;
+        }
+
+        return nullptr;
+    }
+}
+
+// This runs in the Main Thread, in event order
+void Adapter::trackBondEvent(ble_evt_t *event)
+{
+    auto gapEvent = &(event->evt.gap_evt);
+
+    switch (event->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            bondStore.onConnected(gapEvent->conn_handle, gapEvent->params.connected.peer_addr);
+            break;
+        case BLE_GAP_EVT_DISCONNECTED:
+            bondStore.onDisconnected(gapEvent->conn_handle);
+            break;
+        case BLE_GAP_EVT_AUTH_STATUS:
+        {
+            auto authStatus = &(gapEvent->params.auth_status);
+
+            if (authStatus->auth_status != BLE_GAP_SEC_STATUS_SUCCESS || !authStatus->bonded)
+            {
+                break;
+            }
+
+            if (!bondStore.addBond(gapEvent->conn_handle, getSecurityKey(gapEvent->conn_handle),
+                                   authStatus->kdist_own, authStatus->kdist_peer))
+            {
+                std::cerr << "Not able to store bond for connection " << gapEvent->conn_handle << "." << std::endl;
+            }
+
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// This runs in the thread the SoftDevice driver has initiated. Returns true if the request was answered.
+bool Adapter::replySecurityInfoFromBondStore(const ble_gap_evt_t *gapEvent)
+{
+    if (!bondStoreAutoReply || !bondStore.isEnabled())
+    {
+        return false;
+    }
+
+    auto request = &(gapEvent->params.sec_info_request);
+    bond_record_t record;
+
+    if (!bondStore.findBySecInfoRequest(*request, record))
+    {
+        return false;
+    }
+
+    auto encKey = getBondEncKey(record, true);
+    auto encInfo = (request->enc_info && encKey != nullptr) ? &(encKey->enc_info) : nullptr;
+    auto idInfo = (request->id_info && (record.keys & BOND_KEY_OWN_ID)) ? &(record.own_id.id_info) : nullptr;
+    auto signInfo = (request->sign_info && (record.keys & BOND_KEY_OWN_SIGN)) ? &(record.own_sign) : nullptr;
+
+    if (request->enc_info && encInfo == nullptr)
+    {
+        // Let the application decide
+        return false;
+    }
+
+    auto errorCode = sd_ble_gap_sec_info_reply(adapter, gapEvent->conn_handle, encInfo, idInfo, signInfo);
+
+    if (errorCode != NRF_SUCCESS)
+    {
+        std::cerr << "Not able to reply security info from bond store, error " << errorCode << "." << std::endl;
+        return false;
+    }
+
+    bondStoreSecInfoReplyCount += 1;
+    return true;
+}
+
+// This runs in the thread the SoftDevice driver has initiated
+void Adapter::encryptFromBondStore(const ble_gap_evt_t *gapEvent)
+{
+    auto connected = &(gapEvent->params.connected);
+
+    if (!bondStoreAutoEncrypt || !bondStore.isEnabled() || connected->role != BLE_GAP_ROLE_CENTRAL)
+    {
+        return;
+    }
+
+    bond_record_t record;
+
+    if (!bondStore.findByAddress(connected->peer_addr, record))
+    {
+        return;
+    }
+
+    auto encKey = getBondEncKey(record, false);
+
+    if (encKey == nullptr)
+    {
+        return;
+    }
+
+    auto errorCode = sd_ble_gap_encrypt(adapter, gapEvent->conn_handle, &(encKey->master_id), &(encKey->enc_info));
+
+    if (errorCode != NRF_SUCCESS)
+    {
+        std::cerr << "Not able to encrypt link from bond store, error " << errorCode << "." << std::endl;
+        return;
+    }
+
+    bondStoreEncryptCount += 1;
+}
+
+NAN_METHOD(Adapter::GapEnableBondStore)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    std::string path;
+    v8::Local<v8::Object> options;
+    auto argumentcount = 0;
+
+    try
+    {
+        path = ConversionUtility::getNativeString(info[argumentcount]);
+        argumentcount++;
+
+        options = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    bool autoReply;
+    bool autoEncrypt;
+
+    try
+    {
+        autoReply = ConversionUtility::getBool(options, "autoReply");
+        autoEncrypt = ConversionUtility::getBool(options, "autoEncrypt");
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("bond store options", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    try
+    {
+        obj->bondStore.open(path, NRF_SD_BLE_API_VERSION);
+    }
+    catch (std::string error)
+    {
+        Nan::ThrowError(error.c_str());
+        return;
+    }
+
+    obj->bondStoreAutoReply = autoReply;
+    obj->bondStoreAutoEncrypt = autoEncrypt;
+}
+
+NAN_METHOD(Adapter::GapDisableBondStore)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+
+    obj->bondStoreAutoReply = false;
+    obj->bondStoreAutoEncrypt = false;
+    obj->bondStore.close();
+}
+
+NAN_METHOD(Adapter::GapGetBonds)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    auto bonds = obj->bondStore.getBonds();
+    auto array = Nan::New<v8::Array>();
+
+    for (uint32_t i = 0; i < bonds.size(); i++)
+    {
+        auto &record = bonds[i];
+        auto bond = Nan::New<v8::Object>();
+
+        Utility::Set(bond, "peer_addr", GapAddr(&record.peer_addr).ToJs());
+        Utility::Set(bond, "own_enc", (record.keys & BOND_KEY_OWN_ENC) != 0);
+        Utility::Set(bond, "own_id", (record.keys & BOND_KEY_OWN_ID) != 0);
+        Utility::Set(bond, "own_sign", (record.keys & BOND_KEY_OWN_SIGN) != 0);
+        Utility::Set(bond, "peer_enc", (record.keys & BOND_KEY_PEER_ENC) != 0);
+        Utility::Set(bond, "peer_id", (record.keys & BOND_KEY_PEER_ID) != 0);
+        Utility::Set(bond, "peer_sign", (record.keys & BOND_KEY_PEER_SIGN) != 0);
+
+        auto encKey = getBondEncKey(record, true);
+        Utility::Set(bond, "lesc", encKey != nullptr && encKey->enc_info.lesc);
+
+        Nan::Set(array, i, bond);
+    }
+
+    Utility::SetReturnValue(info, array);
+}
+
+NAN_METHOD(Adapter::GapDeleteBond)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    ble_gap_addr_t *peer_addr;
+
+    try
+    {
+        peer_addr = GapAddr(ConversionUtility::getJsObject(info[0]));
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto removed = obj->bondStore.removeBond(*peer_addr);
+    delete peer_addr;
+
+    info.GetReturnValue().Set(removed);
+}
+
+#pragma endregion BondStore
+
+#pragma region LescDhKeyAutoReply
+
+// This runs in the thread the SoftDevice driver has initiated
+bool Adapter::submitLescDhKeyRequest(const ble_gap_evt_t *gapEvent)
+{
+    auto request = &(gapEvent->params.lesc_dhkey_request);
+
+    // OOB data must be set by the application before the reply
+    if (!lescDhKeyWorker.isEnabled() || request->oobd_req || request->p_pk_peer == nullptr)
+    {
+        return false;
+    }
+
+    return lescDhKeyWorker.submit(gapEvent->conn_handle, request->p_pk_peer->pk);
+}
+
+// This runs in Main Thread
+void Adapter::onLescDhKeyEvent(uv_async_t *handle)
+{
+    std::vector<lesc_dhkey_completion_t> completions;
+    lescDhKeyWorker.takeCompletions(completions);
+
+    if (completions.empty() || lescDhKeyCallback == nullptr)
+    {
+        return;
+    }
+
+    Nan::HandleScope scope;
+    auto array = Nan::New<v8::Array>();
+
+    for (uint32_t i = 0; i < completions.size(); i++)
+    {
+        auto &completion = completions[i];
+        auto entry = Nan::New<v8::Object>();
+
+        Utility::Set(entry, "conn_handle", completion.conn_handle);
+        Utility::Set(entry, "peer_key_valid", completion.peer_key_valid);
+
+        if (completion.result != NRF_SUCCESS)
+        {
+            Utility::Set(entry, "error", ErrorMessage::getErrorMessage(completion.result, "replying with DH key (LESC)"));
+        }
+
+        Nan::Set(array, i, entry);
+    }
+
+    v8::Local<v8::Value> argv[1];
+    argv[0] = array;
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    lescDhKeyCallback->Call(1, argv, &resource);
+}
+
+NAN_METHOD(Adapter::GapEnableLescDhKeyAutoReply)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint8_t *privateKey;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        // The worker copies exactly LESC_DHKEY_SK_LEN bytes of the key
+        auto key = info[argumentcount];
+        size_t keyLength = 0;
+
+        if (key->IsUint8Array())
+        {
+            keyLength = Nan::TypedArrayContents<uint8_t>(key).length();
+        }
+        else if (key->IsArray())
+        {
+            keyLength = v8::Local<v8::Array>::Cast(key)->Length();
+        }
+
+        if (keyLength != LESC_DHKEY_SK_LEN)
+        {
+            throw std::string("array or Buffer of 32 bytes");
+        }
+
+        privateKey = ConversionUtility::getNativePointerToUint8(key);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    if (privateKey == nullptr)
+    {
+        Nan::ThrowTypeError("NRF_ERROR_NULL");
+        return;
+    }
+
+    obj->initLescDhKeyHandling(std::make_unique<Nan::Callback>(callback));
+
+    auto async = obj->asyncLescDhKey.get();
+
+    obj->lescDhKeyWorker.start(privateKey,
+        [obj](uint16_t connHandle, const uint8_t *key) {
+            ble_gap_lesc_dhkey_t dhkey;
+            memcpy(dhkey.key, key, BLE_GAP_LESC_DHKEY_LEN);
+            return sd_ble_gap_lesc_dhkey_reply(obj->adapter, connHandle, &dhkey);
+        },
+        [async]() {
+            uv_async_send(async);
+        });
+
+    free(privateKey);
+}
+
+NAN_METHOD(Adapter::GapDisableLescDhKeyAutoReply)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    obj->lescDhKeyWorker.stop();
+}
+
+#pragma endregion LescDhKeyAutoReply
+
 #pragma endregion JavaScript function implementations
 
 #pragma region JavaScript constants from ble_gap.h
@@ -40,8 +40,13 @@
 #include "ble.h"
 #include "ble_hci.h"
 #include "common.h"
+#include "link_policy.h"
+#include "whitelist_mirror.h"
 
 #include <string>
+#include <vector>
+
+class Adapter;
 
 static name_map_t gap_event_name_map = {
     NAME_MAP_ENTRY(BLE_GAP_EVT_CONNECTED),
@@ -569,6 +574,7 @@ public:
     BATON_CONSTRUCTOR(StartScanBaton);
     BATON_DESTRUCTOR(StartScanBaton) { delete scan_params; }
     ble_gap_scan_params_t *scan_params;
+    Adapter *mainObject;
 #if NRF_SD_BLE_API_VERSION >= 5
     ble_data_t *adv_report_buffer;
     bool cont;
@@ -623,8 +629,46 @@ public:
     ble_gap_addr_t *address;
     ble_gap_scan_params_t *scan_params;
     ble_gap_conn_params_t *conn_params;
+    Adapter *mainObject;
+};
+
+struct GapWhitelistSetBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GapWhitelistSetBaton);
+    std::vector<ble_gap_addr_t> addresses;
+    Adapter *mainObject;
 };
 
+struct GapDeviceIdentitiesSetBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GapDeviceIdentitiesSetBaton);
+    std::vector<ble_gap_id_key_t> identities;
+    Adapter *mainObject;
+};
+
+#if NRF_SD_BLE_API_VERSION < 3
+// SoftDevice API v2 takes the whitelist with each selective scan or connect, this holds it for one call
+class WhitelistBuffer
+{
+public:
+    explicit WhitelistBuffer(WhitelistMirror &mirror);
+    WhitelistBuffer(const WhitelistBuffer &) = delete;
+    WhitelistBuffer &operator=(const WhitelistBuffer &) = delete;
+
+    // Sets p_whitelist if the scan parameters are selective
+    void apply(ble_gap_scan_params_t *scanParams);
+
+private:
+    std::vector<ble_gap_addr_t> addresses;
+    std::vector<ble_gap_addr_t *> addressPointers;
+    std::vector<ble_gap_irk_t> irks;
+    std::vector<ble_gap_irk_t *> irkPointers;
+    ble_gap_whitelist_t whitelist;
+};
+#endif
+
 struct GapConnectCancelBaton : public Baton
 {
 public:
@@ -892,6 +936,14 @@ public:
     ble_gap_phys_t *p_gap_phys;
 };
 
+struct GapSetLinkPolicyBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GapSetLinkPolicyBaton);
+    link_policy_params_t params;
+    Adapter *mainObject;
+};
+
 #endif
 
 #pragma endregion Gap Batons
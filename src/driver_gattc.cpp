@@ -454,7 +454,7 @@ NAN_METHOD(Adapter::GattcDiscoverPrimaryServices)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcDiscoverPrimaryServices, reinterpret_cast<uv_after_work_cb>(AfterGattcDiscoverPrimaryServices));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcDiscoverPrimaryServices);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -528,7 +528,7 @@ NAN_METHOD(Adapter::GattcDiscoverRelationship)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcDiscoverRelationship, reinterpret_cast<uv_after_work_cb>(AfterGattcDiscoverRelationship));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcDiscoverRelationship);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -602,7 +602,7 @@ NAN_METHOD(Adapter::GattcDiscoverCharacteristics)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcDiscoverCharacteristics, reinterpret_cast<uv_after_work_cb>(AfterGattcDiscoverCharacteristics));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcDiscoverCharacteristics);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -676,7 +676,7 @@ NAN_METHOD(Adapter::GattcDiscoverDescriptors)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcDiscoverDescriptors, reinterpret_cast<uv_after_work_cb>(AfterGattcDiscoverDescriptors));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcDiscoverDescriptors);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -765,7 +765,7 @@ NAN_METHOD(Adapter::GattcReadCharacteristicValueByUUID)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcReadCharacteristicValueByUUID, reinterpret_cast<uv_after_work_cb>(AfterGattcReadCharacteristicValueByUUID));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcReadCharacteristicValueByUUID);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -830,11 +830,12 @@ NAN_METHOD(Adapter::GattcRead)
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
     auto baton = new GattcReadBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->conn_handle = conn_handle;
     baton->handle = handle;
     baton->offset = offset;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcRead, reinterpret_cast<uv_after_work_cb>(AfterGattcRead));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcRead);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -842,6 +843,11 @@ void Adapter::GattcRead(uv_work_t *req)
 {
     auto baton = static_cast<GattcReadBaton *>(req->data);
     baton->result = sd_ble_gattc_read(baton->adapter, baton->conn_handle, baton->handle, baton->offset);
+
+    if (baton->result == NRF_SUCCESS)
+    {
+        baton->mainObject->linkStats.onRequest(baton->conn_handle, LINK_STATS_PACKET_READ);
+    }
 }
 
 // This runs in Main Thread
@@ -866,6 +872,285 @@ void Adapter::AfterGattcRead(uv_work_t *req)
     delete baton;
 }
 
+NAN_METHOD(Adapter::GattcReadLong)
+{
+    uint16_t conn_handle;
+    uint16_t handle;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    obj->initLongReadHandling();
+
+    // The read may complete in the event thread before the worker has returned, register the callback first
+    auto id = obj->nextLongReadId++;
+    obj->longReadCallbacks[id] = std::make_unique<Nan::Callback>(callback);
+
+    auto baton = new GattcReadLongBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->id = id;
+    baton->conn_handle = conn_handle;
+    baton->handle = handle;
+
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcReadLong);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattcReadLong(uv_work_t *req)
+{
+    auto baton = static_cast<GattcReadLongBaton *>(req->data);
+    auto mainObject = baton->mainObject;
+    auto attMtu = mainObject->linkStats.getAttMtu(baton->conn_handle);
+
+    baton->result = mainObject->longReads.start(baton->id, baton->conn_handle, baton->handle, attMtu);
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattcReadLong(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattcReadLongBaton *>(req->data);
+
+    // On success the callback is called from onLongReadEvent when the whole value is read
+    if (baton->result != NRF_SUCCESS)
+    {
+        baton->mainObject->longReadCallbacks.erase(baton->id);
+
+        v8::Local<v8::Value> argv[1];
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "starting long read");
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        baton->callback->Call(1, argv, &resource);
+    }
+
+    delete baton;
+}
+
+NAN_METHOD(Adapter::GattcWriteLong)
+{
+    uint16_t conn_handle;
+    v8::Local<v8::Object> writes;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        conn_handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        writes = ConversionUtility::getJsObject(info[argumentcount]);
+
+        if (!writes->IsArray())
+        {
+            throw std::string("array");
+        }
+
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    std::vector<long_write_item_t> items;
+
+    try
+    {
+        auto array = v8::Local<v8::Array>::Cast(writes);
+
+        for (uint32_t i = 0; i < array->Length(); i++)
+        {
+            auto write = ConversionUtility::getJsObject(Utility::Get(array, i));
+
+            long_write_item_t item;
+            item.handle = ConversionUtility::getNativeUint16(write, "handle");
+            item.value = ConversionUtility::getNativeByteVector(Utility::Get(write, "value"));
+            items.push_back(item);
+        }
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("writes", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    obj->initLongWriteHandling();
+
+    // The write may complete in the event thread before the worker has returned, register the callback first
+    auto id = obj->nextLongWriteId++;
+    obj->longWriteCallbacks[id] = std::make_unique<Nan::Callback>(callback);
+
+    auto baton = new GattcWriteLongBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->id = id;
+    baton->conn_handle = conn_handle;
+    baton->items.swap(items);
+
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcWriteLong);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattcWriteLong(uv_work_t *req)
+{
+    auto baton = static_cast<GattcWriteLongBaton *>(req->data);
+    auto mainObject = baton->mainObject;
+    auto attMtu = mainObject->linkStats.getAttMtu(baton->conn_handle);
+
+    baton->result = mainObject->longWrites.start(baton->id, baton->conn_handle, baton->items, attMtu);
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattcWriteLong(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattcWriteLongBaton *>(req->data);
+
+    // On success the callback is called from onLongWriteEvent when the queue is executed or cancelled
+    if (baton->result != NRF_SUCCESS)
+    {
+        baton->mainObject->longWriteCallbacks.erase(baton->id);
+
+        v8::Local<v8::Value> argv[1];
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "starting long write");
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        baton->callback->Call(1, argv, &resource);
+    }
+
+    delete baton;
+}
+
+// This runs in the thread the SoftDevice driver has initiated. Returns true if the response belongs to a long write.
+bool Adapter::continueLongWrite(const ble_gattc_evt_t *gattcEvent)
+{
+    auto response = &(gattcEvent->params.write_rsp);
+    auto handle = gattcEvent->gatt_status == BLE_GATT_STATUS_SUCCESS ? response->handle : gattcEvent->error_handle;
+
+    return longWrites.onWriteResponse(gattcEvent->conn_handle, gattcEvent->gatt_status, handle, response->offset, response->data, response->len);
+}
+
+// This runs in Main Thread
+void Adapter::onLongWriteEvent(uv_async_t *handle)
+{
+    std::vector<long_write_completion_t> completions;
+    longWrites.takeCompletions(completions);
+
+    for (auto &completion : completions)
+    {
+        auto entry = longWriteCallbacks.find(completion.id);
+
+        if (entry == longWriteCallbacks.end())
+        {
+            continue;
+        }
+
+        // Take the callback out of the map first, it may start another long write
+        auto callback = std::move(entry->second);
+        longWriteCallbacks.erase(entry);
+
+        Nan::HandleScope scope;
+        v8::Local<v8::Value> argv[2];
+
+        if (completion.result != NRF_SUCCESS)
+        {
+            argv[0] = ErrorMessage::getErrorMessage(completion.result, "writing long value");
+            argv[1] = Nan::Undefined();
+        }
+        else
+        {
+            auto result = Nan::New<v8::Object>();
+            Utility::Set(result, "conn_handle", completion.conn_handle);
+            Utility::Set(result, "executed", completion.executed);
+            Utility::Set(result, "verify_failed", completion.verify_failed);
+            Utility::Set(result, "gatt_status", completion.gatt_status);
+            Utility::Set(result, "gatt_status_name", ConversionUtility::valueToJsString(completion.gatt_status, gatt_status_map, ConversionUtility::toJsString("Unknown GATT status")));
+            Utility::Set(result, "error_handle", completion.error_handle);
+            Utility::Set(result, "request_count", completion.request_count);
+
+            argv[0] = Nan::Undefined();
+            argv[1] = result;
+        }
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        callback->Call(2, argv, &resource);
+    }
+}
+
+// This runs in Main Thread
+void Adapter::onLongReadEvent(uv_async_t *handle)
+{
+    std::vector<long_read_completion_t> completions;
+    longReads.takeCompletions(completions);
+
+    for (auto &completion : completions)
+    {
+        auto entry = longReadCallbacks.find(completion.id);
+
+        if (entry == longReadCallbacks.end())
+        {
+            continue;
+        }
+
+        // Take the callback out of the map first, it may start another long read
+        auto callback = std::move(entry->second);
+        longReadCallbacks.erase(entry);
+
+        Nan::HandleScope scope;
+        v8::Local<v8::Value> argv[2];
+
+        if (completion.result != NRF_SUCCESS)
+        {
+            argv[0] = ErrorMessage::getErrorMessage(completion.result, "reading long value");
+            argv[1] = Nan::Undefined();
+        }
+        else
+        {
+            auto result = Nan::New<v8::Object>();
+            Utility::Set(result, "conn_handle", completion.conn_handle);
+            Utility::Set(result, "handle", completion.handle);
+            Utility::Set(result, "gatt_status", completion.gatt_status);
+            Utility::Set(result, "gatt_status_name", ConversionUtility::valueToJsString(completion.gatt_status, gatt_status_map, ConversionUtility::toJsString("Unknown GATT status")));
+            Utility::Set(result, "request_count", completion.request_count);
+            Utility::Set(result, "value", ConversionUtility::toJsValueArray(completion.value.data(), static_cast<uint16_t>(completion.value.size())));
+
+            argv[0] = Nan::Undefined();
+            argv[1] = result;
+        }
+
+        Nan::AsyncResource resource("pc-ble-driver-js:callback");
+        callback->Call(2, argv, &resource);
+    }
+}
+
 NAN_METHOD(Adapter::GattcReadCharacteristicValues)
 {
     uint16_t conn_handle;
@@ -918,7 +1203,7 @@ NAN_METHOD(Adapter::GattcReadCharacteristicValues)
     baton->p_handles = p_handles;
     baton->handle_count = handle_count;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcReadCharacteristicValues, reinterpret_cast<uv_after_work_cb>(AfterGattcReadCharacteristicValues));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcReadCharacteristicValues);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -979,6 +1264,7 @@ NAN_METHOD(Adapter::GattcWrite)
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
     auto baton = new GattcWriteBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->conn_handle = conn_handle;
 
     try
@@ -992,7 +1278,7 @@ NAN_METHOD(Adapter::GattcWrite)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcWrite, reinterpret_cast<uv_after_work_cb>(AfterGattcWrite));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcWrite);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1000,6 +1286,12 @@ void Adapter::GattcWrite(uv_work_t *req)
 {
     auto baton = static_cast<GattcWriteBaton *>(req->data);
     baton->result = sd_ble_gattc_write(baton->adapter, baton->conn_handle, baton->p_write_params);
+    baton->mainObject->trackLinkTx(baton->conn_handle, LINK_STATS_PACKET_WRITE, baton->p_write_params->len, baton->result);
+
+    if (baton->result == NRF_SUCCESS && baton->p_write_params->write_op == BLE_GATT_OP_WRITE_REQ)
+    {
+        baton->mainObject->linkStats.onRequest(baton->conn_handle, LINK_STATS_PACKET_WRITE);
+    }
 }
 
 // This runs in Main Thread
@@ -1055,7 +1347,7 @@ NAN_METHOD(Adapter::GattcConfirmHandleValue)
     baton->conn_handle = conn_handle;
     baton->handle = handle;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcConfirmHandleValue, reinterpret_cast<uv_after_work_cb>(AfterGattcConfirmHandleValue));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcConfirmHandleValue);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1116,10 +1408,11 @@ NAN_METHOD(Adapter::GattcExchangeMtuRequest)
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
     auto baton = new GattcExchangeMtuRequestBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->conn_handle = conn_handle;
     baton->client_rx_mtu = client_rx_mtu;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattcExchangeMtuRequest, reinterpret_cast<uv_after_work_cb>(AfterGattcExchangeMtuRequest));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattcExchangeMtuRequest);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1127,6 +1420,11 @@ void Adapter::GattcExchangeMtuRequest(uv_work_t *req)
 {
     auto baton = static_cast<GattcExchangeMtuRequestBaton *>(req->data);
     baton->result = sd_ble_gattc_exchange_mtu_request(baton->adapter, baton->conn_handle, baton->client_rx_mtu);
+
+    if (baton->result == NRF_SUCCESS)
+    {
+        baton->mainObject->linkStats.setLocalAttMtu(baton->conn_handle, baton->client_rx_mtu);
+    }
 }
 
 // This runs in Main Thread
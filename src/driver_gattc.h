@@ -39,6 +39,11 @@
 
 #include "common.h"
 #include "ble_gattc.h"
+#include "long_write_engine.h"
+
+#include <vector>
+
+class Adapter;
 
 extern name_map_t gatt_status_map;
 
@@ -322,6 +327,27 @@ public:
     uint16_t conn_handle;
     uint16_t handle;
     uint16_t offset;
+    Adapter *mainObject;
+};
+
+struct GattcReadLongBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattcReadLongBaton);
+    uint32_t id;
+    uint16_t conn_handle;
+    uint16_t handle;
+    Adapter *mainObject;
+};
+
+struct GattcWriteLongBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattcWriteLongBaton);
+    uint32_t id;
+    uint16_t conn_handle;
+    std::vector<long_write_item_t> items;
+    Adapter *mainObject;
 };
 
 struct GattcReadCharacteristicValuesBaton : public Baton
@@ -345,6 +371,7 @@ public:
     }
     uint16_t conn_handle;
     ble_gattc_write_params_t *p_write_params;
+    Adapter *mainObject;
 };
 
 struct GattcConfirmHandleValueBaton : public Baton
@@ -361,6 +388,7 @@ public:
     BATON_CONSTRUCTOR(GattcExchangeMtuRequestBaton);
     uint16_t conn_handle;
     uint16_t client_rx_mtu;
+    Adapter *mainObject;
 };
 
 ///// End GATTC Batons //////////////////////////////////////////////////////////////////////////////////
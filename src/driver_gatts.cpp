@@ -41,7 +41,9 @@
 #include "driver_gap.h"
 #include "driver_gatt.h"
 
+#include <cstring>
 #include <iostream>
+#include <sstream>
 
 static name_map_t gatts_op_map =
 {
@@ -439,7 +441,7 @@ NAN_METHOD(Adapter::GattsAddService)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsAddService, reinterpret_cast<uv_after_work_cb>(AfterGattsAddService));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsAddService);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -505,6 +507,7 @@ NAN_METHOD(Adapter::GattsAddCharacteristic)
 
     auto baton = new GattsAddCharacteristicBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->service_handle = serviceHandle;
 
     try
@@ -529,7 +532,7 @@ NAN_METHOD(Adapter::GattsAddCharacteristic)
 
     baton->p_handles = new ble_gatts_char_handles_t();
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsAddCharacteristic, reinterpret_cast<uv_after_work_cb>(AfterGattsAddCharacteristic));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsAddCharacteristic);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -537,6 +540,11 @@ void Adapter::GattsAddCharacteristic(uv_work_t *req)
 {
     auto baton = static_cast<GattsAddCharacteristicBaton *>(req->data);
     baton->result = sd_ble_gatts_characteristic_add(baton->adapter, baton->service_handle, baton->p_char_md, baton->p_attr_char_value, baton->p_handles);
+
+    if (baton->result == NRF_SUCCESS && baton->p_handles->cccd_handle != BLE_GATT_HANDLE_INVALID)
+    {
+        baton->mainObject->notificationFanout.addCharacteristic(baton->p_handles->value_handle, baton->p_handles->cccd_handle);
+    }
 }
 
 // This runs in Main Thread
@@ -604,7 +612,7 @@ NAN_METHOD(Adapter::GattsAddDescriptor)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsAddDescriptor, reinterpret_cast<uv_after_work_cb>(AfterGattsAddDescriptor));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsAddDescriptor);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -638,6 +646,364 @@ void Adapter::AfterGattsAddDescriptor(uv_work_t *req)
     delete baton;
 }
 
+namespace {
+    // Converts a 16-bit or 128-bit UUID string (dashes allowed) to little endian bytes as expected by sd_ble_uuid_decode
+    std::vector<uint8_t> tableUuidToNative(const std::string &uuid)
+    {
+        std::string hex;
+
+        for (auto c : uuid)
+        {
+            if (c != '-')
+            {
+                hex.push_back(c);
+            }
+        }
+
+        if (hex.length() != 4 && hex.length() != 32)
+        {
+            throw std::string("UUID string with 4 or 32 hex digits");
+        }
+
+        auto uuid_le = std::vector<uint8_t>(hex.length() / 2);
+
+        for (size_t i = 0; i < uuid_le.size(); i++)
+        {
+            auto high = ConversionUtility::extractHexHelper(hex[i * 2]);
+            auto low = ConversionUtility::extractHexHelper(hex[i * 2 + 1]);
+
+            if (high == 0xFF || low == 0xFF)
+            {
+                throw std::string("UUID string with 4 or 32 hex digits");
+            }
+
+            uuid_le[uuid_le.size() - 1 - i] = static_cast<uint8_t>((high << 4) + low);
+        }
+
+        return uuid_le;
+    }
+
+    // Same layout as GattsAttribute, except that the UUID is given as a string next to the attribute
+    ble_gatts_attr_t *tableAttributeToNative(v8::Local<v8::Object> jsobj)
+    {
+        auto attribute = new ble_gatts_attr_t();
+
+        try
+        {
+            attribute->p_attr_md = GattsAttributeMetadata(ConversionUtility::getJsObject(jsobj, "attr_md"));
+            attribute->init_len = ConversionUtility::getNativeUint16(jsobj, "init_len");
+            attribute->init_offs = ConversionUtility::getNativeUint16(jsobj, "init_offs");
+            attribute->max_len = ConversionUtility::getNativeUint16(jsobj, "max_len");
+            attribute->p_value = ConversionUtility::getNativePointerToUint8(jsobj, "value");
+        }
+        catch (std::string)
+        {
+            GattsBuildTableBaton::freeTableAttribute(attribute);
+            throw;
+        }
+
+        return attribute;
+    }
+
+    v8::Local<v8::Array> getTableArray(v8::Local<v8::Object> jsobj, const char *name)
+    {
+        auto value = Utility::Get(jsobj, name);
+
+        if (value->IsUndefined())
+        {
+            return Nan::New<v8::Array>();
+        }
+
+        if (!value->IsArray())
+        {
+            throw std::string("array");
+        }
+
+        return v8::Local<v8::Array>::Cast(value);
+    }
+
+    class TableUuidResolver
+    {
+    public:
+        TableUuidResolver(adapter_t *adapter, VendorUuidRegistry *vendorUuids) : adapter(adapter), vendorUuids(vendorUuids), vsAdded(0) {}
+
+        uint32_t resolve(const std::vector<uint8_t> &uuid_le, ble_uuid_t *uuid)
+        {
+            if (uuid_le.size() == 2)
+            {
+                uuid->type = BLE_UUID_TYPE_BLE;
+                uuid->uuid = static_cast<uint16_t>(uuid_le[0] | (uuid_le[1] << 8));
+                return NRF_SUCCESS;
+            }
+
+            // Bytes 12 and 13 hold the 16-bit alias, the remaining bytes are the vendor specific base
+            uuid->uuid = static_cast<uint16_t>(uuid_le[12] | (uuid_le[13] << 8));
+
+            if (vendorUuids->findType(uuid_le.data(), &uuid->type))
+            {
+                return NRF_SUCCESS;
+            }
+
+            auto err_code = sd_ble_uuid_decode(adapter, VENDOR_UUID_LENGTH, uuid_le.data(), uuid);
+
+            if (err_code == NRF_ERROR_NOT_FOUND)
+            {
+                ble_uuid128_t vs_uuid;
+                std::memcpy(vs_uuid.uuid128, uuid_le.data(), VENDOR_UUID_LENGTH);
+
+                err_code = sd_ble_uuid_vs_add(adapter, &vs_uuid, &uuid->type);
+
+                if (err_code == NRF_SUCCESS)
+                {
+                    vsAdded++;
+                }
+            }
+
+            if (err_code == NRF_SUCCESS)
+            {
+                vendorUuids->add(uuid->type, uuid_le.data());
+            }
+
+            return err_code;
+        }
+
+        uint8_t getVsAddedCount() const { return vsAdded; }
+
+    private:
+        adapter_t *adapter;
+        VendorUuidRegistry *vendorUuids;
+        uint8_t vsAdded;
+    };
+}
+
+NAN_METHOD(Adapter::GattsBuildTable)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    v8::Local<v8::Object> definition;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        definition = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto baton = new GattsBuildTableBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->vs_uuid_count = 0;
+
+    std::stringstream element;
+
+    try
+    {
+        element << "services";
+        auto services = getTableArray(definition, "services");
+
+        for (uint32_t i = 0; i < services->Length(); i++)
+        {
+            element.str("");
+            element << "services[" << i << "]";
+
+            auto jsService = ConversionUtility::getJsObject(Utility::Get(services, i));
+
+            baton->services.push_back(GattsTableService());
+            auto &service = baton->services.back();
+            service.type = ConversionUtility::getNativeUint8(jsService, "type");
+            service.uuid_le = tableUuidToNative(ConversionUtility::getNativeString(jsService, "uuid"));
+            service.handle = BLE_GATT_HANDLE_INVALID;
+
+            auto characteristics = getTableArray(jsService, "characteristics");
+
+            for (uint32_t j = 0; j < characteristics->Length(); j++)
+            {
+                element.str("");
+                element << "services[" << i << "].characteristics[" << j << "]";
+
+                auto jsCharacteristic = ConversionUtility::getJsObject(Utility::Get(characteristics, j));
+
+                service.characteristics.push_back(GattsTableCharacteristic());
+                auto &characteristic = service.characteristics.back();
+                characteristic.p_char_md = nullptr;
+                characteristic.p_attr_char_value = nullptr;
+                characteristic.handles = ble_gatts_char_handles_t();
+                characteristic.uuid_le = tableUuidToNative(ConversionUtility::getNativeString(jsCharacteristic, "uuid"));
+                characteristic.p_char_md = GattsCharacteristicMetadata(ConversionUtility::getJsObject(jsCharacteristic, "metadata"));
+                characteristic.p_attr_char_value = tableAttributeToNative(ConversionUtility::getJsObject(jsCharacteristic, "attribute"));
+
+                auto descriptors = getTableArray(jsCharacteristic, "descriptors");
+
+                for (uint32_t k = 0; k < descriptors->Length(); k++)
+                {
+                    element.str("");
+                    element << "services[" << i << "].characteristics[" << j << "].descriptors[" << k << "]";
+
+                    auto jsDescriptor = ConversionUtility::getJsObject(Utility::Get(descriptors, k));
+
+                    characteristic.descriptors.push_back(GattsTableDescriptor());
+                    auto &descriptor = characteristic.descriptors.back();
+                    descriptor.p_attr = nullptr;
+                    descriptor.handle = BLE_GATT_HANDLE_INVALID;
+                    descriptor.uuid_le = tableUuidToNative(ConversionUtility::getNativeString(jsDescriptor, "uuid"));
+                    descriptor.p_attr = tableAttributeToNative(jsDescriptor);
+                }
+            }
+        }
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage(element.str(), error);
+        Nan::ThrowTypeError(message);
+        delete baton;
+        return;
+    }
+
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsBuildTable);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattsBuildTable(uv_work_t *req)
+{
+    auto baton = static_cast<GattsBuildTableBaton *>(req->data);
+    TableUuidResolver resolver(baton->adapter, &baton->mainObject->vendorUuids);
+    std::stringstream element;
+
+    baton->result = NRF_SUCCESS;
+
+    for (size_t i = 0; i < baton->services.size() && baton->result == NRF_SUCCESS; i++)
+    {
+        auto &service = baton->services[i];
+
+        element.str("");
+        element << "services[" << i << "]";
+
+        baton->result = resolver.resolve(service.uuid_le, &service.uuid);
+
+        if (baton->result == NRF_SUCCESS)
+        {
+            baton->result = sd_ble_gatts_service_add(baton->adapter, service.type, &service.uuid, &service.handle);
+        }
+
+        for (size_t j = 0; j < service.characteristics.size() && baton->result == NRF_SUCCESS; j++)
+        {
+            auto &characteristic = service.characteristics[j];
+
+            element.str("");
+            element << "services[" << i << "].characteristics[" << j << "]";
+
+            baton->result = resolver.resolve(characteristic.uuid_le, &characteristic.uuid);
+
+            if (baton->result == NRF_SUCCESS)
+            {
+                characteristic.p_attr_char_value->p_uuid = &characteristic.uuid;
+                baton->result = sd_ble_gatts_characteristic_add(baton->adapter, service.handle, characteristic.p_char_md, characteristic.p_attr_char_value, &characteristic.handles);
+            }
+
+            if (baton->result == NRF_SUCCESS && characteristic.handles.cccd_handle != BLE_GATT_HANDLE_INVALID)
+            {
+                baton->mainObject->notificationFanout.addCharacteristic(characteristic.handles.value_handle, characteristic.handles.cccd_handle);
+            }
+
+            for (size_t k = 0; k < characteristic.descriptors.size() && baton->result == NRF_SUCCESS; k++)
+            {
+                auto &descriptor = characteristic.descriptors[k];
+
+                element.str("");
+                element << "services[" << i << "].characteristics[" << j << "].descriptors[" << k << "]";
+
+                baton->result = resolver.resolve(descriptor.uuid_le, &descriptor.uuid);
+
+                if (baton->result == NRF_SUCCESS)
+                {
+                    descriptor.p_attr->p_uuid = &descriptor.uuid;
+                    baton->result = sd_ble_gatts_descriptor_add(baton->adapter, characteristic.handles.value_handle, descriptor.p_attr, &descriptor.handle);
+                }
+            }
+        }
+    }
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        baton->failed_element = element.str();
+    }
+
+    baton->vs_uuid_count = resolver.getVsAddedCount();
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattsBuildTable(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattsBuildTableBaton *>(req->data);
+    v8::Local<v8::Value> argv[2];
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "building attribute table at " + baton->failed_element);
+        argv[1] = Nan::Undefined();
+    }
+    else
+    {
+        auto services = Nan::New<v8::Array>();
+
+        for (uint32_t i = 0; i < baton->services.size(); i++)
+        {
+            auto &service = baton->services[i];
+            auto jsService = Nan::New<v8::Object>();
+            auto characteristics = Nan::New<v8::Array>();
+
+            for (uint32_t j = 0; j < service.characteristics.size(); j++)
+            {
+                auto &characteristic = service.characteristics[j];
+                auto jsCharacteristic = Nan::New<v8::Object>();
+                auto descriptors = Nan::New<v8::Array>();
+
+                for (uint32_t k = 0; k < characteristic.descriptors.size(); k++)
+                {
+                    auto &descriptor = characteristic.descriptors[k];
+                    auto jsDescriptor = Nan::New<v8::Object>();
+
+                    Utility::Set(jsDescriptor, "uuid", BleUUID(&descriptor.uuid).ToJs());
+                    Utility::Set(jsDescriptor, "handle", ConversionUtility::toJsNumber(descriptor.handle));
+                    Nan::Set(descriptors, k, jsDescriptor);
+                }
+
+                Utility::Set(jsCharacteristic, "uuid", BleUUID(&characteristic.uuid).ToJs());
+                Utility::Set(jsCharacteristic, "handles", GattsCharacteristicDefinitionHandles(&characteristic.handles).ToJs());
+                Utility::Set(jsCharacteristic, "descriptors", descriptors);
+                Nan::Set(characteristics, j, jsCharacteristic);
+            }
+
+            Utility::Set(jsService, "uuid", BleUUID(&service.uuid).ToJs());
+            Utility::Set(jsService, "handle", ConversionUtility::toJsNumber(service.handle));
+            Utility::Set(jsService, "characteristics", characteristics);
+            Nan::Set(services, i, jsService);
+        }
+
+        auto result = Nan::New<v8::Object>();
+        Utility::Set(result, "services", services);
+        Utility::Set(result, "vendorUuidCount", ConversionUtility::toJsNumber(baton->vs_uuid_count));
+
+        argv[0] = Nan::Undefined();
+        argv[1] = result;
+    }
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    baton->callback->Call(2, argv, &resource);
+    delete baton;
+}
+
 NAN_METHOD(Adapter::GattsHVX)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
@@ -666,6 +1032,7 @@ NAN_METHOD(Adapter::GattsHVX)
 
     auto baton = new GattsHVXBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->conn_handle = conn_handle;
 
     try
@@ -679,7 +1046,7 @@ NAN_METHOD(Adapter::GattsHVX)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsHVX, reinterpret_cast<uv_after_work_cb>(AfterGattsHVX));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsHVX);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -687,6 +1054,7 @@ void Adapter::GattsHVX(uv_work_t *req)
 {
     auto baton = static_cast<GattsHVXBaton *>(req->data);
     baton->result = sd_ble_gatts_hvx(baton->adapter, baton->conn_handle, baton->p_hvx_params);
+    baton->mainObject->trackLinkTx(baton->conn_handle, LINK_STATS_PACKET_HVX, *(baton->p_hvx_params->p_len), baton->result);
 }
 
 // This runs in Main Thread
@@ -713,6 +1081,138 @@ void Adapter::AfterGattsHVX(uv_work_t *req)
     delete baton;
 }
 
+// This runs in a worker thread or in the thread the SoftDevice driver has initiated
+notification_send_result_t Adapter::sendNotification(const uint16_t connHandle, const uint16_t valueHandle, const uint8_t type, const std::vector<uint8_t> &data)
+{
+    auto length = static_cast<uint16_t>(data.size());
+
+    ble_gatts_hvx_params_t hvx_params;
+    hvx_params.handle = valueHandle;
+    hvx_params.type = type;
+    hvx_params.offset = 0;
+    hvx_params.p_len = &length;
+    hvx_params.p_data = const_cast<uint8_t *>(data.data());
+
+    auto result = sd_ble_gatts_hvx(adapter, connHandle, &hvx_params);
+    trackLinkTx(connHandle, LINK_STATS_PACKET_HVX, length, result);
+
+    switch (result)
+    {
+        case NRF_SUCCESS:
+            return NOTIFICATION_SENT;
+#if NRF_SD_BLE_API_VERSION <= 3
+        case BLE_ERROR_NO_TX_PACKETS:
+#else
+        case NRF_ERROR_RESOURCES:
+#endif
+        case NRF_ERROR_BUSY: // An indication is waiting for confirmation
+            return NOTIFICATION_BUSY;
+        default:
+            return NOTIFICATION_FAILED;
+    }
+}
+
+// Sends the notifications queued on a link when the SoftDevice reports capacity.
+// This runs in the thread the SoftDevice driver has initiated.
+void Adapter::resumeNotifications(const uint16_t connHandle)
+{
+    notificationFanout.resume(connHandle, [this](uint16_t conn, uint16_t handle, uint8_t type, const std::vector<uint8_t> &data) {
+        return sendNotification(conn, handle, type, data);
+    });
+}
+
+NAN_METHOD(Adapter::GattsNotifyAll)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t valueHandle;
+    std::vector<uint8_t> data;
+    v8::Local<v8::Function> callback;
+    auto argumentcount = 0;
+
+    try
+    {
+        valueHandle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        data = ConversionUtility::getNativeByteVector(info[argumentcount]);
+        argumentcount++;
+
+        callback = ConversionUtility::getCallbackFunction(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    auto baton = new GattsNotifyAllBaton(callback);
+    baton->adapter = obj->adapter;
+    baton->mainObject = obj;
+    baton->value_handle = valueHandle;
+    baton->data = std::move(data);
+    baton->notify_result = notify_all_result_t();
+
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsNotifyAll);
+}
+
+// This runs in a worker thread (not Main Thread)
+void Adapter::GattsNotifyAll(uv_work_t *req)
+{
+    auto baton = static_cast<GattsNotifyAllBaton *>(req->data);
+
+    // Links that are not subscribed, or get their notification later, read the new value
+    auto length = static_cast<uint16_t>(baton->data.size());
+    ble_gatts_value_t value;
+    value.len = length;
+    value.offset = 0;
+    value.p_value = baton->data.data();
+
+    baton->result = sd_ble_gatts_value_set(baton->adapter, BLE_CONN_HANDLE_INVALID, baton->value_handle, &value);
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        return;
+    }
+
+    auto mainObject = baton->mainObject;
+    baton->notify_result = mainObject->notificationFanout.notifyAll(baton->value_handle, baton->data,
+        [mainObject](uint16_t conn, uint16_t handle, uint8_t type, const std::vector<uint8_t> &data) {
+            return mainObject->sendNotification(conn, handle, type, data);
+        });
+}
+
+// This runs in Main Thread
+void Adapter::AfterGattsNotifyAll(uv_work_t *req)
+{
+    Nan::HandleScope scope;
+
+    auto baton = static_cast<GattsNotifyAllBaton *>(req->data);
+    v8::Local<v8::Value> argv[2];
+
+    if (baton->result != NRF_SUCCESS)
+    {
+        argv[0] = ErrorMessage::getErrorMessage(baton->result, "setting value before notifying subscribers");
+        argv[1] = Nan::Undefined();
+    }
+    else
+    {
+        auto result = Nan::New<v8::Object>();
+        Utility::Set(result, "subscriberCount", baton->notify_result.subscriber_count);
+        Utility::Set(result, "sentCount", baton->notify_result.sent_count);
+        Utility::Set(result, "queuedCount", baton->notify_result.queued_count);
+        Utility::Set(result, "failedCount", baton->notify_result.failed_count);
+
+        argv[0] = Nan::Undefined();
+        argv[1] = result;
+    }
+
+    Nan::AsyncResource resource("pc-ble-driver-js:callback");
+    baton->callback->Call(2, argv, &resource);
+    delete baton;
+}
+
 NAN_METHOD(Adapter::GattsSystemAttributeSet)
 {
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
@@ -771,7 +1271,7 @@ NAN_METHOD(Adapter::GattsSystemAttributeSet)
     baton->len = len;
     baton->flags = flags;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsSystemAttributeSet, reinterpret_cast<uv_after_work_cb>(AfterGattsSystemAttributeSet));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsSystemAttributeSet);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -849,7 +1349,7 @@ NAN_METHOD(Adapter::GattsSetValue)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsSetValue, reinterpret_cast<uv_after_work_cb>(AfterGattsSetValue));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsSetValue);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -929,7 +1429,7 @@ NAN_METHOD(Adapter::GattsGetValue)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsGetValue, reinterpret_cast<uv_after_work_cb>(AfterGattsGetValue));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsGetValue);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1004,7 +1504,7 @@ NAN_METHOD(Adapter::GattsReplyReadWriteAuthorize)
         return;
     }
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsReplyReadWriteAuthorize, reinterpret_cast<uv_after_work_cb>(AfterGattsReplyReadWriteAuthorize));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsReplyReadWriteAuthorize);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1065,10 +1565,11 @@ NAN_METHOD(Adapter::GattsExchangeMtuReply)
     auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
     auto baton = new GattsExchangeMtuReplyBaton(callback);
     baton->adapter = obj->adapter;
+    baton->mainObject = obj;
     baton->conn_handle = conn_handle;
     baton->server_rx_mtu = server_rx_mtu;
 
-    uv_queue_work(uv_default_loop(), baton->req, GattsExchangeMtuReply, reinterpret_cast<uv_after_work_cb>(AfterGattsExchangeMtuReply));
+    QUEUE_ADAPTER_METHOD(obj, baton, GattsExchangeMtuReply);
 }
 
 // This runs in a worker thread (not Main Thread)
@@ -1076,6 +1577,11 @@ void Adapter::GattsExchangeMtuReply(uv_work_t *req)
 {
     auto baton = static_cast<GattsExchangeMtuReplyBaton *>(req->data);
     baton->result = sd_ble_gatts_exchange_mtu_reply(baton->adapter, baton->conn_handle, baton->server_rx_mtu);
+
+    if (baton->result == NRF_SUCCESS)
+    {
+        baton->mainObject->linkStats.setLocalAttMtu(baton->conn_handle, baton->server_rx_mtu);
+    }
 }
 
 // This runs in Main Thread
@@ -1101,6 +1607,211 @@ void Adapter::AfterGattsExchangeMtuReply(uv_work_t *req)
 }
 #endif
 
+#pragma region AuthorizePolicy
+
+// This runs in the thread the SoftDevice driver has initiated. Returns true if the request was answered.
+bool Adapter::replyAuthorizeFromPolicy(const ble_gatts_evt_t *gattsEvent)
+{
+    auto request = &(gattsEvent->params.authorize_request);
+    auto connHandle = gattsEvent->conn_handle;
+    auto type = request->type;
+
+    auto reply = [this, connHandle, type](uint16_t gattStatus, bool update, uint16_t offset, const uint8_t *data, uint16_t length) {
+        ble_gatts_rw_authorize_reply_params_t params;
+        memset(&params, 0, sizeof(params));
+        params.type = type;
+
+        auto authorize = (type == BLE_GATTS_AUTHORIZE_TYPE_READ) ? &(params.params.read) : &(params.params.write);
+        authorize->gatt_status = gattStatus;
+        authorize->update = update ? 1 : 0;
+        authorize->offset = offset;
+        authorize->len = length;
+        authorize->p_data = const_cast<uint8_t *>(data);
+
+        auto errorCode = sd_ble_gatts_rw_authorize_reply(adapter, connHandle, &params);
+
+        if (errorCode != NRF_SUCCESS)
+        {
+            std::cerr << "Not able to reply to authorize request from policy, error " << errorCode << "." << std::endl;
+        }
+
+        return errorCode;
+    };
+
+    if (type == BLE_GATTS_AUTHORIZE_TYPE_READ)
+    {
+        return authorizePolicy.handleRead(request->request.read.handle, request->request.read.offset, reply);
+    }
+
+    if (type != BLE_GATTS_AUTHORIZE_TYPE_WRITE)
+    {
+        return false;
+    }
+
+    auto write = &(request->request.write);
+
+    // Queued writes need the user memory block and execute handling in JavaScript
+    if (write->op != BLE_GATTS_OP_WRITE_REQ && write->op != BLE_GATTS_OP_WRITE_CMD && write->op != BLE_GATTS_OP_SIGN_WRITE_CMD)
+    {
+        return false;
+    }
+
+    return authorizePolicy.handleWrite(write->handle, write->offset, write->data, write->len, reply);
+}
+
+NAN_INLINE authorize_action_t ToAuthorizeAction(const std::string &action)
+{
+    if (action == "defer")
+    {
+        return AUTHORIZE_DEFER;
+    }
+
+    if (action == "accept")
+    {
+        return AUTHORIZE_ACCEPT;
+    }
+
+    if (action == "value")
+    {
+        return AUTHORIZE_ACCEPT_WITH_VALUE;
+    }
+
+    if (action == "reject")
+    {
+        return AUTHORIZE_REJECT;
+    }
+
+    throw std::string("'defer', 'accept', 'value' or 'reject'");
+}
+
+NAN_METHOD(Adapter::GattsSetAuthorizePolicy)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t handle;
+    v8::Local<v8::Object> policy;
+    auto argumentcount = 0;
+
+    try
+    {
+        handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        policy = ConversionUtility::getJsObject(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    authorize_action_t read;
+    authorize_action_t write;
+    uint16_t rejectStatus;
+    bool hasValue = false;
+    std::vector<uint8_t> value;
+
+    try
+    {
+        read = ToAuthorizeAction(ConversionUtility::getNativeString(policy, "read"));
+        write = ToAuthorizeAction(ConversionUtility::getNativeString(policy, "write"));
+        rejectStatus = ConversionUtility::getNativeUint16(policy, "rejectStatus");
+
+        auto jsValue = Utility::Get(policy, "value");
+
+        if (!jsValue->IsUndefined() && !jsValue->IsNull())
+        {
+            value = ConversionUtility::getNativeByteVector(jsValue);
+            hasValue = true;
+        }
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getStructErrorMessage("authorize policy", error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    obj->authorizePolicy.set(handle, read, write, rejectStatus);
+
+    if (hasValue)
+    {
+        obj->authorizePolicy.setValue(handle, value);
+    }
+}
+
+NAN_METHOD(Adapter::GattsClearAuthorizePolicy)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t handle;
+
+    try
+    {
+        handle = ConversionUtility::getNativeUint16(info[0]);
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    info.GetReturnValue().Set(obj->authorizePolicy.remove(handle));
+}
+
+NAN_METHOD(Adapter::GattsSetAuthorizeValue)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t handle;
+    std::vector<uint8_t> value;
+    auto argumentcount = 0;
+
+    try
+    {
+        handle = ConversionUtility::getNativeUint16(info[argumentcount]);
+        argumentcount++;
+
+        value = ConversionUtility::getNativeByteVector(info[argumentcount]);
+        argumentcount++;
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(argumentcount, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    info.GetReturnValue().Set(obj->authorizePolicy.setValue(handle, value));
+}
+
+NAN_METHOD(Adapter::GattsGetAuthorizeValue)
+{
+    auto obj = Nan::ObjectWrap::Unwrap<Adapter>(info.Holder());
+    uint16_t handle;
+    std::vector<uint8_t> value;
+
+    try
+    {
+        handle = ConversionUtility::getNativeUint16(info[0]);
+    }
+    catch (std::string error)
+    {
+        v8::Local<v8::String> message = ErrorMessage::getTypeErrorMessage(0, error);
+        Nan::ThrowTypeError(message);
+        return;
+    }
+
+    if (!obj->authorizePolicy.getValue(handle, value))
+    {
+        return;
+    }
+
+    info.GetReturnValue().Set(ConversionUtility::toJsValueArray(value.data(), static_cast<uint16_t>(value.size())));
+}
+
+#pragma endregion AuthorizePolicy
+
 extern "C" {
     void init_gatts(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target)
     {
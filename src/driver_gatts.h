@@ -39,6 +39,12 @@
 
 #include "common.h"
 #include "ble_gatts.h"
+#include "notification_fanout.h"
+
+#include <string>
+#include <vector>
+
+class Adapter;
 
 static name_map_t gatts_event_name_map =
 {
@@ -268,6 +274,7 @@ public:
     ble_gatts_char_md_t *p_char_md;
     ble_gatts_attr_t *p_attr_char_value;
     ble_gatts_char_handles_t *p_handles;
+    Adapter *mainObject;
 };
 
 struct GattsAddDescriptorBaton : public Baton
@@ -284,6 +291,86 @@ public:
     uint16_t p_handle;
 };
 
+struct GattsTableDescriptor
+{
+    std::vector<uint8_t> uuid_le;
+    ble_uuid_t uuid;
+    ble_gatts_attr_t *p_attr;
+    uint16_t handle;
+};
+
+struct GattsTableCharacteristic
+{
+    std::vector<uint8_t> uuid_le;
+    ble_uuid_t uuid;
+    ble_gatts_char_md_t *p_char_md;
+    ble_gatts_attr_t *p_attr_char_value;
+    ble_gatts_char_handles_t handles;
+    std::vector<GattsTableDescriptor> descriptors;
+};
+
+struct GattsTableService
+{
+    uint8_t type;
+    std::vector<uint8_t> uuid_le;
+    ble_uuid_t uuid;
+    uint16_t handle;
+    std::vector<GattsTableCharacteristic> characteristics;
+};
+
+struct GattsBuildTableBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattsBuildTableBaton);
+    BATON_DESTRUCTOR(GattsBuildTableBaton)
+    {
+        for (auto &service : services)
+        {
+            for (auto &characteristic : service.characteristics)
+            {
+                for (auto &descriptor : characteristic.descriptors)
+                {
+                    freeTableAttribute(descriptor.p_attr);
+                }
+
+                freeTableCharacteristicMetadata(characteristic.p_char_md);
+                freeTableAttribute(characteristic.p_attr_char_value);
+            }
+        }
+    }
+
+    static void freeTableAttribute(ble_gatts_attr_t *attribute)
+    {
+        if (attribute == nullptr)
+        {
+            return;
+        }
+
+        free((char*)(attribute->p_value));
+        delete attribute->p_attr_md;
+        delete attribute;
+    }
+
+    static void freeTableCharacteristicMetadata(ble_gatts_char_md_t *metadata)
+    {
+        if (metadata == nullptr)
+        {
+            return;
+        }
+
+        delete metadata->p_char_pf;
+        delete metadata->p_user_desc_md;
+        delete metadata->p_cccd_md;
+        delete metadata->p_sccd_md;
+        delete metadata;
+    }
+
+    std::vector<GattsTableService> services;
+    std::string failed_element;
+    uint8_t vs_uuid_count;
+    Adapter *mainObject;
+};
+
 struct GattsHVXBaton : public Baton
 {
 public:
@@ -296,6 +383,17 @@ public:
     }
     uint16_t conn_handle;
     ble_gatts_hvx_params_t *p_hvx_params;
+    Adapter *mainObject;
+};
+
+struct GattsNotifyAllBaton : public Baton
+{
+public:
+    BATON_CONSTRUCTOR(GattsNotifyAllBaton);
+    uint16_t value_handle;
+    std::vector<uint8_t> data;
+    notify_all_result_t notify_result;
+    Adapter *mainObject;
 };
 
 struct GattsSystemAttributeSetBaton : public Baton
@@ -353,6 +451,7 @@ public:
     BATON_CONSTRUCTOR(GattsExchangeMtuReplyBaton);
     uint16_t conn_handle;
     uint16_t server_rx_mtu;
+    Adapter *mainObject;
 };
 #endif
 
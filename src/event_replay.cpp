@@ -0,0 +1,236 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "event_replay.h"
+#include "event_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+EventReplay::EventReplay() :
+    running(false),
+    stopping(false),
+    file(nullptr),
+    formatVersion(0),
+    speed(1.0),
+    adapterId(EVENT_REPLAY_ALL_ADAPTERS),
+    eventCount(0),
+    errorCount(0)
+{
+}
+
+EventReplay::~EventReplay()
+{
+    stop();
+}
+
+void EventReplay::start(const std::string &path, const uint8_t apiVersion, const double speed, const int32_t adapterId,
+                        event_handler_t onEvent, completion_handler_t onCompletion)
+{
+    stop();
+
+    auto traceFile = fopen(path.c_str(), "rb");
+
+    if (traceFile == nullptr)
+    {
+        std::stringstream error;
+        error << "Not able to open event trace file " << path << ".";
+        throw error.str();
+    }
+
+    uint8_t header[EVENT_TRACE_HEADER_SIZE];
+
+    if (fread(header, 1, sizeof(header), traceFile) != sizeof(header)
+        || memcmp(header, EVENT_TRACE_MAGIC, sizeof(EVENT_TRACE_MAGIC)) != 0
+        || header[8] == 0 || header[8] > EVENT_TRACE_FORMAT_VERSION)
+    {
+        fclose(traceFile);
+
+        std::stringstream error;
+        error << "File " << path << " is not a supported event trace.";
+        throw error.str();
+    }
+
+    if (header[9] != apiVersion)
+    {
+        fclose(traceFile);
+
+        std::stringstream error;
+        error << "Event trace " << path << " is from SoftDevice API version " << static_cast<int>(header[9])
+              << ", expected version " << static_cast<int>(apiVersion) << ".";
+        throw error.str();
+    }
+
+    file = traceFile;
+    formatVersion = header[8];
+    this->speed = speed;
+    this->adapterId = adapterId;
+    this->onEvent = onEvent;
+    this->onCompletion = onCompletion;
+
+    eventCount = 0;
+    errorCount = 0;
+    stopping = false;
+    running = true;
+
+    thread = std::thread(&EventReplay::run, this);
+}
+
+void EventReplay::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_all();
+
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+bool EventReplay::isRunning() const
+{
+    return running;
+}
+
+uint32_t EventReplay::getEventCount() const
+{
+    return eventCount;
+}
+
+uint32_t EventReplay::getErrorCount() const
+{
+    return errorCount;
+}
+
+// Returns false at the end of the trace, a truncated record is counted as an error
+bool EventReplay::readRecord(uint64_t &timestamp, uint16_t &recordAdapterId, void *event)
+{
+    uint16_t length;
+
+    recordAdapterId = 0;
+
+    if (fread(&timestamp, sizeof(timestamp), 1, file) != 1)
+    {
+        return false;
+    }
+
+    if ((formatVersion >= 2 && fread(&recordAdapterId, sizeof(recordAdapterId), 1, file) != 1)
+        || fread(&length, sizeof(length), 1, file) != 1)
+    {
+        errorCount += 1;
+        return false;
+    }
+
+    // The event is zero padded, the SoftDevice event structures are larger than the encoded events
+    memset(event, 0, EVENT_REPLAY_EVENT_SIZE);
+    auto readLength = std::min<size_t>(length, EVENT_REPLAY_EVENT_SIZE);
+
+    if (fread(event, 1, readLength, file) != readLength
+        || (length > readLength && fseek(file, static_cast<long>(length - readLength), SEEK_CUR) != 0))
+    {
+        errorCount += 1;
+        return false;
+    }
+
+    return true;
+}
+
+void EventReplay::run()
+{
+    // uint64_t storage keeps the event aligned
+    std::vector<uint64_t> storage(EVENT_REPLAY_EVENT_SIZE / sizeof(uint64_t));
+    auto event = static_cast<void *>(storage.data());
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t firstTimestamp = 0;
+    bool first = true;
+
+    uint64_t timestamp;
+    uint16_t recordAdapterId;
+
+    while (readRecord(timestamp, recordAdapterId, event))
+    {
+        if (adapterId != EVENT_REPLAY_ALL_ADAPTERS && recordAdapterId != adapterId)
+        {
+            continue;
+        }
+
+        if (first)
+        {
+            firstTimestamp = timestamp;
+            first = false;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (speed > 0 && timestamp > firstTimestamp)
+        {
+            // Scheduled from the start so that the replay does not drift, a late thread catches up
+            auto offset = std::chrono::duration<double, std::micro>((timestamp - firstTimestamp) / speed);
+            auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+            condition.wait_until(lock, due, [this] { return stopping; });
+        }
+
+        if (stopping)
+        {
+            break;
+        }
+
+        lock.unlock();
+
+        if (onEvent(event))
+        {
+            eventCount += 1;
+        }
+        else
+        {
+            errorCount += 1;
+        }
+    }
+
+    fclose(file);
+    file = nullptr;
+
+    running = false;
+    onCompletion();
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENT_REPLAY_H
+#define EVENT_REPLAY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Size of the buffer each replayed event is read into, Adapter::appendEvent copies this many bytes
+const size_t EVENT_REPLAY_EVENT_SIZE = 512;
+
+// Replay events from all adapters in the trace
+const int32_t EVENT_REPLAY_ALL_ADAPTERS = -1;
+
+// Reads an event trace written by EventTrace and feeds the events back in a dedicated thread,
+// with the original timing between the events scaled by a speed factor.
+//
+// The adapter event queue has a single producer. While a replay runs, the replay thread must be
+// the only thread appending events, any other event source has to be paused.
+class EventReplay
+{
+public:
+    // Returns false if the event can not be replayed, it is then counted as an error
+    typedef std::function<bool(void *event)> event_handler_t;
+    typedef std::function<void()> completion_handler_t;
+
+    EventReplay();
+    ~EventReplay();
+
+    // speed 1.0 replays in real time, 0 replays as fast as possible. adapterId selects the adapter
+    // to replay events from, or EVENT_REPLAY_ALL_ADAPTERS. Both handlers are called from the replay
+    // thread, onCompletion when the end of the trace is reached or the replay is stopped.
+    // Throws std::string if the trace file can not be read or is from another SoftDevice API version.
+    void start(const std::string &path, const uint8_t apiVersion, const double speed, const int32_t adapterId,
+               event_handler_t onEvent, completion_handler_t onCompletion);
+    void stop();
+
+    bool isRunning() const;
+
+    uint32_t getEventCount() const;
+    uint32_t getErrorCount() const;
+
+private:
+    void run();
+    bool readRecord(uint64_t &timestamp, uint16_t &adapterId, void *event);
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    std::atomic<bool> running;
+    bool stopping;
+
+    FILE *file;
+    uint8_t formatVersion;
+    double speed;
+    int32_t adapterId;
+    event_handler_t onEvent;
+    completion_handler_t onCompletion;
+
+    std::atomic<uint32_t> eventCount;
+    std::atomic<uint32_t> errorCount;
+};
+
+#endif // EVENT_REPLAY_H
@@ -0,0 +1,134 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "event_stats.h"
+
+EventStats::EventStats() :
+    eventCount(0),
+    droppedCount(0),
+    lastBatchSize(0),
+    batchCount(0),
+    callbackTotalTime(0)
+{
+    for (auto &count : eventTypeCounts)
+    {
+        count = 0;
+    }
+}
+
+void EventStats::onEventReceived(const uint16_t evtId)
+{
+    if (evtId < EVENT_ID_COUNT)
+    {
+        eventTypeCounts[evtId] += 1;
+    }
+}
+
+void EventStats::onEventQueued()
+{
+    eventCount += 1;
+}
+
+void EventStats::onEventDropped()
+{
+    droppedCount += 1;
+}
+
+void EventStats::onBatchDelivered(const uint32_t size, const clock::duration duration)
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    auto time = ns < 0 ? static_cast<uint64_t>(0) : static_cast<uint64_t>(ns);
+
+    lastBatchSize = size;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    batchCount += 1;
+    callbackTotalTime += time;
+    callbackTime.record(time);
+    batchSize.record(size);
+}
+
+void EventStats::reset()
+{
+    for (auto &count : eventTypeCounts)
+    {
+        count = 0;
+    }
+
+    eventCount = 0;
+    droppedCount = 0;
+    lastBatchSize = 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    batchCount = 0;
+    callbackTotalTime = 0;
+    callbackTime.reset();
+    batchSize.reset();
+}
+
+uint64_t EventStats::getEventCount() const
+{
+    return eventCount;
+}
+
+uint32_t EventStats::getDroppedCount() const
+{
+    return droppedCount;
+}
+
+uint32_t EventStats::getEventTypeCount(const uint16_t evtId) const
+{
+    return evtId < EVENT_ID_COUNT ? eventTypeCounts[evtId].load() : 0;
+}
+
+uint32_t EventStats::getLastBatchSize() const
+{
+    return lastBatchSize;
+}
+
+event_stats_snapshot_t EventStats::getSnapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    event_stats_snapshot_t snapshot;
+
+    snapshot.event_count = eventCount;
+    snapshot.batch_count = batchCount;
+    snapshot.callback_total_time = callbackTotalTime;
+    snapshot.callback_time = callbackTime;
+    snapshot.batch_size = batchSize;
+
+    return snapshot;
+}
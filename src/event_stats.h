@@ -0,0 +1,95 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENT_STATS_H
+#define EVENT_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "method_stats.h"
+
+typedef struct {
+    uint64_t event_count;           // events queued for JavaScript
+    uint64_t batch_count;           // calls to the JavaScript event callback
+    uint64_t callback_total_time;   // nanoseconds
+    LatencyHistogram callback_time; // nanoseconds per JavaScript event callback
+    LatencyHistogram batch_size;    // events per JavaScript event callback
+} event_stats_snapshot_t;
+
+// Statistics for the events sent from the SoftDevice to JavaScript. Counters are updated from the
+// thread the SoftDevice driver has initiated, batches from the Main Thread. All of it can be read
+// from any thread.
+class EventStats
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    // Event IDs from all SoftDevice modules fit in a byte
+    static const size_t EVENT_ID_COUNT = 256;
+
+    EventStats();
+
+    void onEventReceived(const uint16_t evtId);
+    void onEventQueued();
+    void onEventDropped();
+    void onBatchDelivered(const uint32_t batchSize, const clock::duration callbackTime);
+    void reset();
+
+    uint64_t getEventCount() const;
+    uint32_t getDroppedCount() const;
+    uint32_t getEventTypeCount(const uint16_t evtId) const;
+    uint32_t getLastBatchSize() const;
+
+    event_stats_snapshot_t getSnapshot();
+
+private:
+    std::array<std::atomic<uint32_t>, EVENT_ID_COUNT> eventTypeCounts;
+    std::atomic<uint64_t> eventCount;
+    std::atomic<uint32_t> droppedCount;
+    std::atomic<uint32_t> lastBatchSize;
+
+    std::mutex mutex;
+    uint64_t batchCount;
+    uint64_t callbackTotalTime;
+    LatencyHistogram callbackTime;
+    LatencyHistogram batchSize;
+};
+
+#endif // EVENT_STATS_H
@@ -0,0 +1,210 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "event_trace.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+EventTrace::EventTrace() :
+    enabled(false),
+    file(nullptr),
+    maxFileSize(0),
+    maxFiles(0),
+    apiVersion(0),
+    fileSize(0),
+    recordCount(0),
+    errorCount(0)
+{
+}
+
+EventTrace::~EventTrace()
+{
+    stop();
+}
+
+void EventTrace::start(const std::string &path, const uint32_t maxFileSize, const uint32_t maxFiles, const uint8_t apiVersion)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (file != nullptr)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+
+    this->path = path;
+    this->maxFileSize = maxFileSize;
+    this->maxFiles = maxFiles;
+    this->apiVersion = apiVersion;
+
+    recordCount = 0;
+    errorCount = 0;
+
+    if (!openFile())
+    {
+        std::stringstream error;
+        error << "Not able to open event trace file " << path << ".";
+        throw error.str();
+    }
+
+    enabled = true;
+}
+
+void EventTrace::stop()
+{
+    enabled = false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (file != nullptr)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+bool EventTrace::isEnabled() const
+{
+    return enabled;
+}
+
+void EventTrace::write(const uint64_t timestamp, const uint16_t adapterId, const void *event, const uint16_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    const auto recordSize = sizeof(timestamp) + sizeof(adapterId) + sizeof(length) + length;
+
+    if (maxFileSize != 0 && fileSize + recordSize > maxFileSize && fileSize > EVENT_TRACE_HEADER_SIZE)
+    {
+        rotate();
+
+        if (file == nullptr)
+        {
+            errorCount += 1;
+            return;
+        }
+    }
+
+    if (fwrite(&timestamp, sizeof(timestamp), 1, file) != 1
+        || fwrite(&adapterId, sizeof(adapterId), 1, file) != 1
+        || fwrite(&length, sizeof(length), 1, file) != 1
+        || fwrite(event, 1, length, file) != length)
+    {
+        errorCount += 1;
+        return;
+    }
+
+    fileSize += recordSize;
+    recordCount += 1;
+}
+
+uint32_t EventTrace::getRecordCount() const
+{
+    return recordCount;
+}
+
+uint32_t EventTrace::getErrorCount() const
+{
+    return errorCount;
+}
+
+// Must be called with mutex held
+bool EventTrace::openFile()
+{
+    file = fopen(path.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    uint8_t header[EVENT_TRACE_HEADER_SIZE] = { 0 };
+    memcpy(header, EVENT_TRACE_MAGIC, sizeof(EVENT_TRACE_MAGIC));
+    header[8] = EVENT_TRACE_FORMAT_VERSION;
+    header[9] = apiVersion;
+
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header))
+    {
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    fileSize = sizeof(header);
+    return true;
+}
+
+// Must be called with mutex held
+void EventTrace::rotate()
+{
+    fclose(file);
+    file = nullptr;
+
+    if (maxFiles == 0)
+    {
+        // No history kept, start over in the same file
+        openFile();
+        return;
+    }
+
+    auto rotatedPath = [this](uint32_t index) {
+        std::stringstream name;
+        name << path << "." << index;
+        return name.str();
+    };
+
+    std::remove(rotatedPath(maxFiles).c_str());
+
+    for (auto index = maxFiles; index > 1; index--)
+    {
+        std::rename(rotatedPath(index - 1).c_str(), rotatedPath(index).c_str());
+    }
+
+    std::rename(path.c_str(), rotatedPath(1).c_str());
+
+    if (!openFile())
+    {
+        std::cerr << "Not able to open event trace file " << path << ", tracing stopped." << std::endl;
+        enabled = false;
+    }
+}
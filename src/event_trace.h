@@ -0,0 +1,97 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+// Compact binary trace of the events received from the SoftDevice.
+//
+// File layout, integers in host byte order:
+//   header: "PCBLEEVT" (8 bytes), format version (uint8), SoftDevice API version (uint8), reserved (uint16)
+//   record: timestamp in microseconds since epoch (uint64), adapter ID (uint16), event length (uint16),
+//           ble_evt_t (length bytes). Format version 1 records have no adapter ID.
+//           Since format version 3, data an event points to is stored after the ble_evt_t and the pointer
+//           is null, see Adapter::traceEvent. Older records of such events are not replayed.
+//
+// When a file reaches maxFileSize it is renamed to <path>.1, older files are shifted
+// up to <path>.<maxFiles> and a new file is started at <path>.
+const char EVENT_TRACE_MAGIC[8] = { 'P', 'C', 'B', 'L', 'E', 'E', 'V', 'T' };
+const uint8_t EVENT_TRACE_FORMAT_VERSION = 3;
+const size_t EVENT_TRACE_HEADER_SIZE = 12;
+
+class EventTrace
+{
+public:
+    EventTrace();
+    ~EventTrace();
+
+    // Throws std::string if the trace file can not be opened
+    void start(const std::string &path, const uint32_t maxFileSize, const uint32_t maxFiles, const uint8_t apiVersion);
+    void stop();
+
+    bool isEnabled() const;
+
+    // Called from the thread receiving events from the SoftDevice
+    void write(const uint64_t timestamp, const uint16_t adapterId, const void *event, const uint16_t length);
+
+    uint32_t getRecordCount() const;
+    uint32_t getErrorCount() const;
+
+private:
+    bool openFile();
+    void rotate();
+
+    std::mutex mutex;
+    std::atomic<bool> enabled;
+
+    FILE *file;
+    std::string path;
+    uint32_t maxFileSize;
+    uint32_t maxFiles;
+    uint8_t apiVersion;
+    size_t fileSize;
+
+    std::atomic<uint32_t> recordCount;
+    std::atomic<uint32_t> errorCount;
+};
+
+#endif // EVENT_TRACE_H
@@ -0,0 +1,237 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "lesc_dhkey_worker.h"
+#include "uECC/uECC.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+
+namespace {
+    void reverse(uint8_t *dst, const uint8_t *src, const size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            dst[i] = src[length - 1 - i];
+        }
+    }
+
+    // Uses local buffers so that it can run concurrently with the ecc* functions exposed to JavaScript
+    bool computeSharedSecret(const uint8_t *le_sk, const uint8_t *le_pk, uint8_t *le_ss)
+    {
+        uint8_t be_sk[LESC_DHKEY_SK_LEN];
+        uint8_t be_pk[LESC_DHKEY_PK_LEN];
+        uint8_t be_ss[LESC_DHKEY_LEN];
+
+        auto curve = uECC_secp256r1();
+
+        reverse(be_sk, le_sk, LESC_DHKEY_SK_LEN);
+        reverse(&be_pk[0], &le_pk[0], LESC_DHKEY_PK_LEN / 2);
+        reverse(&be_pk[LESC_DHKEY_PK_LEN / 2], &le_pk[LESC_DHKEY_PK_LEN / 2], LESC_DHKEY_PK_LEN / 2);
+
+        if (!uECC_valid_public_key(be_pk, curve) || !uECC_shared_secret(be_pk, be_sk, be_ss, curve))
+        {
+            return false;
+        }
+
+        reverse(le_ss, be_ss, LESC_DHKEY_LEN);
+        return true;
+    }
+}
+
+LescDhKeyWorker::LescDhKeyWorker() :
+    enabled(false),
+    stopping(false),
+    replyCount(0),
+    errorCount(0),
+    maxComputeTime(0)
+{
+    memset(privateKey, 0, sizeof(privateKey));
+}
+
+LescDhKeyWorker::~LescDhKeyWorker()
+{
+    stop();
+}
+
+void LescDhKeyWorker::start(const uint8_t *privateKey, reply_handler_t reply, completion_handler_t onCompletion)
+{
+    stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    memcpy(this->privateKey, privateKey, LESC_DHKEY_SK_LEN);
+    this->reply = reply;
+    this->onCompletion = onCompletion;
+    stopping = false;
+
+    thread = std::thread(&LescDhKeyWorker::run, this);
+    enabled = true;
+}
+
+void LescDhKeyWorker::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!thread.joinable())
+        {
+            return;
+        }
+
+        enabled = false;
+        stopping = true;
+    }
+
+    condition.notify_one();
+    thread.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.clear();
+    memset(privateKey, 0, sizeof(privateKey));
+}
+
+bool LescDhKeyWorker::isEnabled() const
+{
+    return enabled;
+}
+
+bool LescDhKeyWorker::submit(const uint16_t connHandle, const uint8_t *peerPublicKey)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!enabled)
+        {
+            return false;
+        }
+
+        request_t request;
+        request.conn_handle = connHandle;
+        memcpy(request.pk_peer, peerPublicKey, LESC_DHKEY_PK_LEN);
+        requests.push_back(request);
+    }
+
+    condition.notify_one();
+    return true;
+}
+
+void LescDhKeyWorker::takeCompletions(std::vector<lesc_dhkey_completion_t> &completions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    completions.swap(this->completions);
+    this->completions.clear();
+}
+
+uint32_t LescDhKeyWorker::getReplyCount() const
+{
+    return replyCount;
+}
+
+uint32_t LescDhKeyWorker::getErrorCount() const
+{
+    return errorCount;
+}
+
+uint32_t LescDhKeyWorker::getMaxComputeTime() const
+{
+    return maxComputeTime;
+}
+
+void LescDhKeyWorker::run()
+{
+    std::random_device random;
+
+    while (true)
+    {
+        request_t request;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopping || !requests.empty(); });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            request = requests.front();
+            requests.pop_front();
+        }
+
+        lesc_dhkey_completion_t completion;
+        completion.conn_handle = request.conn_handle;
+
+        uint8_t dhkey[LESC_DHKEY_LEN];
+        auto start = std::chrono::steady_clock::now();
+        completion.peer_key_valid = computeSharedSecret(privateKey, request.pk_peer, dhkey);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        if (!completion.peer_key_valid)
+        {
+            // The SoftDevice still expects a reply, a random key makes the DHKey check fail as required
+            for (auto &byte : dhkey)
+            {
+                byte = static_cast<uint8_t>(random());
+            }
+        }
+
+        auto computeTime = static_cast<uint32_t>(elapsed.count());
+
+        if (computeTime > maxComputeTime)
+        {
+            maxComputeTime = computeTime;
+        }
+
+        completion.result = reply(request.conn_handle, dhkey);
+
+        if (completion.result == 0 && completion.peer_key_valid)
+        {
+            replyCount += 1;
+        }
+        else
+        {
+            errorCount += 1;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            completions.push_back(completion);
+        }
+
+        onCompletion();
+    }
+}
@@ -0,0 +1,113 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LESC_DHKEY_WORKER_H
+#define LESC_DHKEY_WORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const size_t LESC_DHKEY_SK_LEN = 32;
+const size_t LESC_DHKEY_PK_LEN = 64;
+const size_t LESC_DHKEY_LEN = 32;
+
+typedef struct {
+    uint16_t conn_handle;
+    uint32_t result;      // Result from sending the reply to the SoftDevice
+    bool peer_key_valid;  // False if the peer public key was not on the curve, a random key was sent instead
+} lesc_dhkey_completion_t;
+
+// Computes LE Secure Connections DH keys in a dedicated thread and sends the reply
+// to the SoftDevice without going through JavaScript. Keys are in little endian
+// byte order, as used by the SoftDevice.
+class LescDhKeyWorker
+{
+public:
+    typedef std::function<uint32_t(uint16_t connHandle, const uint8_t *dhkey)> reply_handler_t;
+    typedef std::function<void()> completion_handler_t;
+
+    LescDhKeyWorker();
+    ~LescDhKeyWorker();
+
+    // reply sends the DH key to the SoftDevice, onCompletion is called after each reply.
+    // Both are called from the worker thread. privateKey must be LESC_DHKEY_SK_LEN bytes.
+    void start(const uint8_t *privateKey, reply_handler_t reply, completion_handler_t onCompletion);
+    void stop();
+
+    bool isEnabled() const;
+
+    // Called from the thread receiving events from the SoftDevice, the key is copied
+    bool submit(const uint16_t connHandle, const uint8_t *peerPublicKey);
+
+    void takeCompletions(std::vector<lesc_dhkey_completion_t> &completions);
+
+    uint32_t getReplyCount() const;
+    uint32_t getErrorCount() const;
+    uint32_t getMaxComputeTime() const;
+
+private:
+    typedef struct {
+        uint16_t conn_handle;
+        uint8_t pk_peer[LESC_DHKEY_PK_LEN];
+    } request_t;
+
+    void run();
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    std::atomic<bool> enabled;
+    bool stopping;
+
+    uint8_t privateKey[LESC_DHKEY_SK_LEN];
+    reply_handler_t reply;
+    completion_handler_t onCompletion;
+
+    std::deque<request_t> requests;
+    std::vector<lesc_dhkey_completion_t> completions;
+
+    std::atomic<uint32_t> replyCount;
+    std::atomic<uint32_t> errorCount;
+    std::atomic<uint32_t> maxComputeTime; // microseconds
+};
+
+#endif // LESC_DHKEY_WORKER_H
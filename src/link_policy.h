@@ -0,0 +1,82 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINK_POLICY_H
+#define LINK_POLICY_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+typedef struct {
+    uint16_t att_mtu;         // ATT MTU to request on connect and to reply with, 0 leaves it to JavaScript
+    uint16_t max_tx_octets;   // Data length to request on connect and to reply with, 0 leaves it to JavaScript
+    uint16_t max_rx_octets;
+    uint8_t tx_phys;          // Preferred PHYs as BLE_GAP_PHY_* bits, 0 leaves the PHY to JavaScript
+    uint8_t rx_phys;
+    bool conn_evt_ext;        // Extend connection events while there is data to send
+} link_policy_params_t;
+
+// Link throughput settings applied to each new connection, and used to answer the ATT MTU,
+// data length and PHY requests from peers, in the thread receiving events from the SoftDevice.
+// All methods are thread safe.
+class LinkPolicy
+{
+public:
+    LinkPolicy();
+
+    void set(const link_policy_params_t &params);
+    void clear();
+    link_policy_params_t get();
+
+    // result is the SoftDevice error code of a request sent on connect, or of a reply to a peer
+    void onRequested(const uint32_t result);
+    void onReplied(const uint32_t result);
+
+    uint32_t getRequestCount() const;
+    uint32_t getReplyCount() const;
+    uint32_t getErrorCount() const;
+
+private:
+    std::mutex mutex;
+    link_policy_params_t params;
+
+    std::atomic<uint32_t> requestCount;
+    std::atomic<uint32_t> replyCount;
+    std::atomic<uint32_t> errorCount;
+};
+
+#endif // LINK_POLICY_H
@@ -0,0 +1,373 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "link_stats.h"
+
+#include <algorithm>
+
+namespace {
+    // Link defaults from the Bluetooth Core specification, until the peers negotiate otherwise
+    const uint16_t DEFAULT_ATT_MTU = 23;
+    const uint16_t DEFAULT_MAX_OCTETS = 27;
+    const uint8_t DEFAULT_PHY = 1; // 1 Mbps
+
+    uint32_t toMicroseconds(const LinkStats::clock::duration duration)
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return us < 0 ? 0 : static_cast<uint32_t>(us);
+    }
+
+    size_t latencyBucket(const uint32_t us)
+    {
+        size_t bucket = 0;
+
+        while ((us >> bucket) > 1 && bucket < LINK_STATS_LATENCY_BUCKETS - 1)
+        {
+            bucket++;
+        }
+
+        return bucket;
+    }
+}
+
+void LinkStats::onConnected(const uint16_t connHandle, const uint16_t interval, const uint16_t latency, const uint16_t timeout)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    link_t link = {};
+    link.connected = clock::now();
+    link.stats.conn_handle = connHandle;
+    link.stats.conn_interval = interval;
+    link.stats.slave_latency = latency;
+    link.stats.conn_sup_timeout = timeout;
+    link.stats.att_mtu = DEFAULT_ATT_MTU;
+    link.stats.max_tx_octets = DEFAULT_MAX_OCTETS;
+    link.stats.max_rx_octets = DEFAULT_MAX_OCTETS;
+    link.stats.tx_phy = DEFAULT_PHY;
+    link.stats.rx_phy = DEFAULT_PHY;
+
+    links[connHandle] = link;
+}
+
+void LinkStats::onDisconnected(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    links.erase(connHandle);
+}
+
+void LinkStats::onConnParams(const uint16_t connHandle, const uint16_t interval, const uint16_t latency, const uint16_t timeout)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link == nullptr)
+    {
+        return;
+    }
+
+    link->stats.conn_interval = interval;
+    link->stats.slave_latency = latency;
+    link->stats.conn_sup_timeout = timeout;
+}
+
+void LinkStats::onRx(const uint16_t connHandle, const link_stats_packet_t type, const uint16_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link == nullptr)
+    {
+        return;
+    }
+
+    link->stats.rx_packet_count += 1;
+    link->stats.rx_byte_count += length;
+
+    if (type == LINK_STATS_PACKET_HVX)
+    {
+        link->stats.hvx_rx_count += 1;
+    }
+    else if (type == LINK_STATS_PACKET_WRITE)
+    {
+        link->stats.write_rx_count += 1;
+    }
+}
+
+void LinkStats::onTx(const uint16_t connHandle, const link_stats_packet_t type, const uint16_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link == nullptr)
+    {
+        return;
+    }
+
+    link->stats.tx_packet_count += 1;
+    link->stats.tx_byte_count += length;
+
+    if (type == LINK_STATS_PACKET_HVX)
+    {
+        link->stats.hvx_tx_count += 1;
+    }
+    else if (type == LINK_STATS_PACKET_WRITE)
+    {
+        link->stats.write_tx_count += 1;
+    }
+}
+
+void LinkStats::onTxStall(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link != nullptr)
+    {
+        link->stats.tx_stall_count += 1;
+    }
+}
+
+void LinkStats::onRequest(const uint16_t connHandle, const link_stats_packet_t type)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link == nullptr)
+    {
+        return;
+    }
+
+    if (type == LINK_STATS_PACKET_READ)
+    {
+        link->read_request = clock::now();
+        link->read_pending = true;
+    }
+    else if (type == LINK_STATS_PACKET_WRITE)
+    {
+        link->write_request = clock::now();
+        link->write_pending = true;
+    }
+}
+
+void LinkStats::onResponse(const uint16_t connHandle, const link_stats_packet_t type)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link == nullptr)
+    {
+        return;
+    }
+
+    bool *pending;
+    clock::time_point *request;
+    rtt_t *rtt;
+
+    if (type == LINK_STATS_PACKET_READ)
+    {
+        pending = &link->read_pending;
+        request = &link->read_request;
+        rtt = &link->read_rtt;
+    }
+    else if (type == LINK_STATS_PACKET_WRITE)
+    {
+        pending = &link->write_pending;
+        request = &link->write_request;
+        rtt = &link->write_rtt;
+    }
+    else
+    {
+        return;
+    }
+
+    // The response may arrive before the worker thread has recorded the request
+    if (!*pending)
+    {
+        return;
+    }
+
+    auto us = toMicroseconds(clock::now() - *request);
+    *pending = false;
+
+    rtt->count += 1;
+    rtt->sum += us;
+
+    if (us > rtt->max)
+    {
+        rtt->max = us;
+    }
+}
+
+void LinkStats::onEventDelivered(const uint16_t connHandle, const clock::time_point received, const clock::time_point delivered)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link == nullptr)
+    {
+        return;
+    }
+
+    auto us = toMicroseconds(delivered - received);
+
+    link->stats.event_count += 1;
+    link->event_latency_sum += us;
+    link->event_latency_histogram[latencyBucket(us)] += 1;
+}
+
+void LinkStats::setLocalAttMtu(const uint16_t connHandle, const uint16_t attMtu)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link != nullptr)
+    {
+        link->local_att_mtu = attMtu;
+        updateAttMtu(link);
+    }
+}
+
+void LinkStats::setPeerAttMtu(const uint16_t connHandle, const uint16_t attMtu)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link != nullptr)
+    {
+        link->peer_att_mtu = attMtu;
+        updateAttMtu(link);
+    }
+}
+
+void LinkStats::setDataLength(const uint16_t connHandle, const uint16_t maxTxOctets, const uint16_t maxRxOctets)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link != nullptr)
+    {
+        link->stats.max_tx_octets = maxTxOctets;
+        link->stats.max_rx_octets = maxRxOctets;
+    }
+}
+
+void LinkStats::setPhy(const uint16_t connHandle, const uint8_t txPhy, const uint8_t rxPhy)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    if (link != nullptr)
+    {
+        link->stats.tx_phy = txPhy;
+        link->stats.rx_phy = rxPhy;
+    }
+}
+
+uint16_t LinkStats::getAttMtu(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto link = find(connHandle);
+
+    return link != nullptr ? link->stats.att_mtu : DEFAULT_ATT_MTU;
+}
+
+std::vector<link_stats_snapshot_t> LinkStats::getSnapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<link_stats_snapshot_t> snapshot;
+    auto now = clock::now();
+
+    for (auto &entry : links)
+    {
+        auto &link = entry.second;
+        auto stats = link.stats;
+
+        stats.connected_time = std::chrono::duration<double>(now - link.connected).count();
+
+        if (stats.connected_time > 0)
+        {
+            stats.hvx_rx_rate = stats.hvx_rx_count / stats.connected_time;
+            stats.hvx_tx_rate = stats.hvx_tx_count / stats.connected_time;
+            stats.write_rx_rate = stats.write_rx_count / stats.connected_time;
+            stats.write_tx_rate = stats.write_tx_count / stats.connected_time;
+        }
+
+        if (stats.event_count > 0)
+        {
+            stats.event_latency_avg = static_cast<double>(link.event_latency_sum) / stats.event_count;
+
+            // Smallest bucket that covers 99% of the events, reported as the bucket upper bound
+            uint64_t threshold = (static_cast<uint64_t>(stats.event_count) * 99 + 99) / 100;
+            uint64_t cumulative = 0;
+
+            for (size_t bucket = 0; bucket < LINK_STATS_LATENCY_BUCKETS; bucket++)
+            {
+                cumulative += link.event_latency_histogram[bucket];
+
+                if (cumulative >= threshold)
+                {
+                    stats.event_latency_p99 = (2u << bucket) - 1;
+                    break;
+                }
+            }
+        }
+
+        stats.read_rtt_count = link.read_rtt.count;
+        stats.read_rtt_max = link.read_rtt.max;
+        stats.read_rtt_avg = link.read_rtt.count > 0 ? static_cast<double>(link.read_rtt.sum) / link.read_rtt.count : 0;
+        stats.write_rtt_count = link.write_rtt.count;
+        stats.write_rtt_max = link.write_rtt.max;
+        stats.write_rtt_avg = link.write_rtt.count > 0 ? static_cast<double>(link.write_rtt.sum) / link.write_rtt.count : 0;
+
+        snapshot.push_back(stats);
+    }
+
+    return snapshot;
+}
+
+void LinkStats::updateAttMtu(link_t *link)
+{
+    if (link->local_att_mtu != 0 && link->peer_att_mtu != 0)
+    {
+        link->stats.att_mtu = std::min(link->local_att_mtu, link->peer_att_mtu);
+    }
+}
+
+LinkStats::link_t *LinkStats::find(const uint16_t connHandle)
+{
+    auto it = links.find(connHandle);
+    return it == links.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,160 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Number of power of two buckets in the event latency histogram, the last bucket holds everything above ~8 seconds
+const size_t LINK_STATS_LATENCY_BUCKETS = 24;
+
+enum link_stats_packet_t
+{
+    LINK_STATS_PACKET_OTHER,
+    LINK_STATS_PACKET_HVX,
+    LINK_STATS_PACKET_WRITE,
+    LINK_STATS_PACKET_READ
+};
+
+typedef struct {
+    uint16_t conn_handle;
+    double connected_time;          // seconds
+
+    uint32_t rx_packet_count;
+    uint32_t rx_byte_count;
+    uint32_t tx_packet_count;
+    uint32_t tx_byte_count;
+
+    uint32_t hvx_rx_count;
+    uint32_t hvx_tx_count;
+    uint32_t write_rx_count;
+    uint32_t write_tx_count;
+    double hvx_rx_rate;             // per second over connected_time
+    double hvx_tx_rate;
+    double write_rx_rate;
+    double write_tx_rate;
+
+    uint32_t tx_stall_count;        // SoftDevice had no TX buffers for a notification, indication or write
+
+    uint32_t event_count;           // events delivered to JavaScript
+    double event_latency_avg;       // microseconds from the SoftDevice driver thread to JavaScript
+    uint32_t event_latency_p99;     // microseconds, upper bound of the histogram bucket
+
+    uint32_t read_rtt_count;
+    double read_rtt_avg;            // microseconds from request to response
+    uint32_t read_rtt_max;
+    uint32_t write_rtt_count;
+    double write_rtt_avg;
+    uint32_t write_rtt_max;
+
+    uint16_t conn_interval;         // 1.25 ms units
+    uint16_t slave_latency;
+    uint16_t conn_sup_timeout;      // 10 ms units
+    uint16_t att_mtu;
+    uint16_t max_tx_octets;
+    uint16_t max_rx_octets;
+    uint8_t tx_phy;
+    uint8_t rx_phy;
+} link_stats_snapshot_t;
+
+// Per connection counters maintained natively in the event path. All methods
+// are thread safe, events arrive in the SoftDevice driver thread, requests in
+// the worker threads and latency is measured in the Main Thread.
+class LinkStats
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    void onConnected(const uint16_t connHandle, const uint16_t interval, const uint16_t latency, const uint16_t timeout);
+    void onDisconnected(const uint16_t connHandle);
+    void onConnParams(const uint16_t connHandle, const uint16_t interval, const uint16_t latency, const uint16_t timeout);
+
+    void onRx(const uint16_t connHandle, const link_stats_packet_t type, const uint16_t length);
+    void onTx(const uint16_t connHandle, const link_stats_packet_t type, const uint16_t length);
+    void onTxStall(const uint16_t connHandle);
+
+    // Round trip time for reads and write requests, ATT allows only one outstanding request per connection
+    void onRequest(const uint16_t connHandle, const link_stats_packet_t type);
+    void onResponse(const uint16_t connHandle, const link_stats_packet_t type);
+
+    void onEventDelivered(const uint16_t connHandle, const clock::time_point received, const clock::time_point delivered);
+
+    // The ATT MTU in effect is the smaller of the two, set when both sides of the exchange are known
+    void setLocalAttMtu(const uint16_t connHandle, const uint16_t attMtu);
+    void setPeerAttMtu(const uint16_t connHandle, const uint16_t attMtu);
+    void setDataLength(const uint16_t connHandle, const uint16_t maxTxOctets, const uint16_t maxRxOctets);
+    void setPhy(const uint16_t connHandle, const uint8_t txPhy, const uint8_t rxPhy);
+
+    // ATT MTU in effect, the default if the connection is unknown
+    uint16_t getAttMtu(const uint16_t connHandle);
+
+    std::vector<link_stats_snapshot_t> getSnapshot();
+
+private:
+    typedef struct {
+        uint32_t count;
+        uint64_t sum;
+        uint32_t max;
+    } rtt_t;
+
+    typedef struct {
+        clock::time_point connected;
+        link_stats_snapshot_t stats;
+        uint64_t event_latency_sum;
+        uint32_t event_latency_histogram[LINK_STATS_LATENCY_BUCKETS];
+        clock::time_point read_request;
+        clock::time_point write_request;
+        bool read_pending;
+        bool write_pending;
+        rtt_t read_rtt;
+        rtt_t write_rtt;
+        uint16_t local_att_mtu;
+        uint16_t peer_att_mtu;
+    } link_t;
+
+    link_t *find(const uint16_t connHandle);
+    static void updateAttMtu(link_t *link);
+
+    std::mutex mutex;
+    std::map<uint16_t, link_t> links;
+};
+
+#endif // LINK_STATS_H
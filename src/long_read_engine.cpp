@@ -0,0 +1,217 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "long_read_engine.h"
+
+#include <algorithm>
+
+LongReadEngine::LongReadEngine() :
+    completedCount(0),
+    failedCount(0),
+    requestCount(0)
+{
+}
+
+void LongReadEngine::setHandlers(read_handler_t read, completion_handler_t onCompletion)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->read = read;
+    this->onCompletion = onCompletion;
+}
+
+void LongReadEngine::removeHandlers()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    read = nullptr;
+    onCompletion = nullptr;
+    reads.clear();
+    completions.clear();
+}
+
+uint32_t LongReadEngine::start(const uint32_t id, const uint16_t connHandle, const uint16_t handle, const uint16_t attMtu)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!read)
+    {
+        return LONG_READ_ERROR_INVALID_STATE;
+    }
+
+    if (reads.find(connHandle) != reads.end())
+    {
+        return LONG_READ_ERROR_BUSY;
+    }
+
+    // The request is sent with the lock held, the response can not be processed before the read is registered
+    auto result = read(connHandle, handle, 0);
+
+    if (result != 0)
+    {
+        return result;
+    }
+
+    auto &entry = reads[connHandle];
+    entry.id = id;
+    entry.handle = handle;
+    entry.att_mtu = attMtu;
+    entry.request_count = 1;
+    entry.value.reserve(LONG_READ_MAX_LENGTH);
+
+    requestCount++;
+
+    return result;
+}
+
+bool LongReadEngine::onReadResponse(const uint16_t connHandle, const uint16_t gattStatus, const uint8_t *data, const uint16_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto entry = reads.find(connHandle);
+
+    if (entry == reads.end())
+    {
+        return false;
+    }
+
+    auto &current = entry->second;
+
+    if (gattStatus != LONG_READ_STATUS_SUCCESS)
+    {
+        // A value that is a multiple of the chunk size ends with an error for the read blob past its end
+        auto pastEnd = !current.value.empty() &&
+            (gattStatus == LONG_READ_STATUS_INVALID_OFFSET || gattStatus == LONG_READ_STATUS_ATTRIBUTE_NOT_LONG);
+
+        complete(entry, 0, pastEnd ? LONG_READ_STATUS_SUCCESS : gattStatus);
+        return true;
+    }
+
+    auto room = static_cast<uint16_t>(LONG_READ_MAX_LENGTH - current.value.size());
+    current.value.insert(current.value.end(), data, data + std::min(length, room));
+
+    // A response shorter than the largest chunk is the last one
+    if (length + 1 < current.att_mtu || current.value.size() >= LONG_READ_MAX_LENGTH)
+    {
+        complete(entry, 0, LONG_READ_STATUS_SUCCESS);
+        return true;
+    }
+
+    auto result = read(connHandle, current.handle, static_cast<uint16_t>(current.value.size()));
+
+    if (result != 0)
+    {
+        complete(entry, result, LONG_READ_STATUS_SUCCESS);
+        return true;
+    }
+
+    current.request_count++;
+    requestCount++;
+
+    return true;
+}
+
+void LongReadEngine::onDisconnected(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto entry = reads.find(connHandle);
+
+    if (entry != reads.end())
+    {
+        complete(entry, LONG_READ_ERROR_INVALID_CONN_HANDLE, LONG_READ_STATUS_SUCCESS);
+    }
+}
+
+void LongReadEngine::abortAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    while (!reads.empty())
+    {
+        complete(reads.begin(), LONG_READ_ERROR_INVALID_CONN_HANDLE, LONG_READ_STATUS_SUCCESS);
+    }
+}
+
+void LongReadEngine::takeCompletions(std::vector<long_read_completion_t> &completions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    completions.swap(this->completions);
+    this->completions.clear();
+}
+
+uint32_t LongReadEngine::getCompletedCount() const
+{
+    return completedCount;
+}
+
+uint32_t LongReadEngine::getFailedCount() const
+{
+    return failedCount;
+}
+
+uint32_t LongReadEngine::getRequestCount() const
+{
+    return requestCount;
+}
+
+void LongReadEngine::complete(std::map<uint16_t, read_t>::iterator entry, const uint32_t result, const uint16_t gattStatus)
+{
+    long_read_completion_t completion;
+    completion.id = entry->second.id;
+    completion.conn_handle = entry->first;
+    completion.handle = entry->second.handle;
+    completion.result = result;
+    completion.gatt_status = gattStatus;
+    completion.request_count = entry->second.request_count;
+    completion.value.swap(entry->second.value);
+
+    reads.erase(entry);
+
+    if (result == 0 && gattStatus == LONG_READ_STATUS_SUCCESS)
+    {
+        completedCount++;
+    }
+    else
+    {
+        failedCount++;
+    }
+
+    completions.push_back(std::move(completion));
+
+    if (onCompletion)
+    {
+        onCompletion();
+    }
+}
@@ -0,0 +1,128 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LONG_READ_ENGINE_H
+#define LONG_READ_ENGINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Largest attribute value allowed by the ATT specification
+const uint16_t LONG_READ_MAX_LENGTH = 512;
+
+// Same values as BLE_GATT_STATUS_SUCCESS, BLE_GATT_STATUS_ATTERR_INVALID_OFFSET and BLE_GATT_STATUS_ATTERR_ATTRIBUTE_NOT_LONG
+const uint16_t LONG_READ_STATUS_SUCCESS = 0x0000;
+const uint16_t LONG_READ_STATUS_INVALID_OFFSET = 0x0107;
+const uint16_t LONG_READ_STATUS_ATTRIBUTE_NOT_LONG = 0x010B;
+
+// Same values as NRF_ERROR_INVALID_STATE, NRF_ERROR_BUSY and BLE_ERROR_INVALID_CONN_HANDLE
+const uint32_t LONG_READ_ERROR_INVALID_STATE = 0x0008;
+const uint32_t LONG_READ_ERROR_BUSY = 0x0011;
+const uint32_t LONG_READ_ERROR_INVALID_CONN_HANDLE = 0x3002;
+
+typedef struct {
+    uint32_t id;
+    uint16_t conn_handle;
+    uint16_t handle;
+    uint32_t result;         // Error code from sending a read request, or LONG_READ_ERROR_INVALID_CONN_HANDLE if the link was lost
+    uint16_t gatt_status;    // GATT status of the response that ended the read
+    uint16_t request_count;
+    std::vector<uint8_t> value;
+} long_read_completion_t;
+
+// Reads attribute values longer than ATT MTU - 1 by sending read blob requests from the thread
+// receiving the read responses, without a round trip to JavaScript per chunk. The value is
+// collected in one buffer and completed once.
+//
+// ATT allows one outstanding request per connection, so there is at most one long read per link.
+// All methods are thread safe.
+class LongReadEngine
+{
+public:
+    // Sends a read (offset 0) or read blob request, returns the SoftDevice error code
+    typedef std::function<uint32_t(uint16_t connHandle, uint16_t handle, uint16_t offset)> read_handler_t;
+    typedef std::function<void()> completion_handler_t;
+
+    LongReadEngine();
+
+    // onCompletion is called with the lock held whenever a completion is available
+    void setHandlers(read_handler_t read, completion_handler_t onCompletion);
+    void removeHandlers();
+
+    // Sends the first read request, attMtu is the ATT MTU in effect on the link
+    uint32_t start(const uint32_t id, const uint16_t connHandle, const uint16_t handle, const uint16_t attMtu);
+
+    // Called from the thread receiving events from the SoftDevice, returns false if there is no long read on the link
+    bool onReadResponse(const uint16_t connHandle, const uint16_t gattStatus, const uint8_t *data, const uint16_t length);
+    void onDisconnected(const uint16_t connHandle);
+
+    // Completes all long reads as if their links were lost
+    void abortAll();
+
+    void takeCompletions(std::vector<long_read_completion_t> &completions);
+
+    uint32_t getCompletedCount() const;
+    uint32_t getFailedCount() const;
+    uint32_t getRequestCount() const;
+
+private:
+    typedef struct {
+        uint32_t id;
+        uint16_t handle;
+        uint16_t att_mtu;
+        uint16_t request_count;
+        std::vector<uint8_t> value;
+    } read_t;
+
+    void complete(std::map<uint16_t, read_t>::iterator read, const uint32_t result, const uint16_t gattStatus);
+
+    std::mutex mutex;
+    read_handler_t read;
+    completion_handler_t onCompletion;
+
+    std::map<uint16_t, read_t> reads;
+    std::vector<long_read_completion_t> completions;
+
+    std::atomic<uint32_t> completedCount;
+    std::atomic<uint32_t> failedCount;
+    std::atomic<uint32_t> requestCount;
+};
+
+#endif // LONG_READ_ENGINE_H
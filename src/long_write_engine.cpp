@@ -0,0 +1,336 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "long_write_engine.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Prepare write request header: opcode, handle and offset
+    const uint16_t PREP_WRITE_HEADER_LENGTH = 5;
+
+    // Largest attribute value allowed by the ATT specification
+    const size_t MAX_VALUE_LENGTH = 512;
+}
+
+LongWriteEngine::LongWriteEngine() :
+    completedCount(0),
+    failedCount(0),
+    verifyFailedCount(0),
+    requestCount(0)
+{
+}
+
+void LongWriteEngine::setHandlers(write_handler_t write, completion_handler_t onCompletion)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->write = write;
+    this->onCompletion = onCompletion;
+}
+
+void LongWriteEngine::removeHandlers()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    write = nullptr;
+    onCompletion = nullptr;
+    writes.clear();
+    completions.clear();
+}
+
+uint32_t LongWriteEngine::start(const uint32_t id, const uint16_t connHandle, std::vector<long_write_item_t> &items, const uint16_t attMtu)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!write)
+    {
+        return LONG_WRITE_ERROR_INVALID_STATE;
+    }
+
+    if (writes.find(connHandle) != writes.end())
+    {
+        return LONG_WRITE_ERROR_BUSY;
+    }
+
+    if (items.empty() || attMtu <= PREP_WRITE_HEADER_LENGTH)
+    {
+        return LONG_WRITE_ERROR_INVALID_PARAM;
+    }
+
+    for (auto &item : items)
+    {
+        if (item.value.size() > MAX_VALUE_LENGTH)
+        {
+            return LONG_WRITE_ERROR_INVALID_PARAM;
+        }
+    }
+
+    write_t entry;
+    entry.id = id;
+    entry.state = STATE_PREPARING;
+    entry.chunk_size = static_cast<uint16_t>(attMtu - PREP_WRITE_HEADER_LENGTH);
+    entry.items.swap(items);
+    entry.item = 0;
+    entry.offset = 0;
+    entry.length = 0;
+    entry.request_count = 0;
+    memset(&entry.failure, 0, sizeof(entry.failure));
+
+    // The request is sent with the lock held, the response can not be processed before the write is registered
+    auto &current = writes[connHandle];
+    current = std::move(entry);
+
+    auto result = sendPrepare(connHandle, current);
+
+    if (result != 0)
+    {
+        writes.erase(connHandle);
+    }
+
+    return result;
+}
+
+bool LongWriteEngine::onWriteResponse(const uint16_t connHandle, const uint16_t gattStatus, const uint16_t handle,
+                                      const uint16_t offset, const uint8_t *data, const uint16_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto entry = writes.find(connHandle);
+
+    if (entry == writes.end())
+    {
+        return false;
+    }
+
+    auto &current = entry->second;
+
+    if (current.state == STATE_CANCELLING)
+    {
+        complete(entry, current.failure);
+        return true;
+    }
+
+    if (current.state == STATE_EXECUTING)
+    {
+        long_write_completion_t completion;
+        memset(&completion, 0, sizeof(completion));
+        completion.gatt_status = gattStatus;
+        completion.error_handle = gattStatus != LONG_WRITE_STATUS_SUCCESS ? handle : 0;
+        completion.executed = gattStatus == LONG_WRITE_STATUS_SUCCESS;
+
+        complete(entry, completion);
+        return true;
+    }
+
+    auto &item = current.items[current.item];
+
+    if (gattStatus != LONG_WRITE_STATUS_SUCCESS)
+    {
+        fail(entry, 0, gattStatus, handle, false);
+        return true;
+    }
+
+    auto echoed = handle == item.handle && offset == current.offset && length == current.length &&
+        (length == 0 || memcmp(data, item.value.data() + current.offset, length) == 0);
+
+    if (!echoed)
+    {
+        fail(entry, 0, LONG_WRITE_STATUS_SUCCESS, item.handle, true);
+        return true;
+    }
+
+    current.offset = static_cast<uint16_t>(current.offset + current.length);
+
+    if (current.offset >= item.value.size())
+    {
+        current.item++;
+        current.offset = 0;
+    }
+
+    uint32_t result;
+
+    if (current.item < current.items.size())
+    {
+        result = sendPrepare(connHandle, current);
+    }
+    else
+    {
+        current.state = STATE_EXECUTING;
+        result = sendExecute(connHandle, current, LONG_WRITE_FLAG_WRITE);
+    }
+
+    if (result != 0)
+    {
+        fail(entry, result, LONG_WRITE_STATUS_SUCCESS, 0, false);
+    }
+
+    return true;
+}
+
+void LongWriteEngine::onDisconnected(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto entry = writes.find(connHandle);
+
+    if (entry != writes.end())
+    {
+        long_write_completion_t completion;
+        memset(&completion, 0, sizeof(completion));
+        completion.result = LONG_WRITE_ERROR_INVALID_CONN_HANDLE;
+
+        complete(entry, completion);
+    }
+}
+
+void LongWriteEngine::abortAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    long_write_completion_t completion;
+    memset(&completion, 0, sizeof(completion));
+    completion.result = LONG_WRITE_ERROR_INVALID_CONN_HANDLE;
+
+    while (!writes.empty())
+    {
+        complete(writes.begin(), completion);
+    }
+}
+
+void LongWriteEngine::takeCompletions(std::vector<long_write_completion_t> &completions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    completions.swap(this->completions);
+    this->completions.clear();
+}
+
+uint32_t LongWriteEngine::getCompletedCount() const
+{
+    return completedCount;
+}
+
+uint32_t LongWriteEngine::getFailedCount() const
+{
+    return failedCount;
+}
+
+uint32_t LongWriteEngine::getVerifyFailedCount() const
+{
+    return verifyFailedCount;
+}
+
+uint32_t LongWriteEngine::getRequestCount() const
+{
+    return requestCount;
+}
+
+uint32_t LongWriteEngine::sendPrepare(const uint16_t connHandle, write_t &current)
+{
+    auto &item = current.items[current.item];
+    current.length = static_cast<uint16_t>(std::min<size_t>(current.chunk_size, item.value.size() - current.offset));
+
+    auto result = write(connHandle, LONG_WRITE_OP_PREP_WRITE_REQ, LONG_WRITE_FLAG_WRITE, item.handle,
+                        current.offset, item.value.data() + current.offset, current.length);
+
+    if (result == 0)
+    {
+        current.request_count++;
+        requestCount++;
+    }
+
+    return result;
+}
+
+uint32_t LongWriteEngine::sendExecute(const uint16_t connHandle, write_t &current, const uint8_t flags)
+{
+    auto result = write(connHandle, LONG_WRITE_OP_EXEC_WRITE_REQ, flags, current.items[0].handle, 0, nullptr, 0);
+
+    if (result == 0)
+    {
+        current.request_count++;
+        requestCount++;
+    }
+
+    return result;
+}
+
+void LongWriteEngine::fail(write_it_t entry, const uint32_t result, const uint16_t gattStatus, const uint16_t errorHandle, const bool verifyFailed)
+{
+    auto &current = entry->second;
+
+    current.state = STATE_CANCELLING;
+    current.failure.result = result;
+    current.failure.gatt_status = gattStatus;
+    current.failure.error_handle = errorHandle;
+    current.failure.verify_failed = verifyFailed;
+
+    // Complete right away if the cancel can not be sent, there will be no response
+    if (sendExecute(entry->first, current, LONG_WRITE_FLAG_CANCEL) != 0)
+    {
+        complete(entry, current.failure);
+    }
+}
+
+void LongWriteEngine::complete(write_it_t entry, const long_write_completion_t &completion)
+{
+    auto done = completion;
+    done.id = entry->second.id;
+    done.conn_handle = entry->first;
+    done.request_count = entry->second.request_count;
+
+    writes.erase(entry);
+
+    if (done.executed)
+    {
+        completedCount++;
+    }
+    else
+    {
+        failedCount++;
+    }
+
+    if (done.verify_failed)
+    {
+        verifyFailedCount++;
+    }
+
+    completions.push_back(done);
+
+    if (onCompletion)
+    {
+        onCompletion();
+    }
+}
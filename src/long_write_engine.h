@@ -0,0 +1,161 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LONG_WRITE_ENGINE_H
+#define LONG_WRITE_ENGINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Same values as BLE_GATT_OP_PREP_WRITE_REQ and BLE_GATT_OP_EXEC_WRITE_REQ
+const uint8_t LONG_WRITE_OP_PREP_WRITE_REQ = 0x04;
+const uint8_t LONG_WRITE_OP_EXEC_WRITE_REQ = 0x05;
+
+// Same values as BLE_GATT_EXEC_WRITE_FLAG_PREPARED_CANCEL and BLE_GATT_EXEC_WRITE_FLAG_PREPARED_WRITE
+const uint8_t LONG_WRITE_FLAG_CANCEL = 0x00;
+const uint8_t LONG_WRITE_FLAG_WRITE = 0x01;
+
+// Same value as BLE_GATT_STATUS_SUCCESS
+const uint16_t LONG_WRITE_STATUS_SUCCESS = 0x0000;
+
+// Same values as NRF_ERROR_INVALID_PARAM, NRF_ERROR_INVALID_STATE, NRF_ERROR_BUSY and BLE_ERROR_INVALID_CONN_HANDLE
+const uint32_t LONG_WRITE_ERROR_INVALID_PARAM = 0x0007;
+const uint32_t LONG_WRITE_ERROR_INVALID_STATE = 0x0008;
+const uint32_t LONG_WRITE_ERROR_BUSY = 0x0011;
+const uint32_t LONG_WRITE_ERROR_INVALID_CONN_HANDLE = 0x3002;
+
+typedef struct {
+    uint16_t handle;
+    std::vector<uint8_t> value;
+} long_write_item_t;
+
+typedef struct {
+    uint32_t id;
+    uint16_t conn_handle;
+    uint32_t result;          // Error code from sending a request, or LONG_WRITE_ERROR_INVALID_CONN_HANDLE if the link was lost
+    uint16_t gatt_status;     // GATT status of the response that failed the write
+    uint16_t error_handle;    // Handle the failure refers to
+    bool verify_failed;       // The peer echoed different data than was sent, the queue was cancelled
+    bool executed;            // The peer executed the queued writes
+    uint16_t request_count;
+} long_write_completion_t;
+
+// Writes one or more attribute values with prepare write requests followed by one execute write
+// request, sending each request from the thread receiving the previous response. Every echoed
+// prepare write response is compared with the data sent, so the same queue gives reliable writes
+// across several handles. Any failure cancels the queue on the peer.
+//
+// ATT allows one outstanding request per connection, so there is at most one long write per link.
+// All methods are thread safe.
+class LongWriteEngine
+{
+public:
+    // Sends a prepare or execute write request, returns the SoftDevice error code
+    typedef std::function<uint32_t(uint16_t connHandle, uint8_t writeOp, uint8_t flags, uint16_t handle,
+                                   uint16_t offset, const uint8_t *data, uint16_t length)> write_handler_t;
+    typedef std::function<void()> completion_handler_t;
+
+    LongWriteEngine();
+
+    // onCompletion is called with the lock held whenever a completion is available
+    void setHandlers(write_handler_t write, completion_handler_t onCompletion);
+    void removeHandlers();
+
+    // Sends the first prepare write request, attMtu is the ATT MTU in effect on the link
+    uint32_t start(const uint32_t id, const uint16_t connHandle, std::vector<long_write_item_t> &items, const uint16_t attMtu);
+
+    // Called from the thread receiving events from the SoftDevice, returns false if there is no long write on the link
+    bool onWriteResponse(const uint16_t connHandle, const uint16_t gattStatus, const uint16_t handle,
+                         const uint16_t offset, const uint8_t *data, const uint16_t length);
+    void onDisconnected(const uint16_t connHandle);
+
+    // Completes all long writes as if their links were lost
+    void abortAll();
+
+    void takeCompletions(std::vector<long_write_completion_t> &completions);
+
+    uint32_t getCompletedCount() const;
+    uint32_t getFailedCount() const;
+    uint32_t getVerifyFailedCount() const;
+    uint32_t getRequestCount() const;
+
+private:
+    enum state_t
+    {
+        STATE_PREPARING,
+        STATE_EXECUTING,
+        STATE_CANCELLING
+    };
+
+    typedef struct {
+        uint32_t id;
+        state_t state;
+        uint16_t chunk_size;
+        std::vector<long_write_item_t> items;
+        size_t item;              // Item and offset of the prepare write request sent last
+        uint16_t offset;
+        uint16_t length;
+        uint16_t request_count;
+        long_write_completion_t failure;
+    } write_t;
+
+    typedef std::map<uint16_t, write_t>::iterator write_it_t;
+
+    uint32_t sendPrepare(const uint16_t connHandle, write_t &current);
+    uint32_t sendExecute(const uint16_t connHandle, write_t &current, const uint8_t flags);
+
+    // Records the first failure and cancels the queue on the peer
+    void fail(write_it_t entry, const uint32_t result, const uint16_t gattStatus, const uint16_t errorHandle, const bool verifyFailed);
+    void complete(write_it_t entry, const long_write_completion_t &completion);
+
+    std::mutex mutex;
+    write_handler_t write;
+    completion_handler_t onCompletion;
+
+    std::map<uint16_t, write_t> writes;
+    std::vector<long_write_completion_t> completions;
+
+    std::atomic<uint32_t> completedCount;
+    std::atomic<uint32_t> failedCount;
+    std::atomic<uint32_t> verifyFailedCount;
+    std::atomic<uint32_t> requestCount;
+};
+
+#endif // LONG_WRITE_ENGINE_H
@@ -0,0 +1,184 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "method_stats.h"
+
+#include <algorithm>
+#include <limits>
+
+LatencyHistogram::LatencyHistogram() :
+    buckets(BUCKET_COUNT, 0)
+{
+    reset();
+}
+
+void LatencyHistogram::record(const uint64_t value)
+{
+    buckets[bucketIndex(value)] += 1;
+    count += 1;
+    sum += value;
+    min = std::min(min, value);
+    max = std::max(max, value);
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    min = std::numeric_limits<uint64_t>::max();
+    max = 0;
+    sum = 0;
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+    return count;
+}
+
+uint64_t LatencyHistogram::getMin() const
+{
+    return count > 0 ? min : 0;
+}
+
+uint64_t LatencyHistogram::getMax() const
+{
+    return max;
+}
+
+double LatencyHistogram::getMean() const
+{
+    return count > 0 ? static_cast<double>(sum) / count : 0;
+}
+
+uint64_t LatencyHistogram::getPercentile(const double percentile) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    auto threshold = static_cast<uint64_t>(percentile / 100.0 * count + 0.5);
+    threshold = std::max<uint64_t>(1, std::min(threshold, count));
+    uint64_t cumulative = 0;
+
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        cumulative += buckets[i];
+
+        if (cumulative >= threshold)
+        {
+            return i == BUCKET_COUNT - 1 ? max : std::min(bucketUpperBound(i), max);
+        }
+    }
+
+    return max;
+}
+
+uint32_t LatencyHistogram::bucketIndex(const uint64_t value)
+{
+    if (value < SUB_BUCKET_COUNT)
+    {
+        return static_cast<uint32_t>(value);
+    }
+
+    uint32_t exponent = 63;
+
+    while ((value >> exponent) == 0)
+    {
+        exponent--;
+    }
+
+    if (exponent > MAX_EXPONENT)
+    {
+        return BUCKET_COUNT - 1;
+    }
+
+    auto subBucket = static_cast<uint32_t>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(const uint32_t index)
+{
+    if (index < SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+
+    auto exponent = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+    auto subBucket = static_cast<uint64_t>(index % SUB_BUCKET_COUNT);
+    auto width = static_cast<uint64_t>(1) << (exponent - SUB_BUCKET_BITS);
+
+    return (static_cast<uint64_t>(1) << exponent) + (subBucket + 1) * width - 1;
+}
+
+void MethodStats::record(const char *method, const clock::duration queue, const clock::duration execute, const clock::duration callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &stats = methods[method];
+
+    if (stats.name.empty())
+    {
+        stats.name = method;
+    }
+
+    auto toNanoseconds = [](const clock::duration duration) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        return ns < 0 ? static_cast<uint64_t>(0) : static_cast<uint64_t>(ns);
+    };
+
+    stats.queue.record(toNanoseconds(queue));
+    stats.execute.record(toNanoseconds(execute));
+    stats.callback.record(toNanoseconds(callback));
+}
+
+void MethodStats::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    methods.clear();
+}
+
+std::vector<method_stats_t> MethodStats::getSnapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<method_stats_t> snapshot;
+
+    for (auto &entry : methods)
+    {
+        snapshot.push_back(entry.second);
+    }
+
+    return snapshot;
+}
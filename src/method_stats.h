@@ -0,0 +1,105 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef METHOD_STATS_H
+#define METHOD_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Log-linear latency histogram in the style of HdrHistogram. Values are nanoseconds,
+// each power of two range is split in 8 sub buckets giving a relative error below 12.5%.
+class LatencyHistogram
+{
+public:
+    static const uint32_t SUB_BUCKET_BITS = 3;
+    static const uint32_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static const uint32_t MAX_EXPONENT = 40; // values above ~36 minutes end up in the last bucket
+    static const uint32_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT;
+
+    LatencyHistogram();
+
+    void record(const uint64_t value);
+    void reset();
+
+    uint64_t getCount() const;
+    uint64_t getMin() const;
+    uint64_t getMax() const;
+    double getMean() const;
+
+    // Upper bound of the bucket holding the given percentile, clamped to the recorded maximum
+    uint64_t getPercentile(const double percentile) const;
+
+private:
+    static uint32_t bucketIndex(const uint64_t value);
+    static uint64_t bucketUpperBound(const uint32_t index);
+
+    std::vector<uint32_t> buckets;
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+};
+
+typedef struct {
+    std::string name;
+    LatencyHistogram queue;     // From the JavaScript call until a thread pool worker picks up the job
+    LatencyHistogram execute;   // The SoftDevice call, including the serialization round trip
+    LatencyHistogram callback;  // The After function, including the JavaScript callback
+} method_stats_t;
+
+// Latency statistics for the asynchronous adapter methods, keyed by method name.
+// Records are made from the Main Thread, the lock allows reading from anywhere.
+class MethodStats
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    void record(const char *method, const clock::duration queue, const clock::duration execute, const clock::duration callback);
+    void reset();
+
+    std::vector<method_stats_t> getSnapshot();
+
+private:
+    std::mutex mutex;
+    std::map<std::string, method_stats_t> methods;
+};
+
+#endif // METHOD_STATS_H
@@ -0,0 +1,340 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "notification_fanout.h"
+
+NotificationFanout::NotificationFanout() :
+    nextLinkId(0),
+    sentCount(0),
+    queuedCount(0),
+    droppedCount(0)
+{
+}
+
+void NotificationFanout::addCharacteristic(const uint16_t valueHandle, const uint16_t cccdHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    cccdHandles[cccdHandle] = valueHandle;
+}
+
+void NotificationFanout::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    cccdHandles.clear();
+    links.clear();
+}
+
+void NotificationFanout::onConnected(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // CCCDs are disabled on a new connection until the peer writes them
+    links[connHandle] = link_t();
+    links[connHandle].id = ++nextLinkId;
+}
+
+void NotificationFanout::onDisconnected(const uint16_t connHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto link = links.find(connHandle);
+
+    if (link == links.end())
+    {
+        return;
+    }
+
+    droppedCount += static_cast<uint32_t>(link->second.queue.size());
+    links.erase(link);
+}
+
+bool NotificationFanout::onWrite(const uint16_t connHandle, const uint16_t handle, const uint8_t *data, const uint16_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto cccd = cccdHandles.find(handle);
+
+    if (cccd == cccdHandles.end())
+    {
+        return false;
+    }
+
+    uint16_t value = 0;
+
+    if (length > 0)
+    {
+        value = data[0];
+    }
+
+    if (length > 1)
+    {
+        value |= static_cast<uint16_t>(data[1] << 8);
+    }
+
+    links[connHandle].cccds[cccd->second] = value;
+    return true;
+}
+
+uint16_t NotificationFanout::getCccdValue(const uint16_t connHandle, const uint16_t valueHandle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto link = links.find(connHandle);
+
+    if (link == links.end())
+    {
+        return 0;
+    }
+
+    auto cccd = link->second.cccds.find(valueHandle);
+    return cccd == link->second.cccds.end() ? 0 : cccd->second;
+}
+
+notify_all_result_t NotificationFanout::notifyAll(const uint16_t valueHandle, const std::vector<uint8_t> &data, send_handler_t send)
+{
+    notify_all_result_t result = {};
+    auto shared = std::make_shared<const std::vector<uint8_t>>(data);
+    std::vector<target_t> targets;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (auto &entry : links)
+    {
+        auto connHandle = entry.first;
+        auto &link = entry.second;
+        auto cccd = link.cccds.find(valueHandle);
+
+        if (cccd == link.cccds.end())
+        {
+            continue;
+        }
+
+        uint8_t type = 0;
+
+        if (cccd->second & NOTIFICATION_FANOUT_INDICATE)
+        {
+            type = NOTIFICATION_FANOUT_INDICATE;
+        }
+        else if (cccd->second & NOTIFICATION_FANOUT_NOTIFY)
+        {
+            type = NOTIFICATION_FANOUT_NOTIFY;
+        }
+        else
+        {
+            continue;
+        }
+
+        result.subscriber_count++;
+
+        // Keep the order on links that already wait for TX buffers or are sent on by another thread
+        if (!link.sending && link.queue.empty())
+        {
+            link.sending = true;
+            link.resumeRequested = false;
+            targets.push_back({ connHandle, link.id, type });
+            continue;
+        }
+
+        if (link.queue.size() >= NOTIFICATION_FANOUT_QUEUE_SIZE)
+        {
+            droppedCount++;
+            result.failed_count++;
+            continue;
+        }
+
+        link.queue.push_back({ valueHandle, type, shared });
+        queuedCount++;
+        result.queued_count++;
+    }
+
+    for (auto &target : targets)
+    {
+        lock.unlock();
+        auto sendResult = send(target.conn_handle, valueHandle, target.type, *shared);
+        lock.lock();
+
+        auto link = findLink(target.conn_handle, target.link_id);
+
+        if (sendResult == NOTIFICATION_SENT)
+        {
+            sentCount++;
+            result.sent_count++;
+        }
+        else if (sendResult == NOTIFICATION_FAILED)
+        {
+            result.failed_count++;
+        }
+        else if (link == nullptr)
+        {
+            droppedCount++;
+            result.failed_count++;
+        }
+        else
+        {
+            // Data queued by other threads while sending goes after this
+            link->queue.push_front({ valueHandle, target.type, shared });
+            queuedCount++;
+            result.queued_count++;
+
+            if (!link->resumeRequested)
+            {
+                link->sending = false;
+                continue;
+            }
+        }
+
+        if (link != nullptr)
+        {
+            drain(lock, target.conn_handle, target.link_id, send);
+        }
+    }
+
+    return result;
+}
+
+void NotificationFanout::resume(const uint16_t connHandle, send_handler_t send)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    auto entry = links.find(connHandle);
+
+    if (entry == links.end())
+    {
+        return;
+    }
+
+    auto &link = entry->second;
+
+    // The thread sending on the link retries when it gets busy
+    if (link.sending)
+    {
+        link.resumeRequested = true;
+        return;
+    }
+
+    if (link.queue.empty())
+    {
+        return;
+    }
+
+    link.sending = true;
+    drain(lock, connHandle, link.id, send);
+}
+
+NotificationFanout::link_t *NotificationFanout::findLink(const uint16_t connHandle, const uint32_t linkId)
+{
+    auto entry = links.find(connHandle);
+
+    if (entry == links.end() || entry->second.id != linkId)
+    {
+        return nullptr;
+    }
+
+    return &(entry->second);
+}
+
+// Called with the lock held by the thread that set sending on the link. Sends the queued data until the
+// queue is empty or the SoftDevice is busy, and returns with the lock held and sending cleared.
+void NotificationFanout::drain(std::unique_lock<std::mutex> &lock, const uint16_t connHandle, const uint32_t linkId, send_handler_t &send)
+{
+    while (true)
+    {
+        auto link = findLink(connHandle, linkId);
+
+        // The queue was counted as dropped when the link was lost
+        if (link == nullptr)
+        {
+            return;
+        }
+
+        if (link->queue.empty())
+        {
+            link->sending = false;
+            return;
+        }
+
+        auto pending = link->queue.front();
+        link->resumeRequested = false;
+
+        lock.unlock();
+        auto sendResult = send(connHandle, pending.value_handle, pending.type, *(pending.data));
+        lock.lock();
+
+        link = findLink(connHandle, linkId);
+
+        if (link == nullptr)
+        {
+            return;
+        }
+
+        if (sendResult == NOTIFICATION_BUSY)
+        {
+            if (link->resumeRequested)
+            {
+                continue;
+            }
+
+            link->sending = false;
+            return;
+        }
+
+        if (sendResult == NOTIFICATION_SENT)
+        {
+            sentCount++;
+        }
+        else
+        {
+            droppedCount++;
+        }
+
+        link->queue.pop_front();
+    }
+}
+
+uint32_t NotificationFanout::getSentCount() const
+{
+    return sentCount;
+}
+
+uint32_t NotificationFanout::getQueuedCount() const
+{
+    return queuedCount;
+}
+
+uint32_t NotificationFanout::getDroppedCount() const
+{
+    return droppedCount;
+}
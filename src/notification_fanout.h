@@ -0,0 +1,144 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NOTIFICATION_FANOUT_H
+#define NOTIFICATION_FANOUT_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Pending notifications and indications kept per link while the SoftDevice has no TX buffers
+const size_t NOTIFICATION_FANOUT_QUEUE_SIZE = 64;
+
+// CCCD bits, the same values as BLE_GATT_HVX_NOTIFICATION and BLE_GATT_HVX_INDICATION
+const uint8_t NOTIFICATION_FANOUT_NOTIFY = 0x01;
+const uint8_t NOTIFICATION_FANOUT_INDICATE = 0x02;
+
+enum notification_send_result_t
+{
+    NOTIFICATION_SENT,
+    NOTIFICATION_BUSY,   // No TX buffers or an indication is outstanding, retried when the link has capacity
+    NOTIFICATION_FAILED
+};
+
+typedef struct {
+    uint32_t subscriber_count;
+    uint32_t sent_count;
+    uint32_t queued_count;
+    uint32_t failed_count;   // Including notifications dropped because the link queue was full
+} notify_all_result_t;
+
+// Tracks the CCCD value of each characteristic per connection from the writes received from
+// the peers, and sends notifications or indications to all subscribed links. A link that
+// runs out of TX buffers gets its notifications queued, in order, until the SoftDevice
+// reports that packets were transmitted or an indication was confirmed.
+//
+// All methods are thread safe. The send handler is called with the lock released, so that
+// the thread receiving events is not held up by the SoftDevice round trips. One thread at a
+// time sends on a link, the others queue behind it, so notifications are sent in order.
+class NotificationFanout
+{
+public:
+    typedef std::function<notification_send_result_t(uint16_t connHandle, uint16_t valueHandle, uint8_t type,
+                                                      const std::vector<uint8_t> &data)> send_handler_t;
+
+    NotificationFanout();
+
+    // Characteristics with a CCCD, added when the attribute table is built
+    void addCharacteristic(const uint16_t valueHandle, const uint16_t cccdHandle);
+
+    // The attribute table and all links are gone when the SoftDevice is reset
+    void clear();
+
+    void onConnected(const uint16_t connHandle);
+    void onDisconnected(const uint16_t connHandle);
+
+    // Returns true if handle is a CCCD
+    bool onWrite(const uint16_t connHandle, const uint16_t handle, const uint8_t *data, const uint16_t length);
+
+    uint16_t getCccdValue(const uint16_t connHandle, const uint16_t valueHandle);
+
+    // Sends data to every link subscribed to valueHandle, indications are preferred if both are enabled
+    notify_all_result_t notifyAll(const uint16_t valueHandle, const std::vector<uint8_t> &data, send_handler_t send);
+
+    // Sends queued notifications on connHandle until the SoftDevice is busy again
+    void resume(const uint16_t connHandle, send_handler_t send);
+
+    uint32_t getSentCount() const;
+    uint32_t getQueuedCount() const;
+    uint32_t getDroppedCount() const;
+
+private:
+    typedef struct {
+        uint16_t value_handle;
+        uint8_t type;
+        std::shared_ptr<const std::vector<uint8_t>> data;
+    } pending_t;
+
+    typedef struct {
+        std::map<uint16_t, uint16_t> cccds;   // value handle -> CCCD value
+        std::deque<pending_t> queue;
+        uint32_t id = 0;                      // Tells a new link on a reused connection handle apart
+        bool sending = false;                 // A thread is sending on the link with the lock released
+        bool resumeRequested = false;         // Capacity was reported while sending
+    } link_t;
+
+    typedef struct {
+        uint16_t conn_handle;
+        uint32_t link_id;
+        uint8_t type;
+    } target_t;
+
+    link_t *findLink(const uint16_t connHandle, const uint32_t linkId);
+    void drain(std::unique_lock<std::mutex> &lock, const uint16_t connHandle, const uint32_t linkId, send_handler_t &send);
+
+    std::mutex mutex;
+    std::map<uint16_t, uint16_t> cccdHandles;  // CCCD handle -> value handle
+    std::map<uint16_t, link_t> links;
+    uint32_t nextLinkId;
+
+    std::atomic<uint32_t> sentCount;
+    std::atomic<uint32_t> queuedCount;
+    std::atomic<uint32_t> droppedCount;
+};
+
+#endif // NOTIFICATION_FANOUT_H
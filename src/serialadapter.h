@@ -40,6 +40,10 @@
 
 METHOD_DEFINITIONS(GetAdapterList);
 
+// Hotplug monitoring of adapters, only supported on Linux
+NAN_METHOD(StartAdapterMonitor);
+NAN_METHOD(StopAdapterMonitor);
+
 struct AdapterListBaton : Baton
 {
 public:
@@ -0,0 +1,370 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "serialadapter.h"
+
+#include <nan.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <libudev.h>
+#include <cstring>
+#endif
+
+#if defined(__linux__)
+
+// This compilation unit will be linked several times. So the
+// monitor state and handlers must not have external linkage.
+namespace {
+    const char *SEGGER_VENDOR_ID = "1366";
+    const char *NXP_VENDOR_ID = "0d28";
+
+    struct monitored_adapter_t
+    {
+        std::string comName;
+        std::string manufacturer;
+        std::string serialNumber;
+        std::string pnpId;
+        std::string locationId;
+        std::string vendorId;
+        std::string productId;
+    };
+
+    struct adapter_monitor_t
+    {
+        struct udev *udev = nullptr;
+        struct udev_monitor *monitor = nullptr;
+        uv_poll_t *poll = nullptr;
+        std::unique_ptr<Nan::Callback> callback;
+
+        // Set while events are dispatched to JS. Stopping the monitor from
+        // the callback is then deferred until dispatching is done.
+        bool dispatching = false;
+        bool stopRequested = false;
+
+        // Adapters currently present, keyed by tty syspath. Attributes of the
+        // USB parent are gone when a remove event arrives, so removed adapters
+        // are reported with the information cached when they were added.
+        std::map<std::string, monitored_adapter_t> adapters;
+    };
+
+    std::unique_ptr<adapter_monitor_t> adapterMonitor;
+
+    std::string toString(const char *value)
+    {
+        return value != nullptr ? std::string(value) : std::string();
+    }
+
+    bool getMonitoredAdapter(struct udev_device *tty, monitored_adapter_t &adapter)
+    {
+        const char *devnode = udev_device_get_devnode(tty);
+
+        if (devnode == nullptr)
+        {
+            return false;
+        }
+
+        // The parent is owned by the tty device and must not be unref-ed
+        auto usb = udev_device_get_parent_with_subsystem_devtype(tty, "usb", "usb_device");
+
+        if (usb == nullptr)
+        {
+            return false;
+        }
+
+        const char *idVendor = udev_device_get_sysattr_value(usb, "idVendor");
+
+        // Only add SEGGER and ARM (even though VENDOR_ID is NXPs...) devices
+        if (idVendor == nullptr
+            || (strcmp(idVendor, SEGGER_VENDOR_ID) != 0 && strcmp(idVendor, NXP_VENDOR_ID) != 0))
+        {
+            return false;
+        }
+
+        adapter.comName = devnode;
+        adapter.vendorId = idVendor;
+        adapter.productId = toString(udev_device_get_sysattr_value(usb, "idProduct"));
+        adapter.manufacturer = toString(udev_device_get_sysattr_value(usb, "manufacturer"));
+        adapter.serialNumber = toString(udev_device_get_sysattr_value(usb, "serial"));
+        adapter.locationId = toString(udev_device_get_property_value(tty, "ID_PATH"));
+
+        const auto idSerial = toString(udev_device_get_property_value(tty, "ID_SERIAL"));
+        const auto interfaceNumber = toString(udev_device_get_property_value(tty, "ID_USB_INTERFACE_NUM"));
+
+        if (!idSerial.empty())
+        {
+            adapter.pnpId = "usb-" + idSerial + "-if" + interfaceNumber;
+        }
+
+        return true;
+    }
+
+    v8::Local<v8::Object> toJs(const monitored_adapter_t &adapter)
+    {
+        Nan::EscapableHandleScope scope;
+        v8::Local<v8::Object> item = Nan::New<v8::Object>();
+        Utility::Set(item, "comName", adapter.comName);
+        Utility::Set(item, "manufacturer", adapter.manufacturer);
+        Utility::Set(item, "serialNumber", adapter.serialNumber);
+        Utility::Set(item, "pnpId", adapter.pnpId);
+        Utility::Set(item, "locationId", adapter.locationId);
+        Utility::Set(item, "vendorId", adapter.vendorId);
+        Utility::Set(item, "productId", adapter.productId);
+        return scope.Escape(item);
+    }
+
+    void emitAdapterEvent(const char *eventName, const monitored_adapter_t &adapter)
+    {
+        Nan::HandleScope scope;
+        v8::Local<v8::Value> argv[2];
+        argv[0] = Nan::New<v8::String>(eventName).ToLocalChecked();
+        argv[1] = toJs(adapter);
+
+        Nan::AsyncResource resource("pc-ble-driver-js:adapter-monitor");
+        adapterMonitor->callback->Call(2, argv, &resource);
+    }
+
+    void enumerateAdapters(adapter_monitor_t &monitor)
+    {
+        auto udev_enum = udev_enumerate_new(monitor.udev);
+
+        if (udev_enum == nullptr)
+        {
+            return;
+        }
+
+        udev_enumerate_add_match_subsystem(udev_enum, "tty");
+        udev_enumerate_scan_devices(udev_enum);
+
+        struct udev_list_entry *udev_entry;
+
+        udev_list_entry_foreach(udev_entry, udev_enumerate_get_list_entry(udev_enum))
+        {
+            const char *syspath = udev_list_entry_get_name(udev_entry);
+            auto tty = udev_device_new_from_syspath(monitor.udev, syspath);
+
+            if (tty == nullptr)
+            {
+                continue;
+            }
+
+            monitored_adapter_t adapter;
+
+            if (getMonitoredAdapter(tty, adapter))
+            {
+                monitor.adapters[syspath] = adapter;
+            }
+
+            udev_device_unref(tty);
+        }
+
+        udev_enumerate_unref(udev_enum);
+    }
+
+    void handleDevice(struct udev_device *tty)
+    {
+        const auto action = toString(udev_device_get_action(tty));
+        const auto syspath = toString(udev_device_get_syspath(tty));
+
+        if (action == "add")
+        {
+            monitored_adapter_t adapter;
+
+            if (adapterMonitor->adapters.count(syspath) == 0 && getMonitoredAdapter(tty, adapter))
+            {
+                adapterMonitor->adapters[syspath] = adapter;
+                emitAdapterEvent("added", adapter);
+            }
+        }
+        else if (action == "remove")
+        {
+            auto it = adapterMonitor->adapters.find(syspath);
+
+            if (it != adapterMonitor->adapters.end())
+            {
+                const auto adapter = it->second;
+                adapterMonitor->adapters.erase(it);
+                emitAdapterEvent("removed", adapter);
+            }
+        }
+    }
+
+    void destroyAdapterMonitor(std::unique_ptr<adapter_monitor_t> monitor)
+    {
+        if (monitor->poll != nullptr)
+        {
+            uv_poll_stop(monitor->poll);
+            uv_close(reinterpret_cast<uv_handle_t *>(monitor->poll), [](uv_handle_t *raw_handle) {
+                delete reinterpret_cast<uv_poll_t *>(raw_handle);
+            });
+        }
+
+        if (monitor->monitor != nullptr)
+        {
+            udev_monitor_unref(monitor->monitor);
+        }
+
+        if (monitor->udev != nullptr)
+        {
+            udev_unref(monitor->udev);
+        }
+    }
+
+    std::remove_pointer<uv_poll_cb>::type monitor_poll_handler;
+    void monitor_poll_handler(uv_poll_t *handle, int status, int events)
+    {
+        if (adapterMonitor == nullptr || status < 0 || !(events & UV_READABLE))
+        {
+            return;
+        }
+
+        // Drain all pending events, the socket is non-blocking
+        adapterMonitor->dispatching = true;
+
+        while (!adapterMonitor->stopRequested)
+        {
+            auto tty = udev_monitor_receive_device(adapterMonitor->monitor);
+
+            if (tty == nullptr)
+            {
+                break;
+            }
+
+            handleDevice(tty);
+            udev_device_unref(tty);
+        }
+
+        adapterMonitor->dispatching = false;
+
+        if (adapterMonitor->stopRequested)
+        {
+            destroyAdapterMonitor(std::move(adapterMonitor));
+        }
+    }
+}
+
+NAN_METHOD(StartAdapterMonitor)
+{
+    if (!info[0]->IsFunction())
+    {
+        Nan::ThrowTypeError("First argument must be a function");
+        return;
+    }
+
+    if (adapterMonitor != nullptr)
+    {
+        Nan::ThrowError("Adapter monitor is already started");
+        return;
+    }
+
+    std::unique_ptr<adapter_monitor_t> monitor(new adapter_monitor_t());
+    monitor->udev = udev_new();
+
+    if (monitor->udev != nullptr)
+    {
+        monitor->monitor = udev_monitor_new_from_netlink(monitor->udev, "udev");
+    }
+
+    if (monitor->monitor == nullptr
+        || udev_monitor_filter_add_match_subsystem_devtype(monitor->monitor, "tty", nullptr) < 0
+        || udev_monitor_enable_receiving(monitor->monitor) < 0)
+    {
+        destroyAdapterMonitor(std::move(monitor));
+        Nan::ThrowError("Failed to create udev monitor");
+        return;
+    }
+
+    // Enumerate after receiving is enabled, so that no device added in between is missed
+    enumerateAdapters(*monitor);
+
+    monitor->poll = new uv_poll_t();
+
+    if (uv_poll_init(uv_default_loop(), monitor->poll, udev_monitor_get_fd(monitor->monitor)) != 0)
+    {
+        delete monitor->poll;
+        monitor->poll = nullptr;
+        destroyAdapterMonitor(std::move(monitor));
+        Nan::ThrowError("Failed to poll udev monitor");
+        return;
+    }
+
+    monitor->callback.reset(new Nan::Callback(info[0].As<v8::Function>()));
+    uv_poll_start(monitor->poll, UV_READABLE, monitor_poll_handler);
+
+    v8::Local<v8::Array> adapters = Nan::New<v8::Array>();
+    uint32_t i = 0;
+
+    for (const auto &entry : monitor->adapters)
+    {
+        Nan::Set(adapters, i++, toJs(entry.second));
+    }
+
+    adapterMonitor = std::move(monitor);
+    info.GetReturnValue().Set(adapters);
+}
+
+NAN_METHOD(StopAdapterMonitor)
+{
+    if (adapterMonitor == nullptr)
+    {
+        return;
+    }
+
+    if (adapterMonitor->dispatching)
+    {
+        adapterMonitor->stopRequested = true;
+        return;
+    }
+
+    destroyAdapterMonitor(std::move(adapterMonitor));
+}
+
+#else
+
+NAN_METHOD(StartAdapterMonitor)
+{
+    Nan::ThrowError("Adapter monitoring is not supported on this platform");
+}
+
+NAN_METHOD(StopAdapterMonitor)
+{
+}
+
+#endif
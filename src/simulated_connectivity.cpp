@@ -0,0 +1,311 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "simulated_connectivity.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace {
+    // SoftDevice calls that only report a return code, the JavaScript API does not wait for an event after them
+    const char *supportedMethods[] = {
+        "Close",
+        "ConnReset",
+        "GapStartScan",
+        "GapStopScan",
+        "GapStartAdvertising",
+        "GapStopAdvertising",
+        "GapUpdateConnectionParameters",
+        "GattsHVX",
+        "GattcConfirmHandleValue"
+    };
+
+    const size_t HVX_DATA_OFFSET = offsetof(ble_evt_t, evt.gattc_evt.params.hvx.data);
+    const uint8_t ADVERTISER_COUNT = 16;
+
+    void setPeerAddress(ble_gap_addr_t *addr, const uint16_t index)
+    {
+        addr->addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC;
+        addr->addr[0] = static_cast<uint8_t>(index & 0xFF);
+        addr->addr[1] = static_cast<uint8_t>(index >> 8);
+        addr->addr[BLE_GAP_ADDR_LEN - 1] = 0xC0;
+    }
+
+    void makeConnected(ble_evt_t *event, const uint16_t connHandle)
+    {
+        memset(event, 0, SIMULATED_EVENT_SIZE);
+        event->header.evt_id = BLE_GAP_EVT_CONNECTED;
+        event->header.evt_len = static_cast<uint16_t>(sizeof(ble_evt_t));
+
+        auto gapEvent = &(event->evt.gap_evt);
+        gapEvent->conn_handle = connHandle;
+
+        // The peer is the central, no JavaScript connect operation is waiting for the connection
+        auto connected = &(gapEvent->params.connected);
+        setPeerAddress(&(connected->peer_addr), connHandle);
+        connected->role = BLE_GAP_ROLE_PERIPH;
+        connected->conn_params.min_conn_interval = 24;
+        connected->conn_params.max_conn_interval = 24;
+        connected->conn_params.slave_latency = 0;
+        connected->conn_params.conn_sup_timeout = 400;
+    }
+
+    void makeAdvReport(ble_evt_t *event, const uint64_t count)
+    {
+        // Flags and complete local name
+        const uint8_t data[] = { 0x02, 0x01, 0x06, 0x04, 0x09, 'S', 'i', 'm' };
+
+        memset(event, 0, SIMULATED_EVENT_SIZE);
+        event->header.evt_id = BLE_GAP_EVT_ADV_REPORT;
+        event->header.evt_len = static_cast<uint16_t>(sizeof(ble_evt_t));
+
+        auto gapEvent = &(event->evt.gap_evt);
+        gapEvent->conn_handle = BLE_CONN_HANDLE_INVALID;
+
+        auto report = &(gapEvent->params.adv_report);
+        setPeerAddress(&(report->peer_addr), static_cast<uint16_t>(0x8000 | (count % ADVERTISER_COUNT)));
+        report->rssi = static_cast<int8_t>(-40 - static_cast<int8_t>(count % 40));
+        report->scan_rsp = 0;
+        report->type = BLE_GAP_ADV_TYPE_ADV_IND;
+        report->dlen = sizeof(data);
+        memcpy(report->data, data, sizeof(data));
+    }
+
+    void makeHvx(ble_evt_t *event, const uint16_t connHandle, const uint16_t handle, const uint16_t length, const uint64_t count)
+    {
+        memset(event, 0, SIMULATED_EVENT_SIZE);
+        event->header.evt_id = BLE_GATTC_EVT_HVX;
+        event->header.evt_len = static_cast<uint16_t>(HVX_DATA_OFFSET + length);
+
+        auto gattcEvent = &(event->evt.gattc_evt);
+        gattcEvent->conn_handle = connHandle;
+        gattcEvent->gatt_status = BLE_GATT_STATUS_SUCCESS;
+
+        auto hvx = &(gattcEvent->params.hvx);
+        hvx->handle = handle;
+        hvx->type = BLE_GATT_HVX_NOTIFICATION;
+        hvx->len = length;
+
+        for (uint16_t i = 0; i < length; i++)
+        {
+            hvx->data[i] = static_cast<uint8_t>(count + i);
+        }
+    }
+
+    std::chrono::steady_clock::time_point nextTime(const std::chrono::steady_clock::time_point &start, const uint64_t count, const uint64_t rate)
+    {
+        if (rate == 0)
+        {
+            return std::chrono::steady_clock::time_point::max();
+        }
+
+        // Scheduled from the start time so that the rate does not drift, a late thread catches up
+        return start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(count * 1000000000ULL / rate));
+    }
+}
+
+SimulatedConnectivity::SimulatedConnectivity(const simulated_connectivity_params_t &params) :
+    params(params),
+    stopping(false),
+    paused(false),
+    emitting(false),
+    eventCount(0),
+    callCount(0)
+{
+    // The notification data must fit in the event buffer
+    this->params.hvx_length = static_cast<uint16_t>(std::min<size_t>(this->params.hvx_length, SIMULATED_EVENT_SIZE - HVX_DATA_OFFSET));
+}
+
+SimulatedConnectivity::~SimulatedConnectivity()
+{
+    stop();
+}
+
+void SimulatedConnectivity::start(event_handler_t onEvent)
+{
+    stop();
+
+    this->onEvent = onEvent;
+    stopping = false;
+    thread = std::thread(&SimulatedConnectivity::run, this);
+}
+
+void SimulatedConnectivity::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_all();
+
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+void SimulatedConnectivity::pause()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    paused = true;
+    condition.notify_all();
+    condition.wait(lock, [this] { return !emitting; });
+}
+
+void SimulatedConnectivity::resume()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        paused = false;
+    }
+
+    condition.notify_all();
+}
+
+uint32_t SimulatedConnectivity::call(const char *methodName)
+{
+    callCount++;
+
+    if (params.rpc_latency > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(params.rpc_latency));
+    }
+
+    for (auto supported : supportedMethods)
+    {
+        if (strcmp(supported, methodName) == 0)
+        {
+            return NRF_SUCCESS;
+        }
+    }
+
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+uint32_t SimulatedConnectivity::getEventCount() const
+{
+    return eventCount;
+}
+
+uint32_t SimulatedConnectivity::getCallCount() const
+{
+    return callCount;
+}
+
+void SimulatedConnectivity::run()
+{
+    // uint64_t storage keeps the event aligned
+    std::vector<uint64_t> storage(SIMULATED_EVENT_SIZE / sizeof(uint64_t));
+    auto event = reinterpret_cast<ble_evt_t *>(storage.data());
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // pause() waits for the connections to be reported
+    emitting = true;
+    lock.unlock();
+
+    for (uint32_t connHandle = 0; connHandle < params.connection_count; connHandle++)
+    {
+        makeConnected(event, static_cast<uint16_t>(connHandle));
+        onEvent(event);
+        eventCount++;
+    }
+
+    lock.lock();
+    emitting = false;
+    condition.notify_all();
+
+    // Notifications are sent round robin on the connections
+    const uint64_t advRate = params.adv_report_rate;
+    const uint64_t hvxRate = static_cast<uint64_t>(params.hvx_rate) * params.connection_count;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t advCount = 0;
+    uint64_t hvxCount = 0;
+
+    while (!stopping)
+    {
+        if (paused)
+        {
+            condition.wait(lock, [this] { return stopping || !paused; });
+
+            // Continue at the configured rates instead of catching up with the time paused
+            start = std::chrono::steady_clock::now();
+            advCount = 0;
+            hvxCount = 0;
+            continue;
+        }
+
+        auto nextAdv = nextTime(start, advCount, advRate);
+        auto nextHvx = nextTime(start, hvxCount, hvxRate);
+        auto next = std::min(nextAdv, nextHvx);
+
+        if (next == std::chrono::steady_clock::time_point::max())
+        {
+            condition.wait(lock, [this] { return stopping || paused; });
+            continue;
+        }
+
+        if (condition.wait_until(lock, next, [this] { return stopping || paused; }))
+        {
+            continue;
+        }
+
+        emitting = true;
+        lock.unlock();
+
+        if (nextAdv <= nextHvx)
+        {
+            makeAdvReport(event, advCount++);
+        }
+        else
+        {
+            auto connHandle = static_cast<uint16_t>(hvxCount % params.connection_count);
+            makeHvx(event, connHandle, params.hvx_handle, params.hvx_length, hvxCount++);
+        }
+
+        onEvent(event);
+        eventCount++;
+
+        lock.lock();
+        emitting = false;
+        condition.notify_all();
+    }
+}
@@ -0,0 +1,105 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIMULATED_CONNECTIVITY_H
+#define SIMULATED_CONNECTIVITY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "sd_rpc.h"
+
+// Size of the buffer each synthesized event is built in, Adapter::appendEvent copies this many bytes
+const size_t SIMULATED_EVENT_SIZE = 512;
+
+typedef struct {
+    uint32_t adv_report_rate;   // Advertising reports per second, 0 disables advertising reports
+    uint32_t connection_count;  // Number of connections established when the adapter is opened
+    uint32_t hvx_rate;          // Notifications per second on each connection, 0 disables notifications
+    uint16_t hvx_handle;        // Attribute handle the notifications are sent from
+    uint16_t hvx_length;        // Length of the notification data
+    uint32_t rpc_latency;       // Time in microseconds each SoftDevice call takes
+} simulated_connectivity_params_t;
+
+// Stands in for the connectivity firmware, the serialization transport and the serial port.
+// Synthesizes SoftDevice events at the configured rates in a dedicated thread and completes
+// SoftDevice calls after the configured latency. Used for benchmarking without hardware.
+class SimulatedConnectivity
+{
+public:
+    typedef std::function<void(ble_evt_t *event)> event_handler_t;
+
+    explicit SimulatedConnectivity(const simulated_connectivity_params_t &params);
+    ~SimulatedConnectivity();
+
+    // onEvent is called from the simulator thread, the event is only valid during the call
+    void start(event_handler_t onEvent);
+    void stop();
+
+    // Stops synthesizing events until resume() is called. When pause() returns onEvent is not running,
+    // so that another thread can append events to the adapter. The rates restart from resume().
+    void pause();
+    void resume();
+
+    // Called instead of the SoftDevice call of an async adapter method, runs in a libuv thread pool thread.
+    // Methods that only need a return code from the SoftDevice succeed, others return NRF_ERROR_NOT_SUPPORTED.
+    uint32_t call(const char *methodName);
+
+    uint32_t getEventCount() const;
+    uint32_t getCallCount() const;
+
+private:
+    void run();
+
+    simulated_connectivity_params_t params;
+    event_handler_t onEvent;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    bool stopping;
+    bool paused;
+    bool emitting;
+
+    std::atomic<uint32_t> eventCount;
+    std::atomic<uint32_t> callCount;
+};
+
+#endif // SIMULATED_CONNECTIVITY_H
@@ -0,0 +1,142 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vendor_uuid_registry.h"
+
+#include <algorithm>
+
+namespace {
+    // The SoftDevice supports a handful of vendor specific bases, avoid growing in the common case
+    const size_t EXPECTED_VENDOR_UUID_COUNT = 16;
+
+    const size_t ALIAS_OFFSET = 12;
+}
+
+VendorUuidRegistry::VendorUuidRegistry() :
+    hitCount(0),
+    missCount(0)
+{
+    entries.reserve(EXPECTED_VENDOR_UUID_COUNT);
+}
+
+VendorUuidRegistry::base_t VendorUuidRegistry::toBase(const uint8_t *uuid_le)
+{
+    base_t base;
+    std::copy(uuid_le, uuid_le + VENDOR_UUID_LENGTH, base.begin());
+    base[ALIAS_OFFSET] = 0;
+    base[ALIAS_OFFSET + 1] = 0;
+    return base;
+}
+
+void VendorUuidRegistry::add(const uint8_t type, const uint8_t *uuid_le)
+{
+    auto base = toBase(uuid_le);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto &entry : entries)
+    {
+        if (entry.type == type)
+        {
+            entry.base = base;
+            return;
+        }
+    }
+
+    entries.push_back({ type, base });
+}
+
+bool VendorUuidRegistry::findType(const uint8_t *uuid_le, uint8_t *type)
+{
+    auto base = toBase(uuid_le);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto &entry : entries)
+    {
+        if (entry.base == base)
+        {
+            *type = entry.type;
+            hitCount++;
+            return true;
+        }
+    }
+
+    missCount++;
+    return false;
+}
+
+bool VendorUuidRegistry::getBase(const uint8_t type, uint8_t *uuid_le)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto &entry : entries)
+    {
+        if (entry.type == type)
+        {
+            std::copy(entry.base.begin(), entry.base.end(), uuid_le);
+            hitCount++;
+            return true;
+        }
+    }
+
+    missCount++;
+    return false;
+}
+
+void VendorUuidRegistry::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+size_t VendorUuidRegistry::getCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+uint32_t VendorUuidRegistry::getHitCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+uint32_t VendorUuidRegistry::getMissCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
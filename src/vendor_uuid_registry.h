@@ -0,0 +1,86 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VENDOR_UUID_REGISTRY_H
+#define VENDOR_UUID_REGISTRY_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Length of a 128-bit UUID, bytes 12 and 13 (little endian) hold the 16-bit alias within the base
+const size_t VENDOR_UUID_LENGTH = 16;
+
+// Mirror of the vendor specific UUID table in the SoftDevice. Populated whenever a base is
+// added to or decoded by the SoftDevice and cleared when the SoftDevice is reset or enabled.
+// Lookups do not allocate. All methods are thread safe, bases are added from the worker
+// threads and looked up in the Main Thread.
+class VendorUuidRegistry
+{
+public:
+    VendorUuidRegistry();
+
+    // uuid_le is a 128-bit UUID in little endian, the 16-bit alias is ignored
+    void add(const uint8_t type, const uint8_t *uuid_le);
+    bool findType(const uint8_t *uuid_le, uint8_t *type);
+
+    // Copies the base with the alias set to zero
+    bool getBase(const uint8_t type, uint8_t *uuid_le);
+
+    void clear();
+
+    size_t getCount();
+    uint32_t getHitCount();
+    uint32_t getMissCount();
+
+private:
+    typedef std::array<uint8_t, VENDOR_UUID_LENGTH> base_t;
+
+    typedef struct {
+        uint8_t type;
+        base_t base;
+    } entry_t;
+
+    static base_t toBase(const uint8_t *uuid_le);
+
+    std::mutex mutex;
+    std::vector<entry_t> entries;
+    uint32_t hitCount;
+    uint32_t missCount;
+};
+
+#endif // VENDOR_UUID_REGISTRY_H
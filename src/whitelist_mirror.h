@@ -0,0 +1,81 @@
+/* Copyright (c) 2010 - 2017, Nordic Semiconductor ASA
+ *
+ * All rights reserved.
+ *
+ * Use in source and binary forms, redistribution in binary form only, with
+ * or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 2. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 3. This software, with or without modification, must only be used with a Nordic
+ *    Semiconductor ASA integrated circuit.
+ *
+ * 4. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WHITELIST_MIRROR_H
+#define WHITELIST_MIRROR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Same values as BLE_GAP_ADDR_LEN and BLE_GAP_SEC_KEY_LEN
+const size_t WHITELIST_ADDR_LEN = 6;
+const size_t WHITELIST_IRK_LEN = 16;
+
+typedef struct {
+    uint8_t addr_type;
+    uint8_t addr[WHITELIST_ADDR_LEN];  // Little endian, as used by the SoftDevice
+} whitelist_addr_t;
+
+typedef struct {
+    whitelist_addr_t id_addr;
+    uint8_t irk[WHITELIST_IRK_LEN];
+} whitelist_identity_t;
+
+// The whitelist and device identity list last accepted by the SoftDevice, so that they can be
+// listed without a round trip and passed again where the SoftDevice API wants them per operation.
+// The lists are lost when the SoftDevice is reset. All methods are thread safe.
+class WhitelistMirror
+{
+public:
+    void setAddresses(const std::vector<whitelist_addr_t> &addresses);
+    void setIdentities(const std::vector<whitelist_identity_t> &identities);
+    void clear();
+
+    std::vector<whitelist_addr_t> getAddresses();
+    std::vector<whitelist_identity_t> getIdentities();
+
+    uint32_t getAddressCount();
+    uint32_t getIdentityCount();
+
+private:
+    std::mutex mutex;
+    std::vector<whitelist_addr_t> addresses;
+    std::vector<whitelist_identity_t> identities;
+};
+
+#endif // WHITELIST_MIRROR_H
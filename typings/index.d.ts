@@ -10,10 +10,24 @@ export declare interface AdapterOpenOptions {
   parity?: string;
   flowControl?: string;
   eventInterval?: number;
+  eventMaxLatency?: number;
+  eventMaxBatchSize?: number;
   logLevel?: string;
   retransmissionInterval?: number;
   responseTimeout?: number;
   enableBLE?: boolean;
+  sharedEventDispatcher?: boolean;
+  physicalLayer?: 'uart' | 'simulated';
+  simulation?: SimulationOptions;
+}
+
+export declare interface SimulationOptions {
+  advReportRate?: number;
+  connectionCount?: number;
+  hvxRate?: number;
+  hvxHandle?: number;
+  hvxLength?: number;
+  rpcLatency?: number;
 }
 
 export declare interface AdapterStatus {
@@ -33,6 +47,8 @@ export declare interface ScanParameters {
   interval: number;
   window: number;
   timeout: number;
+  use_whitelist?: number | boolean;
+  adv_dir_report?: number | boolean;
 }
 
 export declare interface ConnectionParameters {
@@ -133,6 +149,11 @@ export declare interface Device {
   maxConnectionInterval:number;
   slaveLatency:number;
   connectionSupervisionTimeout:number;
+  attMtu: number | null;
+  maxTxOctets: number | null;
+  maxRxOctets: number | null;
+  txPhy: number | null;
+  rxPhy: number | null;
   paired:boolean;
   name: string;
   rssi: number;
@@ -177,6 +198,62 @@ export declare interface Characteristic {
   properties: CharacteristicProperties;
 }
 
+export declare interface NotifyAllResult {
+  subscriberCount: number;
+  sentCount: number;
+  queuedCount: number;
+  failedCount: number;
+}
+
+export declare interface ScheduledConnectOptions extends ConnectionOptions {
+  priority?: number;
+  maxRetries?: number;
+  retryDelay?: number;
+}
+
+export declare interface ScheduledConnectStats {
+  attempts: number;
+  waitTime: number;
+  connectTime: number;
+  totalTime: number;
+  hciStatus: number;
+}
+
+export declare interface DeviceIdentity {
+  address: string | Address;
+  irk: Array<number>;
+}
+
+export declare interface Whitelist {
+  addresses: Address[];
+  identities: { address: Address, irk: Array<number> }[];
+}
+
+export declare interface LinkPolicy {
+  attMtu?: number;
+  maxTxOctets?: number;
+  maxRxOctets?: number;
+  txPhys?: number;
+  rxPhys?: number;
+  connEventExtension?: boolean;
+}
+
+export declare interface ConnParamPolicy {
+  mode: 'defer' | 'accept' | 'clamp' | 'reject';
+  minConnectionInterval?: number;
+  maxConnectionInterval?: number;
+  maxSlaveLatency?: number;
+  minConnectionSupervisionTimeout?: number;
+  maxConnectionSupervisionTimeout?: number;
+}
+
+export declare interface AuthorizePolicy {
+  read?: 'defer' | 'accept' | 'value' | 'reject';
+  write?: 'defer' | 'accept' | 'value' | 'reject';
+  rejectStatus?: number;
+  value?: Array<number> | Uint8Array;
+}
+
 export declare interface Descriptor {
   instanceId: string;
   characteristicInstanceId: string;
@@ -190,15 +267,34 @@ declare class Adapter extends EventEmitter {
   instanceId: string;
   driver: any;
   state: AdapterState;
+  centralConnectionCount: number;
 
   open(options?: AdapterOpenOptions, callback?: (err: any) => void): void;
   close(callback?: (err: any) => void): void;
   enableBLE(options: any, callback?: (err: any) => void): void; // FIXME: define options
+  startEventTrace(path: string, options?: { maxFileSize?: number, maxFiles?: number }): void;
+  stopEventTrace(): void;
+  startEventReplay(path: string, options?: { speed?: number, adapterId?: number }, callback?: (err: any, eventCount: number) => void): void;
+  stopEventReplay(): void;
+  getLinkStats(): any[];
+  getMethodStats(): any;
+  resetMethodStats(): void;
+  enableBondStore(path: string, options?: { autoReply?: boolean, autoEncrypt?: boolean }): void;
+  disableBondStore(): void;
+  getBonds(): any[];
+  deleteBond(address: any): boolean;
+  enableLescDhKeyAutoReply(): void;
+  disableLescDhKeyAutoReply(): void;
   startScan(options: ScanParameters, callback?: (err: any) => void): void;
   stopScan(callback?: (err: any) => void): void;
 
   connect(deviceAddress: string | Address, options: ConnectionOptions, callback?: (err: any) => void): void;
   cancelConnect(callback?: (err: any) => void): void;
+  scheduleConnect(deviceAddress: string | Address, options: ScheduledConnectOptions, callback?: (err: any, device?: Device, stats?: ScheduledConnectStats) => void): number;
+  cancelScheduledConnect(id: number): boolean;
+  setWhitelist(addresses: Array<string | Address>, callback?: (err: any) => void): void;
+  setDeviceIdentities(identities: DeviceIdentity[], callback?: (err: any) => void): void;
+  getWhitelist(): Whitelist;
   disconnect(deviceInstanceId: string, callback?: (err: any) => void): void;
 
   getState(callback: (err: any, state: AdapterState) => void): void;
@@ -208,7 +304,11 @@ declare class Adapter extends EventEmitter {
 
   updateConnectionParameters(deviceInstanceId: string, options: ConnectionParameters, callback?: (err: any) => void): void;
   rejectConnParams(deviceInstanceId: string, callback?: (err: any) => void): void;
+  setConnParamPolicy(policy: ConnParamPolicy, deviceInstanceId?: string): void;
+  clearConnParamPolicy(deviceInstanceId?: string): boolean;
   requestAttMtu(deviceInstanceId: string, mtu: number, callback?: (err: any, value: number) => void): void;
+  setLinkPolicy(policy: LinkPolicy, callback?: (err: any) => void): void;
+  clearLinkPolicy(callback?: (err: any) => void): void;
   getCurrentAttMtu(deviceInstanceId: string): number|undefined;
 
   getService(serviceInstanceId: string): Service;
@@ -219,8 +319,14 @@ declare class Adapter extends EventEmitter {
   getDescriptors(characteristicId: string, callback?: (err?: any, descriptors?: Array<Descriptor>) => void): void;
   readCharacteristicValue(characteristicId: string, callback?: (err: any, bytesRead: Array<number>) => void): void;
   writeCharacteristicValue(characteristicId: string, value: Array<number>, ack: boolean, callback?: (error: Error) => void): void;
+  notifyCharacteristicValue(characteristicId: string, value: Array<number> | Uint8Array, callback?: (error: Error, result: NotifyAllResult) => void): void;
+  setAuthorizePolicy(attributeId: string, policy: AuthorizePolicy): void;
+  clearAuthorizePolicy(attributeId: string): boolean;
+  setAuthorizeValue(attributeId: string, value: Array<number> | Uint8Array): boolean;
+  getAuthorizeValue(attributeId: string): Array<number> | undefined;
   readDescriptorValue(descriptorId: string, callback?: (err: any, value: Array<number>) => void): void;
   writeDescriptorValue(descriptorId: string, value: Array<number>, ack: boolean, callback?: (error: Error) => void): void;
+  writeReliable(writes: Array<{ attributeId: string, value: Array<number> }>, callback?: (error: Error, attributes: Array<Characteristic | Descriptor>) => void): void;
 
   authenticate(deviceInstanceId: string, secParams: any, callback?: (err: any) => void): void;
   replySecParams(deviceInstanceId: string, secStatus: number, secParams: SecurityParameters | null, secKeys: SecurityKeys | null, callback?: (err: any, keyset?: any) => void): void;
@@ -250,6 +356,7 @@ declare class Adapter extends EventEmitter {
   on(event: 'authKeyRequest', listener: (device: Device, keyType: string) => void): this;
   on(event: 'keyPressed', listener: (device: Device, keyPressNotificationType: string) => void): this;
   on(event: 'lescDhkeyRequest', listener: (device: Device, pk_peer: any) => void): this; // FIXME: define pk_peer
+  on(event: 'lescDhkeyReplied', listener: (device: Device, peerKeyValid: boolean) => void): this;
   on(event: 'secInfoRequest', listener: (device: Device, event: any) => void): this; // FIXME: define event
   on(event: 'securityRequest', listener: (device: Device, event: any) => void): this; // FIXME: define event
   on(event: 'connParamUpdateRequest', listener: (device: Device, connectionParameters: ConnectionParameters) => void): this;
@@ -309,8 +416,37 @@ export declare interface DfuTransportParameters {
 }
 
 export declare class Dfu extends EventEmitter {
-  constructor(transportType: string, transportParameters: DfuTransportParameters);
+  constructor(transportType: string, transportParameters: DfuTransportParameters, transportFactory?: (transportParameters: DfuTransportParameters) => any);
+  static createTransport(transportParameters: DfuTransportParameters): any;
   performDFU(zipFilePath: string, callback: (err?: any, abort?: boolean) => void): void;
+  performUpdates(updates: any[], callback: (err?: any, abort?: boolean) => void): void;
+  fetchUpdates(zipFilePath: string, callback: (err?: any, updates?: any[]) => void): void;
+  abort(): void;
+}
+
+export declare interface DfuTarget {
+  address: string;
+  addressType: string;
+}
+
+export declare interface DfuOrchestratorOptions {
+  maxJobsPerAdapter?: number;
+  prnValue?: number;
+  mtuSize?: number;
+  progressInterval?: number;
+  transportFactory?: (transportParameters: DfuTransportParameters) => any;
+}
+
+export declare interface DfuJobResult {
+  target: DfuTarget;
+  adapterInstanceId?: string;
+  error?: any;
+  aborted: boolean;
+}
+
+export declare class DfuOrchestrator extends EventEmitter {
+  constructor(adapters: Adapter[], options?: DfuOrchestratorOptions);
+  performDFU(zipFilePath: string, targets: DfuTarget[], callback: (err?: any, results?: DfuJobResult[]) => void): void;
   abort(): void;
 }
 